@@ -0,0 +1,2309 @@
+/******************************************************************************
+ * @file    bench.c
+ * @brief   Simple calculator benchmarks
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Times every operator in scalar (direct perform_* calls), dispatch
+ * (calc_execute per element) and SIMD (calc_apply_isa per instruction set)
+ * form, with a second operand shared by every lane (generic, detected by
+ * calc_apply, and as a literal inlined into calc_const.h's kernels), and
+ * again on 64 and 128-bit operands, reductions per instruction set and
+ * thread count against a fold of perform_addition, arbitrary precision
+ * operators
+ * on small and large operands, operand parsing and result formatting
+ * against their libc counterparts, compiling expressions (on the heap and
+ * into an arena) and evaluating them interpreted and JIT compiled,
+ * end-to-end text and binary batch throughput at several input sizes, from
+ * files and pipes, round trips to a server through both I/O backends, a
+ * batch sharded across servers, and one-shot runs of simplecalc and
+ * calc-static from exec to exit.
+ * Each benchmark is calibrated to run for at least BENCH_MIN_SAMPLE seconds
+ * per sample and sampled BENCH_REPEATS times.
+ *
+ * Results are printed and also written as tab separated lines (name, mean
+ * ns/op, standard deviation, best ns/op, ops/s, cycles/op). Passing such a
+ * file back with --baseline flags every benchmark whose best time got more
+ * than BENCH_REGRESSION slower, and makes the run fail.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "calc.h"
+#include "calc_const.h"
+#define BENCH_OPERANDS        100000
+#define BENCH_LANES           4096 // Operator arrays stay in L1/L2
+#define BENCH_REPEATS         10
+#define BENCH_MIN_SAMPLE      0.002
+#define BENCH_REGRESSION      0.10
+#define BENCH_NAME_MAX        64
+#define BENCH_BASELINE        512
+#define OPERAND_MAX           16
+#define BENCH_VARIABLES       4
+#define BENCH_SKEWED_LINES    1000000
+#define BENCH_SKEWED_DISTINCT 4096
+#define BENCH_CACHE_ENTRIES   16384
+#define BENCH_PIPELINED       1000
+#define BENCH_REDUCE_VALUES   (1u << 22) // Past the last level cache
+#define BENCH_COORD_NODES     2
+#define BENCH_COORD_SHARD     4096
+#define BENCH_COORD_CREDITS   4
+#define BENCH_COORD_TIMEOUT   60000 // Milliseconds
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+/******************************************************************************
+ * @brief    Run shared by every benchmark: where results go, what they are
+ *           compared against and which benchmarks are selected
+ ******************************************************************************/
+typedef struct
+{
+    FILE *       output;
+    const char * filter;
+    size_t       baseline_count;
+    char         baseline_names[BENCH_BASELINE][BENCH_NAME_MAX];
+    double       baseline_best[BENCH_BASELINE];
+    int          regressions;
+} bench_state;
+
+/******************************************************************************
+ * @brief    Operand arrays for the operator benchmarks
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t operand1[BENCH_LANES];
+    uint32_t operand2[BENCH_LANES];
+    uint32_t result[BENCH_LANES];
+    uint8_t  error_mask[BENCH_LANES / 8];
+    calc_op  op;
+    calc_isa isa;
+} bench_arrays;
+
+/******************************************************************************
+ * @brief    Operand arrays for the wide operator benchmarks; 128-bit lanes
+ *           are the 64-bit operands sign extended
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t   operand1[BENCH_LANES];
+    uint64_t   operand2[BENCH_LANES];
+    uint64_t   result[BENCH_LANES];
+    uint8_t    error_mask[BENCH_LANES / 8];
+    calc_op    op;
+    calc_isa   isa;
+    calc_width width;
+} bench_arrays64;
+
+/******************************************************************************
+ * @brief    Operands for the arbitrary precision benchmarks: BENCH_LANES small
+ *           pairs, or the first pair only when large
+ ******************************************************************************/
+typedef struct
+{
+    calc_big        operand1[BENCH_LANES];
+    calc_big        operand2[BENCH_LANES];
+    calc_big_result result;
+    calc_op         op;
+} bench_big_data;
+
+typedef struct
+{
+    const char (*texts)[OPERAND_MAX];
+    const size_t * lengths;
+    size_t         count;
+    int (*parse)(const char *, size_t, uint32_t *);
+} bench_parse_data;
+
+typedef struct
+{
+    const calc_result * results;
+    size_t              count;
+} bench_format_data;
+
+/******************************************************************************
+ * @brief    Division operands, and the format to print their quotients in
+ ******************************************************************************/
+typedef struct
+{
+    const int32_t * dividends;
+    const int32_t * divisors;
+    size_t          count;
+    calc_div_format format;
+} bench_division_data;
+
+/******************************************************************************
+ * @brief    Input for the end-to-end benchmarks
+ ******************************************************************************/
+typedef struct
+{
+    const char *    text;       // Expressions, for calc_batch_eval
+    size_t          length;
+    size_t          lines;
+    calc_buffer     output;
+    int             input_fd;   // Same input as a file, for the run benchmarks
+    int             output_fd;  // /dev/null
+    unsigned        threads;
+    unsigned        numa_nodes; // Nodes to pin the threads to; 0 for none
+    calc_cache *    cache;      // Result cache for calc_batch_eval, or NULL
+    size_t          cache_size; // Entries per thread for the run benchmarks
+    calc_io         io;         // Backend for the run benchmarks
+    int             feed_fd;    // Write end of the pipe run_batch_pipe reads
+    calc_div_format division;   // Division output; zero is the classic one
+} bench_batch_data;
+
+/******************************************************************************
+ * @brief    A compiled expression and bindings to evaluate it against
+ ******************************************************************************/
+typedef struct
+{
+    const char * text;
+    calc_expr *  expr;
+    calc_arena * arena; // Reset after every compile into it
+    uint32_t     bindings[BENCH_LANES][BENCH_VARIABLES];
+    uint32_t     columns[BENCH_VARIABLES][BENCH_LANES]; // The same, transposed
+    double       results[BENCH_LANES];
+    uint8_t      error_mask[BENCH_LANES / 8];
+} bench_expr_data;
+
+/******************************************************************************
+ * @brief    Values for the reduction benchmarks, and the run to time
+ ******************************************************************************/
+typedef struct
+{
+    const uint32_t * values;
+    size_t           count;
+    calc_reduce_op   op;
+    calc_isa         isa;
+    unsigned         threads;
+    int              input_fd; // The values as text lines, for calc_batch
+} bench_reduce_data;
+
+typedef size_t (*bench_fn)(void * context);
+
+typedef struct
+{
+    const char * name;
+    const char * symbol;
+    calc_op      op;
+    bench_fn     scalar;
+} bench_operator;
+
+// Keeps results observable so no kernel is optimised away
+static volatile uint32_t bench_sink;
+
+// Function Prototypes
+double   now_seconds(void);
+uint64_t now_cycles(void);
+void     bench_run(bench_state * state,
+                   const char *  name,
+                   bench_fn      fn,
+                   void *        context);
+int      load_baseline(bench_state * state, const char * path);
+int      parse_strtoul(const char * text, size_t length, uint32_t * value);
+size_t   run_parse(void * context);
+size_t   run_format_printf(void * context);
+size_t   run_format_calc(void * context);
+size_t   run_format_division(void * context);
+size_t   run_dispatch(void * context);
+size_t   run_simd(void * context);
+size_t   run_dispatch_wide(void * context);
+size_t   run_simd64(void * context);
+size_t   run_big_small(void * context);
+size_t   run_big_large(void * context);
+size_t   run_batch_eval(void * context);
+size_t   run_batch_file(void * context);
+size_t   run_batch_pipe(void * context);
+void *   feed_pipe(void * context);
+size_t   run_binary_file(void * context);
+size_t   run_server_round_trip(void * context);
+size_t   run_coord(void * context);
+size_t   run_startup(void * context);
+void     bench_operators(bench_state * state);
+size_t   run_apply(void * context);
+void     bench_constant(bench_state * state);
+void     bench_wide(bench_state * state);
+size_t   run_reduce_fold(void * context);
+size_t   run_reduce(void * context);
+size_t   run_reduce_text(void * context);
+void     bench_reduce(bench_state * state);
+int      random_big(calc_big * value, size_t digits);
+void     bench_big(bench_state * state);
+void     bench_parse(bench_state * state);
+void     bench_format(bench_state * state);
+size_t   run_expr_compile(void * context);
+size_t   run_expr_compile_arena(void * context);
+size_t   run_expr_eval(void * context);
+size_t   run_expr_eval_columns(void * context);
+void     bench_expressions(bench_state * state);
+void     bench_batch(bench_state * state, size_t lines);
+void     bench_cache(bench_state * state);
+void     bench_server(bench_state * state, calc_io io);
+void *   bench_serve(void * server);
+void     bench_coord(bench_state * state);
+void     count_answer(void * context, const calc_client_answer * answer);
+void     wait_for_answers(calc_client * client);
+size_t   run_client_round_trip(void * context);
+size_t   run_client_pipelined(void * context);
+size_t   run_client_batch(void * context);
+void     bench_client(bench_state * state);
+void     bench_startup(bench_state * state);
+void     bench_binary(bench_state * state, size_t rows);
+int      write_temp_file(const void * data, size_t length);
+uint32_t random_operand(void);
+uint64_t random_operand64(void);
+
+/******************************************************************************
+ * @brief    Monotonic clock in seconds
+ ******************************************************************************/
+double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/******************************************************************************
+ * @brief    Time stamp counter, or 0 where there is none
+ * @note     The TSC ticks at a constant reference rate, which is not the
+ *           core clock when the CPU boosts or throttles.
+ ******************************************************************************/
+uint64_t now_cycles(void)
+{
+#if defined(BENCH_HAVE_TSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/******************************************************************************
+ * @brief    Random 32-bit operand of random magnitude
+ ******************************************************************************/
+uint32_t random_operand(void)
+{
+    uint32_t value = ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+    return value >> ((uint32_t)rand() % 32);
+}
+
+/******************************************************************************
+ * @brief    Random 64-bit operand of random magnitude
+ ******************************************************************************/
+uint64_t random_operand64(void)
+{
+    uint64_t value = ((uint64_t)random_operand() << 32) ^ random_operand();
+    return value >> ((uint32_t)rand() % 64);
+}
+
+/******************************************************************************
+ * @brief    Calibrate, sample and report one benchmark
+ * @param    state   Run state
+ * @param    name    Benchmark name, without spaces
+ * @param    fn      Runs the benchmark once and returns the operations done
+ * @param    context Passed to fn
+ ******************************************************************************/
+void bench_run(bench_state * state,
+               const char *  name,
+               bench_fn      fn,
+               void *        context)
+{
+    double   samples[BENCH_REPEATS];
+    double   mean      = 0.0;
+    double   variance  = 0.0;
+    double   best      = 0.0;
+    double   cycles    = 0.0;
+    size_t   calls     = 1;
+    uint64_t total_ops = 0;
+
+    if (NULL != state->filter &&
+        0 != strncmp(name, state->filter, strlen(state->filter)))
+    {
+        return;
+    }
+
+    // Grow the calls per sample until a sample is long enough to time
+    for (;;)
+    {
+        double start = now_seconds();
+        for (size_t call = 0; call < calls; call++)
+        {
+            (void)fn(context);
+        }
+        if (now_seconds() - start >= BENCH_MIN_SAMPLE)
+        {
+            break;
+        }
+        calls *= 2;
+    }
+
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+    {
+        size_t   ops         = 0;
+        double   start       = now_seconds();
+        uint64_t start_cycle = now_cycles();
+        for (size_t call = 0; call < calls; call++)
+        {
+            ops += fn(context);
+        }
+        uint64_t elapsed_cycles = now_cycles() - start_cycle;
+        double   elapsed        = now_seconds() - start;
+
+        samples[repeat] = elapsed * 1e9 / (double)ops;
+        cycles += (double)elapsed_cycles;
+        total_ops += ops;
+        mean += samples[repeat];
+        if (0 == repeat || samples[repeat] < best)
+        {
+            best = samples[repeat];
+        }
+    }
+    mean /= BENCH_REPEATS;
+    for (int repeat = 0; repeat < BENCH_REPEATS; repeat++)
+    {
+        double delta = samples[repeat] - mean;
+        variance += delta * delta;
+    }
+    double stddev = sqrt(variance / (BENCH_REPEATS - 1));
+    cycles /= (double)total_ops;
+
+    printf("%-32s %9.2f ns/op +-%5.1f%% %13.0f ops/s",
+           name,
+           mean,
+           100.0 * stddev / mean,
+           1e9 / mean);
+#if defined(BENCH_HAVE_TSC)
+    printf(" %8.2f cyc/op", cycles);
+#endif
+
+    for (size_t i = 0; i < state->baseline_count; i++)
+    {
+        if (0 == strcmp(state->baseline_names[i], name))
+        {
+            double change = (best - state->baseline_best[i]) /
+                            state->baseline_best[i];
+            printf(" %+7.1f%%", 100.0 * change);
+            if (change > BENCH_REGRESSION)
+            {
+                printf(" REGRESSION");
+                state->regressions++;
+            }
+            break;
+        }
+    }
+    printf("\n");
+
+    if (NULL != state->output)
+    {
+        fprintf(state->output,
+                "%s\t%.3f\t%.3f\t%.3f\t%.0f\t%.3f\n",
+                name,
+                mean,
+                stddev,
+                best,
+                1e9 / mean,
+                cycles);
+    }
+}
+
+/******************************************************************************
+ * @brief    Read the results of an earlier run to compare against
+ * @return   1 if successful, 0 if the file cannot be read
+ ******************************************************************************/
+int load_baseline(bench_state * state, const char * path)
+{
+    char   line[256];
+    FILE * file = fopen(path, "r");
+
+    if (NULL == file)
+    {
+        return 0;
+    }
+    while (state->baseline_count < BENCH_BASELINE &&
+           NULL != fgets(line, sizeof(line), file))
+    {
+        size_t index = state->baseline_count;
+        double mean;
+        double stddev;
+
+        if ('#' != line[0] &&
+            4 == sscanf(line,
+                        "%63s %lf %lf %lf",
+                        state->baseline_names[index],
+                        &mean,
+                        &stddev,
+                        &state->baseline_best[index]) &&
+            state->baseline_best[index] > 0.0)
+        {
+            state->baseline_count++;
+        }
+    }
+    fclose(file);
+    return 1;
+}
+
+// Direct calls of each perform_* function over the operand arrays
+#define SCALAR_KERNEL_INT(name, function, type)                            \
+    static size_t name(void * context)                                     \
+    {                                                                      \
+        bench_arrays * data = context;                                     \
+        uint32_t       sum  = 0;                                           \
+        for (size_t i = 0; i < BENCH_LANES; i++)                           \
+        {                                                                  \
+            type value = 0;                                                \
+            (void)function((int32_t)data->operand1[i],                     \
+                           (int32_t)data->operand2[i],                     \
+                           &value);                                        \
+            sum += (uint32_t)(int64_t)value;                               \
+        }                                                                  \
+        bench_sink += sum;                                                 \
+        return BENCH_LANES;                                                \
+    }
+
+#define SCALAR_KERNEL_UINT(name, function)                                 \
+    static size_t name(void * context)                                     \
+    {                                                                      \
+        bench_arrays * data = context;                                     \
+        for (size_t i = 0; i < BENCH_LANES; i++)                           \
+        {                                                                  \
+            data->result[i] =                                              \
+                function(data->operand1[i], data->operand2[i]);            \
+        }                                                                  \
+        bench_sink += data->result[BENCH_LANES - 1];                       \
+        return BENCH_LANES;                                                \
+    }
+
+SCALAR_KERNEL_INT(scalar_addition, perform_addition, int32_t)
+SCALAR_KERNEL_INT(scalar_subtraction, perform_subtraction, int32_t)
+SCALAR_KERNEL_INT(scalar_multiplication, perform_multiplication, int32_t)
+SCALAR_KERNEL_INT(scalar_division, perform_division, double)
+SCALAR_KERNEL_INT(scalar_modulo, perform_modulo, int32_t)
+SCALAR_KERNEL_UINT(scalar_left_shift, perform_left_shift)
+SCALAR_KERNEL_UINT(scalar_right_shift, perform_right_shift)
+SCALAR_KERNEL_UINT(scalar_and, perform_and)
+SCALAR_KERNEL_UINT(scalar_or, perform_or)
+SCALAR_KERNEL_UINT(scalar_xor, perform_xor)
+SCALAR_KERNEL_UINT(scalar_rotate_left, rotate_left)
+SCALAR_KERNEL_UINT(scalar_rotate_right, rotate_right)
+
+static const bench_operator operators[] = {
+    { "addition", "+", CALC_OP_ADD, scalar_addition },
+    { "subtraction", "-", CALC_OP_SUB, scalar_subtraction },
+    { "multiplication", "*", CALC_OP_MUL, scalar_multiplication },
+    { "division", "/", CALC_OP_DIV, scalar_division },
+    { "modulo", "%", CALC_OP_MOD, scalar_modulo },
+    { "left_shift", "<<", CALC_OP_SHL, scalar_left_shift },
+    { "right_shift", ">>", CALC_OP_SHR, scalar_right_shift },
+    { "and", "&", CALC_OP_AND, scalar_and },
+    { "or", "|", CALC_OP_OR, scalar_or },
+    { "xor", "^", CALC_OP_XOR, scalar_xor },
+    { "rotate_left", "<<<", CALC_OP_ROL, scalar_rotate_left },
+    { "rotate_right", ">>>", CALC_OP_ROR, scalar_rotate_right },
+};
+
+#define OPERATOR_COUNT (sizeof(operators) / sizeof(operators[0]))
+
+/******************************************************************************
+ * @brief    One operator through the opcode dispatch, element by element
+ ******************************************************************************/
+size_t run_dispatch(void * context)
+{
+    bench_arrays * data = context;
+    uint32_t       sum  = 0;
+
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        calc_result result =
+            calc_execute(data->op, data->operand1[i], data->operand2[i]);
+        sum += result.value.as_uint;
+    }
+    bench_sink += sum;
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    One operator over the whole array with one instruction set
+ ******************************************************************************/
+size_t run_simd(void * context)
+{
+    bench_arrays * data = context;
+
+    (void)calc_apply_isa(data->isa,
+                         data->op,
+                         data->operand1,
+                         data->operand2,
+                         data->result,
+                         data->error_mask,
+                         BENCH_LANES);
+    bench_sink += data->result[BENCH_LANES - 1];
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    Time every operator in scalar, dispatch and SIMD form
+ ******************************************************************************/
+void bench_operators(bench_state * state)
+{
+    bench_arrays * data = malloc(sizeof(*data));
+    char           name[BENCH_NAME_MAX];
+
+    if (NULL == data)
+    {
+        return;
+    }
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        data->operand1[i] = random_operand();
+        data->operand2[i] = random_operand() | 1; // Never divide by zero
+    }
+
+    for (size_t i = 0; i < OPERATOR_COUNT; i++)
+    {
+        data->op = operators[i].op;
+
+        snprintf(name, sizeof(name), "scalar/%s", operators[i].name);
+        bench_run(state, name, operators[i].scalar, data);
+
+        snprintf(name, sizeof(name), "dispatch/%s", operators[i].name);
+        bench_run(state, name, run_dispatch, data);
+
+        // calc_apply has no division, as it has no 32-bit result
+        for (int isa = 0; isa < CALC_ISA_COUNT && CALC_OP_DIV != data->op;
+             isa++)
+        {
+            if (!calc_isa_supported((calc_isa)isa))
+            {
+                continue;
+            }
+            data->isa = (calc_isa)isa;
+            snprintf(name,
+                     sizeof(name),
+                     "simd/%s/%s",
+                     calc_isa_name(data->isa),
+                     operators[i].name);
+            bench_run(state, name, run_simd, data);
+        }
+    }
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    One operator over the whole array through calc_apply
+ ******************************************************************************/
+size_t run_apply(void * context)
+{
+    bench_arrays * data = context;
+
+    (void)calc_apply(data->op,
+                     data->operand1,
+                     data->operand2,
+                     data->result,
+                     data->error_mask,
+                     BENCH_LANES);
+    bench_sink += data->result[BENCH_LANES - 1];
+    return BENCH_LANES;
+}
+
+// A kernel of calc_const.h with its second operand written out, as a
+// caller that knows it when building would use it
+#define LITERAL_KERNEL(name, kernel, constant)                             \
+    static size_t name(void * context)                                     \
+    {                                                                      \
+        bench_arrays * data = context;                                     \
+        (void)kernel(data->operand1,                                       \
+                     constant,                                             \
+                     data->result,                                         \
+                     NULL,                                                 \
+                     BENCH_LANES);                                         \
+        bench_sink += data->result[BENCH_LANES - 1];                       \
+        return BENCH_LANES;                                                \
+    }
+
+LITERAL_KERNEL(literal_modulo_1000, const_mod_32, 1000)
+LITERAL_KERNEL(literal_modulo_7, const_mod_32, 7)
+LITERAL_KERNEL(literal_right_shift_7, const_shr_32, 7)
+LITERAL_KERNEL(literal_rotate_left_13, const_rol_32, 13)
+
+/******************************************************************************
+ * @brief    Operators whose second operand is the same in every lane:
+ *           through the generic kernels, through calc_apply, which detects
+ *           it, and as a literal
+ ******************************************************************************/
+void bench_constant(bench_state * state)
+{
+    static const struct
+    {
+        const char * name;
+        calc_op      op;
+        uint32_t     operand2;
+        size_t (*literal)(void *);
+    } cases[] = {
+        { "modulo/1000", CALC_OP_MOD, 1000, literal_modulo_1000 },
+        { "modulo/7", CALC_OP_MOD, 7, literal_modulo_7 },
+        { "right_shift/7", CALC_OP_SHR, 7, literal_right_shift_7 },
+        { "rotate_left/13", CALC_OP_ROL, 13, literal_rotate_left_13 },
+    };
+    bench_arrays * data = malloc(sizeof(*data));
+    char           name[BENCH_NAME_MAX];
+
+    if (NULL == data)
+    {
+        return;
+    }
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        data->operand1[i] = random_operand();
+    }
+
+    data->isa = calc_isa_detect();
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        data->op = cases[i].op;
+        for (size_t lane = 0; lane < BENCH_LANES; lane++)
+        {
+            data->operand2[lane] = cases[i].operand2;
+        }
+
+        snprintf(name, sizeof(name), "const/%s/generic", cases[i].name);
+        bench_run(state, name, run_simd, data);
+        snprintf(name, sizeof(name), "const/%s/detected", cases[i].name);
+        bench_run(state, name, run_apply, data);
+        snprintf(name, sizeof(name), "const/%s/literal", cases[i].name);
+        bench_run(state, name, cases[i].literal, data);
+    }
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    One operator at 64 or 128 bits through calc_execute_wide
+ ******************************************************************************/
+size_t run_dispatch_wide(void * context)
+{
+    bench_arrays64 * data = context;
+    uint64_t         sum  = 0;
+
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        calc_wide_result result =
+            calc_execute_wide(data->width,
+                              data->op,
+                              (calc_uint128)(int64_t)data->operand1[i],
+                              (calc_uint128)(int64_t)data->operand2[i]);
+        sum += (uint64_t)result.value;
+    }
+    bench_sink += (uint32_t)sum;
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    One operator over the whole 64-bit array with one instruction set
+ ******************************************************************************/
+size_t run_simd64(void * context)
+{
+    bench_arrays64 * data = context;
+
+    (void)calc_apply64_isa(data->isa,
+                           data->op,
+                           data->operand1,
+                           data->operand2,
+                           data->result,
+                           data->error_mask,
+                           BENCH_LANES);
+    bench_sink += (uint32_t)data->result[BENCH_LANES - 1];
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    Time every operator at 64 and 128 bits, dispatched and as SIMD
+ ******************************************************************************/
+void bench_wide(bench_state * state)
+{
+    bench_arrays64 * data = malloc(sizeof(*data));
+    char             name[BENCH_NAME_MAX];
+
+    if (NULL == data)
+    {
+        return;
+    }
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        data->operand1[i] = random_operand64();
+        data->operand2[i] = random_operand64() | 1; // Never divide by zero
+    }
+
+    for (size_t i = 0; i < OPERATOR_COUNT; i++)
+    {
+        data->op = operators[i].op;
+
+        data->width = CALC_WIDTH_64;
+        snprintf(name, sizeof(name), "dispatch64/%s", operators[i].name);
+        bench_run(state, name, run_dispatch_wide, data);
+
+        data->width = CALC_WIDTH_128;
+        snprintf(name, sizeof(name), "dispatch128/%s", operators[i].name);
+        bench_run(state, name, run_dispatch_wide, data);
+
+        for (int isa = 0; isa < CALC_ISA_COUNT && CALC_OP_DIV != data->op;
+             isa++)
+        {
+            if (!calc_isa_supported((calc_isa)isa))
+            {
+                continue;
+            }
+            data->isa = (calc_isa)isa;
+            snprintf(name,
+                     sizeof(name),
+                     "simd64/%s/%s",
+                     calc_isa_name(data->isa),
+                     operators[i].name);
+            bench_run(state, name, run_simd64, data);
+        }
+    }
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    Sum as a shell loop would build it: perform_addition, left to
+ *           right
+ ******************************************************************************/
+size_t run_reduce_fold(void * context)
+{
+    bench_reduce_data * data  = context;
+    int32_t             total = 0;
+
+    for (size_t i = 0; i < data->count; i++)
+    {
+        if (CALC_OK !=
+            perform_addition(total, (int32_t)data->values[i], &total))
+        {
+            break;
+        }
+    }
+    bench_sink += (uint32_t)total;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    One reduction through calc_reduce_isa
+ ******************************************************************************/
+size_t run_reduce(void * context)
+{
+    bench_reduce_data * data   = context;
+    calc_reduction      result = calc_reduce_isa(
+        data->isa, data->op, data->values, data->count, data->threads, 1);
+
+    bench_sink += (uint32_t)result.value;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Sum of a text file of operands through calc_batch_reduce
+ ******************************************************************************/
+size_t run_reduce_text(void * context)
+{
+    bench_reduce_data * data   = context;
+    calc_batch_counts   counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    calc_reduction      result = { CALC_OK, 0, 0 };
+
+    lseek(data->input_fd, 0, SEEK_SET);
+    (void)calc_batch_reduce(
+        data->input_fd, CALC_REDUCE_SUM, data->threads, 1, &result, &counts);
+    bench_sink += (uint32_t)result.value;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Time every reduction per instruction set on an array in cache,
+ *           and sums of a larger array and of a text file per thread count
+ ******************************************************************************/
+void bench_reduce(bench_state * state)
+{
+    static const struct
+    {
+        const char *   name;
+        calc_reduce_op op;
+    } reductions[] = {
+        { "sum", CALC_REDUCE_SUM },
+        { "xor", CALC_REDUCE_XOR },
+        { "min", CALC_REDUCE_MIN },
+        { "popcount", CALC_REDUCE_POPCOUNT },
+    };
+    static const unsigned threads[] = { 1, 2, 4, 8 };
+    uint32_t * values = malloc(BENCH_REDUCE_VALUES * sizeof(*values));
+    calc_buffer       text = { NULL, 0, 0 };
+    bench_reduce_data data;
+    char              name[BENCH_NAME_MAX];
+
+    if (NULL == values)
+    {
+        return;
+    }
+    for (size_t i = 0; i < BENCH_REDUCE_VALUES; i++)
+    {
+        // Small enough that the fold of perform_addition never overflows
+        values[i] = (uint32_t)((int32_t)(random_operand() % 1024) - 512);
+    }
+
+    memset(&data, 0, sizeof(data));
+    data.values = values;
+    data.count  = BENCH_LANES;
+    data.op     = CALC_REDUCE_SUM;
+    bench_run(state, "reduce/sum/perform_addition", run_reduce_fold, &data);
+    for (size_t i = 0; i < sizeof(reductions) / sizeof(reductions[0]); i++)
+    {
+        data.op = reductions[i].op;
+        for (int isa = 0; isa < CALC_ISA_COUNT; isa++)
+        {
+            if (!calc_isa_supported((calc_isa)isa))
+            {
+                continue;
+            }
+            data.isa = (calc_isa)isa;
+            snprintf(name,
+                     sizeof(name),
+                     "reduce/%s/%s",
+                     reductions[i].name,
+                     calc_isa_name(data.isa));
+            bench_run(state, name, run_reduce, &data);
+        }
+    }
+
+    data.op    = CALC_REDUCE_SUM;
+    data.isa   = calc_isa_detect();
+    data.count = BENCH_REDUCE_VALUES;
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+    {
+        data.threads = threads[i];
+        snprintf(name, sizeof(name), "reduce/array/threads/%u", threads[i]);
+        bench_run(state, name, run_reduce, &data);
+    }
+
+    // Some of the same values as text, one per line
+    data.count = BENCH_OPERANDS * 10;
+    for (size_t i = 0; i < data.count; i++)
+    {
+        if (!calc_buffer_reserve(&text, CALC_FORMAT_MAX))
+        {
+            break;
+        }
+        text.used +=
+            calc_format_int32(text.data + text.used, (int32_t)values[i]);
+        text.data[text.used++] = '\n';
+    }
+    data.input_fd = write_temp_file(text.data, text.used);
+    for (size_t i = 0; data.input_fd >= 0 && i < 3; i++)
+    {
+        data.threads = threads[i];
+        snprintf(name, sizeof(name), "reduce/text/threads/%u", threads[i]);
+        bench_run(state, name, run_reduce_text, &data);
+    }
+
+    if (data.input_fd >= 0)
+    {
+        close(data.input_fd);
+    }
+    calc_buffer_free(&text);
+    free(values);
+}
+
+/******************************************************************************
+ * @brief    One operator on every small pair through calc_big_execute
+ ******************************************************************************/
+size_t run_big_small(void * context)
+{
+    bench_big_data * data = context;
+    uint64_t         sum  = 0;
+
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        calc_big_execute(
+            data->op, &data->operand1[i], &data->operand2[i], &data->result);
+        sum += data->result.value.length;
+    }
+    bench_sink += (uint32_t)sum;
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    One operator on the first, large, pair through calc_big_execute
+ ******************************************************************************/
+size_t run_big_large(void * context)
+{
+    bench_big_data * data = context;
+
+    calc_big_execute(
+        data->op, &data->operand1[0], &data->operand2[0], &data->result);
+    bench_sink += (uint32_t)data->result.value.length;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Set value to a random positive number of the given decimal digits
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+int random_big(calc_big * value, size_t digits)
+{
+    char * text = malloc(digits);
+    int    ok;
+
+    if (NULL == text)
+    {
+        return 0;
+    }
+    text[0] = (char)('1' + (rand() % 9));
+    for (size_t i = 1; i < digits; i++)
+    {
+        text[i] = (char)('0' + (rand() % 10));
+    }
+    ok = calc_big_parse(text, digits, value);
+    free(text);
+    return ok;
+}
+
+/******************************************************************************
+ * @brief    Time the arbitrary precision operators on 32-bit sized operands,
+ *           which stay inline, and multiplication and division on operands of
+ *           a few sizes either side of the Karatsuba threshold
+ ******************************************************************************/
+void bench_big(bench_state * state)
+{
+    static const size_t limbs[] = { 16, 256, 2048 };
+    bench_big_data *    data    = malloc(sizeof(*data));
+    char                name[BENCH_NAME_MAX];
+
+    if (NULL == data)
+    {
+        return;
+    }
+    calc_big_init(&data->result.value);
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        calc_big_init(&data->operand1[i]);
+        calc_big_init(&data->operand2[i]);
+        calc_big_set_int(&data->operand1[i], (int32_t)random_operand());
+        calc_big_set_int(&data->operand2[i], (int32_t)(random_operand() | 1));
+    }
+
+    for (size_t i = 0; i < OPERATOR_COUNT; i++)
+    {
+        if (CALC_OP_ROL == operators[i].op || CALC_OP_ROR == operators[i].op)
+        {
+            continue; // Only defined for a width
+        }
+        data->op = operators[i].op;
+        snprintf(name, sizeof(name), "big/%s/small", operators[i].name);
+        bench_run(state, name, run_big_small, data);
+    }
+
+    for (size_t i = 0; i < sizeof(limbs) / sizeof(limbs[0]); i++)
+    {
+        // A 64-bit limb holds just over 19 decimal digits
+        if (!random_big(&data->operand1[0], limbs[i] * 19) ||
+            !random_big(&data->operand2[0], limbs[i] * 19))
+        {
+            break;
+        }
+        data->op = CALC_OP_MUL;
+        snprintf(name, sizeof(name), "big/mul/%zu", limbs[i]);
+        bench_run(state, name, run_big_large, data);
+
+        // Divide a product of twice the size, so the quotient is as long
+        calc_big_mul(
+            &data->operand1[0], &data->operand2[0], &data->result.value);
+        calc_big_free(&data->operand1[0]);
+        data->operand1[0] = data->result.value;
+        calc_big_init(&data->result.value);
+
+        data->op = CALC_OP_DIV;
+        snprintf(name, sizeof(name), "big/div/%zu", limbs[i]);
+        bench_run(state, name, run_big_large, data);
+
+        data->op = CALC_OP_MOD;
+        snprintf(name, sizeof(name), "big/mod/%zu", limbs[i]);
+        bench_run(state, name, run_big_large, data);
+    }
+
+    calc_big_free(&data->result.value);
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        calc_big_free(&data->operand1[i]);
+        calc_big_free(&data->operand2[i]);
+    }
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    Reference conversion, as main() originally did it
+ ******************************************************************************/
+int parse_strtoul(const char * text, size_t length, uint32_t * value)
+{
+    char * endptr;
+
+    (void)length;
+    errno  = 0;
+    *value = strtoul(text, &endptr, 10);
+    if (*endptr != '\0' || errno == ERANGE)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    One pass of an operand parser over the generated operands
+ ******************************************************************************/
+size_t run_parse(void * context)
+{
+    const bench_parse_data * data     = context;
+    uint32_t                 checksum = 0;
+
+    for (size_t i = 0; i < data->count; i++)
+    {
+        uint32_t value = 0;
+        if (data->parse(data->texts[i], data->lengths[i], &value))
+        {
+            checksum += value;
+        }
+    }
+    bench_sink += checksum;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Time the operand parser against strtoul
+ ******************************************************************************/
+void bench_parse(bench_state * state)
+{
+    char (*texts)[OPERAND_MAX] = malloc(BENCH_OPERANDS * sizeof(*texts));
+    size_t * lengths           = malloc(BENCH_OPERANDS * sizeof(*lengths));
+
+    if (NULL != texts && NULL != lengths)
+    {
+        // Operands of every length from 1 to 10 digits, like real input
+        for (size_t i = 0; i < BENCH_OPERANDS; i++)
+        {
+            lengths[i] =
+                (size_t)snprintf(texts[i], OPERAND_MAX, "%u", random_operand());
+        }
+
+        bench_parse_data data = {
+            (const char(*)[OPERAND_MAX])texts, lengths, BENCH_OPERANDS, NULL
+        };
+        data.parse = parse_strtoul;
+        bench_run(state, "parse/strtoul", run_parse, &data);
+        data.parse = calc_parse_uint32;
+        bench_run(state, "parse/calc", run_parse, &data);
+    }
+    free(texts);
+    free(lengths);
+}
+
+/******************************************************************************
+ * @brief    Result lines formatted with snprintf, as main() originally did
+ ******************************************************************************/
+size_t run_format_printf(void * context)
+{
+    const bench_format_data * data = context;
+    char                      line[CALC_FORMAT_MAX];
+    size_t                    total = 0;
+
+    for (size_t i = 0; i < data->count; i++)
+    {
+        const calc_result * result = &data->results[i];
+        if (CALC_KIND_DOUBLE == result->kind)
+        {
+            total += (size_t)snprintf(line,
+                                      sizeof(line),
+                                      "Result: %.2f\n",
+                                      result->value.as_double);
+        }
+        else
+        {
+            total += (size_t)snprintf(
+                line, sizeof(line), "Result: %d\n", result->value.as_int);
+        }
+    }
+    bench_sink += (uint32_t)total;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Result lines formatted with calc_format_result
+ ******************************************************************************/
+size_t run_format_calc(void * context)
+{
+    const bench_format_data * data = context;
+    char                      line[CALC_FORMAT_MAX];
+    size_t                    total = 0;
+
+    for (size_t i = 0; i < data->count; i++)
+    {
+        total += calc_format_result(line, &data->results[i]);
+    }
+    bench_sink += (uint32_t)total;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Quotient lines formatted with calc_format_division
+ ******************************************************************************/
+size_t run_format_division(void * context)
+{
+    const bench_division_data * data = context;
+    char                        line[CALC_FORMAT_MAX];
+    size_t                      total = 0;
+
+    for (size_t i = 0; i < data->count; i++)
+    {
+        total += calc_format_division(
+            line, data->dividends[i], data->divisors[i], data->format);
+    }
+    bench_sink += (uint32_t)total;
+    return data->count;
+}
+
+/******************************************************************************
+ * @brief    Time result formatting against snprintf
+ ******************************************************************************/
+void bench_format(bench_state * state)
+{
+    calc_result * results = malloc(BENCH_OPERANDS * sizeof(*results));
+
+    if (NULL == results)
+    {
+        return;
+    }
+
+    // Integer results, with one division in eight
+    for (size_t i = 0; i < BENCH_OPERANDS; i++)
+    {
+        calc_op op = (0 == i % 8) ? CALC_OP_DIV : CALC_OP_XOR;
+        results[i] = calc_execute(op, random_operand(), random_operand() | 1);
+    }
+
+    bench_format_data data = { results, BENCH_OPERANDS };
+    bench_run(state, "format/snprintf", run_format_printf, &data);
+    bench_run(state, "format/calc", run_format_calc, &data);
+    free(results);
+
+    int32_t * dividends = malloc(BENCH_OPERANDS * sizeof(*dividends));
+    int32_t * divisors  = malloc(BENCH_OPERANDS * sizeof(*divisors));
+    if (NULL != dividends && NULL != divisors)
+    {
+        static const struct
+        {
+            const char *    name;
+            calc_div_format format;
+        } formats[] = {
+            { "double", { CALC_DIV_DOUBLE, 0 } },
+            { "fixed2", { CALC_DIV_FIXED, 2 } },
+            { "fixed18", { CALC_DIV_FIXED, CALC_DIV_DIGITS_MAX } },
+            { "integer", { CALC_DIV_INTEGER, 0 } },
+            { "exact", { CALC_DIV_EXACT, 0 } },
+            { "shortest", { CALC_DIV_SHORTEST, 0 } },
+        };
+        char name[BENCH_NAME_MAX];
+
+        for (size_t i = 0; i < BENCH_OPERANDS; i++)
+        {
+            dividends[i] = (int32_t)random_operand();
+            divisors[i]  = (int32_t)(random_operand() | 1);
+        }
+        bench_division_data division = {
+            dividends, divisors, BENCH_OPERANDS, { CALC_DIV_DOUBLE, 0 }
+        };
+        for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++)
+        {
+            division.format = formats[i].format;
+            snprintf(name, sizeof(name), "format/div/%s", formats[i].name);
+            bench_run(state, name, run_format_division, &division);
+        }
+    }
+    free(dividends);
+    free(divisors);
+}
+
+/******************************************************************************
+ * @brief    Compile an expression and throw it away
+ ******************************************************************************/
+size_t run_expr_compile(void * context)
+{
+    bench_expr_data * data = context;
+    calc_expr *       expr;
+
+    if (CALC_EXPR_OK == calc_expr_compile(data->text, &expr, NULL))
+    {
+        bench_sink += (uint32_t)calc_expr_variable_count(expr);
+        calc_expr_free(expr);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Compile an expression into an arena and reset it
+ ******************************************************************************/
+size_t run_expr_compile_arena(void * context)
+{
+    bench_expr_data * data = context;
+    calc_expr *       expr;
+
+    if (CALC_EXPR_OK ==
+        calc_expr_compile_in(data->arena, data->text, &expr, NULL))
+    {
+        bench_sink += (uint32_t)calc_expr_variable_count(expr);
+    }
+    calc_arena_reset(data->arena);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a compiled expression once per set of bindings
+ ******************************************************************************/
+size_t run_expr_eval(void * context)
+{
+    bench_expr_data * data = context;
+    uint32_t          sum  = 0;
+
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        sum += calc_expr_eval(data->expr, data->bindings[i]).value.as_uint;
+    }
+    bench_sink += sum;
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a compiled expression over the columns of all bindings
+ ******************************************************************************/
+size_t run_expr_eval_columns(void * context)
+{
+    bench_expr_data * data = context;
+    const uint32_t *  columns[BENCH_VARIABLES];
+
+    for (size_t variable = 0; variable < BENCH_VARIABLES; variable++)
+    {
+        columns[variable] = data->columns[variable];
+    }
+    bench_sink += (uint32_t)calc_expr_eval_columns(
+        data->expr, columns, data->results, data->error_mask, BENCH_LANES);
+    return BENCH_LANES;
+}
+
+/******************************************************************************
+ * @brief    Time compiling expressions and evaluating them many times
+ ******************************************************************************/
+void bench_expressions(bench_state * state)
+{
+    static const char * const texts[] = {
+        "(a << 3) ^ (b + c)",
+        "((a & 0xFFFF) * 3 + (b >>> 7)) | (c ^ d) - (a % 251)",
+        "((a & 0xFFFF) * 8 + (b | 0)) ^ ((a & 0xFFFF) * 8 <<< 32) % 16",
+    };
+    bench_expr_data * data = malloc(sizeof(*data));
+    char              name[BENCH_NAME_MAX];
+    char              text[16];
+    size_t count = OPERATOR_COUNT + (sizeof(texts) / sizeof(texts[0]));
+
+    if (NULL == data)
+    {
+        return;
+    }
+    data->arena = calc_arena_create(0);
+    if (NULL == data->arena)
+    {
+        free(data);
+        return;
+    }
+    for (size_t i = 0; i < BENCH_LANES; i++)
+    {
+        for (size_t variable = 0; variable < BENCH_VARIABLES; variable++)
+        {
+            data->bindings[i][variable] = random_operand() >> 4;
+        }
+        data->bindings[i][1] |= 1; // Never divide by zero
+        for (size_t variable = 0; variable < BENCH_VARIABLES; variable++)
+        {
+            data->columns[variable][i] = data->bindings[i][variable];
+        }
+    }
+
+    // "a <op> b" for every operator, then the compound expressions
+    for (size_t i = 0; i < count; i++)
+    {
+        const char * label = text;
+        if (i < OPERATOR_COUNT)
+        {
+            snprintf(text, sizeof(text), "a %s b", operators[i].symbol);
+            data->text = text;
+            label      = operators[i].name;
+        }
+        else
+        {
+            data->text = texts[i - OPERATOR_COUNT];
+            snprintf(text, sizeof(text), "%zu", i - OPERATOR_COUNT);
+        }
+        if (CALC_EXPR_OK != calc_expr_compile(data->text, &data->expr, NULL))
+        {
+            continue;
+        }
+
+        snprintf(name, sizeof(name), "expr/compile/%s", label);
+        bench_run(state, name, run_expr_compile, data);
+        snprintf(name, sizeof(name), "expr/compile/%s/arena", label);
+        bench_run(state, name, run_expr_compile_arena, data);
+        snprintf(name, sizeof(name), "expr/eval/%s", label);
+        bench_run(state, name, run_expr_eval, data);
+        snprintf(name, sizeof(name), "expr/columns/%s", label);
+        bench_run(state, name, run_expr_eval_columns, data);
+        if (calc_expr_jit(data->expr))
+        {
+            snprintf(name, sizeof(name), "expr/jit/%s", label);
+            bench_run(state, name, run_expr_eval, data);
+        }
+        calc_expr_free(data->expr);
+    }
+    calc_arena_destroy(data->arena);
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    Write data to an unlinked temporary file
+ * @return   Descriptor of the file, or -1
+ ******************************************************************************/
+int write_temp_file(const void * data, size_t length)
+{
+    char                  path[] = "/tmp/calc-bench-XXXXXX";
+    int                   fd     = mkstemp(path);
+    const unsigned char * bytes  = data;
+
+    if (fd < 0)
+    {
+        return -1;
+    }
+    unlink(path);
+    while (length > 0)
+    {
+        ssize_t count = write(fd, bytes, length);
+        if (count < 0)
+        {
+            close(fd);
+            return -1;
+        }
+        bytes += count;
+        length -= (size_t)count;
+    }
+    return fd;
+}
+
+/******************************************************************************
+ * @brief    Text batch evaluated in memory
+ ******************************************************************************/
+size_t run_batch_eval(void * context)
+{
+    bench_batch_data * data   = context;
+    calc_batch_counts  counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+
+    data->output.used = 0;
+    (void)calc_batch_eval(data->text,
+                          data->length,
+                          &data->output,
+                          data->cache,
+                          CALC_WIDTH_32,
+                          data->division,
+                          &counts);
+    bench_sink += (uint32_t)data->output.used;
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Text batch run from a file to /dev/null
+ ******************************************************************************/
+size_t run_batch_file(void * context)
+{
+    bench_batch_data * data   = context;
+    calc_batch_counts  counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+
+    lseek(data->input_fd, 0, SEEK_SET);
+    (void)calc_batch_run(data->input_fd,
+                         data->output_fd,
+                         data->threads,
+                         data->numa_nodes,
+                         data->cache_size,
+                         CALC_WIDTH_32,
+                         data->division,
+                         data->io,
+                         &counts);
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Feeder thread: write the whole text batch into a pipe, close it
+ ******************************************************************************/
+void * feed_pipe(void * context)
+{
+    bench_batch_data * data   = context;
+    const char *       text   = data->text;
+    size_t             length = data->length;
+
+    while (length > 0)
+    {
+        ssize_t count = write(data->feed_fd, text, length);
+        if (count <= 0)
+        {
+            break;
+        }
+        text += count;
+        length -= (size_t)count;
+    }
+    close(data->feed_fd);
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Text batch run on one thread from a pipe to /dev/null
+ ******************************************************************************/
+size_t run_batch_pipe(void * context)
+{
+    bench_batch_data * data   = context;
+    calc_batch_counts  counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    int                ends[2];
+    pthread_t          feeder;
+
+    if (0 != pipe(ends))
+    {
+        return data->lines;
+    }
+    data->feed_fd = ends[1];
+    if (0 != pthread_create(&feeder, NULL, feed_pipe, data))
+    {
+        close(ends[0]);
+        close(ends[1]);
+        return data->lines;
+    }
+    (void)calc_batch_run(ends[0],
+                         data->output_fd,
+                         1,
+                         0,
+                         0,
+                         CALC_WIDTH_32,
+                         data->division,
+                         data->io,
+                         &counts);
+    pthread_join(feeder, NULL);
+    close(ends[0]);
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Binary request run from a file to /dev/null
+ ******************************************************************************/
+size_t run_binary_file(void * context)
+{
+    bench_batch_data * data   = context;
+    calc_batch_counts  counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+
+    lseek(data->input_fd, 0, SEEK_SET);
+    (void)calc_binary_run(data->input_fd, data->output_fd, &counts);
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Time end-to-end text batches of a given size
+ ******************************************************************************/
+void bench_batch(bench_state * state, size_t lines)
+{
+    calc_buffer      text = { NULL, 0, 0 };
+    bench_batch_data data;
+    char             name[BENCH_NAME_MAX];
+    long             cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    unsigned         numa = calc_numa_nodes();
+
+    memset(&data, 0, sizeof(data));
+    for (size_t i = 0; i < lines; i++)
+    {
+        if (!calc_buffer_reserve(&text, CALC_FORMAT_MAX))
+        {
+            calc_buffer_free(&text);
+            return;
+        }
+        text.used += (size_t)snprintf(text.data + text.used,
+                                      CALC_FORMAT_MAX,
+                                      "%u %s %u\n",
+                                      random_operand(),
+                                      operators[i % OPERATOR_COUNT].symbol,
+                                      random_operand() | 1);
+    }
+    data.text      = text.data;
+    data.length    = text.used;
+    data.lines     = lines;
+    data.input_fd  = write_temp_file(text.data, text.used);
+    data.output_fd = open("/dev/null", O_WRONLY);
+
+    snprintf(name, sizeof(name), "batch/eval/%zu", lines);
+    bench_run(state, name, run_batch_eval, &data);
+
+    if (data.input_fd >= 0 && data.output_fd >= 0)
+    {
+        data.io      = CALC_IO_POSIX;
+        data.threads = 1;
+        snprintf(name, sizeof(name), "batch/file/%zu/t1", lines);
+        bench_run(state, name, run_batch_file, &data);
+        snprintf(name, sizeof(name), "batch/pipe/%zu/t1", lines);
+        bench_run(state, name, run_batch_pipe, &data);
+
+        if (calc_io_supported(CALC_IO_URING))
+        {
+            data.io = CALC_IO_URING;
+            snprintf(name, sizeof(name), "batch/file/%zu/t1/uring", lines);
+            bench_run(state, name, run_batch_file, &data);
+            snprintf(name, sizeof(name), "batch/pipe/%zu/t1/uring", lines);
+            bench_run(state, name, run_batch_pipe, &data);
+            data.io = CALC_IO_POSIX;
+        }
+
+        data.threads = (cpus > 1) ? (unsigned)cpus : 2;
+        snprintf(name, sizeof(name), "batch/file/%zu/t%u", lines, data.threads);
+        bench_run(state, name, run_batch_file, &data);
+
+        // Pinned, over as many of 1, 2 and 4 nodes as the machine has
+        for (unsigned nodes = 1; nodes <= 4 && nodes <= numa; nodes *= 2)
+        {
+            data.numa_nodes = nodes;
+            snprintf(name,
+                     sizeof(name),
+                     "batch/file/%zu/t%u/numa/%u",
+                     lines,
+                     data.threads,
+                     nodes);
+            bench_run(state, name, run_batch_file, &data);
+        }
+        data.numa_nodes = 0;
+    }
+
+    if (data.input_fd >= 0)
+    {
+        close(data.input_fd);
+    }
+    if (data.output_fd >= 0)
+    {
+        close(data.output_fd);
+    }
+    calc_buffer_free(&data.output);
+    calc_buffer_free(&text);
+}
+
+/******************************************************************************
+ * @brief    Time a skewed batch, where a few lines make up most of the input,
+ *           with and without a result cache
+ ******************************************************************************/
+void bench_cache(bench_state * state)
+{
+    calc_buffer      text = { NULL, 0, 0 };
+    bench_batch_data data;
+    uint32_t         operands[BENCH_SKEWED_DISTINCT][2];
+
+    memset(&data, 0, sizeof(data));
+    for (size_t i = 0; i < BENCH_SKEWED_DISTINCT; i++)
+    {
+        operands[i][0] = random_operand();
+        operands[i][1] = random_operand() | 1;
+    }
+    for (size_t i = 0; i < BENCH_SKEWED_LINES; i++)
+    {
+        // Cubing a uniform draw piles the picks onto the first triples
+        double draw  = (double)rand() / ((double)RAND_MAX + 1.0);
+        size_t index = (size_t)(draw * draw * draw * BENCH_SKEWED_DISTINCT);
+
+        if (!calc_buffer_reserve(&text, CALC_FORMAT_MAX))
+        {
+            calc_buffer_free(&text);
+            return;
+        }
+        text.used += (size_t)snprintf(text.data + text.used,
+                                      CALC_FORMAT_MAX,
+                                      "%u %s %u\n",
+                                      operands[index][0],
+                                      operators[index % OPERATOR_COUNT].symbol,
+                                      operands[index][1]);
+    }
+    data.text      = text.data;
+    data.length    = text.used;
+    data.lines     = BENCH_SKEWED_LINES;
+    data.threads   = 1;
+    data.io        = CALC_IO_POSIX;
+    data.input_fd  = write_temp_file(text.data, text.used);
+    data.output_fd = open("/dev/null", O_WRONLY);
+
+    bench_run(state, "batch/skewed/eval", run_batch_eval, &data);
+    data.cache = calc_cache_create(BENCH_CACHE_ENTRIES);
+    if (NULL != data.cache)
+    {
+        bench_run(state, "batch/skewed/eval/cache", run_batch_eval, &data);
+        calc_cache_destroy(data.cache);
+        data.cache = NULL;
+    }
+    if (data.input_fd >= 0 && data.output_fd >= 0)
+    {
+        bench_run(state, "batch/skewed/file/t1", run_batch_file, &data);
+        data.cache_size = BENCH_CACHE_ENTRIES;
+        bench_run(state, "batch/skewed/file/t1/cache", run_batch_file, &data);
+    }
+
+    if (data.input_fd >= 0)
+    {
+        close(data.input_fd);
+    }
+    if (data.output_fd >= 0)
+    {
+        close(data.output_fd);
+    }
+    calc_buffer_free(&data.output);
+    calc_buffer_free(&text);
+}
+
+/******************************************************************************
+ * @brief    A client connected to a server running on its own thread
+ ******************************************************************************/
+typedef struct
+{
+    calc_server * server;
+    int           fd;
+    const char *  request; // Lines sent per round trip
+    size_t        length;
+    size_t        lines;
+    size_t        response; // Bytes answered per round trip
+    char *        buffer;
+} bench_server_data;
+
+/******************************************************************************
+ * @brief    Server thread
+ ******************************************************************************/
+void * bench_serve(void * server)
+{
+    calc_batch_counts counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+
+    (void)calc_server_run(server, &counts);
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Send the request lines and wait for every answer
+ ******************************************************************************/
+size_t run_server_round_trip(void * context)
+{
+    bench_server_data * data     = context;
+    size_t              received = 0;
+
+    if (write(data->fd, data->request, data->length) !=
+        (ssize_t)data->length)
+    {
+        return data->lines;
+    }
+    while (received < data->response)
+    {
+        ssize_t count =
+            read(data->fd, data->buffer, data->response - received);
+        if (count <= 0)
+        {
+            break;
+        }
+        received += (size_t)count;
+    }
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Time round trips to a server over a Unix socket, one line at a
+ *           time and pipelined
+ * @param    state   Benchmark state
+ * @param    io      Event loop of the server; io_uring names end in /uring
+ ******************************************************************************/
+void bench_server(bench_state * state, calc_io io)
+{
+    char                directory[] = "/tmp/calc-bench-XXXXXX";
+    char                path[sizeof(directory) + 16];
+    char                name[BENCH_NAME_MAX];
+    const char *        suffix = (CALC_IO_URING == io) ? "/uring" : "";
+    struct sockaddr_un  address;
+    bench_server_data   data;
+    calc_buffer         text = { NULL, 0, 0 };
+    pthread_t           thread;
+
+    memset(&data, 0, sizeof(data));
+    if (NULL == mkdtemp(directory))
+    {
+        return;
+    }
+    snprintf(path, sizeof(path), "%s/sock", directory);
+    if (CALC_SERVER_OK != calc_server_create(path, NULL, 0, io, &data.server))
+    {
+        rmdir(directory);
+        return;
+    }
+    if (0 != pthread_create(&thread, NULL, bench_serve, data.server))
+    {
+        calc_server_destroy(data.server);
+        rmdir(directory);
+        return;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    data.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (data.fd >= 0 &&
+        0 == connect(data.fd, (struct sockaddr *)&address, sizeof(address)))
+    {
+        // "3 + 4" is answered with "Result: 7\n"
+        for (size_t i = 0; i < BENCH_PIPELINED; i++)
+        {
+            if (calc_buffer_reserve(&text, 8))
+            {
+                memcpy(text.data + text.used, "3 + 4\n", 6);
+                text.used += 6;
+            }
+        }
+        data.buffer  = malloc(BENCH_PIPELINED * 10);
+        data.request = text.data;
+
+        if (NULL != data.buffer && BENCH_PIPELINED * 6 == text.used)
+        {
+            data.length   = 6;
+            data.lines    = 1;
+            data.response = 10;
+            snprintf(name, sizeof(name), "server/round_trip%s", suffix);
+            bench_run(state, name, run_server_round_trip, &data);
+
+            data.length   = text.used;
+            data.lines    = BENCH_PIPELINED;
+            data.response = BENCH_PIPELINED * 10;
+            snprintf(name,
+                     sizeof(name),
+                     "server/pipelined/%d%s",
+                     BENCH_PIPELINED,
+                     suffix);
+            bench_run(state, name, run_server_round_trip, &data);
+        }
+    }
+
+    if (data.fd >= 0)
+    {
+        close(data.fd);
+    }
+    calc_server_stop(data.server);
+    pthread_join(thread, NULL);
+    calc_server_destroy(data.server);
+    rmdir(directory);
+    free(data.buffer);
+    calc_buffer_free(&text);
+}
+
+/******************************************************************************
+ * @brief    Servers running on their own threads, and a batch to shard
+ *           across them
+ ******************************************************************************/
+typedef struct
+{
+    calc_server * servers[BENCH_COORD_NODES];
+    char          paths[BENCH_COORD_NODES][BENCH_NAME_MAX];
+    const char *  nodes[BENCH_COORD_NODES];
+    size_t        node_count; // Nodes a run shards across
+    size_t        lines;
+    int           input_fd;
+    int           output_fd; // /dev/null
+} bench_coord_data;
+
+/******************************************************************************
+ * @brief    Shard the batch file across the first node_count servers
+ ******************************************************************************/
+size_t run_coord(void * context)
+{
+    bench_coord_data * data = context;
+    calc_coord_counts  counts;
+
+    memset(&counts, 0, sizeof(counts));
+    lseek(data->input_fd, 0, SEEK_SET);
+    (void)calc_coord_run(data->input_fd,
+                         data->output_fd,
+                         0,
+                         data->nodes,
+                         data->node_count,
+                         BENCH_COORD_SHARD,
+                         BENCH_COORD_CREDITS,
+                         BENCH_COORD_TIMEOUT,
+                         &counts);
+    return data->lines;
+}
+
+/******************************************************************************
+ * @brief    Time a batch file sharded across servers on Unix sockets, against
+ *           one server and against several
+ ******************************************************************************/
+void bench_coord(bench_state * state)
+{
+    char             directory[] = "/tmp/calc-bench-XXXXXX";
+    char             name[BENCH_NAME_MAX];
+    bench_coord_data data;
+    calc_buffer      text = { NULL, 0, 0 };
+    pthread_t        threads[BENCH_COORD_NODES];
+    size_t           started = 0;
+
+    memset(&data, 0, sizeof(data));
+    if (NULL == mkdtemp(directory))
+    {
+        return;
+    }
+    for (; started < BENCH_COORD_NODES; started++)
+    {
+        snprintf(data.paths[started],
+                 sizeof(data.paths[started]),
+                 "%s/node%zu",
+                 directory,
+                 started);
+        data.nodes[started] = data.paths[started];
+        if (CALC_SERVER_OK != calc_server_create(data.paths[started],
+                                                 NULL,
+                                                 0,
+                                                 CALC_IO_POSIX,
+                                                 &data.servers[started]))
+        {
+            break;
+        }
+        if (0 != pthread_create(&threads[started],
+                                NULL,
+                                bench_serve,
+                                data.servers[started]))
+        {
+            calc_server_destroy(data.servers[started]);
+            break;
+        }
+    }
+
+    for (size_t i = 0; i < BENCH_OPERANDS; i++)
+    {
+        if (calc_buffer_reserve(&text, CALC_FORMAT_MAX))
+        {
+            text.used += (size_t)snprintf(
+                text.data + text.used,
+                CALC_FORMAT_MAX,
+                "%u %s %u\n",
+                random_operand(),
+                operators[i % OPERATOR_COUNT].symbol,
+                random_operand() | 1);
+            data.lines++;
+        }
+    }
+    data.input_fd  = write_temp_file(text.data, text.used);
+    data.output_fd = open("/dev/null", O_WRONLY);
+    if (BENCH_COORD_NODES == started && data.input_fd >= 0 &&
+        data.output_fd >= 0)
+    {
+        for (data.node_count = 1; data.node_count <= BENCH_COORD_NODES;
+             data.node_count++)
+        {
+            snprintf(name,
+                     sizeof(name),
+                     "coord/text/%zu/nodes/%zu",
+                     data.lines,
+                     data.node_count);
+            bench_run(state, name, run_coord, &data);
+        }
+    }
+
+    if (data.input_fd >= 0)
+    {
+        close(data.input_fd);
+    }
+    if (data.output_fd >= 0)
+    {
+        close(data.output_fd);
+    }
+    for (size_t i = 0; i < started; i++)
+    {
+        calc_server_stop(data.servers[i]);
+        pthread_join(threads[i], NULL);
+        calc_server_destroy(data.servers[i]);
+    }
+    rmdir(directory);
+    calc_buffer_free(&text);
+}
+
+/******************************************************************************
+ * @brief    A client of a server on its own thread, and the operands of the
+ *           requests a run sends
+ ******************************************************************************/
+typedef struct
+{
+    calc_client * client;
+    uint32_t      operand1[BENCH_PIPELINED];
+    uint32_t      operand2[BENCH_PIPELINED];
+    size_t        answered;
+} bench_client_data;
+
+/******************************************************************************
+ * @brief    Completion callback counting the answers
+ ******************************************************************************/
+void count_answer(void * context, const calc_client_answer * answer)
+{
+    bench_client_data * data = context;
+
+    bench_sink += answer->result.value.as_uint;
+    data->answered++;
+}
+
+/******************************************************************************
+ * @brief    Wait for every request in flight
+ ******************************************************************************/
+void wait_for_answers(calc_client * client)
+{
+    while (0 != calc_client_in_flight(client) &&
+           CALC_CLIENT_OK == calc_client_wait(client, -1))
+    {
+    }
+}
+
+/******************************************************************************
+ * @brief    Submit one request and wait for its answer
+ ******************************************************************************/
+size_t run_client_round_trip(void * context)
+{
+    bench_client_data * data = context;
+
+    if (CALC_CLIENT_OK == calc_client_submit(data->client,
+                                             CALC_OP_ADD,
+                                             data->operand1[0],
+                                             data->operand2[0],
+                                             count_answer,
+                                             data,
+                                             NULL))
+    {
+        wait_for_answers(data->client);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Submit the requests one at a time, then wait for the answers
+ ******************************************************************************/
+size_t run_client_pipelined(void * context)
+{
+    bench_client_data * data = context;
+
+    for (size_t i = 0; i < BENCH_PIPELINED; i++)
+    {
+        if (CALC_CLIENT_OK != calc_client_submit(data->client,
+                                                 CALC_OP_ADD,
+                                                 data->operand1[i],
+                                                 data->operand2[i],
+                                                 count_answer,
+                                                 data,
+                                                 NULL))
+        {
+            break;
+        }
+    }
+    wait_for_answers(data->client);
+    return BENCH_PIPELINED;
+}
+
+/******************************************************************************
+ * @brief    Submit the requests in one call, then wait for the answers
+ ******************************************************************************/
+size_t run_client_batch(void * context)
+{
+    bench_client_data * data = context;
+
+    if (CALC_CLIENT_OK == calc_client_submit_batch(data->client,
+                                                   CALC_OP_ADD,
+                                                   data->operand1,
+                                                   data->operand2,
+                                                   BENCH_PIPELINED,
+                                                   count_answer,
+                                                   data,
+                                                   NULL))
+    {
+        wait_for_answers(data->client);
+    }
+    return BENCH_PIPELINED;
+}
+
+/******************************************************************************
+ * @brief    Time the asynchronous client against a server over a Unix
+ *           socket, to compare with the raw round trips of bench_server
+ ******************************************************************************/
+void bench_client(bench_state * state)
+{
+    char                directory[] = "/tmp/calc-bench-XXXXXX";
+    char                path[sizeof(directory) + 16];
+    char                name[BENCH_NAME_MAX];
+    calc_server *       server;
+    bench_client_data * data = calloc(1, sizeof(*data));
+    pthread_t           thread;
+
+    if (NULL == data || NULL == mkdtemp(directory))
+    {
+        free(data);
+        return;
+    }
+    snprintf(path, sizeof(path), "%s/sock", directory);
+    if (CALC_SERVER_OK !=
+        calc_server_create(path, NULL, 0, CALC_IO_POSIX, &server))
+    {
+        rmdir(directory);
+        free(data);
+        return;
+    }
+    if (0 != pthread_create(&thread, NULL, bench_serve, server))
+    {
+        calc_server_destroy(server);
+        rmdir(directory);
+        free(data);
+        return;
+    }
+
+    for (size_t i = 0; i < BENCH_PIPELINED; i++)
+    {
+        data->operand1[i] = random_operand() >> 1;
+        data->operand2[i] = random_operand() >> 1;
+    }
+    if (CALC_CLIENT_OK == calc_client_connect(path, &data->client))
+    {
+        bench_run(state, "client/round_trip", run_client_round_trip, data);
+        snprintf(name, sizeof(name), "client/pipelined/%d", BENCH_PIPELINED);
+        bench_run(state, name, run_client_pipelined, data);
+        snprintf(name, sizeof(name), "client/batch/%d", BENCH_PIPELINED);
+        bench_run(state, name, run_client_batch, data);
+        calc_client_destroy(data->client);
+    }
+
+    calc_server_stop(server);
+    pthread_join(thread, NULL);
+    calc_server_destroy(server);
+    rmdir(directory);
+    free(data);
+}
+
+/******************************************************************************
+ * @brief    A one-shot calculation to run as a process
+ ******************************************************************************/
+typedef struct
+{
+    char *                     argv[5]; // Program, "3", "+", "4", NULL
+    posix_spawn_file_actions_t actions; // Output to /dev/null
+} bench_startup_data;
+
+/******************************************************************************
+ * @brief    Run the program once and wait for it to exit
+ ******************************************************************************/
+size_t run_startup(void * context)
+{
+    bench_startup_data * data          = context;
+    char *               environment[] = { NULL };
+    pid_t                pid;
+    int                  status;
+
+    if (0 == posix_spawn(&pid,
+                         data->argv[0],
+                         &data->actions,
+                         NULL,
+                         data->argv,
+                         environment))
+    {
+        (void)waitpid(pid, &status, 0);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Time "3 + 4" from exec to exit, with simplecalc and with
+ *           calc-static, where they have been built
+ ******************************************************************************/
+void bench_startup(bench_state * state)
+{
+    static char * const programs[] = { "./simplecalc", "./calc-static" };
+    static char         three[]    = "3";
+    static char         plus[]     = "+";
+    static char         four[]     = "4";
+    char                name[BENCH_NAME_MAX];
+    bench_startup_data  data;
+
+    if (0 != posix_spawn_file_actions_init(&data.actions))
+    {
+        return;
+    }
+    if (0 == posix_spawn_file_actions_addopen(
+                 &data.actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0))
+    {
+        for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); i++)
+        {
+            if (0 != access(programs[i], X_OK))
+            {
+                continue;
+            }
+            data.argv[0] = programs[i];
+            data.argv[1] = three;
+            data.argv[2] = plus;
+            data.argv[3] = four;
+            data.argv[4] = NULL;
+            snprintf(name, sizeof(name), "startup/%s", programs[i] + 2);
+            bench_run(state, name, run_startup, &data);
+        }
+    }
+    posix_spawn_file_actions_destroy(&data.actions);
+}
+
+/******************************************************************************
+ * @brief    Time end-to-end binary requests of a given size
+ ******************************************************************************/
+void bench_binary(bench_state * state, size_t rows)
+{
+    size_t           size    = CALC_BINARY_HEADER_SIZE + (8 * rows);
+    unsigned char *  request = malloc(size);
+    bench_batch_data data;
+    char             name[BENCH_NAME_MAX];
+
+    if (NULL == request)
+    {
+        return;
+    }
+
+    // The host is assumed to be little-endian, as the format is
+    uint32_t magic   = CALC_BINARY_REQUEST_MAGIC;
+    uint16_t version = CALC_BINARY_VERSION;
+    uint16_t op      = CALC_OP_ADD;
+    uint64_t count   = rows;
+    memcpy(request, &magic, 4);
+    memcpy(request + 4, &version, 2);
+    memcpy(request + 6, &op, 2);
+    memcpy(request + 8, &count, 8);
+    for (size_t i = 0; i < 2 * rows; i++)
+    {
+        uint32_t value = random_operand();
+        memcpy(request + CALC_BINARY_HEADER_SIZE + (4 * i), &value, 4);
+    }
+
+    memset(&data, 0, sizeof(data));
+    data.lines     = rows;
+    data.input_fd  = write_temp_file(request, size);
+    data.output_fd = open("/dev/null", O_WRONLY);
+    if (data.input_fd >= 0 && data.output_fd >= 0)
+    {
+        snprintf(name, sizeof(name), "binary/file/%zu", rows);
+        bench_run(state, name, run_binary_file, &data);
+    }
+
+    if (data.input_fd >= 0)
+    {
+        close(data.input_fd);
+    }
+    if (data.output_fd >= 0)
+    {
+        close(data.output_fd);
+    }
+    free(request);
+}
+
+/******************************************************************************
+ * @brief    Main function
+ ******************************************************************************/
+int main(int argc, char * argv[])
+{
+    static bench_state state;
+    const char *       output_path   = NULL;
+    const char *       baseline_path = NULL;
+    static const size_t sizes[]      = { 1000, 100000, 1000000 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--baseline") && i + 1 < argc)
+        {
+            baseline_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--filter") && i + 1 < argc)
+        {
+            state.filter = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr,
+                    "Usage: ./calc-bench [--output FILE] [--baseline FILE] "
+                    "[--filter PREFIX]\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Read the baseline first, as it may be the file being rewritten
+    if (NULL != baseline_path && !load_baseline(&state, baseline_path))
+    {
+        fprintf(stderr, "Error! Unable to read baseline.\n");
+        return EXIT_FAILURE;
+    }
+    if (NULL != output_path)
+    {
+        state.output = fopen(output_path, "w");
+        if (NULL == state.output)
+        {
+            fprintf(stderr, "Error! Unable to write results.\n");
+            return EXIT_FAILURE;
+        }
+        fprintf(state.output,
+                "# name\tmean_ns\tstddev_ns\tbest_ns\tops_per_s\t"
+                "cycles_per_op\n");
+    }
+
+    srand(1);
+    bench_operators(&state);
+    bench_constant(&state);
+    bench_wide(&state);
+    bench_reduce(&state);
+    bench_big(&state);
+    bench_parse(&state);
+    bench_format(&state);
+    bench_expressions(&state);
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        bench_batch(&state, sizes[i]);
+        bench_binary(&state, sizes[i]);
+    }
+    bench_cache(&state);
+    bench_server(&state, CALC_IO_POSIX);
+    if (calc_io_supported(CALC_IO_URING))
+    {
+        bench_server(&state, CALC_IO_URING);
+    }
+    bench_coord(&state);
+    bench_client(&state);
+    bench_startup(&state);
+
+    if (NULL != state.output)
+    {
+        fclose(state.output);
+    }
+    if (0 != state.regressions)
+    {
+        printf("%d benchmark(s) regressed by more than %.0f%%\n",
+               state.regressions,
+               100.0 * BENCH_REGRESSION);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,58 +1,15 @@
 /******************************************************************************
  * @file    simplecalc.c
- * @brief   Simple calculator program
- * @version 1.5
+ * @brief   Simple calculator library
+ * @version 1.6
  * @date    September 2024
  ******************************************************************************/
 
-#include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
-#include <errno.h>
 #include <limits.h>
-#define BITS_IN_UINT32 32
-#define BASE_DECIMAL   10
-
-// Function Prototypes
-void     print_usage(void);
-uint32_t rotate_left(uint32_t value, uint32_t count);
-uint32_t rotate_right(uint32_t value, uint32_t count);
-int32_t  perform_addition(int32_t operand1, int32_t operand2);
-int32_t  perform_subtraction(int32_t operand1, int32_t operand2);
-int32_t  perform_multiplication(int32_t operand1, int32_t operand2);
-double   perform_division(int32_t operand1, int32_t operand2);
-int32_t  perform_modulo(int32_t operand1, int32_t operand2);
-uint32_t perform_left_shift(uint32_t operand1, uint32_t operand2);
-uint32_t perform_right_shift(uint32_t operand1, uint32_t operand2);
-uint32_t perform_and(uint32_t operand1, uint32_t operand2);
-uint32_t perform_or(uint32_t operand1, uint32_t operand2);
-uint32_t perform_xor(uint32_t operand1, uint32_t operand2);
-void     perform_calculation(
-        uint32_t operand1, const char * operator, uint32_t operand2);
-int  validate_operands(int32_t operand2, const char * operator);
-void handle_error(const char * message);
-
-/******************************************************************************
- * @brief    Print the usage of the program
- ******************************************************************************/
-void print_usage(void)
-{
-    printf("Usage: ./simplecalc operand1 operator operand2\n");
-    printf("Supported Operators:\n");
-    printf(" (+)  addition\n");
-    printf(" (-)  subtraction\n");
-    printf(" (*)  multiplication\n");
-    printf(" (/)  divide\n");
-    printf(" (%%)  modulo\n");
-    printf(" (<<) left shift\n");
-    printf(" (>>) right shift\n");
-    printf(" (&)  bitwise AND\n");
-    printf(" (|)  bitwise OR\n");
-    printf(" (^)  bitwise XOR\n");
-    printf(" (<<<) rotate left\n");
-    printf(" (>>>) rotate right\n");
-}
+#include "calc.h"
+#include "calc_width.h"
 
 /******************************************************************************
  * @brief    Rotate bits to the left
@@ -62,8 +19,7 @@ void print_usage(void)
  ******************************************************************************/
 uint32_t rotate_left(uint32_t value, uint32_t count)
 {
-    count = count % BITS_IN_UINT32; // Ensure the count is within the 0-31 range
-    return (value << count) | (value >> (BITS_IN_UINT32 - count));
+    return width_rol_32(value, count);
 }
 
 /******************************************************************************
@@ -74,113 +30,99 @@ uint32_t rotate_left(uint32_t value, uint32_t count)
  ******************************************************************************/
 uint32_t rotate_right(uint32_t value, uint32_t count)
 {
-    count = count % BITS_IN_UINT32; // Ensure the count is within the 0-31 range
-    return (value >> count) | (value << (BITS_IN_UINT32 - count));
+    return width_ror_32(value, count);
 }
 
 /******************************************************************************
  * @brief    Perform addition
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of addition
+ * @param    result      Result of addition
+ * @return   CALC_OK if successful, error status otherwise
  ******************************************************************************/
-int32_t perform_addition(int32_t operand1, int32_t operand2)
+calc_status perform_addition(
+    int32_t operand1, int32_t operand2, int32_t * result)
 {
-    int64_t result = (int64_t)operand1 + operand2;
-    if (result > INT32_MAX || result < INT32_MIN)
-    {
-        handle_error("Error! Addition result out of bounds.\n");
-        exit(EXIT_FAILURE);
-    }
-    return (int32_t)result;
+    return width_add_32(operand1, operand2, result);
 }
 
 /******************************************************************************
  * @brief    Perform subtraction
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of subtraction
+ * @param    result      Result of subtraction
+ * @return   CALC_OK if successful, error status otherwise
  ******************************************************************************/
-int32_t perform_subtraction(int32_t operand1, int32_t operand2)
+calc_status perform_subtraction(
+    int32_t operand1, int32_t operand2, int32_t * result)
 {
-    int64_t result = (int64_t)operand1 - operand2;
-    if (result > INT32_MAX || result < INT32_MIN)
-    {
-        handle_error("Error! Subtraction result out of bounds.\n");
-        exit(EXIT_FAILURE);
-    }
-    return (int32_t)result;
+    return width_sub_32(operand1, operand2, result);
 }
 
 /******************************************************************************
  * @brief    Perform multiplication
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of multiplication
+ * @param    result      Result of multiplication
+ * @return   CALC_OK if successful, error status otherwise
  ******************************************************************************/
-int32_t perform_multiplication(int32_t operand1, int32_t operand2)
+calc_status perform_multiplication(
+    int32_t operand1, int32_t operand2, int32_t * result)
 {
-    int64_t result = (int64_t)operand1 * operand2;
-    if (result > INT32_MAX || result < INT32_MIN)
-    {
-        handle_error("Error! Multiplication result out of bounds.\n");
-        exit(EXIT_FAILURE);
-    }
-    return (int32_t)result;
+    return width_mul_32(operand1, operand2, result);
 }
 
 /******************************************************************************
  * @brief    Perform division
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of division
+ * @param    result      Result of division
+ * @return   CALC_OK if successful, error status otherwise
  ******************************************************************************/
-double perform_division(int32_t operand1, int32_t operand2)
+calc_status perform_division(
+    int32_t operand1, int32_t operand2, double * result)
 {
     if (0 == operand2)
     {
-        handle_error("Error! Division by zero.\n");
-        exit(EXIT_FAILURE);
+        return CALC_ERR_DIV_BY_ZERO;
     }
-    return (double)operand1 / operand2;
+    *result = (double)operand1 / operand2;
+    return CALC_OK;
 }
 
 /******************************************************************************
  * @brief    Perform modulo operation
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of modulo operation
+ * @param    result      Result of modulo operation
+ * @return   CALC_OK if successful, error status otherwise
  ******************************************************************************/
-int32_t perform_modulo(int32_t operand1, int32_t operand2)
+calc_status perform_modulo(
+    int32_t operand1, int32_t operand2, int32_t * result)
 {
-    if (0 == operand2)
-    {
-        handle_error("Error! Modulo by zero.\n");
-        exit(EXIT_FAILURE);
-    }
-    return operand1 % operand2;
+    return width_mod_32(operand1, operand2, result);
 }
 
 /******************************************************************************
  * @brief    Perform left shift
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of left shift
+ * @return   Result of left shift, 0 when shifting by 32 or more
  ******************************************************************************/
 uint32_t perform_left_shift(uint32_t operand1, uint32_t operand2)
 {
-    return operand1 << operand2;
+    return width_shl_32(operand1, operand2);
 }
 
 /******************************************************************************
  * @brief    Perform right shift
  * @param    operand1    First operand
  * @param    operand2    Second operand
- * @return   Result of right shift
+ * @return   Result of right shift, 0 when shifting by 32 or more
  ******************************************************************************/
 uint32_t perform_right_shift(uint32_t operand1, uint32_t operand2)
 {
-    return operand1 >> operand2;
+    return width_shr_32(operand1, operand2);
 }
 
 /******************************************************************************
@@ -217,185 +159,264 @@ uint32_t perform_xor(uint32_t operand1, uint32_t operand2)
 }
 
 /******************************************************************************
- * @brief    Perform calculation based on operator
- * @param    operand1    First operand
- * @param    operator    Operator as string
- * @param    operand2    Second operand
+ * @brief    Operator table entry
  ******************************************************************************/
-void perform_calculation(
-    uint32_t operand1, const char * operator, uint32_t operand2)
+typedef struct
+{
+    calc_kind kind;
+    calc_status (*execute)(
+        uint32_t operand1, uint32_t operand2, calc_value * result);
+    calc_status (*big)(const calc_big * operand1,
+                       const calc_big * operand2,
+                       calc_big *       result);
+} calc_op_entry;
+
+// Adapters giving every operator the table signature
+static calc_status execute_invalid(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
 {
-    int32_t  result;
-    uint32_t result_uint;
+    (void)operand1;
+    (void)operand2;
+    (void)result;
+    return CALC_ERR_UNSUPPORTED_OPERATOR;
+}
 
-    // Ensure the operator is long enough to check the extended operators
-    if (3 == strlen(operator))
-    {
-        if (0 == strncmp(operator, "<<<", 3))
-        {
-            result_uint = rotate_left(operand1, operand2);
-            printf("Result: %u\n", result_uint);
-            return;
-        }
-        if (0 == strncmp(operator, ">>>", 3))
-        {
-            result_uint = rotate_right(operand1, operand2);
-            printf("Result: %u\n", result_uint);
-            return;
-        }
-    }
+static calc_status execute_add(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
+{
+    return perform_addition(
+        (int32_t)operand1, (int32_t)operand2, &result->as_int);
+}
 
-    // Use a switch statement to handle different operations
-    switch (operator[0])
-    {
-        case '+':
-            result = perform_addition((int32_t)operand1, (int32_t)operand2);
-            printf("Result: %d\n", result);
-            break;
+static calc_status execute_sub(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
+{
+    return perform_subtraction(
+        (int32_t)operand1, (int32_t)operand2, &result->as_int);
+}
 
-        case '-':
-            result = perform_subtraction((int32_t)operand1, (int32_t)operand2);
-            printf("Result: %d\n", result);
-            break;
+static calc_status execute_mul(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
+{
+    return perform_multiplication(
+        (int32_t)operand1, (int32_t)operand2, &result->as_int);
+}
 
-        case '*':
-            result =
-                perform_multiplication((int32_t)operand1, (int32_t)operand2);
-            printf("Result: %d\n", result);
-            break;
+static calc_status execute_div(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
+{
+    return perform_division(
+        (int32_t)operand1, (int32_t)operand2, &result->as_double);
+}
 
-        case '/':
-            printf("Result: %.2f\n",
-                   perform_division((int32_t)operand1, (int32_t)operand2));
-            break;
+static calc_status execute_mod(
+    uint32_t operand1, uint32_t operand2, calc_value * result)
+{
+    return perform_modulo(
+        (int32_t)operand1, (int32_t)operand2, &result->as_int);
+}
 
-        case '%':
-            result = perform_modulo((int32_t)operand1, (int32_t)operand2);
-            printf("Result: %d\n", result);
-            break;
+#define EXECUTE_UINT(name, function)                                  \
+    static calc_status name(                                          \
+        uint32_t operand1, uint32_t operand2, calc_value * result)    \
+    {                                                                 \
+        result->as_uint = function(operand1, operand2);               \
+        return CALC_OK;                                               \
+    }
 
-        case '<':
-            if (operator[1] == '<')
-            {
-                result_uint = perform_left_shift(operand1, operand2);
-                printf("Result: %u\n", result_uint);
-            }
-            else
+EXECUTE_UINT(execute_shl, perform_left_shift)
+EXECUTE_UINT(execute_shr, perform_right_shift)
+EXECUTE_UINT(execute_and, perform_and)
+EXECUTE_UINT(execute_or, perform_or)
+EXECUTE_UINT(execute_xor, perform_xor)
+EXECUTE_UINT(execute_rol, rotate_left)
+EXECUTE_UINT(execute_ror, rotate_right)
+
+// Arbitrary precision has no width to rotate within
+static calc_status big_unsupported(const calc_big * operand1,
+                                   const calc_big * operand2,
+                                   calc_big *       result)
+{
+    (void)operand1;
+    (void)operand2;
+    (void)result;
+    return CALC_ERR_UNSUPPORTED_OPERATOR;
+}
+
+static const calc_op_entry op_table[CALC_OP_COUNT] = {
+    [CALC_OP_INVALID] = { CALC_KIND_UINT, execute_invalid, big_unsupported },
+    [CALC_OP_ADD]     = { CALC_KIND_INT, execute_add, calc_big_add },
+    [CALC_OP_SUB]     = { CALC_KIND_INT, execute_sub, calc_big_sub },
+    [CALC_OP_MUL]     = { CALC_KIND_INT, execute_mul, calc_big_mul },
+    [CALC_OP_DIV]     = { CALC_KIND_DOUBLE, execute_div, calc_big_div },
+    [CALC_OP_MOD]     = { CALC_KIND_INT, execute_mod, calc_big_mod },
+    [CALC_OP_SHL]     = { CALC_KIND_UINT, execute_shl, calc_big_shl },
+    [CALC_OP_SHR]     = { CALC_KIND_UINT, execute_shr, calc_big_shr },
+    [CALC_OP_AND]     = { CALC_KIND_UINT, execute_and, calc_big_and },
+    [CALC_OP_OR]      = { CALC_KIND_UINT, execute_or, calc_big_or },
+    [CALC_OP_XOR]     = { CALC_KIND_UINT, execute_xor, calc_big_xor },
+    [CALC_OP_ROL]     = { CALC_KIND_UINT, execute_rol, big_unsupported },
+    [CALC_OP_ROR]     = { CALC_KIND_UINT, execute_ror, big_unsupported },
+};
+
+// Single character operators, indexed by character
+static const uint8_t single_char_ops[UCHAR_MAX + 1] = {
+    ['+'] = CALC_OP_ADD, ['-'] = CALC_OP_SUB, ['*'] = CALC_OP_MUL,
+    ['/'] = CALC_OP_DIV, ['%'] = CALC_OP_MOD, ['&'] = CALC_OP_AND,
+    ['|'] = CALC_OP_OR,  ['^'] = CALC_OP_XOR,
+};
+
+/******************************************************************************
+ * @brief    Decode an operator of known length into an opcode
+ * @param    symbol      Operator characters, need not be NUL terminated
+ * @param    length      Number of characters
+ * @return   Opcode, or CALC_OP_INVALID if the operator is not supported
+ ******************************************************************************/
+calc_op calc_parse_opcode(const char * symbol, size_t length)
+{
+    unsigned char first = (0 != length) ? (unsigned char)symbol[0] : 0;
+
+    switch (length)
+    {
+        case 1:
+            return (calc_op)single_char_ops[first];
+
+        // Only shifts and rotates are longer: a run of two or three '<' or '>'
+        case 2:
+            if (('<' == first || '>' == first) && first == symbol[1])
             {
-                handle_error("Error! Unsupported operator.\n");
-                exit(EXIT_FAILURE);
+                return ('<' == first) ? CALC_OP_SHL : CALC_OP_SHR;
             }
             break;
 
-        case '>':
-            if (operator[1] == '>')
-            {
-                if (operator[2] == '>')
-                {
-                    result_uint = rotate_right(operand1, operand2);
-                    printf("Result: %u\n", result_uint);
-                }
-                else
-                {
-                    result_uint = perform_right_shift(operand1, operand2);
-                    printf("Result: %u\n", result_uint);
-                }
-            }
-            else
+        case 3:
+            if (('<' == first || '>' == first) && first == symbol[1] &&
+                first == symbol[2])
             {
-                handle_error("Error! Unsupported operator.\n");
-                exit(EXIT_FAILURE);
+                return ('<' == first) ? CALC_OP_ROL : CALC_OP_ROR;
             }
             break;
 
-        case '&':
-            result_uint = perform_and(operand1, operand2);
-            printf("Result: %u\n", result_uint);
-            break;
-
-        case '|':
-            result_uint = perform_or(operand1, operand2);
-            printf("Result: %u\n", result_uint);
-            break;
-
-        case '^':
-            result_uint = perform_xor(operand1, operand2);
-            printf("Result: %u\n", result_uint);
-            break;
-
         default:
-            handle_error("Error! Unsupported operator.\n");
-            exit(EXIT_FAILURE);
+            break;
     }
+    return CALC_OP_INVALID;
 }
 
 /******************************************************************************
- * @brief    Validate operands for division and modulo operations
- * @param    operand2    Second operand (divisor)
- * @param    operator    Operator as string
- * @return   1 if valid, 0 otherwise
+ * @brief    Decode an operator string into an opcode
+ * @param    symbol      Operator as string
+ * @return   Opcode, or CALC_OP_INVALID if the operator is not supported
  ******************************************************************************/
-int validate_operands(int32_t operand2, const char * operator)
+calc_op calc_parse_operator(const char * symbol)
 {
-    if (0 == strncmp(operator, "/", 1) || 0 == strncmp(operator, "%", 1))
-    {
-        if (0 == operand2)
-        {
-            handle_error("Error! Division or modulo by zero.\n");
-            return 0;
-        }
-    }
-    return 1;
+    return calc_parse_opcode(symbol, strlen(symbol));
 }
 
 /******************************************************************************
- * @brief    Handle errors
- * @param    message Error message
+ * @brief    Execute a decoded operator
+ * @param    op          Opcode from calc_parse_operator
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @return   Result of the calculation, with its status and kind
  ******************************************************************************/
-void handle_error(const char * message)
+calc_result calc_execute(calc_op op, uint32_t operand1, uint32_t operand2)
 {
-    fprintf(stderr, "%s", message);
+    calc_result           result;
+    const calc_op_entry * entry =
+        &op_table[(unsigned)op < CALC_OP_COUNT ? op : CALC_OP_INVALID];
+
+    result.kind          = entry->kind;
+    result.value.as_uint = 0;
+    result.status        = entry->execute(operand1, operand2, &result.value);
+    return result;
 }
 
 /******************************************************************************
- * @brief    Main function
+ * @brief    Execute a decoded operator on arbitrary precision operands
+ * @param    op          Opcode from calc_parse_operator
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @param    result      Result of the calculation, with its status and kind;
+ *                       result->value must be initialised and is reused
  ******************************************************************************/
-int main(int argc, char * argv[])
+void calc_big_execute(calc_op           op,
+                      const calc_big *  operand1,
+                      const calc_big *  operand2,
+                      calc_big_result * result)
 {
-    if (argc != 4)
-    {
-        print_usage();
-        return EXIT_FAILURE;
-    }
+    const calc_op_entry * entry =
+        &op_table[(unsigned)op < CALC_OP_COUNT ? op : CALC_OP_INVALID];
 
-    char * endptr;
-    errno = 0;
+    result->kind   = entry->kind;
+    result->status = entry->big(operand1, operand2, &result->value);
+}
 
-    // Convert operand1
-    uint32_t operand1 = strtoul(argv[1], &endptr, BASE_DECIMAL);
-    if (*endptr != '\0' || errno == ERANGE)
-    {
-        handle_error("Error! Invalid operand1.\n");
-        return EXIT_FAILURE;
-    }
+/******************************************************************************
+ * @brief    Which member of a calc_value an operator's result is held in
+ * @param    op      Opcode from calc_parse_operator
+ * @return   Result kind
+ ******************************************************************************/
+calc_kind calc_op_kind(calc_op op)
+{
+    return op_table[(unsigned)op < CALC_OP_COUNT ? op : CALC_OP_INVALID].kind;
+}
 
-    // Convert operand2
-    uint32_t operand2 = strtoul(argv[3], &endptr, BASE_DECIMAL);
-    if (*endptr != '\0' || errno == ERANGE)
-    {
-        handle_error("Error! Invalid operand2.\n");
-        return EXIT_FAILURE;
-    }
+/******************************************************************************
+ * @brief    Perform calculation based on operator
+ * @param    operand1    First operand
+ * @param    symbol      Operator as string
+ * @param    operand2    Second operand
+ * @return   Result of the calculation, with its status and kind
+ ******************************************************************************/
+calc_result perform_calculation(
+    uint32_t operand1, const char * symbol, uint32_t operand2)
+{
+    return calc_execute(calc_parse_operator(symbol), operand1, operand2);
+}
 
-    // Validate operands
-    const char * operator= argv[2];
-    if (!validate_operands((int32_t)operand2, operator))
+/******************************************************************************
+ * @brief    Convert a decimal operand string
+ * @param    text    Operand as string
+ * @param    value   Converted operand
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int calc_parse_operand(const char * text, uint32_t * value)
+{
+    return calc_parse_uint32(text, strlen(text), value);
+}
+
+/******************************************************************************
+ * @brief    Describe a calculation status
+ * @param    status  Status returned by a calculation
+ * @return   Error message (without trailing newline)
+ ******************************************************************************/
+const char * calc_status_message(calc_status status)
+{
+    switch (status)
     {
-        return EXIT_FAILURE;
+        case CALC_OK:
+            return "Success.";
+        case CALC_ERR_ADD_OVERFLOW:
+            return "Error! Addition result out of bounds.";
+        case CALC_ERR_SUB_OVERFLOW:
+            return "Error! Subtraction result out of bounds.";
+        case CALC_ERR_MUL_OVERFLOW:
+            return "Error! Multiplication result out of bounds.";
+        case CALC_ERR_DIV_BY_ZERO:
+            return "Error! Division by zero.";
+        case CALC_ERR_MOD_BY_ZERO:
+            return "Error! Modulo by zero.";
+        case CALC_ERR_UNSUPPORTED_OPERATOR:
+            return "Error! Unsupported operator.";
+        case CALC_ERR_TOO_LARGE:
+            return "Error! Result too large.";
+        case CALC_ERR_NO_MEMORY:
+            return "Error! Out of memory.";
+        case CALC_ERR_EMPTY:
+            return "Error! No values.";
+        case CALC_STATUS_COUNT:
+            break;
     }
-
-    // Perform calculation
-    perform_calculation(operand1, operator, operand2);
-
-    return EXIT_SUCCESS;
+    return "Error! Unknown status.";
 }
@@ -0,0 +1,753 @@
+/******************************************************************************
+ * @file    calc.h
+ * @brief   Simple calculator library interface
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#ifndef CALC_H
+#define CALC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if !defined(__SIZEOF_INT128__)
+#error "64 and 128-bit widths need __int128 (GCC or Clang, 64-bit target)"
+#endif
+
+// 128-bit operands, a compiler extension
+__extension__ typedef __int128          calc_int128;
+__extension__ typedef unsigned __int128 calc_uint128;
+
+/******************************************************************************
+ * @brief    Outcome of a calculation
+ ******************************************************************************/
+typedef enum
+{
+    CALC_OK = 0,
+    CALC_ERR_ADD_OVERFLOW,
+    CALC_ERR_SUB_OVERFLOW,
+    CALC_ERR_MUL_OVERFLOW,
+    CALC_ERR_DIV_BY_ZERO,
+    CALC_ERR_MOD_BY_ZERO,
+    CALC_ERR_UNSUPPORTED_OPERATOR,
+    CALC_ERR_TOO_LARGE, // Arbitrary precision result over CALC_BIG_LIMBS_MAX
+    CALC_ERR_NO_MEMORY,
+    CALC_ERR_EMPTY, // Minimum or maximum of no values
+    CALC_STATUS_COUNT
+} calc_status;
+
+/******************************************************************************
+ * @brief    Decoded operator; CALC_OP_INVALID is zero so tables indexed by
+ *           opcode can handle unsupported operators without a branch
+ ******************************************************************************/
+typedef enum
+{
+    CALC_OP_INVALID = 0,
+    CALC_OP_ADD,        // +
+    CALC_OP_SUB,        // -
+    CALC_OP_MUL,        // *
+    CALC_OP_DIV,        // /
+    CALC_OP_MOD,        // %
+    CALC_OP_SHL,        // <<
+    CALC_OP_SHR,        // >>
+    CALC_OP_AND,        // &
+    CALC_OP_OR,         // |
+    CALC_OP_XOR,        // ^
+    CALC_OP_ROL,        // <<<
+    CALC_OP_ROR,        // >>>
+    CALC_OP_COUNT
+} calc_op;
+
+/******************************************************************************
+ * @brief    Which member of a calc_value holds the result
+ ******************************************************************************/
+typedef enum
+{
+    CALC_KIND_INT = 0, // Signed arithmetic (+ - * %)
+    CALC_KIND_UINT,    // Bitwise, shift and rotate operators
+    CALC_KIND_DOUBLE   // Division
+} calc_kind;
+
+typedef union
+{
+    int32_t  as_int;
+    uint32_t as_uint;
+    double   as_double;
+} calc_value;
+
+/******************************************************************************
+ * @brief    Result of a calculation; value is only meaningful for CALC_OK
+ ******************************************************************************/
+typedef struct
+{
+    calc_status status;
+    calc_kind   kind;
+    calc_value  value;
+} calc_result;
+
+/******************************************************************************
+ * @brief    How a 32-bit quotient is printed
+ ******************************************************************************/
+typedef enum
+{
+    CALC_DIV_DOUBLE = 0, // The double with two decimals, as "%.2f" prints it
+    CALC_DIV_FIXED,      // The exact quotient to digits decimals, half to even
+    CALC_DIV_INTEGER,    // The exact quotient truncated toward zero, as C's /
+    CALC_DIV_EXACT,      // The exact quotient as a reduced fraction, e.g. -7/2
+    CALC_DIV_SHORTEST    // Shortest decimal that reads back as the double
+} calc_div_mode;
+
+// Most decimals of a CALC_DIV_FIXED quotient
+#define CALC_DIV_DIGITS_MAX 18
+
+/******************************************************************************
+ * @brief    Division output; zero initialised it is the classic output
+ ******************************************************************************/
+typedef struct
+{
+    calc_div_mode mode;
+    unsigned      digits; // CALC_DIV_FIXED only, up to CALC_DIV_DIGITS_MAX
+} calc_div_format;
+
+/******************************************************************************
+ * @brief    Operand widths; 32 bits is the classic calculator
+ ******************************************************************************/
+typedef enum
+{
+    CALC_WIDTH_32 = 0,
+    CALC_WIDTH_64,
+    CALC_WIDTH_128,
+    CALC_WIDTH_BIG // Arbitrary precision, see calc_big_execute
+} calc_width;
+
+/******************************************************************************
+ * @brief    Result of a calculation at any width; value is only meaningful
+ *           for CALC_OK
+ *
+ * Integer results are held sign extended (CALC_KIND_INT) or zero extended
+ * (CALC_KIND_UINT) from the width. A quotient (CALC_KIND_DOUBLE) is exact
+ * rather than a double: value is the magnitude of its whole part, and
+ * hundredths its fraction rounded half to even, which is what printing the
+ * exact quotient with "%.2f" shows.
+ ******************************************************************************/
+typedef struct
+{
+    calc_status  status;
+    calc_kind    kind;
+    calc_uint128 value;
+    uint8_t      hundredths;
+    uint8_t      negative; // Quotient only
+} calc_wide_result;
+
+// Limbs a calc_big holds without allocating, and the most it may hold
+#define CALC_BIG_INLINE    2
+#define CALC_BIG_LIMBS_MAX 4096 // 262144 bits, about 78900 digits
+
+/******************************************************************************
+ * @brief    Arbitrary precision integer: sign and magnitude, the magnitude in
+ *           64-bit limbs, least significant first
+ *
+ * Values of up to CALC_BIG_INLINE limbs live in small, so operands and
+ * results of 32 and 64-bit size never touch the heap. Initialise with
+ * calc_big_init and release with calc_big_free; a calc_big may be reused
+ * as a result any number of times, but never as an operand of the same call.
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t * heap;     // Limbs once more than CALC_BIG_INLINE, or NULL
+    size_t     length;   // Limbs in use, the top one nonzero; 0 for zero
+    size_t     capacity; // Limbs heap holds
+    int        negative; // A zero quotient keeps its sign, as a double does
+    uint64_t   small[CALC_BIG_INLINE];
+} calc_big;
+
+/******************************************************************************
+ * @brief    Result of an arbitrary precision calculation; value is only
+ *           meaningful for CALC_OK
+ *
+ * A quotient (CALC_KIND_DOUBLE) is exact to the hundredth, rounded half to
+ * even: value holds it in hundredths.
+ ******************************************************************************/
+typedef struct
+{
+    calc_status status;
+    calc_kind   kind;
+    calc_big    value;
+} calc_big_result;
+
+/******************************************************************************
+ * @brief    Instruction sets calc_apply can run on
+ ******************************************************************************/
+typedef enum
+{
+    CALC_ISA_SCALAR = 0,
+    CALC_ISA_SSE2,
+    CALC_ISA_AVX2,
+    CALC_ISA_AVX512,
+    CALC_ISA_NEON,
+    CALC_ISA_COUNT
+} calc_isa;
+
+/******************************************************************************
+ * @brief    Aggregate of a column of 32-bit values, see calc_reduce
+ ******************************************************************************/
+typedef enum
+{
+    CALC_REDUCE_INVALID = 0,
+    CALC_REDUCE_SUM,      // +, of the values as signed
+    CALC_REDUCE_XOR,      // ^
+    CALC_REDUCE_AND,      // &, all ones for no values
+    CALC_REDUCE_OR,       // |
+    CALC_REDUCE_MIN,      // min, signed
+    CALC_REDUCE_MAX,      // max, signed
+    CALC_REDUCE_POPCOUNT, // popcount, set bits over every value
+    CALC_REDUCE_COUNT
+} calc_reduce_op;
+
+/******************************************************************************
+ * @brief    Result of a reduction; value is only meaningful for CALC_OK
+ *
+ * A sum is the signed total; the bitwise folds are unsigned 32-bit values.
+ ******************************************************************************/
+typedef struct
+{
+    calc_status status;
+    int64_t     value;
+    uint64_t    count; // Values reduced
+} calc_reduction;
+
+/******************************************************************************
+ * @brief    Output buffer flushed to a file descriptor with write(2)
+ ******************************************************************************/
+typedef struct
+{
+    int    fd;
+    char * buffer;
+    size_t used;
+    size_t capacity;
+    int    failed;
+} calc_output;
+
+// Upper bound on the length of one formatted result line
+#define CALC_FORMAT_MAX 64
+
+/******************************************************************************
+ * @brief    Growable byte buffer
+ ******************************************************************************/
+typedef struct
+{
+    char * data;
+    size_t used;
+    size_t capacity;
+} calc_buffer;
+
+/******************************************************************************
+ * @brief    Outcome of a batch run; failed lines are counted, not errors
+ ******************************************************************************/
+typedef enum
+{
+    CALC_BATCH_OK = 0,
+    CALC_BATCH_READ_ERROR,
+    CALC_BATCH_WRITE_ERROR,
+    CALC_BATCH_NO_MEMORY,
+    CALC_BATCH_BAD_FORMAT, // Malformed binary request
+    CALC_BATCH_NODE_ERROR  // Every node was dropped with shards unanswered
+} calc_batch_status;
+
+/******************************************************************************
+ * @brief    System interfaces batch and server I/O can go through
+ ******************************************************************************/
+typedef enum
+{
+    CALC_IO_URING = 0, // io_uring, or POSIX where the kernel lacks it
+    CALC_IO_POSIX      // read(2), write(2) and epoll
+} calc_io;
+
+/******************************************************************************
+ * @brief    Outcome of creating or running a server
+ ******************************************************************************/
+typedef enum
+{
+    CALC_SERVER_OK = 0,
+    CALC_SERVER_ADDRESS_ERROR, // Unusable path or address, or none given
+    CALC_SERVER_POLL_ERROR,
+    CALC_SERVER_NO_MEMORY
+} calc_server_status;
+
+// Server, see calc_server_create
+typedef struct calc_server calc_server;
+
+/******************************************************************************
+ * @brief    What a sharded run sent out and got back, see calc_coord_run
+ ******************************************************************************/
+typedef struct
+{
+    size_t lines;        // Lines or rows answered
+    size_t failed;       // Of which failed
+    size_t shards;       // Shards answered
+    size_t redispatched; // Shards sent again after their node was dropped
+    size_t nodes_lost;   // Nodes unreachable, stalled or disconnected
+} calc_coord_counts;
+
+/******************************************************************************
+ * @brief    Outcome of a client call, or of one request
+ ******************************************************************************/
+typedef enum
+{
+    CALC_CLIENT_OK = 0,
+    CALC_CLIENT_ADDRESS_ERROR, // Unusable address, or no server there
+    CALC_CLIENT_DISCONNECTED,  // Closed, failed, or answered out of protocol
+    CALC_CLIENT_BUSY,          // Too much unsent; process, then submit again
+    CALC_CLIENT_BAD_REQUEST,   // Not an operator the server evaluates
+    CALC_CLIENT_NO_MEMORY
+} calc_client_status;
+
+// Non-blocking connection to a server, see calc_client_connect
+typedef struct calc_client calc_client;
+
+/******************************************************************************
+ * @brief    Answer to one request; result is only meaningful for
+ *           CALC_CLIENT_OK
+ *
+ * result is what the server answered, which may itself be an error. A
+ * quotient comes back as the server prints it, rounded to the hundredth.
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t           id;
+    calc_client_status status;
+    calc_result        result;
+} calc_client_answer;
+
+// Completes a request, with the context it was submitted with
+typedef void (*calc_client_callback)(void *                     context,
+                                     const calc_client_answer * answer);
+
+// Result cache, see calc_cache_create
+typedef struct calc_cache calc_cache;
+
+/******************************************************************************
+ * @brief    Activity of a result cache
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} calc_cache_stats;
+
+// Bump allocator for scratch memory, see calc_arena_create
+typedef struct calc_arena calc_arena;
+
+/******************************************************************************
+ * @brief    Activity of an arena
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t allocations; // Served from the arena
+    uint64_t blocks;      // Obtained from malloc
+    size_t   peak;        // Most bytes in use between two resets
+} calc_arena_stats;
+
+/******************************************************************************
+ * @brief    Line counts of a batch run
+ ******************************************************************************/
+typedef struct
+{
+    size_t           lines;
+    size_t           failed;
+    calc_cache_stats cache; // Summed over the caches of every thread
+    calc_arena_stats arena; // Summed over the arenas of every thread
+} calc_batch_counts;
+
+/******************************************************************************
+ * @brief    Stages of evaluating a batch line that calc_stats times
+ ******************************************************************************/
+typedef enum
+{
+    CALC_STAGE_PARSE = 0, // Splitting the line and parsing the operands
+    CALC_STAGE_DISPATCH,  // Decoding the operator and the cache lookup
+    CALC_STAGE_COMPUTE,
+    CALC_STAGE_FORMAT,
+    CALC_STAGE_COUNT
+} calc_stage;
+
+// Latency buckets of a stage: nanoseconds 0 to 3 exactly, then four per
+// power of two up to 2^33 ns (about 8.6 s), the last one open ended
+#define CALC_STATS_BUCKETS 128
+
+/******************************************************************************
+ * @brief    What every thread has evaluated, see calc_stats_snapshot
+ *
+ * Counters cover batch lines, server requests and binary rows at every
+ * width. Latencies are sampled on one 32-bit batch line in
+ * CALC_STATS_SAMPLE; a cache hit is timed up to its dispatch only.
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t ops[CALC_OP_COUNT];          // Evaluations by operator
+    uint64_t errors[CALC_STATUS_COUNT];   // Failures by status, errors[0] is 0
+    uint64_t rejected;                    // Lines that could not be evaluated
+    uint64_t latency[CALC_STAGE_COUNT][CALC_STATS_BUCKETS];
+    uint64_t latency_sum[CALC_STAGE_COUNT]; // Nanoseconds, over the samples
+} calc_stats;
+
+// One batch line in this many is timed
+#define CALC_STATS_SAMPLE 128
+
+// Longest accepted batch line, excluding the newline
+#define CALC_LINE_MAX 254
+
+/******************************************************************************
+ * Binary columnar format, all fields little-endian. Both messages start with
+ * a 16-byte header: uint32 magic, uint16 version, uint16 opcode (request,
+ * a calc_op) or kind (response, a calc_kind), uint64 row count.
+ *
+ * Request:  header, operand1[count], operand2[count] as uint32
+ * Response: header, result[count] as uint32 (binary64 for CALC_KIND_DOUBLE),
+ *           then (count + 7) / 8 bytes with bit (i % 8) of byte (i / 8) set
+ *           if row i failed; failed rows have a zero result
+ ******************************************************************************/
+#define CALC_BINARY_REQUEST_MAGIC  0x42434C43u // "CLCB"
+#define CALC_BINARY_RESPONSE_MAGIC 0x52434C43u // "CLCR"
+#define CALC_BINARY_VERSION        1
+#define CALC_BINARY_HEADER_SIZE    16
+
+/******************************************************************************
+ * @brief    Outcome of compiling an expression
+ ******************************************************************************/
+typedef enum
+{
+    CALC_EXPR_OK = 0,
+    CALC_EXPR_SYNTAX_ERROR,
+    CALC_EXPR_BAD_LITERAL, // Malformed or wider than 32 bits
+    CALC_EXPR_TOO_LARGE,   // Too many nodes, variables or nested parentheses
+    CALC_EXPR_NO_MEMORY
+} calc_expr_status;
+
+// Compiled expression, see calc_expr_compile
+typedef struct calc_expr calc_expr;
+
+// Most variables in one expression, and longest name including the NUL
+#define CALC_EXPR_VARIABLES_MAX 64
+#define CALC_EXPR_NAME_MAX      32
+
+// Operators
+uint32_t    rotate_left(uint32_t value, uint32_t count);
+uint32_t    rotate_right(uint32_t value, uint32_t count);
+calc_status perform_addition(
+            int32_t operand1, int32_t operand2, int32_t * result);
+calc_status perform_subtraction(
+            int32_t operand1, int32_t operand2, int32_t * result);
+calc_status perform_multiplication(
+            int32_t operand1, int32_t operand2, int32_t * result);
+calc_status perform_division(
+            int32_t operand1, int32_t operand2, double * result);
+calc_status perform_modulo(
+            int32_t operand1, int32_t operand2, int32_t * result);
+uint32_t    perform_left_shift(uint32_t operand1, uint32_t operand2);
+uint32_t    perform_right_shift(uint32_t operand1, uint32_t operand2);
+uint32_t    perform_and(uint32_t operand1, uint32_t operand2);
+uint32_t    perform_or(uint32_t operand1, uint32_t operand2);
+uint32_t    perform_xor(uint32_t operand1, uint32_t operand2);
+
+// Evaluation
+calc_op     calc_parse_operator(const char * symbol);
+calc_op     calc_parse_opcode(const char * symbol, size_t length);
+calc_result calc_execute(calc_op op, uint32_t operand1, uint32_t operand2);
+calc_kind   calc_op_kind(calc_op op);
+calc_result perform_calculation(
+            uint32_t operand1, const char * symbol, uint32_t operand2);
+int         calc_parse_operand(const char * text, uint32_t * value);
+int         calc_parse_uint32(
+            const char * text, size_t length, uint32_t * value);
+const char * calc_status_message(calc_status status);
+
+// Evaluation at a given width
+calc_wide_result calc_execute_wide(calc_width   width,
+                                   calc_op      op,
+                                   calc_uint128 operand1,
+                                   calc_uint128 operand2);
+int              calc_parse_wide(const char *   text,
+                                 size_t         length,
+                                 calc_width     width,
+                                 calc_uint128 * value);
+unsigned         calc_width_bits(calc_width width);
+
+// Arbitrary precision
+void        calc_big_init(calc_big * value);
+void        calc_big_free(calc_big * value);
+void        calc_big_set_int(calc_big * value, int64_t number);
+int         calc_big_parse(const char * text, size_t length, calc_big * value);
+int         calc_big_compare(const calc_big * value1, const calc_big * value2);
+calc_status calc_big_add(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_sub(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_mul(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_div(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_mod(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_shl(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_shr(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_and(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+calc_status calc_big_or(const calc_big * operand1,
+                        const calc_big * operand2,
+                        calc_big *       result);
+calc_status calc_big_xor(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result);
+void        calc_big_execute(calc_op           op,
+                             const calc_big *  operand1,
+                             const calc_big *  operand2,
+                             calc_big_result * result);
+
+// Formatting
+size_t calc_format_uint32(char * out, uint32_t value);
+size_t calc_format_int32(char * out, int32_t value);
+size_t calc_format_fixed2(char * out, double value);
+size_t calc_format_shortest(char * out, double value);
+size_t calc_format_division(char *          out,
+                            int32_t         dividend,
+                            int32_t         divisor,
+                            calc_div_format format);
+size_t calc_format_result(char * out, const calc_result * result);
+size_t calc_format_wide(char * out, const calc_wide_result * result);
+int    calc_format_big(calc_buffer * output, const calc_big_result * result);
+void   calc_output_init(
+       calc_output * output, int fd, char * buffer, size_t capacity);
+int    calc_output_write(
+       calc_output * output, const char * bytes, size_t length);
+int    calc_output_result(calc_output * output, const calc_result * result);
+int    calc_output_flush(calc_output * output);
+
+// Batch evaluation
+int  calc_buffer_reserve(calc_buffer * buffer, size_t extra);
+void calc_buffer_free(calc_buffer * buffer);
+int  calc_batch_eval(const char *        text,
+                     size_t              length,
+                     calc_buffer *       output,
+                     calc_cache *        cache,
+                     calc_width          width,
+                     calc_div_format     division,
+                     calc_batch_counts * counts);
+calc_batch_status calc_batch_run(int                 input_fd,
+                                 int                 output_fd,
+                                 unsigned            threads,
+                                 unsigned            numa_nodes,
+                                 size_t              cache_entries,
+                                 calc_width          width,
+                                 calc_div_format     division,
+                                 calc_io             io,
+                                 calc_batch_counts * counts);
+unsigned          calc_numa_nodes(void);
+calc_batch_status calc_binary_run(int                 input_fd,
+                                  int                 output_fd,
+                                  calc_batch_counts * counts);
+calc_batch_status calc_batch_reduce(int                 input_fd,
+                                    calc_reduce_op      op,
+                                    unsigned            threads,
+                                    int                 wide,
+                                    calc_reduction *    result,
+                                    calc_batch_counts * counts);
+calc_batch_status calc_binary_reduce(int              input_fd,
+                                     calc_reduce_op   op,
+                                     unsigned         threads,
+                                     int              wide,
+                                     calc_reduction * result);
+int               calc_binary_request_size(const void * header, size_t * size);
+calc_batch_status calc_binary_eval(const void *        request,
+                                   size_t              size,
+                                   calc_buffer *       output,
+                                   calc_arena *        arena,
+                                   calc_batch_counts * counts);
+
+// Result cache
+calc_cache * calc_cache_create(size_t entries);
+void         calc_cache_destroy(calc_cache * cache);
+const char * calc_cache_lookup(calc_cache *  cache,
+                               calc_op       op,
+                               uint32_t      operand1,
+                               uint32_t      operand2,
+                               size_t *      length,
+                               calc_status * status);
+void         calc_cache_insert(calc_cache * cache,
+                               calc_op      op,
+                               uint32_t     operand1,
+                               uint32_t     operand2,
+                               calc_status  status,
+                               const char * text,
+                               size_t       length);
+void         calc_cache_add_stats(const calc_cache * cache,
+                                  calc_cache_stats * stats);
+
+// Scratch arenas
+calc_arena * calc_arena_create(size_t block_size);
+void         calc_arena_destroy(calc_arena * arena);
+void *       calc_arena_alloc(calc_arena * arena, size_t size);
+void         calc_arena_reset(calc_arena * arena);
+void         calc_arena_add_stats(const calc_arena * arena,
+                                  calc_arena_stats * stats);
+
+// Statistics
+int      calc_stats_enabled(void);
+void     calc_stats_snapshot(calc_stats * stats);
+uint64_t calc_stats_bucket_limit(size_t bucket);
+int      calc_stats_format(calc_buffer * output, const calc_stats * stats);
+
+// Server
+calc_server_status calc_server_create(const char *  unix_path,
+                                      const char *  tcp_address,
+                                      size_t        cache_entries,
+                                      calc_io       io,
+                                      calc_server ** server);
+calc_server_status calc_server_run(calc_server *       server,
+                                   calc_batch_counts * counts);
+void               calc_server_stop(calc_server * server);
+void               calc_server_destroy(calc_server * server);
+
+// Sharded evaluation across servers
+calc_batch_status calc_coord_run(int                  input_fd,
+                                 int                  output_fd,
+                                 int                  binary,
+                                 const char * const * nodes,
+                                 size_t               node_count,
+                                 size_t               shard_size,
+                                 unsigned             credits,
+                                 unsigned             timeout_ms,
+                                 calc_coord_counts *  counts);
+
+// Asynchronous client
+calc_client_status calc_client_connect(const char *   address,
+                                       calc_client ** client);
+void               calc_client_destroy(calc_client * client);
+int                calc_client_fd(const calc_client * client);
+int                calc_client_writing(const calc_client * client);
+size_t             calc_client_in_flight(const calc_client * client);
+calc_client_status calc_client_submit(calc_client *        client,
+                                      calc_op              op,
+                                      uint32_t             operand1,
+                                      uint32_t             operand2,
+                                      calc_client_callback callback,
+                                      void *               context,
+                                      uint64_t *           id);
+calc_client_status calc_client_submit_batch(calc_client *        client,
+                                            calc_op              op,
+                                            const uint32_t *     operand1,
+                                            const uint32_t *     operand2,
+                                            size_t               count,
+                                            calc_client_callback callback,
+                                            void *               context,
+                                            uint64_t *           first_id);
+calc_client_status calc_client_flush(calc_client * client);
+calc_client_status calc_client_process(calc_client * client);
+calc_client_status calc_client_wait(calc_client * client, int timeout_ms);
+int                calc_client_next(calc_client *        client,
+                                    calc_client_answer * answer);
+
+// I/O backends
+int calc_io_supported(calc_io io);
+
+// Expressions
+calc_expr_status calc_expr_compile(const char * text,
+                                   calc_expr ** expr,
+                                   size_t *     error_offset);
+calc_expr_status calc_expr_compile_in(calc_arena * arena,
+                                      const char * text,
+                                      calc_expr ** expr,
+                                      size_t *     error_offset);
+void             calc_expr_free(calc_expr * expr);
+size_t           calc_expr_variable_count(const calc_expr * expr);
+calc_kind        calc_expr_kind(const calc_expr * expr);
+const char *     calc_expr_variable_name(const calc_expr * expr, size_t index);
+size_t           calc_expr_find_variable(const calc_expr * expr,
+                                         const char *      name,
+                                         size_t            length);
+calc_result      calc_expr_eval(const calc_expr * expr,
+                                const uint32_t *  bindings);
+size_t           calc_expr_eval_array(const calc_expr * expr,
+                                      const uint32_t *  bindings,
+                                      calc_result *     results,
+                                      size_t            count);
+size_t           calc_expr_eval_columns(const calc_expr *        expr,
+                                        const uint32_t * const * columns,
+                                        void *                   results,
+                                        uint8_t *                error_mask,
+                                        size_t                   count);
+int              calc_expr_jit(calc_expr * expr);
+const char *     calc_expr_status_message(calc_expr_status status);
+
+// Array evaluation
+calc_status calc_apply(calc_op         op,
+                       const uint32_t * operand1,
+                       const uint32_t * operand2,
+                       uint32_t *       result,
+                       uint8_t *        error_mask,
+                       size_t           count);
+calc_status calc_apply_isa(calc_isa        isa,
+                           calc_op         op,
+                           const uint32_t * operand1,
+                           const uint32_t * operand2,
+                           uint32_t *       result,
+                           uint8_t *        error_mask,
+                           size_t           count);
+calc_status calc_apply_const(calc_op          op,
+                             const uint32_t * operand1,
+                             uint32_t         operand2,
+                             uint32_t *       result,
+                             uint8_t *        error_mask,
+                             size_t           count);
+calc_status calc_apply64(calc_op          op,
+                         const uint64_t * operand1,
+                         const uint64_t * operand2,
+                         uint64_t *       result,
+                         uint8_t *        error_mask,
+                         size_t           count);
+calc_status calc_apply64_isa(calc_isa         isa,
+                             calc_op          op,
+                             const uint64_t * operand1,
+                             const uint64_t * operand2,
+                             uint64_t *       result,
+                             uint8_t *        error_mask,
+                             size_t           count);
+calc_isa     calc_isa_detect(void);
+int          calc_isa_supported(calc_isa isa);
+const char * calc_isa_name(calc_isa isa);
+
+// Reductions
+calc_reduce_op calc_parse_reduction(const char * name);
+calc_reduction calc_reduce(calc_reduce_op   op,
+                           const uint32_t * values,
+                           size_t           count,
+                           unsigned         threads,
+                           int              wide);
+calc_reduction calc_reduce_isa(calc_isa         isa,
+                               calc_reduce_op   op,
+                               const uint32_t * values,
+                               size_t           count,
+                               unsigned         threads,
+                               int              wide);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CALC_H
@@ -0,0 +1,194 @@
+/******************************************************************************
+ * @file    calc_arena.c
+ * @brief   Bump allocator for short-lived scratch memory
+ * @version 1.6
+ * @date    October 2026
+ *
+ * An arena hands out memory by bumping an offset into its newest block and
+ * frees everything at once when it is reset, so a batch or request costs no
+ * malloc() or free() per allocation. A full block is followed by a new one;
+ * a reset merges the blocks of the round into one block that fits it all
+ * (up to ARENA_RETAIN_MAX), so after the first round a steady workload no
+ * longer touches the system allocator at all.
+ *
+ * An arena is not shared: each thread, or each server, owns one.
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <stdlib.h>
+#include "calc.h"
+
+#define ARENA_ALIGN        _Alignof(max_align_t)
+#define ARENA_BLOCK_MIN    4096
+#define ARENA_RETAIN_MAX   (1024 * 1024) // Most kept across a reset
+#define ARENA_ROUND(bytes) (((bytes) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+/******************************************************************************
+ * @brief    Block of an arena, newest first
+ ******************************************************************************/
+typedef struct arena_block
+{
+    struct arena_block * next;
+    size_t               size;
+    size_t               used;
+    _Alignas(max_align_t) unsigned char data[];
+} arena_block;
+
+struct calc_arena
+{
+    arena_block *    blocks;
+    size_t           block_size;
+    size_t           in_use; // Bytes handed out since the last reset
+    calc_arena_stats stats;
+};
+
+/******************************************************************************
+ * @brief    Create an arena
+ * @param    block_size  Bytes of each block, at least ARENA_BLOCK_MIN; the
+ *                       first is allocated on first use
+ * @return   New arena, or NULL if out of memory
+ ******************************************************************************/
+calc_arena * calc_arena_create(size_t block_size)
+{
+    calc_arena * arena = calloc(1, sizeof(*arena));
+
+    if (NULL != arena)
+    {
+        arena->block_size = ARENA_ROUND(
+            (block_size > ARENA_BLOCK_MIN) ? block_size : ARENA_BLOCK_MIN);
+    }
+    return arena;
+}
+
+/******************************************************************************
+ * @brief    Free a chain of blocks
+ ******************************************************************************/
+static void free_blocks(arena_block * block)
+{
+    while (NULL != block)
+    {
+        arena_block * next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+/******************************************************************************
+ * @brief    Release an arena and everything allocated from it
+ * @param    arena   Arena, may be NULL
+ ******************************************************************************/
+void calc_arena_destroy(calc_arena * arena)
+{
+    if (NULL != arena)
+    {
+        free_blocks(arena->blocks);
+    }
+    free(arena);
+}
+
+/******************************************************************************
+ * @brief    Start a block of at least size bytes
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int add_block(calc_arena * arena, size_t size)
+{
+    if (size > SIZE_MAX - sizeof(arena_block))
+    {
+        return 0;
+    }
+
+    arena_block * block = malloc(sizeof(*block) + size);
+    if (NULL == block)
+    {
+        return 0;
+    }
+    block->next   = arena->blocks;
+    block->size   = size;
+    block->used   = 0;
+    arena->blocks = block;
+    arena->stats.blocks++;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Allocate from an arena
+ * @param    arena   Arena
+ * @param    size    Bytes wanted
+ * @return   Uninitialised memory aligned for any type, valid until the next
+ *           reset, or NULL if out of memory
+ ******************************************************************************/
+void * calc_arena_alloc(calc_arena * arena, size_t size)
+{
+    if (size > SIZE_MAX - ARENA_ALIGN)
+    {
+        return NULL;
+    }
+    size = ARENA_ROUND(size);
+
+    arena_block * block = arena->blocks;
+    if (NULL == block || block->size - block->used < size)
+    {
+        if (!add_block(arena,
+                       (size > arena->block_size) ? size : arena->block_size))
+        {
+            return NULL;
+        }
+        block = arena->blocks;
+    }
+
+    void * memory = block->data + block->used;
+    block->used += size;
+    arena->in_use += size;
+    arena->stats.allocations++;
+    if (arena->in_use > arena->stats.peak)
+    {
+        arena->stats.peak = arena->in_use;
+    }
+    return memory;
+}
+
+/******************************************************************************
+ * @brief    Free everything allocated from an arena at once
+ *
+ * A round that needed several blocks leaves one block big enough for it, so
+ * the next round of the same size is served from a single block.
+ ******************************************************************************/
+void calc_arena_reset(calc_arena * arena)
+{
+    arena_block * block = arena->blocks;
+
+    if (NULL != block && NULL != block->next)
+    {
+        size_t total = 0;
+        for (arena_block * at = block; NULL != at; at = at->next)
+        {
+            total += at->size;
+        }
+        free_blocks(block);
+        arena->blocks = NULL;
+        // Should this fail, the next allocation simply tries again
+        (void)add_block(arena, (total < ARENA_RETAIN_MAX) ? total
+                                                          : arena->block_size);
+    }
+    else if (NULL != block && block->size > ARENA_RETAIN_MAX)
+    {
+        // One oversized request should not pin its memory for good
+        free(block);
+        arena->blocks = NULL;
+    }
+    if (NULL != arena->blocks)
+    {
+        arena->blocks->used = 0;
+    }
+    arena->in_use = 0;
+}
+
+/******************************************************************************
+ * @brief    Add an arena's allocation counts and peak to stats
+ ******************************************************************************/
+void calc_arena_add_stats(const calc_arena * arena, calc_arena_stats * stats)
+{
+    stats->allocations += arena->stats.allocations;
+    stats->blocks += arena->stats.blocks;
+    stats->peak += arena->stats.peak;
+}
@@ -0,0 +1,1636 @@
+/******************************************************************************
+ * @file    calc_batch.c
+ * @brief   Batch evaluation of newline-delimited expressions
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Input is read in chunks that end on a line boundary. With one thread each
+ * chunk is evaluated and written in turn. With more, chunks are handed to a
+ * work-stealing pool through a ring of slots, and a writer thread emits the
+ * slots strictly in input order, so the output never depends on scheduling.
+ * Each thread can keep a cache of formatted results for repeated lines.
+ *
+ * On request the workers are pinned and spread over NUMA nodes. Slots are
+ * dealt to the workers in turn, so each slot has a home worker, and its
+ * buffers, like each worker's cache, are set up on that worker's node;
+ * stealing then prefers a worker on the same node. A mapped input is page
+ * cache shared by every node, and stays where it is.
+ * The bookkeeping of a run (slots and caches) comes from one arena that is
+ * released with it, and lines are evaluated into buffers reused from chunk
+ * to chunk, so no allocation is made per line.
+ *
+ * Regular files are mapped instead of read, and chunks are then slices of
+ * the mapping that are evaluated in place. Pipes, terminals and anything
+ * that cannot be mapped are read into per-chunk buffers.
+ *
+ * A single-threaded run can do its I/O through io_uring. A chunk is read
+ * from a pipe by one chain of linked reads of a pipe's worth each, rather
+ * than a read(2) per pipe's worth, into a registered buffer. Finished output
+ * buffers queue up, and are written to a file by one chain of linked writes
+ * that goes out with the next read, or with the wait for a free buffer.
+ * The kernel completes a write to a pipe or socket as soon as it is full,
+ * which costs a completion per pipe's worth, so those are instead written
+ * by one writev(2) of the whole queue.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE // madvise() hints beyond POSIX, F_GETPIPE_SZ
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_numa.h"
+#include "calc_pool.h"
+#include "calc_reduce.h"
+#include "calc_stats.h"
+#include "calc_uring.h"
+
+#define BATCH_CHUNK_SIZE       (256 * 1024)
+#define BATCH_READ_SIZE        (BATCH_CHUNK_SIZE + CALC_LINE_MAX + 1)
+#define BATCH_OUTPUT_SIZE      (2 * BATCH_CHUNK_SIZE) // Typical chunk output
+#define BATCH_SLOTS_PER_THREAD 4
+#define BATCH_ARENA_BLOCK      (16 * 1024)
+#define BATCH_TOKENS           3
+#define BATCH_URING_ENTRIES    16
+#define BATCH_URING_OUTPUTS    4
+#define BATCH_URING_READS      4                   // Longest chain of reads
+#define BATCH_URING_READ_TAG   (UINT64_C(1) << 63) // Ored with the link
+#define BATCH_REDUCE_BLOCK     1024 // Operands parsed between kernel calls
+
+static const char whitespace[] = " \t\r";
+
+/******************************************************************************
+ * @brief    io_uring state of a single-threaded run. Outputs form a queue;
+ *           with a ring, the first filled ones are written in order by at
+ *           most one chain of linked writes at a time, each tagged with its
+ *           sequence number plus one. Reads are tagged with their link in
+ *           the chain, ored with BATCH_URING_READ_TAG
+ ******************************************************************************/
+typedef struct
+{
+    calc_uring  ring;
+    int         output_fd;
+    int         fixed;    // The read buffer is registered as buffer 0
+    int         gathered; // Output is written with writev(2)
+    size_t      piece;    // Bytes per read in a chain
+    calc_buffer outputs[BATCH_URING_OUTPUTS];
+    size_t      first;    // Sequence number of the oldest unwritten output
+    size_t      filled;   // Outputs waiting to be written, or being written
+    size_t      written;  // Bytes of the first output already written
+    size_t      writing;  // Writes in flight
+    size_t      reading;  // Reads in flight
+    int32_t     read_results[BATCH_URING_READS];
+    int         write_failed;
+} batch_uring;
+
+/******************************************************************************
+ * @brief    Reader state carried from one chunk to the next
+ ******************************************************************************/
+typedef struct
+{
+    int           fd;
+    int           eof;
+    int           discarding; // Dropping the rest of an overlong line
+    calc_buffer   carry;      // Partial line at the end of the last chunk
+    char *        map;        // Whole input file, or NULL when streaming
+    size_t        map_size;
+    size_t        position;   // Start of the next slice of the mapping
+    batch_uring * uring;      // Ring reads go through, or NULL for read(2)
+} batch_reader;
+
+typedef enum
+{
+    SLOT_FREE = 0,
+    SLOT_QUEUED,
+    SLOT_DONE
+} slot_state;
+
+typedef struct
+{
+    calc_buffer       input;  // Read buffer when streaming
+    const char *      text;   // Chunk to evaluate, in input or the mapping
+    size_t            length;
+    calc_buffer       output;
+    calc_batch_counts counts;
+    slot_state        state;
+    int               no_memory;
+} batch_slot;
+
+/******************************************************************************
+ * @brief    Shared state of a multithreaded run
+ ******************************************************************************/
+typedef struct
+{
+    pthread_mutex_t   lock;
+    pthread_cond_t    changed;
+    batch_slot *      slots;
+    size_t            slot_count;
+    calc_cache **     caches; // One per worker, or NULL without caching
+    calc_width        width;
+    calc_div_format   division;
+    size_t            submitted;
+    int               reader_done;
+    int               output_fd;
+    calc_batch_status status;
+    calc_batch_counts counts;
+} batch_pipeline;
+
+/******************************************************************************
+ * @brief    Chunk of a reduction, with the partial of its operands
+ ******************************************************************************/
+typedef struct
+{
+    calc_buffer         input; // Read buffer when streaming
+    const char *        text;  // Chunk to reduce, in input or the mapping
+    size_t              length;
+    calc_reduce_partial partial;
+    calc_batch_counts   counts;
+    slot_state          state;
+} reduce_slot;
+
+/******************************************************************************
+ * @brief    Shared state of a multithreaded reduction
+ ******************************************************************************/
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  changed;
+    reduce_slot *   slots;
+    calc_isa        isa;
+    calc_reduce_op  op;
+} reduce_pipeline;
+
+/******************************************************************************
+ * @brief    Append a line of text to an output buffer with room reserved
+ ******************************************************************************/
+static void append_line(calc_buffer * output, const char * message)
+{
+    size_t length = strlen(message);
+    memcpy(output->data + output->used, message, length);
+    output->used += length;
+}
+
+/******************************************************************************
+ * @brief    Answer a line that cannot be evaluated with an error message
+ ******************************************************************************/
+static void reject_line(calc_buffer * output, const char * message)
+{
+    append_line(output, message);
+    calc_stats_reject();
+}
+
+/******************************************************************************
+ * @brief    Evaluate the tokens of a line at 64 or 128 bits
+ * @return   1 if the line was evaluated successfully, 0 otherwise
+ ******************************************************************************/
+static int eval_wide(const char * const tokens[BATCH_TOKENS],
+                     const size_t       lengths[BATCH_TOKENS],
+                     calc_width         width,
+                     calc_buffer *      output)
+{
+    calc_uint128 operand1;
+    calc_uint128 operand2;
+
+    if (!calc_parse_wide(tokens[0], lengths[0], width, &operand1))
+    {
+        reject_line(output, "Error! Invalid operand1.\n");
+        return 0;
+    }
+    if (!calc_parse_wide(tokens[2], lengths[2], width, &operand2))
+    {
+        reject_line(output, "Error! Invalid operand2.\n");
+        return 0;
+    }
+
+    calc_op          op     = calc_parse_opcode(tokens[1], lengths[1]);
+    calc_wide_result result = calc_execute_wide(width, op, operand1, operand2);
+    output->used += calc_format_wide(output->data + output->used, &result);
+    calc_stats_count(op, result.status);
+    return CALC_OK == result.status;
+}
+
+/******************************************************************************
+ * @brief    Evaluate the tokens of a line with arbitrary precision
+ * @return   1 if the line was evaluated successfully, 0 otherwise
+ ******************************************************************************/
+static int eval_big(const char * const tokens[BATCH_TOKENS],
+                    const size_t       lengths[BATCH_TOKENS],
+                    calc_buffer *      output)
+{
+    calc_big        operand1;
+    calc_big        operand2;
+    calc_big_result result;
+    int             ok = 0;
+
+    calc_big_init(&operand1);
+    calc_big_init(&operand2);
+    calc_big_init(&result.value);
+    if (!calc_big_parse(tokens[0], lengths[0], &operand1))
+    {
+        reject_line(output, "Error! Invalid operand1.\n");
+    }
+    else if (!calc_big_parse(tokens[2], lengths[2], &operand2))
+    {
+        reject_line(output, "Error! Invalid operand2.\n");
+    }
+    else
+    {
+        calc_op op = calc_parse_opcode(tokens[1], lengths[1]);
+        calc_big_execute(op, &operand1, &operand2, &result);
+        calc_stats_count(op, result.status);
+        if (!calc_format_big(output, &result))
+        {
+            append_line(output, "Error! Out of memory.\n");
+        }
+        else
+        {
+            ok = (CALC_OK == result.status);
+        }
+    }
+    calc_big_free(&operand1);
+    calc_big_free(&operand2);
+    calc_big_free(&result.value);
+    return ok;
+}
+
+/******************************************************************************
+ * @brief    Evaluate one line and append its output line
+ * @param    line    Line without its newline
+ * @param    length  Length of line
+ * @param    cache       Cache of formatted results, or NULL; only 32-bit
+ *                       results are cached
+ * @param    width       Operand width
+ * @param    division    How 32-bit quotients are printed
+ * @param    output      Output buffer with at least CALC_FORMAT_MAX bytes
+ *                       free
+ * @return   1 if the line was evaluated successfully, 0 otherwise
+ ******************************************************************************/
+static int eval_line(const char *    line,
+                     size_t          length,
+                     calc_cache *    cache,
+                     calc_width      width,
+                     calc_div_format division,
+                     calc_buffer *   output)
+{
+    const char * tokens[BATCH_TOKENS];
+    size_t       lengths[BATCH_TOKENS];
+    size_t       count  = 0;
+    size_t       cursor = 0;
+    uint32_t     operand1;
+    uint32_t     operand2;
+
+    // Only 32-bit lines are timed, so other widths leave the sample alone
+    calc_stats_time lap = (CALC_WIDTH_32 == width) ? calc_stats_start() : 0;
+
+    if (length > CALC_LINE_MAX)
+    {
+        reject_line(output, "Error! Line too long.\n");
+        return 0;
+    }
+
+    // Split the line into whitespace separated tokens
+    for (;;)
+    {
+        while (cursor < length && NULL != memchr(whitespace, line[cursor], 3))
+        {
+            cursor++;
+        }
+        if (cursor == length)
+        {
+            break;
+        }
+        if (BATCH_TOKENS == count)
+        {
+            count++; // Trailing garbage
+            break;
+        }
+        tokens[count] = line + cursor;
+        while (cursor < length &&
+               NULL == memchr(whitespace, line[cursor], 3))
+        {
+            cursor++;
+        }
+        lengths[count] = (size_t)(line + cursor - tokens[count]);
+        count++;
+    }
+    if (BATCH_TOKENS != count)
+    {
+        reject_line(output, "Error! Invalid expression.\n");
+        return 0;
+    }
+    if (CALC_WIDTH_BIG == width)
+    {
+        return eval_big(tokens, lengths, output);
+    }
+    if (CALC_WIDTH_32 != width)
+    {
+        return eval_wide(tokens, lengths, width, output);
+    }
+
+    if (!calc_parse_uint32(tokens[0], lengths[0], &operand1))
+    {
+        reject_line(output, "Error! Invalid operand1.\n");
+        return 0;
+    }
+    if (!calc_parse_uint32(tokens[2], lengths[2], &operand2))
+    {
+        reject_line(output, "Error! Invalid operand2.\n");
+        return 0;
+    }
+    lap = calc_stats_lap(lap, CALC_STAGE_PARSE);
+
+    calc_op op = calc_parse_opcode(tokens[1], lengths[1]);
+    if (NULL != cache)
+    {
+        size_t       cached_length;
+        calc_status  status;
+        const char * cached = calc_cache_lookup(
+            cache, op, operand1, operand2, &cached_length, &status);
+        if (NULL != cached)
+        {
+            memcpy(output->data + output->used, cached, cached_length);
+            output->used += cached_length;
+            calc_stats_lap(lap, CALC_STAGE_DISPATCH);
+            calc_stats_count(op, status);
+            return CALC_OK == status;
+        }
+    }
+    lap = calc_stats_lap(lap, CALC_STAGE_DISPATCH);
+
+    calc_result result = { CALC_OK, CALC_KIND_DOUBLE, { 0 } };
+    char *      text   = output->data + output->used;
+    size_t      written;
+    if (CALC_OP_DIV == op && CALC_DIV_DOUBLE != division.mode)
+    {
+        // Same status as calc_execute, without computing the double
+        result.status = (0 == operand2) ? CALC_ERR_DIV_BY_ZERO : CALC_OK;
+        lap           = calc_stats_lap(lap, CALC_STAGE_COMPUTE);
+        written       = calc_format_division(
+            text, (int32_t)operand1, (int32_t)operand2, division);
+    }
+    else
+    {
+        result  = calc_execute(op, operand1, operand2);
+        lap     = calc_stats_lap(lap, CALC_STAGE_COMPUTE);
+        written = calc_format_result(text, &result);
+    }
+    calc_stats_lap(lap, CALC_STAGE_FORMAT);
+    calc_stats_count(op, result.status);
+    output->used += written;
+    if (NULL != cache)
+    {
+        calc_cache_insert(
+            cache, op, operand1, operand2, result.status, text, written);
+    }
+    return CALC_OK == result.status;
+}
+
+/******************************************************************************
+ * @brief    Evaluate newline-delimited expressions
+ * @param    text    Lines; a last line without a newline is evaluated too
+ * @param    length  Length of text
+ * @param    output  Buffer the output lines are appended to
+ * @param    cache       Cache of formatted results, or NULL; its statistics
+ *                       are not added to counts. A cache must always be
+ *                       used with the same division format.
+ * @param    width       Operand width
+ * @param    division    How 32-bit quotients are printed
+ * @param    counts      Incremented by the lines seen and the lines that
+ *                       failed
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+int calc_batch_eval(const char *        text,
+                    size_t              length,
+                    calc_buffer *       output,
+                    calc_cache *        cache,
+                    calc_width          width,
+                    calc_div_format     division,
+                    calc_batch_counts * counts)
+{
+    const char * end = text + length;
+
+    while (text < end)
+    {
+        const char * newline = memchr(text, '\n', (size_t)(end - text));
+        const char * stop    = (NULL != newline) ? newline : end;
+
+        if (!calc_buffer_reserve(output, CALC_FORMAT_MAX))
+        {
+            return 0;
+        }
+        counts->lines++;
+        counts->failed += !eval_line(
+            text, (size_t)(stop - text), cache, width, division, output);
+        text = (NULL != newline) ? newline + 1 : end;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Queue one chain of linked writes of every filled output, unless
+ *           a chain is still in flight or the output is gathered; the next
+ *           submission sends it
+ * @return   1 if successful, 0 if the submission queue is full
+ ******************************************************************************/
+static int uring_start_writes(batch_uring * uring)
+{
+    if (uring->gathered || 0 != uring->writing)
+    {
+        return 1;
+    }
+    for (size_t i = 0; i < uring->filled; i++)
+    {
+        size_t                sequence = uring->first + i;
+        size_t                skip     = (0 == i) ? uring->written : 0;
+        struct io_uring_sqe * sqe      = calc_uring_sqe(&uring->ring);
+        calc_buffer *         output =
+            &uring->outputs[sequence % BATCH_URING_OUTPUTS];
+
+        if (NULL == sqe)
+        {
+            return 0;
+        }
+        sqe->opcode    = IORING_OP_WRITE;
+        sqe->fd        = uring->output_fd;
+        sqe->addr      = (uint64_t)(uintptr_t)(output->data + skip);
+        sqe->len       = (uint32_t)(output->used - skip);
+        sqe->off       = (uint64_t)-1; // At the file position, like write(2)
+        sqe->flags     = (i + 1 < uring->filled) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = sequence + 1;
+    }
+    uring->writing = uring->filled;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Account for the written bytes of the oldest outputs
+ ******************************************************************************/
+static void uring_written(batch_uring * uring, size_t count)
+{
+    while (0 != uring->filled)
+    {
+        calc_buffer * output =
+            &uring->outputs[uring->first % BATCH_URING_OUTPUTS];
+        size_t left = output->used - uring->written;
+
+        if (count < left)
+        {
+            uring->written += count;
+            return;
+        }
+        count -= left;
+        uring->first++;
+        uring->filled--;
+        uring->written = 0;
+    }
+}
+
+/******************************************************************************
+ * @brief    Account for a completion
+ ******************************************************************************/
+static void uring_complete(batch_uring * uring, uint64_t tag, int32_t result)
+{
+    if (0 != (tag & BATCH_URING_READ_TAG))
+    {
+        uring->read_results[tag & ~BATCH_URING_READ_TAG] = result;
+        uring->reading--;
+        return;
+    }
+
+    // A short write breaks the chain, and the writes after it are cancelled,
+    // so they are all resubmitted from where it stopped
+    uring->writing--;
+    if (tag - 1 != uring->first || -ECANCELED == result || -EINTR == result)
+    {
+        return;
+    }
+    if (result > 0 ||
+        (0 == result &&
+         0 == uring->outputs[uring->first % BATCH_URING_OUTPUTS].used))
+    {
+        uring_written(uring, (size_t)result);
+    }
+    else
+    {
+        uring->write_failed = 1;
+    }
+}
+
+/******************************************************************************
+ * @brief    Submit what is queued, wait, and account for every completion
+ * @param    uring   State
+ * @param    wait    Completions to wait for, at most the requests in flight;
+ *                   waiting for a whole chain takes one system call
+ * @return   1 if successful, 0 if the ring failed
+ ******************************************************************************/
+static int uring_reap(batch_uring * uring, size_t wait)
+{
+    struct io_uring_cqe * cqe = calc_uring_peek(&uring->ring);
+
+    while (NULL == cqe)
+    {
+        int status = calc_uring_submit(&uring->ring, (unsigned)wait);
+        if (0 != status && -EINTR != status)
+        {
+            return 0;
+        }
+        cqe = calc_uring_peek(&uring->ring);
+    }
+    for (; NULL != cqe; cqe = calc_uring_peek(&uring->ring))
+    {
+        uint64_t tag    = cqe->user_data;
+        int32_t  result = cqe->res;
+        calc_uring_seen(&uring->ring);
+        uring_complete(uring, tag, result);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Write the whole output queue with writev(2)
+ * @return   1 if successful, 0 otherwise
+ ******************************************************************************/
+static int uring_write_gathered(batch_uring * uring)
+{
+    while (0 != uring->filled)
+    {
+        struct iovec parts[BATCH_URING_OUTPUTS];
+
+        for (size_t i = 0; i < uring->filled; i++)
+        {
+            calc_buffer * output =
+                &uring->outputs[(uring->first + i) % BATCH_URING_OUTPUTS];
+            size_t        skip = (0 == i) ? uring->written : 0;
+            parts[i].iov_base  = output->data + skip;
+            parts[i].iov_len   = output->used - skip;
+        }
+        ssize_t count = writev(uring->output_fd, parts, (int)uring->filled);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return 0;
+        }
+        uring_written(uring, (size_t)count);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Write queued outputs until no more than keep are left
+ * @return   1 if successful, 0 if writing failed
+ ******************************************************************************/
+static int uring_drain(batch_uring * uring, size_t keep)
+{
+    while (uring->filled > keep && !uring->write_failed)
+    {
+        if (uring->gathered ? !uring_write_gathered(uring)
+                            : !uring_start_writes(uring) ||
+                                  !uring_reap(uring, uring->writing))
+        {
+            uring->write_failed = 1;
+        }
+    }
+    return !uring->write_failed;
+}
+
+/******************************************************************************
+ * @brief    Set up io_uring I/O for a single-threaded run
+ * @param    uring       State to initialise
+ * @param    reader      Reader, whose reads go through the ring from now on
+ * @param    chunk       Read buffer, allocated here so it can be registered
+ * @param    output_fd   Descriptor results are written to
+ * @return   1 if successful, 0 if io_uring is unavailable
+ ******************************************************************************/
+static int uring_open(batch_uring *  uring,
+                      batch_reader * reader,
+                      calc_buffer *  chunk,
+                      int            output_fd)
+{
+    struct stat info;
+
+    memset(uring, 0, sizeof(*uring));
+    if (!calc_uring_init(&uring->ring, BATCH_URING_ENTRIES))
+    {
+        calc_uring_exit(&uring->ring);
+        return 0;
+    }
+    uring->output_fd = output_fd;
+    uring->gathered  = 0 != fstat(output_fd, &info) ||
+                      !(S_ISREG(info.st_mode) || S_ISBLK(info.st_mode));
+
+    // Only a stream is read; pinning the buffer may exceed RLIMIT_MEMLOCK,
+    // and then reads just copy into it
+    uring->piece = BATCH_READ_SIZE;
+    if (NULL == reader->map && calc_buffer_reserve(chunk, BATCH_READ_SIZE))
+    {
+        struct iovec buffer = { chunk->data, chunk->capacity };
+        uring->fixed = calc_uring_register_buffers(&uring->ring, &buffer, 1);
+
+        int pipe_size = -1;
+        if (0 == fstat(reader->fd, &info) && S_ISFIFO(info.st_mode))
+        {
+            pipe_size = fcntl(reader->fd, F_GETPIPE_SZ);
+        }
+        if (pipe_size > 0)
+        {
+            uring->piece = (size_t)pipe_size;
+        }
+    }
+    reader->uring = uring;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Get an empty output buffer, writing the queue if it is full
+ * @return   Output buffer, or NULL if writing failed
+ ******************************************************************************/
+static calc_buffer * uring_output(batch_uring * uring)
+{
+    if (!uring_drain(uring, BATCH_URING_OUTPUTS - 1))
+    {
+        return NULL;
+    }
+
+    calc_buffer * output =
+        &uring->outputs[(uring->first + uring->filled) % BATCH_URING_OUTPUTS];
+    output->used = 0;
+    return output;
+}
+
+/******************************************************************************
+ * @brief    Write every filled output and release the ring
+ * @return   1 if everything was written, 0 otherwise
+ ******************************************************************************/
+static int uring_close(batch_uring * uring)
+{
+    int written = uring_drain(uring, 0);
+
+    // Writes still in flight after a failure must end before their buffers
+    while (0 != uring->writing && uring_reap(uring, uring->writing))
+    {
+    }
+    calc_uring_exit(&uring->ring);
+    for (size_t i = 0; i < BATCH_URING_OUTPUTS; i++)
+    {
+        calc_buffer_free(&uring->outputs[i]);
+    }
+    return written;
+}
+
+/******************************************************************************
+ * @brief    Read from the input, through the ring if there is one: a chain
+ *           of reads of a pipe's worth each, submitted with any queued writes
+ * @return   Bytes read, 0 at the end of the input, or -1 with errno set
+ ******************************************************************************/
+static ssize_t read_input(batch_reader * reader, char * data, size_t length)
+{
+    batch_uring * uring = reader->uring;
+
+    if (NULL == uring)
+    {
+        return read(reader->fd, data, length);
+    }
+
+    size_t links = (length + uring->piece - 1) / uring->piece;
+    links        = (links < BATCH_URING_READS) ? links : BATCH_URING_READS;
+    if (!uring_start_writes(uring))
+    {
+        errno = EIO;
+        return -1;
+    }
+    for (size_t i = 0; i < links; i++)
+    {
+        struct io_uring_sqe * sqe    = calc_uring_sqe(&uring->ring);
+        size_t                offset = i * uring->piece;
+        size_t                size   = length - offset;
+
+        if (NULL == sqe)
+        {
+            errno = EIO;
+            return -1;
+        }
+        if (size > uring->piece)
+        {
+            size = uring->piece;
+        }
+        sqe->opcode    = uring->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe->fd        = reader->fd;
+        sqe->addr      = (uint64_t)(uintptr_t)(data + offset);
+        sqe->len       = (uint32_t)size;
+        sqe->off       = (uint64_t)-1;
+        sqe->flags     = (i + 1 < links) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = BATCH_URING_READ_TAG | i;
+        uring->reading++;
+    }
+    while (0 != uring->reading)
+    {
+        if (!uring_reap(uring, uring->reading))
+        {
+            errno = EIO;
+            return -1;
+        }
+    }
+
+    // A short read ends the chain, and cancels the reads after it
+    ssize_t total = 0;
+    for (size_t i = 0; i < links; i++)
+    {
+        int32_t result = uring->read_results[i];
+        if (result < 0)
+        {
+            if (0 == total)
+            {
+                errno = -result;
+                return -1;
+            }
+            break;
+        }
+        total += result;
+        if ((size_t)result < uring->piece)
+        {
+            break;
+        }
+    }
+    return total;
+}
+
+/******************************************************************************
+ * @brief    Read the next chunk of whole lines from a stream
+ * @param    reader  Reader state
+ * @param    chunk   Filled with the chunk; empty once the input is exhausted
+ * @return   CALC_BATCH_OK, or the error that stopped reading
+ ******************************************************************************/
+static calc_batch_status read_stream(batch_reader * reader, calc_buffer * chunk)
+{
+    const size_t capacity = BATCH_READ_SIZE;
+
+    chunk->used = 0;
+    if (!calc_buffer_reserve(chunk, capacity))
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+
+    for (;;)
+    {
+        if (0 != reader->carry.used)
+        {
+            memcpy(chunk->data, reader->carry.data, reader->carry.used);
+        }
+        chunk->used        = reader->carry.used;
+        reader->carry.used = 0;
+
+        while (!reader->eof && chunk->used < BATCH_CHUNK_SIZE)
+        {
+            ssize_t count = read_input(reader,
+                                       chunk->data + chunk->used,
+                                       capacity - chunk->used);
+            if (count < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                return CALC_BATCH_READ_ERROR;
+            }
+            if (0 == count)
+            {
+                reader->eof = 1;
+                break;
+            }
+
+            // Drop the unread rest of an overlong line up to its newline
+            char * fresh = chunk->data + chunk->used;
+            if (reader->discarding)
+            {
+                char * newline = memchr(fresh, '\n', (size_t)count);
+                if (NULL == newline)
+                {
+                    continue;
+                }
+                count -= newline - fresh;
+                memmove(fresh, newline, (size_t)count);
+                reader->discarding = 0;
+            }
+            chunk->used += (size_t)count;
+        }
+
+        if (reader->eof)
+        {
+            return CALC_BATCH_OK; // The last line needs no newline
+        }
+
+        // Keep the partial last line for the next chunk; an overlong one
+        // only needs enough of it kept to still be reported as too long
+        size_t whole = chunk->used;
+        while (whole > 0 && '\n' != chunk->data[whole - 1])
+        {
+            whole--;
+        }
+        size_t tail = chunk->used - whole;
+        if (tail > CALC_LINE_MAX + 1)
+        {
+            tail               = CALC_LINE_MAX + 1;
+            reader->discarding = 1;
+        }
+        if (!calc_buffer_reserve(&reader->carry, tail))
+        {
+            return CALC_BATCH_NO_MEMORY;
+        }
+        memcpy(reader->carry.data, chunk->data + whole, tail);
+        reader->carry.used = tail;
+        chunk->used        = whole;
+
+        if (0 != whole)
+        {
+            return CALC_BATCH_OK;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Map the input if it is a regular file
+ * @param    reader  Reader state; map stays NULL if the input is streamed
+ ******************************************************************************/
+static void map_input(batch_reader * reader)
+{
+    struct stat info;
+
+    // Empty and pseudo files (which report a size of 0) are streamed
+    if (0 != fstat(reader->fd, &info) || !S_ISREG(info.st_mode) ||
+        info.st_size <= 0)
+    {
+        return;
+    }
+
+    // Start wherever the descriptor is, as reading it would
+    off_t offset = lseek(reader->fd, 0, SEEK_CUR);
+    if (offset < 0 || offset >= info.st_size)
+    {
+        return;
+    }
+
+    void * map =
+        mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+    if (MAP_FAILED == map)
+    {
+        return;
+    }
+    (void)posix_madvise(map, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+    (void)madvise(map, (size_t)info.st_size, MADV_HUGEPAGE);
+#endif
+    reader->map      = map;
+    reader->map_size = (size_t)info.st_size;
+    reader->position = (size_t)offset;
+}
+
+/******************************************************************************
+ * @brief    Get the next chunk of whole lines
+ * @param    reader  Reader state
+ * @param    buffer  Read buffer, only used when streaming
+ * @param    text    Set to the chunk
+ * @param    length  Set to the length of the chunk; 0 once input is exhausted
+ * @return   CALC_BATCH_OK, or the error that stopped reading
+ ******************************************************************************/
+static calc_batch_status next_chunk(batch_reader * reader,
+                                    calc_buffer *  buffer,
+                                    const char **  text,
+                                    size_t *       length)
+{
+    if (NULL == reader->map)
+    {
+        calc_batch_status status = read_stream(reader, buffer);
+        *text                    = buffer->data;
+        *length                  = buffer->used;
+        return status;
+    }
+
+    // A slice of the mapping, extended to the end of its last line
+    size_t start = reader->position;
+    size_t stop  = reader->map_size;
+    if (stop - start > BATCH_CHUNK_SIZE)
+    {
+        const char * newline = memchr(reader->map + start + BATCH_CHUNK_SIZE,
+                                      '\n',
+                                      stop - start - BATCH_CHUNK_SIZE);
+        if (NULL != newline)
+        {
+            stop = (size_t)(newline + 1 - reader->map);
+        }
+    }
+    reader->position = stop;
+    *text            = reader->map + start;
+    *length          = stop - start;
+    return CALC_BATCH_OK;
+}
+
+/******************************************************************************
+ * @brief    Write a whole buffer to a file descriptor
+ * @return   1 if successful, 0 otherwise
+ ******************************************************************************/
+static int write_buffer(int fd, const calc_buffer * buffer)
+{
+    calc_output output;
+
+    calc_output_init(&output, fd, buffer->data, buffer->capacity);
+    output.used = buffer->used;
+    return calc_output_flush(&output);
+}
+
+/******************************************************************************
+ * @brief    Pool task: evaluate the chunk in one slot
+ ******************************************************************************/
+static void eval_slot(void * context, size_t task, unsigned worker)
+{
+    batch_pipeline * pipeline = context;
+    batch_slot *     slot     = &pipeline->slots[task];
+
+    slot->output.used = 0;
+    slot->no_memory   = !calc_batch_eval(
+        slot->text,
+        slot->length,
+        &slot->output,
+        (NULL != pipeline->caches) ? pipeline->caches[worker] : NULL,
+        pipeline->width,
+        pipeline->division,
+        &slot->counts);
+
+    pthread_mutex_lock(&pipeline->lock);
+    slot->state = SLOT_DONE;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+/******************************************************************************
+ * @brief    Writer thread: emit evaluated slots in input order
+ ******************************************************************************/
+static void * write_slots(void * argument)
+{
+    batch_pipeline * pipeline = argument;
+
+    for (size_t next = 0;; next++)
+    {
+        batch_slot * slot = &pipeline->slots[next % pipeline->slot_count];
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (SLOT_DONE != slot->state &&
+               !(pipeline->reader_done && next == pipeline->submitted))
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        int finished = (SLOT_DONE != slot->state);
+        int failed   = (CALC_BATCH_OK != pipeline->status);
+        pthread_mutex_unlock(&pipeline->lock);
+        if (finished)
+        {
+            break;
+        }
+
+        // After an error, keep draining slots so the reader is not blocked
+        calc_batch_status status = CALC_BATCH_OK;
+        if (slot->no_memory)
+        {
+            status = CALC_BATCH_NO_MEMORY;
+        }
+        else if (!failed && !write_buffer(pipeline->output_fd, &slot->output))
+        {
+            status = CALC_BATCH_WRITE_ERROR;
+        }
+
+        pthread_mutex_lock(&pipeline->lock);
+        if (CALC_BATCH_OK == pipeline->status)
+        {
+            pipeline->status = status;
+        }
+        pipeline->counts.lines += slot->counts.lines;
+        pipeline->counts.failed += slot->counts.failed;
+        slot->state = SLOT_FREE;
+        pthread_cond_broadcast(&pipeline->changed);
+        pthread_mutex_unlock(&pipeline->lock);
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Set up each slot's buffers on the node of its home worker
+ * @param    pipeline    Run whose slots to place
+ * @param    reader      Input of the run
+ * @param    threads     Worker threads; slot i is dealt to worker i % threads
+ * @param    numa        Nodes the workers are placed on
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int place_slots(batch_pipeline *     pipeline,
+                       const batch_reader * reader,
+                       unsigned             threads,
+                       const calc_numa *    numa)
+{
+    int    streaming = (NULL == reader->map);
+    size_t slots     = pipeline->slot_count;
+
+    // A mapping shorter than the ring never reaches its later slots
+    if (!streaming)
+    {
+        size_t chunks = (reader->map_size - reader->position) /
+                            BATCH_CHUNK_SIZE +
+                        1;
+        slots = (chunks < slots) ? chunks : slots;
+    }
+
+    for (size_t i = 0; i < slots; i++)
+    {
+        batch_slot *     slot = &pipeline->slots[i];
+        calc_numa_policy saved;
+        unsigned         cpu;
+        int              placed;
+
+        // Touching every page while the node is preferred puts it there
+        calc_numa_prefer(
+            calc_numa_place(numa, (unsigned)(i % threads), &cpu), &saved);
+        placed = calc_buffer_reserve(&slot->output, BATCH_OUTPUT_SIZE) &&
+                 (!streaming ||
+                  calc_buffer_reserve(&slot->input, BATCH_READ_SIZE));
+        if (placed)
+        {
+            memset(slot->output.data, 0, slot->output.capacity);
+            if (streaming)
+            {
+                memset(slot->input.data, 0, slot->input.capacity);
+            }
+        }
+        calc_numa_restore(&saved);
+        if (!placed)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a stream with a pool of worker threads
+ ******************************************************************************/
+static calc_batch_status run_parallel(batch_reader *      reader,
+                                      int                 output_fd,
+                                      unsigned            threads,
+                                      const calc_numa *   numa,
+                                      calc_cache **       caches,
+                                      calc_width          width,
+                                      calc_div_format     division,
+                                      calc_arena *        arena,
+                                      calc_batch_counts * counts)
+{
+    batch_pipeline pipeline;
+    pthread_t      writer;
+    calc_pool *    pool;
+
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.output_fd  = output_fd;
+    pipeline.caches     = caches;
+    pipeline.width      = width;
+    pipeline.division   = division;
+    pipeline.slot_count = (size_t)threads * BATCH_SLOTS_PER_THREAD;
+    pipeline.slots =
+        calc_arena_alloc(arena, pipeline.slot_count * sizeof(*pipeline.slots));
+    if (NULL == pipeline.slots)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+    memset(pipeline.slots, 0, pipeline.slot_count * sizeof(*pipeline.slots));
+    pthread_mutex_init(&pipeline.lock, NULL);
+    pthread_cond_init(&pipeline.changed, NULL);
+
+    pool = NULL;
+    if (NULL != numa && !place_slots(&pipeline, reader, threads, numa))
+    {
+        pipeline.status = CALC_BATCH_NO_MEMORY;
+    }
+    else
+    {
+        pool = calc_pool_create(
+            threads, pipeline.slot_count, eval_slot, &pipeline, numa);
+    }
+    if (NULL == pool)
+    {
+        if (CALC_BATCH_OK == pipeline.status)
+        {
+            pipeline.status = CALC_BATCH_NO_MEMORY;
+        }
+    }
+    else if (0 != pthread_create(&writer, NULL, write_slots, &pipeline))
+    {
+        calc_pool_destroy(pool);
+        pool            = NULL;
+        pipeline.status = CALC_BATCH_NO_MEMORY;
+    }
+
+    for (size_t sequence = 0; NULL != pool; sequence++)
+    {
+        size_t       index = sequence % pipeline.slot_count;
+        batch_slot * slot  = &pipeline.slots[index];
+
+        pthread_mutex_lock(&pipeline.lock);
+        while (SLOT_FREE != slot->state)
+        {
+            pthread_cond_wait(&pipeline.changed, &pipeline.lock);
+        }
+        int stop = (CALC_BATCH_OK != pipeline.status);
+        pthread_mutex_unlock(&pipeline.lock);
+
+        calc_batch_status status = CALC_BATCH_OK;
+        if (!stop)
+        {
+            status = next_chunk(
+                reader, &slot->input, &slot->text, &slot->length);
+        }
+        if (stop || CALC_BATCH_OK != status || 0 == slot->length)
+        {
+            pthread_mutex_lock(&pipeline.lock);
+            if (CALC_BATCH_OK == pipeline.status)
+            {
+                pipeline.status = status;
+            }
+            pipeline.reader_done = 1;
+            pthread_cond_broadcast(&pipeline.changed);
+            pthread_mutex_unlock(&pipeline.lock);
+            break;
+        }
+
+        memset(&slot->counts, 0, sizeof(slot->counts));
+        pthread_mutex_lock(&pipeline.lock);
+        slot->state = SLOT_QUEUED;
+        pipeline.submitted++;
+        pthread_mutex_unlock(&pipeline.lock);
+        calc_pool_submit(pool, index);
+    }
+
+    if (NULL != pool)
+    {
+        pthread_join(writer, NULL);
+        calc_pool_destroy(pool);
+    }
+
+    for (size_t i = 0; i < pipeline.slot_count; i++)
+    {
+        calc_buffer_free(&pipeline.slots[i].input);
+        calc_buffer_free(&pipeline.slots[i].output);
+    }
+    pthread_cond_destroy(&pipeline.changed);
+    pthread_mutex_destroy(&pipeline.lock);
+
+    counts->lines += pipeline.counts.lines;
+    counts->failed += pipeline.counts.failed;
+    return pipeline.status;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a stream on the calling thread
+ ******************************************************************************/
+static calc_batch_status run_serial(batch_reader *      reader,
+                                    int                 output_fd,
+                                    calc_cache *        cache,
+                                    calc_width          width,
+                                    calc_div_format     division,
+                                    calc_io             io,
+                                    calc_batch_counts * counts)
+{
+    batch_uring       uring;
+    calc_buffer       chunk  = { NULL, 0, 0 };
+    calc_buffer       plain  = { NULL, 0, 0 }; // Output without a ring
+    calc_batch_status status = CALC_BATCH_OK;
+    int               ringed =
+        CALC_IO_URING == io && uring_open(&uring, reader, &chunk, output_fd);
+
+    for (;;)
+    {
+        const char *  text;
+        size_t        length;
+        calc_buffer * output = ringed ? NULL : &plain;
+
+        status = next_chunk(reader, &chunk, &text, &length);
+        if (CALC_BATCH_OK != status || 0 == length)
+        {
+            break;
+        }
+        if (ringed && NULL == (output = uring_output(&uring)))
+        {
+            status = CALC_BATCH_WRITE_ERROR;
+            break;
+        }
+
+        output->used = 0;
+        if (!calc_batch_eval(
+                text, length, output, cache, width, division, counts))
+        {
+            status = CALC_BATCH_NO_MEMORY;
+            break;
+        }
+        if (ringed)
+        {
+            uring.filled++; // Written along with the next submission
+        }
+        else if (!write_buffer(output_fd, output))
+        {
+            status = CALC_BATCH_WRITE_ERROR;
+            break;
+        }
+    }
+
+    if (ringed && !uring_close(&uring) && CALC_BATCH_OK == status)
+    {
+        status = CALC_BATCH_WRITE_ERROR;
+    }
+    reader->uring = NULL;
+    calc_buffer_free(&chunk);
+    calc_buffer_free(&plain);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Fold the operand on each line of a chunk into a partial
+ * @param    isa     Instruction set to reduce with
+ * @param    op      Operator
+ * @param    text    Lines, each holding one operand
+ * @param    length  Length of text
+ * @param    partial Partial, updated
+ * @param    counts  Updated with the lines seen and those that failed
+ * @note     Blank lines are skipped; any other line that is not an operand
+ *           fails, and its value is left out
+ ******************************************************************************/
+static void reduce_text(calc_isa              isa,
+                        calc_reduce_op        op,
+                        const char *          text,
+                        size_t                length,
+                        calc_reduce_partial * partial,
+                        calc_batch_counts *   counts)
+{
+    const char * end = text + length;
+    uint32_t     values[BATCH_REDUCE_BLOCK];
+    size_t       used = 0;
+
+    while (text < end)
+    {
+        const char * newline = memchr(text, '\n', (size_t)(end - text));
+        const char * stop    = (NULL != newline) ? newline : end;
+        const char * next    = (NULL != newline) ? newline + 1 : end;
+
+        // calc_parse_uint32 skips leading blanks but not trailing ones
+        while (stop > text && NULL != strchr(whitespace, stop[-1]))
+        {
+            stop--;
+        }
+        if (stop > text)
+        {
+            size_t size = (size_t)(stop - text);
+
+            counts->lines++;
+            if (size <= CALC_LINE_MAX &&
+                calc_parse_uint32(text, size, &values[used]))
+            {
+                used++;
+            }
+            else
+            {
+                counts->failed++;
+            }
+            if (BATCH_REDUCE_BLOCK == used)
+            {
+                calc_reduce_values(isa, op, values, used, partial);
+                used = 0;
+            }
+        }
+        text = next;
+    }
+    calc_reduce_values(isa, op, values, used, partial);
+}
+
+/******************************************************************************
+ * @brief    Pool task: reduce the chunk in one slot
+ ******************************************************************************/
+static void reduce_slot_task(void * context, size_t task, unsigned worker)
+{
+    reduce_pipeline * pipeline = context;
+    reduce_slot *     slot     = &pipeline->slots[task];
+
+    (void)worker;
+    reduce_text(pipeline->isa,
+                pipeline->op,
+                slot->text,
+                slot->length,
+                &slot->partial,
+                &slot->counts);
+
+    pthread_mutex_lock(&pipeline->lock);
+    slot->state = SLOT_DONE;
+    pthread_cond_broadcast(&pipeline->changed);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+/******************************************************************************
+ * @brief    Merge a reduced slot into the total and free it
+ ******************************************************************************/
+static void fold_slot(calc_reduce_op        op,
+                      reduce_slot *         slot,
+                      calc_reduce_partial * total,
+                      calc_batch_counts *   counts)
+{
+    if (SLOT_DONE == slot->state)
+    {
+        calc_reduce_merge(op, total, &slot->partial);
+        counts->lines += slot->counts.lines;
+        counts->failed += slot->counts.failed;
+        slot->state = SLOT_FREE;
+    }
+}
+
+/******************************************************************************
+ * @brief    Reduce a stream with a pool of worker threads
+ *
+ * Chunks go to the pool through a ring of slots, and the reader merges a
+ * slot's partial into the total when it comes round to reuse it. Every
+ * operator is commutative, so the order chunks finish in does not matter.
+ ******************************************************************************/
+static calc_batch_status reduce_parallel(batch_reader *        reader,
+                                         unsigned              threads,
+                                         reduce_pipeline *     pipeline,
+                                         calc_arena *          arena,
+                                         calc_reduce_partial * total,
+                                         calc_batch_counts *   counts)
+{
+    const size_t      slot_count = (size_t)threads * BATCH_SLOTS_PER_THREAD;
+    calc_batch_status status     = CALC_BATCH_OK;
+    calc_pool *       pool       = NULL;
+
+    pipeline->slots =
+        calc_arena_alloc(arena, slot_count * sizeof(*pipeline->slots));
+    if (NULL == pipeline->slots)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+    memset(pipeline->slots, 0, slot_count * sizeof(*pipeline->slots));
+    pthread_mutex_init(&pipeline->lock, NULL);
+    pthread_cond_init(&pipeline->changed, NULL);
+
+    pool = calc_pool_create(
+        threads, slot_count, reduce_slot_task, pipeline, NULL);
+    if (NULL == pool)
+    {
+        status = CALC_BATCH_NO_MEMORY;
+    }
+    for (size_t sequence = 0; NULL != pool; sequence++)
+    {
+        size_t        index = sequence % slot_count;
+        reduce_slot * slot  = &pipeline->slots[index];
+
+        pthread_mutex_lock(&pipeline->lock);
+        while (SLOT_QUEUED == slot->state)
+        {
+            pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+        }
+        pthread_mutex_unlock(&pipeline->lock);
+        fold_slot(pipeline->op, slot, total, counts);
+
+        status = next_chunk(reader, &slot->input, &slot->text, &slot->length);
+        if (CALC_BATCH_OK != status || 0 == slot->length)
+        {
+            break;
+        }
+        slot->partial = calc_reduce_identity(pipeline->op);
+        memset(&slot->counts, 0, sizeof(slot->counts));
+        pthread_mutex_lock(&pipeline->lock);
+        slot->state = SLOT_QUEUED;
+        pthread_mutex_unlock(&pipeline->lock);
+        calc_pool_submit(pool, index);
+    }
+    calc_pool_destroy(pool); // Runs the slots still queued
+
+    for (size_t i = 0; i < slot_count; i++)
+    {
+        fold_slot(pipeline->op, &pipeline->slots[i], total, counts);
+        calc_buffer_free(&pipeline->slots[i].input);
+    }
+    pthread_cond_destroy(&pipeline->changed);
+    pthread_mutex_destroy(&pipeline->lock);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Create a result cache for each thread of a run
+ * @param    arena   Arena the array comes from
+ * @param    threads Caches to create, one per worker
+ * @param    entries Entries of each cache
+ * @param    numa    Nodes the workers are placed on, each cache going on
+ *                   its worker's; NULL to leave them where they fall
+ * @return   Array of caches, or NULL if out of memory
+ ******************************************************************************/
+static calc_cache ** create_caches(calc_arena *      arena,
+                                   unsigned          threads,
+                                   size_t            entries,
+                                   const calc_numa * numa)
+{
+    calc_cache ** caches = calc_arena_alloc(arena, threads * sizeof(*caches));
+
+    for (unsigned i = 0; NULL != caches && i < threads; i++)
+    {
+        calc_numa_policy saved;
+        unsigned         cpu;
+
+        // The cache clears its entries as it is created, which places them
+        if (NULL != numa)
+        {
+            calc_numa_prefer(calc_numa_place(numa, i, &cpu), &saved);
+        }
+        caches[i] = calc_cache_create(entries);
+        if (NULL != numa)
+        {
+            calc_numa_restore(&saved);
+        }
+        if (NULL == caches[i])
+        {
+            while (i > 0)
+            {
+                calc_cache_destroy(caches[--i]);
+            }
+            caches = NULL;
+        }
+    }
+    return caches;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a stream of expressions, one output line per input line
+ * @param    input_fd        Descriptor expressions are read from
+ * @param    output_fd       Descriptor results are written to
+ * @param    threads         Worker threads; 0 or 1 evaluates on the caller
+ * @param    numa_nodes      Pin the workers, spread over up to this many
+ *                           NUMA nodes; 0 leaves them to the scheduler
+ * @param    cache_entries   Size of each thread's result cache; 0 for none
+ * @param    width           Operand width
+ * @param    division        How 32-bit quotients are printed
+ * @param    io              I/O backend; only a single thread uses io_uring
+ * @param    counts          Incremented by the lines seen, the lines that
+ *                           failed and the activity of the caches and the
+ *                           run's arena
+ * @return   CALC_BATCH_OK, or the I/O or memory error that stopped the run
+ ******************************************************************************/
+calc_batch_status calc_batch_run(int                 input_fd,
+                                 int                 output_fd,
+                                 unsigned            threads,
+                                 unsigned            numa_nodes,
+                                 size_t              cache_entries,
+                                 calc_width          width,
+                                 calc_div_format     division,
+                                 calc_io             io,
+                                 calc_batch_counts * counts)
+{
+    batch_reader      reader = {
+        input_fd, 0, 0, { NULL, 0, 0 }, NULL, 0, 0, NULL
+    };
+    calc_batch_status status = CALC_BATCH_OK;
+    unsigned          lanes  = (threads > 1) ? threads : 1; // Caches needed
+    calc_cache **     caches = NULL;
+    calc_numa *       numa   = NULL;
+    calc_arena *      arena  = calc_arena_create(BATCH_ARENA_BLOCK);
+
+    if (NULL == arena)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+    if (threads > 1 && 0 != numa_nodes)
+    {
+        numa = calc_arena_alloc(arena, sizeof(*numa));
+        if (NULL == numa)
+        {
+            calc_arena_destroy(arena);
+            return CALC_BATCH_NO_MEMORY;
+        }
+        if (!calc_numa_detect(numa, numa_nodes))
+        {
+            numa = NULL; // Nothing to pin to; run as without
+        }
+    }
+    if (0 != cache_entries)
+    {
+        caches = create_caches(arena, lanes, cache_entries, numa);
+        if (NULL == caches)
+        {
+            calc_arena_destroy(arena);
+            return CALC_BATCH_NO_MEMORY;
+        }
+    }
+
+    map_input(&reader);
+    if (threads > 1)
+    {
+        status = run_parallel(&reader,
+                              output_fd,
+                              threads,
+                              numa,
+                              caches,
+                              width,
+                              division,
+                              arena,
+                              counts);
+    }
+    else
+    {
+        status = run_serial(&reader,
+                            output_fd,
+                            (NULL != caches) ? caches[0] : NULL,
+                            width,
+                            division,
+                            io,
+                            counts);
+    }
+
+    for (unsigned i = 0; NULL != caches && i < lanes; i++)
+    {
+        calc_cache_add_stats(caches[i], &counts->cache);
+        calc_cache_destroy(caches[i]);
+    }
+    calc_arena_add_stats(arena, &counts->arena);
+    calc_arena_destroy(arena);
+    if (NULL != reader.map)
+    {
+        munmap(reader.map, reader.map_size);
+    }
+    calc_buffer_free(&reader.carry);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Reduce a stream of operands, one per line
+ * @param    input_fd    Descriptor operands are read from
+ * @param    op          Operator
+ * @param    threads     Worker threads; 0 or 1 reduces on the caller
+ * @param    wide        Nonzero if a sum may take 64 bits rather than 32
+ * @param    result      Set to the result, see calc_reduce
+ * @param    counts      Updated with the lines read and those that were not
+ *                       operands, which are ignored by the result
+ * @return   CALC_BATCH_OK, or the error that stopped the run
+ ******************************************************************************/
+calc_batch_status calc_batch_reduce(int                 input_fd,
+                                    calc_reduce_op      op,
+                                    unsigned            threads,
+                                    int                 wide,
+                                    calc_reduction *    result,
+                                    calc_batch_counts * counts)
+{
+    batch_reader        reader   = {
+        input_fd, 0, 0, { NULL, 0, 0 }, NULL, 0, 0, NULL
+    };
+    reduce_pipeline     pipeline;
+    calc_reduce_partial total    = calc_reduce_identity(op);
+    calc_batch_status   status   = CALC_BATCH_OK;
+    calc_arena *        arena    = calc_arena_create(BATCH_ARENA_BLOCK);
+
+    if (NULL == arena)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.isa = calc_isa_detect();
+    pipeline.op  = op;
+
+    map_input(&reader);
+    if (threads > 1)
+    {
+        status = reduce_parallel(
+            &reader, threads, &pipeline, arena, &total, counts);
+    }
+    else
+    {
+        calc_buffer chunk = { NULL, 0, 0 };
+        for (;;)
+        {
+            const char * text;
+            size_t       length;
+
+            status = next_chunk(&reader, &chunk, &text, &length);
+            if (CALC_BATCH_OK != status || 0 == length)
+            {
+                break;
+            }
+            reduce_text(pipeline.isa, op, text, length, &total, counts);
+        }
+        calc_buffer_free(&chunk);
+    }
+    *result = calc_reduce_finish(op, &total, wide);
+
+    calc_arena_add_stats(arena, &counts->arena);
+    calc_arena_destroy(arena);
+    if (NULL != reader.map)
+    {
+        munmap(reader.map, reader.map_size);
+    }
+    calc_buffer_free(&reader.carry);
+    return status;
+}
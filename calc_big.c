@@ -0,0 +1,1197 @@
+/******************************************************************************
+ * @file    calc_big.c
+ * @brief   Arbitrary precision integers
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Magnitudes are arrays of 64-bit limbs with 128-bit intermediates. Sums,
+ * differences and products of one-limb operands are done directly in 128
+ * bits, which is where 32 and 64-bit inputs always land. Longer products
+ * use schoolbook multiplication up to BIG_KARATSUBA limbs and Karatsuba
+ * above, with all of the recursion's scratch allocated up front; quotients
+ * use Knuth's algorithm D, or a single pass for one-limb divisors.
+ *
+ * Without a width the operators keep their meaning as far as they can:
+ * + - * never overflow, / is exact to the hundredth and % takes the sign of
+ * the dividend, as in C. & | ^ and the shifts act on an infinite two's
+ * complement, so >> rounds toward minus infinity and a negative count
+ * shifts the other way. Rotates need a width and are unsupported.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "calc.h"
+
+#define BIG_LIMB_BITS    64
+#define BIG_KARATSUBA    32 // Limbs of the shorter factor worth splitting
+#define BIG_CHUNK_DIGITS 19 // Decimal digits that always fit in a limb
+#define BIG_HUNDREDTHS   100
+#define BIG_LOCAL        64 // Limbs of scratch kept on the stack
+
+/******************************************************************************
+ * @brief    Limbs of a value, wherever they are stored
+ ******************************************************************************/
+static uint64_t * limbs(calc_big * value)
+{
+    return (NULL != value->heap) ? value->heap : value->small;
+}
+
+static const uint64_t * const_limbs(const calc_big * value)
+{
+    return (NULL != value->heap) ? value->heap : value->small;
+}
+
+/******************************************************************************
+ * @brief    Whether a value is below zero; a zero quotient may carry a sign
+ ******************************************************************************/
+static int is_negative(const calc_big * value)
+{
+    return value->negative && 0 != value->length;
+}
+
+/******************************************************************************
+ * @brief    Make room for count limbs, keeping the current ones
+ * @return   CALC_OK, CALC_ERR_TOO_LARGE or CALC_ERR_NO_MEMORY
+ ******************************************************************************/
+static calc_status reserve(calc_big * value, size_t count)
+{
+    if (count > CALC_BIG_LIMBS_MAX)
+    {
+        return CALC_ERR_TOO_LARGE;
+    }
+    if ((NULL == value->heap && count <= CALC_BIG_INLINE) ||
+        (NULL != value->heap && count <= value->capacity))
+    {
+        return CALC_OK;
+    }
+
+    size_t capacity = 2 * value->capacity;
+    if (capacity < count)
+    {
+        capacity = count;
+    }
+    if (capacity > CALC_BIG_LIMBS_MAX)
+    {
+        capacity = CALC_BIG_LIMBS_MAX;
+    }
+    uint64_t * heap = realloc(value->heap, capacity * sizeof(*heap));
+    if (NULL == heap)
+    {
+        return CALC_ERR_NO_MEMORY;
+    }
+    if (NULL == value->heap)
+    {
+        memcpy(heap, value->small, value->length * sizeof(*heap));
+    }
+    value->heap     = heap;
+    value->capacity = capacity;
+    return CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Drop leading zero limbs; zero has no sign
+ ******************************************************************************/
+static void trim(calc_big * value)
+{
+    const uint64_t * digits = const_limbs(value);
+
+    while (0 != value->length && 0 == digits[value->length - 1])
+    {
+        value->length--;
+    }
+    if (0 == value->length)
+    {
+        value->negative = 0;
+    }
+}
+
+/******************************************************************************
+ * @brief    Store a 128-bit signed value; never allocates
+ ******************************************************************************/
+static void set_int128(calc_big * value, calc_int128 number)
+{
+    calc_uint128 magnitude =
+        (number < 0) ? 0 - (calc_uint128)number : (calc_uint128)number;
+    uint64_t * digits = limbs(value);
+
+    digits[0]       = (uint64_t)magnitude;
+    digits[1]       = (uint64_t)(magnitude >> BIG_LIMB_BITS);
+    value->length   = 2;
+    value->negative = (number < 0);
+    trim(value);
+}
+
+/******************************************************************************
+ * @brief    Signed value of a value of at most one limb
+ ******************************************************************************/
+static calc_int128 small_value(const calc_big * value)
+{
+    calc_int128 number = (0 != value->length) ? const_limbs(value)[0] : 0;
+
+    return is_negative(value) ? -number : number;
+}
+
+/******************************************************************************
+ * Limb array primitives. Lengths count limbs; results may share storage
+ * with the first operand where noted.
+ ******************************************************************************/
+
+// r = a + b where an >= bn, r may be a; returns the carry out of limb an - 1
+static uint64_t limbs_add(uint64_t *       r,
+                          const uint64_t * a,
+                          size_t           an,
+                          const uint64_t * b,
+                          size_t           bn)
+{
+    uint64_t carry = 0;
+
+    for (size_t i = 0; i < an; i++)
+    {
+        uint64_t x   = a[i];
+        uint64_t sum = x + ((i < bn) ? b[i] : 0);
+        uint64_t out = (sum < x);
+        r[i]         = sum + carry;
+        carry        = out | (r[i] < sum);
+    }
+    return carry;
+}
+
+// r = a - b where a >= b and an >= bn, r may be a; returns the borrow
+static uint64_t limbs_sub(uint64_t *       r,
+                          const uint64_t * a,
+                          size_t           an,
+                          const uint64_t * b,
+                          size_t           bn)
+{
+    uint64_t borrow = 0;
+
+    for (size_t i = 0; i < an; i++)
+    {
+        uint64_t x    = a[i];
+        uint64_t y    = (i < bn) ? b[i] : 0;
+        uint64_t diff = x - y;
+        uint64_t out  = (x < y);
+        r[i]          = diff - borrow;
+        borrow        = out | (diff < borrow);
+    }
+    return borrow;
+}
+
+// Compare magnitudes without leading zero limbs
+static int limbs_compare(const uint64_t * a,
+                         size_t           an,
+                         const uint64_t * b,
+                         size_t           bn)
+{
+    if (an != bn)
+    {
+        return (an < bn) ? -1 : 1;
+    }
+    for (size_t i = an; i-- > 0;)
+    {
+        if (a[i] != b[i])
+        {
+            return (a[i] < b[i]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r = a * m + carry, r may be a; returns the limb carried out
+static uint64_t limbs_mul_1(uint64_t *       r,
+                            const uint64_t * a,
+                            size_t           n,
+                            uint64_t         m,
+                            uint64_t         carry)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        calc_uint128 product = (calc_uint128)a[i] * m + carry;
+        r[i]                 = (uint64_t)product;
+        carry                = (uint64_t)(product >> BIG_LIMB_BITS);
+    }
+    return carry;
+}
+
+// r += a * m over n limbs; returns the limb carried out
+static uint64_t limbs_addmul_1(uint64_t *       r,
+                               const uint64_t * a,
+                               size_t           n,
+                               uint64_t         m)
+{
+    uint64_t carry = 0;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        calc_uint128 product = (calc_uint128)a[i] * m + r[i] + carry;
+        r[i]                 = (uint64_t)product;
+        carry                = (uint64_t)(product >> BIG_LIMB_BITS);
+    }
+    return carry;
+}
+
+// q = a / d, q may be a or NULL; returns the remainder
+static uint64_t limbs_divrem_1(uint64_t *       q,
+                               const uint64_t * a,
+                               size_t           n,
+                               uint64_t         d)
+{
+    calc_uint128 remainder = 0;
+
+    for (size_t i = n; i-- > 0;)
+    {
+        calc_uint128 part = (remainder << BIG_LIMB_BITS) | a[i];
+        if (NULL != q)
+        {
+            q[i] = (uint64_t)(part / d);
+        }
+        remainder = part % d;
+    }
+    return (uint64_t)remainder;
+}
+
+// r = a << shift for shift < 64, r may be a; returns the bits shifted out
+static uint64_t limbs_shl(uint64_t *       r,
+                          const uint64_t * a,
+                          size_t           n,
+                          unsigned         shift)
+{
+    uint64_t out = 0;
+
+    if (0 == shift)
+    {
+        memmove(r, a, n * sizeof(*r));
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t limb = a[i];
+        r[i]          = (limb << shift) | out;
+        out           = limb >> (BIG_LIMB_BITS - shift);
+    }
+    return out;
+}
+
+// r = a >> shift for shift < 64, r may be a
+static void limbs_shr(uint64_t *       r,
+                      const uint64_t * a,
+                      size_t           n,
+                      unsigned         shift)
+{
+    if (0 == shift)
+    {
+        memmove(r, a, n * sizeof(*r));
+        return;
+    }
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t high = (i + 1 < n) ? a[i + 1] : 0;
+        r[i] = (a[i] >> shift) | (high << (BIG_LIMB_BITS - shift));
+    }
+}
+
+/******************************************************************************
+ * @brief    Schoolbook product, r = a * b over an + bn limbs
+ ******************************************************************************/
+static void multiply_schoolbook(uint64_t *       r,
+                                const uint64_t * a,
+                                size_t           an,
+                                const uint64_t * b,
+                                size_t           bn)
+{
+    memset(r, 0, (an + bn) * sizeof(*r));
+    for (size_t j = 0; j < bn; j++)
+    {
+        r[an + j] = limbs_addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+/******************************************************************************
+ * @brief    Scratch limbs multiply() needs for an an by bn limb product;
+ *           follows the same recursion
+ ******************************************************************************/
+static size_t multiply_scratch(size_t an, size_t bn)
+{
+    if (an < bn)
+    {
+        size_t swap = an;
+        an          = bn;
+        bn          = swap;
+    }
+    if (bn < BIG_KARATSUBA)
+    {
+        return 0;
+    }
+
+    size_t half = (an + 1) / 2;
+    if (bn <= half)
+    {
+        size_t full = multiply_scratch(bn, bn);
+        size_t last = multiply_scratch(an % bn, bn);
+        return 2 * bn + ((full > last) ? full : last);
+    }
+
+    size_t most = multiply_scratch(half + 1, half + 1);
+    size_t low  = multiply_scratch(half, half);
+    size_t high = multiply_scratch(an - half, bn - half);
+    most        = (low > most) ? low : most;
+    most        = (high > most) ? high : most;
+    return 4 * (half + 1) + most;
+}
+
+/******************************************************************************
+ * @brief    Product r = a * b over an + bn limbs, Karatsuba for long factors
+ * @param    scratch     multiply_scratch(an, bn) limbs
+ *
+ * With a = a1 B + a0 and b = b1 B + b0 split at half the longer factor,
+ * a b = a1 b1 B^2 + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B + a0 b0, three
+ * half-size products instead of four. A factor too short to split is
+ * multiplied with slices of the other as long as itself.
+ ******************************************************************************/
+static void multiply(uint64_t *       r,
+                     const uint64_t * a,
+                     size_t           an,
+                     const uint64_t * b,
+                     size_t           bn,
+                     uint64_t *       scratch)
+{
+    if (an < bn)
+    {
+        multiply(r, b, bn, a, an, scratch);
+        return;
+    }
+    if (bn < BIG_KARATSUBA)
+    {
+        multiply_schoolbook(r, a, an, b, bn);
+        return;
+    }
+
+    size_t half = (an + 1) / 2;
+    if (bn <= half)
+    {
+        uint64_t * part = scratch;
+
+        memset(r, 0, (an + bn) * sizeof(*r));
+        for (size_t i = 0; i < an; i += bn)
+        {
+            size_t length = (an - i < bn) ? an - i : bn;
+            multiply(part, a + i, length, b, bn, scratch + 2 * bn);
+
+            uint64_t carry = limbs_add(
+                r + i, r + i, length + bn, part, length + bn);
+            for (size_t k = i + length + bn; 0 != carry && k < an + bn; k++)
+            {
+                carry = (0 == ++r[k]);
+            }
+        }
+        return;
+    }
+
+    size_t           high1 = an - half;
+    size_t           high2 = bn - half;
+    uint64_t *       sum1  = scratch;
+    uint64_t *       sum2  = sum1 + (half + 1);
+    uint64_t *       mid   = sum2 + (half + 1);
+    uint64_t *       next  = mid + 2 * (half + 1);
+    const uint64_t * a1    = a + half;
+    const uint64_t * b1    = b + half;
+
+    sum1[half] = limbs_add(sum1, a, half, a1, high1);
+    sum2[half] = limbs_add(sum2, b, half, b1, high2);
+    multiply(mid, sum1, half + 1, sum2, half + 1, next);
+    multiply(r, a, half, b, half, next);
+    multiply(r + 2 * half, a1, high1, b1, high2, next);
+
+    // The middle term, a0 b1 + a1 b0, added in at B
+    size_t mid_length = 2 * (half + 1);
+    size_t room       = an + bn - half;
+    (void)limbs_sub(mid, mid, mid_length, r, 2 * half);
+    (void)limbs_sub(mid, mid, mid_length, r + 2 * half, high1 + high2);
+    (void)limbs_add(r + half,
+                    r + half,
+                    room,
+                    mid,
+                    (mid_length < room) ? mid_length : room);
+}
+
+/******************************************************************************
+ * @brief    Knuth's algorithm D: q = a / b and r = a % b of magnitudes
+ * @param    q       an - bn + 1 limbs, or NULL
+ * @param    r       bn limbs, or NULL
+ * @param    scratch an + 1 + bn limbs
+ * @note     Needs an >= bn >= 2 and a nonzero top limb of b.
+ ******************************************************************************/
+static void divide_knuth(uint64_t *       q,
+                         uint64_t *       r,
+                         const uint64_t * a,
+                         size_t           an,
+                         const uint64_t * b,
+                         size_t           bn,
+                         uint64_t *       scratch)
+{
+    // Normalise so that the divisor's top bit is set
+    unsigned   shift = (unsigned)__builtin_clzll(b[bn - 1]);
+    uint64_t * u     = scratch;
+    uint64_t * v     = scratch + an + 1;
+
+    (void)limbs_shl(v, b, bn, shift);
+    u[an] = limbs_shl(u, a, an, shift);
+
+    for (size_t j = an - bn + 1; j-- > 0;)
+    {
+        // Estimate the quotient limb from the top two limbs; it is at most
+        // two too large, and the test against v[bn - 2] catches most of that
+        calc_uint128 top =
+            ((calc_uint128)u[j + bn] << BIG_LIMB_BITS) | u[j + bn - 1];
+        calc_uint128 estimate  = top / v[bn - 1];
+        calc_uint128 remainder = top % v[bn - 1];
+        while (0 != (estimate >> BIG_LIMB_BITS) ||
+               estimate * v[bn - 2] >
+                   ((remainder << BIG_LIMB_BITS) | u[j + bn - 2]))
+        {
+            estimate--;
+            remainder += v[bn - 1];
+            if (0 != (remainder >> BIG_LIMB_BITS))
+            {
+                break;
+            }
+        }
+
+        // u[j .. j + bn] -= estimate * v
+        uint64_t digit  = (uint64_t)estimate;
+        uint64_t carry  = 0;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i <= bn; i++)
+        {
+            uint64_t low = carry;
+            if (i < bn)
+            {
+                calc_uint128 product = (calc_uint128)digit * v[i] + carry;
+                low                  = (uint64_t)product;
+                carry = (uint64_t)(product >> BIG_LIMB_BITS);
+            }
+            uint64_t x    = u[j + i];
+            uint64_t diff = x - low;
+            uint64_t out  = (x < low);
+            u[j + i]      = diff - borrow;
+            borrow        = out | (diff < borrow);
+        }
+
+        // Rarely the estimate is still one too large: add v back
+        if (0 != borrow)
+        {
+            digit--;
+            u[j + bn] += limbs_add(u + j, u + j, bn, v, bn);
+        }
+        if (NULL != q)
+        {
+            q[j] = digit;
+        }
+    }
+
+    if (NULL != r)
+    {
+        limbs_shr(r, u, bn, shift);
+    }
+}
+
+/******************************************************************************
+ * @brief    Quotient and remainder of two magnitudes; signs are left to
+ *           the caller
+ * @param    quotient    Set to floor(a / b), or NULL
+ * @param    remainder   Set to a mod b, or NULL
+ * @return   CALC_OK or CALC_ERR_NO_MEMORY
+ ******************************************************************************/
+static calc_status divide(const uint64_t * a,
+                          size_t           an,
+                          const uint64_t * b,
+                          size_t           bn,
+                          calc_big *       quotient,
+                          calc_big *       remainder)
+{
+    calc_status status = CALC_OK;
+
+    if (an < bn)
+    {
+        if (NULL != quotient)
+        {
+            quotient->length = 0;
+        }
+        if (NULL != remainder &&
+            CALC_OK == (status = reserve(remainder, an)))
+        {
+            memcpy(limbs(remainder), a, an * sizeof(*a));
+            remainder->length = an;
+        }
+        return status;
+    }
+    if (NULL != quotient && CALC_OK != (status = reserve(quotient, an)))
+    {
+        return status;
+    }
+    if (NULL != remainder && CALC_OK != (status = reserve(remainder, bn)))
+    {
+        return status;
+    }
+
+    uint64_t * q = (NULL != quotient) ? limbs(quotient) : NULL;
+    uint64_t * r = (NULL != remainder) ? limbs(remainder) : NULL;
+    if (1 == bn)
+    {
+        uint64_t rest = limbs_divrem_1(q, a, an, b[0]);
+        if (NULL != r)
+        {
+            r[0] = rest;
+        }
+    }
+    else
+    {
+        uint64_t   local[BIG_LOCAL];
+        size_t     size    = an + 1 + bn;
+        uint64_t * scratch = local;
+        if (size > BIG_LOCAL &&
+            NULL == (scratch = malloc(size * sizeof(*scratch))))
+        {
+            return CALC_ERR_NO_MEMORY;
+        }
+        divide_knuth(q, r, a, an, b, bn, scratch);
+        if (local != scratch)
+        {
+            free(scratch);
+        }
+    }
+
+    if (NULL != quotient)
+    {
+        quotient->length = an - bn + 1;
+        trim(quotient);
+    }
+    if (NULL != remainder)
+    {
+        remainder->length = bn;
+        trim(remainder);
+    }
+    return CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Add one to a magnitude
+ ******************************************************************************/
+static calc_status increment(calc_big * value)
+{
+    calc_status status = reserve(value, value->length + 1);
+
+    if (CALC_OK == status)
+    {
+        uint64_t * digits     = limbs(value);
+        size_t     i          = 0;
+        digits[value->length] = 0;
+        while (0 == ++digits[i])
+        {
+            i++;
+        }
+        if (i == value->length)
+        {
+            value->length++;
+        }
+    }
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Initialise a value to zero
+ ******************************************************************************/
+void calc_big_init(calc_big * value)
+{
+    memset(value, 0, sizeof(*value));
+}
+
+/******************************************************************************
+ * @brief    Release a value's limbs; it is zero afterwards
+ ******************************************************************************/
+void calc_big_free(calc_big * value)
+{
+    free(value->heap);
+    calc_big_init(value);
+}
+
+/******************************************************************************
+ * @brief    Set a value from a machine integer; never allocates
+ ******************************************************************************/
+void calc_big_set_int(calc_big * value, int64_t number)
+{
+    set_int128(value, number);
+}
+
+/******************************************************************************
+ * @brief    Convert a decimal operand of known length
+ * @param    text    Operand characters, need not be NUL terminated
+ * @param    length  Number of characters
+ * @param    value   Converted operand
+ * @return   1 if valid, 0 if malformed, over CALC_BIG_LIMBS_MAX or out of
+ *           memory
+ * @note     Accepts calc_parse_uint32's syntax: leading whitespace, a sign
+ *           and digits, with an empty operand meaning 0.
+ ******************************************************************************/
+int calc_big_parse(const char * text, size_t length, calc_big * value)
+{
+    const char * cursor = text;
+    const char * end    = text + length;
+    int          minus  = 0;
+
+    value->length   = 0;
+    value->negative = 0;
+    while (cursor < end &&
+           (' ' == *cursor || ('\t' <= *cursor && *cursor <= '\r')))
+    {
+        cursor++;
+    }
+    if (cursor < end && ('+' == *cursor || '-' == *cursor))
+    {
+        minus = ('-' == *cursor);
+        cursor++;
+    }
+
+    const char * first = cursor;
+    while (cursor < end && (unsigned char)(*cursor - '0') < 10)
+    {
+        cursor++;
+    }
+    if (first == cursor || cursor != end)
+    {
+        return 0 == length;
+    }
+    while (end - first > 1 && '0' == *first)
+    {
+        first++;
+    }
+
+    // Whole chunks of BIG_CHUNK_DIGITS digits: value = value * 10^k + chunk
+    size_t count = (size_t)(end - first);
+    if (CALC_OK != reserve(value, count / BIG_CHUNK_DIGITS + 1))
+    {
+        return 0;
+    }
+    uint64_t * digits = limbs(value);
+    size_t     chunk  = count % BIG_CHUNK_DIGITS;
+    if (0 == chunk)
+    {
+        chunk = BIG_CHUNK_DIGITS;
+    }
+    for (; first < end; first += chunk, chunk = BIG_CHUNK_DIGITS)
+    {
+        uint64_t part  = 0;
+        uint64_t scale = 1;
+        for (size_t i = 0; i < chunk; i++)
+        {
+            part  = (part * 10) + (uint64_t)(first[i] - '0');
+            scale = scale * 10;
+        }
+        uint64_t carry =
+            limbs_mul_1(digits, digits, value->length, scale, part);
+        if (0 != carry)
+        {
+            digits[value->length++] = carry;
+        }
+    }
+    value->negative = minus && 0 != value->length;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Compare two values
+ * @return   Negative, zero or positive as value1 is below, equal to or above
+ *           value2
+ ******************************************************************************/
+int calc_big_compare(const calc_big * value1, const calc_big * value2)
+{
+    int negative1 = is_negative(value1);
+    int negative2 = is_negative(value2);
+
+    if (negative1 != negative2)
+    {
+        return negative1 ? -1 : 1;
+    }
+    int order = limbs_compare(const_limbs(value1),
+                              value1->length,
+                              const_limbs(value2),
+                              value2->length);
+    return negative1 ? -order : order;
+}
+
+/******************************************************************************
+ * @brief    Signed sum, operand2 taken with the given sign
+ ******************************************************************************/
+static calc_status add_signed(const calc_big * operand1,
+                              const calc_big * operand2,
+                              int              negative2,
+                              calc_big *       result)
+{
+    int negative1 = is_negative(operand1);
+
+    if (operand1->length <= 1 && operand2->length <= 1)
+    {
+        calc_int128 number2 = small_value(operand2);
+        set_int128(result,
+                   small_value(operand1) +
+                       ((negative2 != is_negative(operand2)) ? -number2
+                                                             : number2));
+        return CALC_OK;
+    }
+
+    const calc_big * large  = operand1;
+    const calc_big * lesser = operand2;
+    int              sign   = negative1;
+    if (negative1 != negative2)
+    {
+        // Opposite signs: the difference of the magnitudes
+        if (limbs_compare(const_limbs(operand1),
+                          operand1->length,
+                          const_limbs(operand2),
+                          operand2->length) < 0)
+        {
+            large  = operand2;
+            lesser = operand1;
+            sign   = negative2;
+        }
+        calc_status status = reserve(result, large->length);
+        if (CALC_OK != status)
+        {
+            return status;
+        }
+        (void)limbs_sub(limbs(result),
+                        const_limbs(large),
+                        large->length,
+                        const_limbs(lesser),
+                        lesser->length);
+        result->length = large->length;
+    }
+    else
+    {
+        if (operand1->length < operand2->length)
+        {
+            large  = operand2;
+            lesser = operand1;
+        }
+        calc_status status = reserve(result, large->length + 1);
+        if (CALC_OK != status)
+        {
+            return status;
+        }
+        uint64_t * digits     = limbs(result);
+        digits[large->length] = limbs_add(digits,
+                                          const_limbs(large),
+                                          large->length,
+                                          const_limbs(lesser),
+                                          lesser->length);
+        result->length        = large->length + 1;
+    }
+    result->negative = sign;
+    trim(result);
+    return CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision addition
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @param    result      Sum, distinct from the operands
+ * @return   CALC_OK, CALC_ERR_TOO_LARGE or CALC_ERR_NO_MEMORY
+ ******************************************************************************/
+calc_status calc_big_add(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return add_signed(operand1, operand2, is_negative(operand2), result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision subtraction
+ * @see      calc_big_add
+ ******************************************************************************/
+calc_status calc_big_sub(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return add_signed(operand1, operand2, !is_negative(operand2), result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision multiplication
+ * @see      calc_big_add
+ ******************************************************************************/
+calc_status calc_big_mul(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    int         negative = is_negative(operand1) != is_negative(operand2);
+    size_t      length1  = operand1->length;
+    size_t      length2  = operand2->length;
+    calc_status status   = CALC_OK;
+
+    if (length1 <= 1 && length2 <= 1)
+    {
+        calc_uint128 product = 0;
+        if (0 != length1 && 0 != length2)
+        {
+            product = (calc_uint128)const_limbs(operand1)[0] *
+                      const_limbs(operand2)[0];
+        }
+        uint64_t * digits = limbs(result);
+        digits[0]         = (uint64_t)product;
+        digits[1]         = (uint64_t)(product >> BIG_LIMB_BITS);
+        result->length    = 2;
+    }
+    else if (0 == length1 || 0 == length2)
+    {
+        result->length = 0;
+    }
+    else
+    {
+        status = reserve(result, length1 + length2);
+        if (CALC_OK != status)
+        {
+            return status;
+        }
+
+        size_t     size    = multiply_scratch(length1, length2);
+        uint64_t * scratch = NULL;
+        if (0 != size && NULL == (scratch = malloc(size * sizeof(*scratch))))
+        {
+            return CALC_ERR_NO_MEMORY;
+        }
+        multiply(limbs(result),
+                 const_limbs(operand1),
+                 length1,
+                 const_limbs(operand2),
+                 length2,
+                 scratch);
+        free(scratch);
+        result->length = length1 + length2;
+    }
+    result->negative = negative;
+    trim(result);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision division, exact to the hundredth
+ * @param    operand1    Dividend
+ * @param    operand2    Divisor
+ * @param    result      Quotient in hundredths, rounded half to even
+ * @return   CALC_OK, CALC_ERR_DIV_BY_ZERO, CALC_ERR_TOO_LARGE or
+ *           CALC_ERR_NO_MEMORY
+ ******************************************************************************/
+calc_status calc_big_div(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    calc_big    scaled;
+    calc_big    remainder;
+    calc_status status;
+
+    if (0 == operand2->length)
+    {
+        return CALC_ERR_DIV_BY_ZERO;
+    }
+
+    calc_big_init(&scaled);
+    calc_big_init(&remainder);
+    status = reserve(&scaled, operand1->length + 1);
+    if (CALC_OK == status)
+    {
+        uint64_t * digits = limbs(&scaled);
+        digits[operand1->length] = limbs_mul_1(digits,
+                                               const_limbs(operand1),
+                                               operand1->length,
+                                               BIG_HUNDREDTHS,
+                                               0);
+        scaled.length = operand1->length + 1;
+        trim(&scaled);
+        status = divide(const_limbs(&scaled),
+                        scaled.length,
+                        const_limbs(operand2),
+                        operand2->length,
+                        result,
+                        &remainder);
+    }
+
+    // Round half to even: compare twice the remainder with the divisor
+    if (CALC_OK == status && 0 != remainder.length &&
+        CALC_OK == (status = reserve(&remainder, remainder.length + 1)))
+    {
+        uint64_t * digits = limbs(&remainder);
+        digits[remainder.length] =
+            limbs_shl(digits, digits, remainder.length, 1);
+        remainder.length++;
+        trim(&remainder);
+
+        int order = limbs_compare(digits,
+                                  remainder.length,
+                                  const_limbs(operand2),
+                                  operand2->length);
+        int odd   = 0 != result->length && 0 != (limbs(result)[0] & 1);
+        if (order > 0 || (0 == order && odd))
+        {
+            status = increment(result);
+        }
+    }
+
+    // As for a double, the sign survives a quotient that rounds to zero
+    result->negative = operand1->negative != operand2->negative;
+    calc_big_free(&scaled);
+    calc_big_free(&remainder);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision modulo, with the sign of the dividend
+ * @return   CALC_OK, CALC_ERR_MOD_BY_ZERO or CALC_ERR_NO_MEMORY
+ * @see      calc_big_add
+ ******************************************************************************/
+calc_status calc_big_mod(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    if (0 == operand2->length)
+    {
+        return CALC_ERR_MOD_BY_ZERO;
+    }
+
+    calc_status status = divide(const_limbs(operand1),
+                                operand1->length,
+                                const_limbs(operand2),
+                                operand2->length,
+                                NULL,
+                                result);
+    result->negative   = is_negative(operand1) && 0 != result->length;
+    return status;
+}
+
+/******************************************************************************
+ * @brief    value << bits of a magnitude, keeping its sign
+ ******************************************************************************/
+static calc_status shift_left(const calc_big * value,
+                              uint64_t         bits,
+                              calc_big *       result)
+{
+    if (0 == value->length)
+    {
+        result->length = 0;
+        return CALC_OK;
+    }
+    if (bits >= (uint64_t)CALC_BIG_LIMBS_MAX * BIG_LIMB_BITS)
+    {
+        return CALC_ERR_TOO_LARGE;
+    }
+
+    size_t      whole  = (size_t)(bits / BIG_LIMB_BITS);
+    size_t      length = value->length + whole + 1;
+    calc_status status = reserve(result, length);
+    if (CALC_OK != status)
+    {
+        return status;
+    }
+    uint64_t * digits = limbs(result);
+    memset(digits, 0, whole * sizeof(*digits));
+    digits[length - 1] = limbs_shl(digits + whole,
+                                   const_limbs(value),
+                                   value->length,
+                                   (unsigned)(bits % BIG_LIMB_BITS));
+    result->length     = length;
+    result->negative   = is_negative(value);
+    trim(result);
+    return CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    value >> bits, rounding toward minus infinity
+ *
+ * For negative values that is -(((|value| - 1) >> bits) + 1), the
+ * arithmetic shift of the two's complement.
+ ******************************************************************************/
+static calc_status shift_right(const calc_big * value,
+                               uint64_t         bits,
+                               calc_big *       result)
+{
+    static const uint64_t one[1] = { 1 };
+    int                   minus  = is_negative(value);
+    size_t                length = value->length;
+    calc_status           status = reserve(result, length);
+
+    if (CALC_OK != status)
+    {
+        return status;
+    }
+
+    uint64_t * digits = limbs(result);
+    if (minus)
+    {
+        (void)limbs_sub(digits, const_limbs(value), length, one, 1);
+    }
+    else
+    {
+        memcpy(digits, const_limbs(value), length * sizeof(*digits));
+    }
+
+    if (bits >= (uint64_t)length * BIG_LIMB_BITS)
+    {
+        result->length = 0;
+    }
+    else
+    {
+        size_t whole = (size_t)(bits / BIG_LIMB_BITS);
+        limbs_shr(digits,
+                  digits + whole,
+                  length - whole,
+                  (unsigned)(bits % BIG_LIMB_BITS));
+        result->length = length - whole;
+        trim(result);
+    }
+
+    result->negative = minus;
+    return minus ? increment(result) : CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Shift by a signed count, the other way when it is negative
+ ******************************************************************************/
+static calc_status shift(const calc_big * value,
+                         const calc_big * count,
+                         int              left,
+                         calc_big *       result)
+{
+    // Counts beyond one limb are beyond any result size too
+    uint64_t bits = (count->length > 1)   ? UINT64_MAX
+                    : (0 != count->length) ? const_limbs(count)[0]
+                                           : 0;
+
+    if (is_negative(count))
+    {
+        left = !left;
+    }
+    return left ? shift_left(value, bits, result)
+                : shift_right(value, bits, result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision left shift
+ * @return   CALC_OK, CALC_ERR_TOO_LARGE or CALC_ERR_NO_MEMORY
+ * @see      calc_big_add
+ ******************************************************************************/
+calc_status calc_big_shl(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return shift(operand1, operand2, 1, result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision right shift, rounding toward minus infinity
+ * @see      calc_big_shl
+ ******************************************************************************/
+calc_status calc_big_shr(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return shift(operand1, operand2, 0, result);
+}
+
+/******************************************************************************
+ * @brief    Bitwise operator on the infinite two's complement of both values
+ *
+ * Negative magnitudes are complemented on the fly (~m + 1, limb by limb),
+ * one limb wider than the longer operand so the sign limb is included.
+ ******************************************************************************/
+static calc_status bitwise(const calc_big * operand1,
+                           const calc_big * operand2,
+                           calc_op          op,
+                           calc_big *       result)
+{
+    int              minus1 = is_negative(operand1);
+    int              minus2 = is_negative(operand2);
+    size_t           length = ((operand1->length > operand2->length)
+                                   ? operand1->length
+                                   : operand2->length) + 1;
+    const uint64_t * x      = const_limbs(operand1);
+    const uint64_t * y      = const_limbs(operand2);
+    uint64_t         carry1 = 1;
+    uint64_t         carry2 = 1;
+    calc_status      status = reserve(result, length);
+
+    if (CALC_OK != status)
+    {
+        return status;
+    }
+
+    uint64_t * digits = limbs(result);
+    for (size_t i = 0; i < length; i++)
+    {
+        uint64_t limb1 = (i < operand1->length) ? x[i] : 0;
+        uint64_t limb2 = (i < operand2->length) ? y[i] : 0;
+        if (minus1)
+        {
+            limb1  = ~limb1 + carry1;
+            carry1 = carry1 && 0 == limb1;
+        }
+        if (minus2)
+        {
+            limb2  = ~limb2 + carry2;
+            carry2 = carry2 && 0 == limb2;
+        }
+        digits[i] = (CALC_OP_AND == op)  ? (limb1 & limb2)
+                    : (CALC_OP_OR == op) ? (limb1 | limb2)
+                                         : (limb1 ^ limb2);
+    }
+
+    int minus = (CALC_OP_AND == op)  ? (minus1 & minus2)
+                : (CALC_OP_OR == op) ? (minus1 | minus2)
+                                     : (minus1 ^ minus2);
+    if (minus)
+    {
+        uint64_t carry = 1;
+        for (size_t i = 0; i < length; i++)
+        {
+            digits[i] = ~digits[i] + carry;
+            carry     = carry && 0 == digits[i];
+        }
+    }
+    result->length   = length;
+    result->negative = minus;
+    trim(result);
+    return CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision bitwise AND
+ * @return   CALC_OK, CALC_ERR_TOO_LARGE or CALC_ERR_NO_MEMORY
+ * @see      calc_big_add
+ ******************************************************************************/
+calc_status calc_big_and(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return bitwise(operand1, operand2, CALC_OP_AND, result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision bitwise OR
+ * @see      calc_big_and
+ ******************************************************************************/
+calc_status calc_big_or(const calc_big * operand1,
+                        const calc_big * operand2,
+                        calc_big *       result)
+{
+    return bitwise(operand1, operand2, CALC_OP_OR, result);
+}
+
+/******************************************************************************
+ * @brief    Arbitrary precision bitwise XOR
+ * @see      calc_big_and
+ ******************************************************************************/
+calc_status calc_big_xor(const calc_big * operand1,
+                         const calc_big * operand2,
+                         calc_big *       result)
+{
+    return bitwise(operand1, operand2, CALC_OP_XOR, result);
+}
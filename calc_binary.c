@@ -0,0 +1,558 @@
+/******************************************************************************
+ * @file    calc_binary.c
+ * @brief   Binary columnar batch evaluation
+ * @version 1.6
+ * @date    October 2026
+ *
+ * A request is a header followed by the operand1 column and then the
+ * operand2 column, both packed little-endian uint32. The response is a
+ * header, the result column (uint32, or IEEE 754 binary64 for division) and
+ * a bitmap of the failed rows laid out as calc_apply's error mask. Failed
+ * rows hold zero in the result column. See calc.h for the header layout.
+ *
+ * The request is mapped (or, for pipes, read whole) and the operand columns
+ * are fed to calc_apply in blocks straight from the input, so no value is
+ * ever formatted or parsed. Requests already in memory, such as those a
+ * server receives, are answered into a buffer the same way. Scratch space
+ * and the failure bitmap come from an arena, which a server resets between
+ * requests rather than allocating them anew for each.
+ *
+ * A reduction reads a bare column, with no header, and reduces it in place.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_net.h"
+#include "calc_reduce.h"
+#include "calc_stats.h"
+
+#define BINARY_BLOCK      4096 // Rows per calc_apply call, a multiple of 8
+#define BINARY_OUTPUT_MAX (64 * 1024)
+#define ROWS_PER_BYTE     8
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CALC_BINARY_NATIVE 1 // Columns can be used in place
+#endif
+
+/******************************************************************************
+ * @brief    Whole request, either mapped or read into a buffer
+ ******************************************************************************/
+typedef struct
+{
+    const unsigned char * data;
+    size_t                size;
+    void *                map;
+    calc_buffer           buffer;
+} binary_input;
+
+/******************************************************************************
+ * @brief    Working storage of one run, allocated so runs stay reentrant
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t      operand1[BINARY_BLOCK]; // Decoded columns, big-endian only
+    uint32_t      operand2[BINARY_BLOCK];
+    uint32_t      result[BINARY_BLOCK];
+    unsigned char encoded[BINARY_BLOCK * sizeof(double)];
+    char          output[BINARY_OUTPUT_MAX];
+} binary_scratch;
+
+/******************************************************************************
+ * @brief    Where a response goes: streamed to a descriptor, or appended to a
+ *           buffer in memory
+ ******************************************************************************/
+typedef struct
+{
+    calc_output * stream;
+    calc_buffer * buffer;
+    int           no_memory;
+} binary_sink;
+
+/******************************************************************************
+ * @brief    Map the request, or read it whole if it cannot be mapped
+ * @return   CALC_BATCH_OK, or the error that stopped reading
+ ******************************************************************************/
+static calc_batch_status read_input(int fd, binary_input * input)
+{
+    struct stat info;
+
+    if (0 == fstat(fd, &info) && S_ISREG(info.st_mode) && info.st_size > 0 &&
+        0 == lseek(fd, 0, SEEK_CUR))
+    {
+        void * map =
+            mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != map)
+        {
+            (void)posix_madvise(
+                map, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+            input->map  = map;
+            input->data = map;
+            input->size = (size_t)info.st_size;
+            return CALC_BATCH_OK;
+        }
+    }
+
+    for (;;)
+    {
+        if (!calc_buffer_reserve(&input->buffer, BINARY_OUTPUT_MAX))
+        {
+            return CALC_BATCH_NO_MEMORY;
+        }
+        ssize_t count = read(fd,
+                             input->buffer.data + input->buffer.used,
+                             input->buffer.capacity - input->buffer.used);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return CALC_BATCH_READ_ERROR;
+        }
+        if (0 == count)
+        {
+            break;
+        }
+        input->buffer.used += (size_t)count;
+    }
+    input->data = (const unsigned char *)input->buffer.data;
+    input->size = input->buffer.used;
+    return CALC_BATCH_OK;
+}
+
+/******************************************************************************
+ * @brief    Get a block of an operand column as host integers
+ * @param    column  Start of the block in the request
+ * @param    scratch Room for BINARY_BLOCK values, used on big-endian hosts
+ * @param    rows    Rows in the block
+ ******************************************************************************/
+static const uint32_t * load_column(const unsigned char * column,
+                                    uint32_t *            scratch,
+                                    size_t                rows)
+{
+#if defined(CALC_BINARY_NATIVE)
+    // The header keeps both columns 4-byte aligned in the request
+    (void)scratch;
+    (void)rows;
+    return (const uint32_t *)(const void *)column;
+#else
+    for (size_t i = 0; i < rows; i++)
+    {
+        scratch[i] = calc_net_load_le32(column + (i * sizeof(uint32_t)));
+    }
+    return scratch;
+#endif
+}
+
+/******************************************************************************
+ * @brief    Evaluate one block of division rows, which have double results
+ * @return   1 if any row failed, 0 otherwise
+ ******************************************************************************/
+static int divide_block(const uint32_t * operand1,
+                        const uint32_t * operand2,
+                        unsigned char *  out,
+                        uint8_t *        error_mask,
+                        size_t           rows)
+{
+    unsigned sticky = 0;
+
+    // A zero divisor is swapped for 1 and its row flagged, so the loop has
+    // no branch; the flags reach the error mask only if one was raised
+    memset(error_mask, 0, (rows + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE);
+    for (size_t i = 0; i < rows; i++)
+    {
+        int32_t  divisor  = (int32_t)operand2[i];
+        unsigned zero     = (0 == divisor);
+        double   quotient = (double)(int32_t)operand1[i] /
+                          (double)(zero ? 1 : divisor);
+        uint64_t bits     = 0;
+
+        memcpy(&bits, &quotient, sizeof(bits));
+        bits &= (uint64_t)zero - 1; // Failed rows carry 0
+        calc_net_store_le64(out + (i * sizeof(bits)), bits);
+        sticky |= zero;
+    }
+    for (size_t i = 0; 0 != sticky && i < rows; i++)
+    {
+        error_mask[i / ROWS_PER_BYTE] |=
+            (uint8_t)((unsigned)(0 == operand2[i]) << (i % ROWS_PER_BYTE));
+    }
+    return 0 != sticky;
+}
+
+/******************************************************************************
+ * @brief    Evaluate one block of 32-bit rows with calc_apply
+ * @return   1 if any row failed, 0 otherwise
+ ******************************************************************************/
+static int apply_block(calc_op          op,
+                       const uint32_t * operand1,
+                       const uint32_t * operand2,
+                       uint32_t *       result,
+                       unsigned char *  out,
+                       uint8_t *        error_mask,
+                       size_t           rows)
+{
+    int failed = (CALC_OK != calc_apply(
+                      op, operand1, operand2, result, error_mask, rows));
+
+    // Failed rows carry 0: their mask bit, widened to a word, clears them
+    for (size_t i = 0; i < rows; i++)
+    {
+        uint32_t bit = (uint32_t)failed &
+                       (uint32_t)(error_mask[i / ROWS_PER_BYTE] >>
+                                  (i % ROWS_PER_BYTE));
+        calc_net_store_le32(out + (i * sizeof(uint32_t)),
+                            result[i] & (bit - 1));
+    }
+    return failed;
+}
+
+/******************************************************************************
+ * @brief    Count the failed rows of a block
+ ******************************************************************************/
+static size_t count_failed(const uint8_t * error_mask, size_t rows)
+{
+    size_t failed = 0;
+
+    for (size_t i = 0; i < (rows + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE; i++)
+    {
+        failed += (size_t)__builtin_popcount(error_mask[i]);
+    }
+    return failed;
+}
+
+/******************************************************************************
+ * @brief    Write part of a response
+ * @return   1 if successful, 0 once a write has failed
+ ******************************************************************************/
+static int sink_write(binary_sink * sink, const void * bytes, size_t length)
+{
+    if (NULL != sink->stream)
+    {
+        return calc_output_write(sink->stream, bytes, length);
+    }
+    if (sink->no_memory || !calc_buffer_reserve(sink->buffer, length))
+    {
+        sink->no_memory = 1;
+        return 0;
+    }
+    memcpy(sink->buffer->data + sink->buffer->used, bytes, length);
+    sink->buffer->used += length;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Check a request header
+ * @param    header  CALC_BINARY_HEADER_SIZE bytes
+ * @param    op      Set to the request's operator
+ * @param    count   Set to the request's row count
+ * @return   1 if the header is valid, 0 otherwise
+ ******************************************************************************/
+static int parse_header(const unsigned char * header,
+                        calc_op *             op,
+                        uint64_t *            count)
+{
+    uint16_t opcode = calc_net_load_le16(header + 6);
+
+    *op    = (calc_op)opcode;
+    *count = calc_net_load_le64(header + 8);
+    // Two columns of count rows must fit in a size_t
+    return CALC_BINARY_REQUEST_MAGIC == calc_net_load_le32(header) &&
+           CALC_BINARY_VERSION == calc_net_load_le16(header + 4) &&
+           CALC_OP_INVALID != opcode && opcode < CALC_OP_COUNT &&
+           *count <= (SIZE_MAX - CALC_BINARY_HEADER_SIZE) /
+                         (2 * sizeof(uint32_t));
+}
+
+/******************************************************************************
+ * @brief    Evaluate a validated request and write the response
+ ******************************************************************************/
+static calc_batch_status eval_request(const unsigned char * request,
+                                      calc_op               op,
+                                      size_t                count,
+                                      binary_sink *         sink,
+                                      binary_scratch *      scratch,
+                                      calc_arena *          arena,
+                                      calc_batch_counts *   counts)
+{
+    const unsigned char * column1 = request + CALC_BINARY_HEADER_SIZE;
+    const unsigned char * column2 = column1 + (count * sizeof(uint32_t));
+    size_t        mask_size = (count + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE;
+    unsigned char header[CALC_BINARY_HEADER_SIZE];
+    int           written;
+
+    calc_kind kind  = calc_op_kind(op);
+    size_t    width =
+        (CALC_KIND_DOUBLE == kind) ? sizeof(double) : sizeof(uint32_t);
+
+    uint8_t * error_mask = calc_arena_alloc(arena, mask_size);
+    if (NULL == error_mask)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+
+    calc_net_store_le32(header, CALC_BINARY_RESPONSE_MAGIC);
+    calc_net_store_le16(header + 4, CALC_BINARY_VERSION);
+    calc_net_store_le16(header + 6, (uint16_t)kind);
+    calc_net_store_le64(header + 8, count);
+    written = sink_write(sink, header, sizeof(header));
+
+    for (size_t start = 0; start < count && written; start += BINARY_BLOCK)
+    {
+        size_t rows   = (count - start < BINARY_BLOCK) ? count - start
+                                                       : BINARY_BLOCK;
+        size_t offset = start * sizeof(uint32_t);
+        const uint32_t * x =
+            load_column(column1 + offset, scratch->operand1, rows);
+        const uint32_t * y =
+            load_column(column2 + offset, scratch->operand2, rows);
+        uint8_t * mask = error_mask + (start / ROWS_PER_BYTE);
+        int       failed;
+        size_t    failures = 0;
+
+        if (CALC_KIND_DOUBLE == kind)
+        {
+            failed = divide_block(x, y, scratch->encoded, mask, rows);
+        }
+        else
+        {
+            failed = apply_block(
+                op, x, y, scratch->result, scratch->encoded, mask, rows);
+        }
+        if (failed)
+        {
+            failures = count_failed(mask, rows);
+        }
+        calc_stats_count_rows(op, rows, failures);
+        counts->failed += failures;
+        counts->lines += rows;
+        written = sink_write(sink, scratch->encoded, rows * width);
+    }
+
+    if (written)
+    {
+        written = sink_write(sink, error_mask, mask_size);
+    }
+    if (sink->no_memory)
+    {
+        return CALC_BATCH_NO_MEMORY;
+    }
+    if (NULL != sink->stream && !(written && calc_output_flush(sink->stream)))
+    {
+        return CALC_BATCH_WRITE_ERROR;
+    }
+    return CALC_BATCH_OK;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a binary columnar request
+ * @param    input_fd    Descriptor the request is read from
+ * @param    output_fd   Descriptor the response is written to
+ * @param    counts      Incremented by the rows seen and the rows that failed
+ * @return   CALC_BATCH_OK, CALC_BATCH_BAD_FORMAT if the request is malformed,
+ *           or the I/O or memory error that stopped the run
+ ******************************************************************************/
+calc_batch_status calc_binary_run(int                 input_fd,
+                                  int                 output_fd,
+                                  calc_batch_counts * counts)
+{
+    binary_input      input   = { NULL, 0, NULL, { NULL, 0, 0 } };
+    calc_arena *      arena   = calc_arena_create(sizeof(binary_scratch));
+    binary_scratch *  scratch = NULL;
+    calc_batch_status status  = CALC_BATCH_NO_MEMORY;
+
+    if (NULL != arena)
+    {
+        scratch = calc_arena_alloc(arena, sizeof(*scratch));
+    }
+    if (NULL != scratch)
+    {
+        status = read_input(input_fd, &input);
+    }
+    if (CALC_BATCH_OK == status)
+    {
+        calc_op     op;
+        uint64_t    count;
+        calc_output output;
+        binary_sink sink = { &output, NULL, 0 };
+
+        // Exactly two full columns must follow the header
+        status = CALC_BATCH_BAD_FORMAT;
+        if (input.size >= CALC_BINARY_HEADER_SIZE &&
+            parse_header(input.data, &op, &count) &&
+            input.size - CALC_BINARY_HEADER_SIZE ==
+                count * 2 * sizeof(uint32_t))
+        {
+            calc_output_init(&output,
+                             output_fd,
+                             scratch->output,
+                             sizeof(scratch->output));
+            status = eval_request(
+                input.data, op, (size_t)count, &sink, scratch, arena, counts);
+        }
+    }
+
+    if (NULL != input.map)
+    {
+        munmap(input.map, input.size);
+    }
+    calc_buffer_free(&input.buffer);
+    if (NULL != arena)
+    {
+        calc_arena_add_stats(arena, &counts->arena);
+    }
+    calc_arena_destroy(arena);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Size of the binary request a header starts
+ * @param    header  At least CALC_BINARY_HEADER_SIZE bytes
+ * @param    size    Set to the size of the whole request, header included
+ * @return   1 if the header is valid, 0 otherwise
+ ******************************************************************************/
+int calc_binary_request_size(const void * header, size_t * size)
+{
+    calc_op  op;
+    uint64_t count;
+
+    if (!parse_header(header, &op, &count))
+    {
+        return 0;
+    }
+    *size = CALC_BINARY_HEADER_SIZE + (size_t)(count * 2 * sizeof(uint32_t));
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a binary request held in memory
+ * @param    request Whole request
+ * @param    size    Size of request
+ * @param    output  Buffer the response is appended to
+ * @param    arena   Scratch space, for the caller to reset once the response
+ *                   is no longer needed
+ * @param    counts  Incremented by the rows seen and the rows that failed
+ * @return   CALC_BATCH_OK, CALC_BATCH_BAD_FORMAT if the request is malformed,
+ *           or CALC_BATCH_NO_MEMORY
+ ******************************************************************************/
+calc_batch_status calc_binary_eval(const void *        request,
+                                   size_t              size,
+                                   calc_buffer *       output,
+                                   calc_arena *        arena,
+                                   calc_batch_counts * counts)
+{
+    size_t      expected;
+    binary_sink sink = { NULL, output, 0 };
+
+    if (size < CALC_BINARY_HEADER_SIZE ||
+        !calc_binary_request_size(request, &expected) || size != expected)
+    {
+        return CALC_BATCH_BAD_FORMAT;
+    }
+
+    // The output staging area is only needed when streaming
+    const unsigned char * data = request;
+    binary_scratch *      scratch =
+        calc_arena_alloc(arena, offsetof(binary_scratch, output));
+
+    // Columns are read in place, so they must be 4-byte aligned
+    if (0 != ((uintptr_t)data % sizeof(uint32_t)))
+    {
+        unsigned char * copy = calc_arena_alloc(arena, size);
+        if (NULL != copy)
+        {
+            memcpy(copy, data, size);
+        }
+        data = copy;
+    }
+
+    calc_batch_status status = CALC_BATCH_NO_MEMORY;
+    if (NULL != scratch && NULL != data)
+    {
+        status = eval_request(data,
+                              (calc_op)calc_net_load_le16(data + 6),
+                              (expected - CALC_BINARY_HEADER_SIZE) /
+                                  (2 * sizeof(uint32_t)),
+                              &sink,
+                              scratch,
+                              arena,
+                              counts);
+    }
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Reduce a column of values packed little-endian uint32, with no
+ *           header
+ * @param    input_fd    Descriptor the column is read from
+ * @param    op          Operator
+ * @param    threads     Worker threads; 0 or 1 reduces on the caller
+ * @param    wide        Nonzero if a sum may take 64 bits rather than 32
+ * @param    result      Set to the result, see calc_reduce
+ * @return   CALC_BATCH_OK, CALC_BATCH_BAD_FORMAT if the input is not a whole
+ *           number of values, or the error that stopped the run
+ ******************************************************************************/
+calc_batch_status calc_binary_reduce(int              input_fd,
+                                     calc_reduce_op   op,
+                                     unsigned         threads,
+                                     int              wide,
+                                     calc_reduction * result)
+{
+    binary_input      input  = { NULL, 0, NULL, { NULL, 0, 0 } };
+    calc_batch_status status = read_input(input_fd, &input);
+
+    if (CALC_BATCH_OK == status && 0 != input.size % sizeof(uint32_t))
+    {
+        status = CALC_BATCH_BAD_FORMAT;
+    }
+    if (CALC_BATCH_OK == status)
+    {
+        size_t count = input.size / sizeof(uint32_t);
+#if defined(CALC_BINARY_NATIVE)
+        // Mappings and buffers are both aligned for the values
+        *result = calc_reduce(op,
+                              (const uint32_t *)(const void *)input.data,
+                              count,
+                              threads,
+                              wide);
+#else
+        uint32_t            scratch[BINARY_BLOCK];
+        calc_reduce_partial total = calc_reduce_identity(op);
+        calc_isa            isa   = calc_isa_detect();
+
+        (void)threads;
+        for (size_t start = 0; start < count; start += BINARY_BLOCK)
+        {
+            size_t rows = (count - start < BINARY_BLOCK) ? count - start
+                                                         : BINARY_BLOCK;
+            calc_reduce_values(
+                isa,
+                op,
+                load_column(input.data + (start * sizeof(uint32_t)),
+                            scratch,
+                            rows),
+                rows,
+                &total);
+        }
+        *result = calc_reduce_finish(op, &total, wide);
+#endif
+        if (CALC_ERR_NO_MEMORY == result->status)
+        {
+            status = CALC_BATCH_NO_MEMORY;
+        }
+    }
+
+    if (NULL != input.map)
+    {
+        munmap(input.map, input.size);
+    }
+    calc_buffer_free(&input.buffer);
+    return status;
+}
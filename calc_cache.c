@@ -0,0 +1,219 @@
+/******************************************************************************
+ * @file    calc_cache.c
+ * @brief   Bounded cache of formatted results
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Entries are keyed on (opcode, operand1, operand2) and hold the status and
+ * the formatted output line, so a hit skips both the operator and the
+ * formatter. An entry is exactly one cache line; four of them form a set
+ * that a key hashes to, and a full set evicts with CLOCK: the hand skips,
+ * and clears, entries referenced since it last passed them.
+ *
+ * A cache is not shared: each thread owns one, so nothing is locked.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "calc.h"
+
+#define CACHE_LINE_SIZE 64
+#define CACHE_WAYS      4
+#define CACHE_TEXT_MAX  (CACHE_LINE_SIZE - 12)
+
+/******************************************************************************
+ * @brief    One cached line; op is CALC_OP_INVALID while the entry is empty
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t operand1;
+    uint32_t operand2;
+    uint8_t  op;
+    uint8_t  status;
+    uint8_t  length;
+    uint8_t  referenced;
+    char     text[CACHE_TEXT_MAX];
+} cache_entry;
+
+_Static_assert(sizeof(cache_entry) == CACHE_LINE_SIZE,
+               "cache entries must be one cache line");
+
+struct calc_cache
+{
+    cache_entry *    entries;
+    uint8_t *        hands; // CLOCK hand of each set
+    size_t           set_mask;
+    calc_cache_stats stats;
+};
+
+/******************************************************************************
+ * @brief    Create a cache
+ * @param    entries     Lines to hold, rounded up to a power of two
+ * @return   New cache, or NULL if out of memory
+ ******************************************************************************/
+calc_cache * calc_cache_create(size_t entries)
+{
+    size_t       sets  = 1;
+    calc_cache * cache = calloc(1, sizeof(*cache));
+
+    if (NULL == cache)
+    {
+        return NULL;
+    }
+    while (sets * CACHE_WAYS < entries)
+    {
+        sets *= 2;
+    }
+
+    size_t size    = sets * CACHE_WAYS * sizeof(cache_entry);
+    cache->entries = aligned_alloc(CACHE_LINE_SIZE, size);
+    cache->hands   = calloc(sets, sizeof(*cache->hands));
+    if (NULL == cache->entries || NULL == cache->hands)
+    {
+        calc_cache_destroy(cache);
+        return NULL;
+    }
+    memset(cache->entries, 0, size);
+    cache->set_mask = sets - 1;
+    return cache;
+}
+
+/******************************************************************************
+ * @brief    Release a cache
+ * @param    cache   Cache, may be NULL
+ ******************************************************************************/
+void calc_cache_destroy(calc_cache * cache)
+{
+    if (NULL != cache)
+    {
+        free(cache->entries);
+        free(cache->hands);
+    }
+    free(cache);
+}
+
+/******************************************************************************
+ * @brief    Set a key belongs to
+ ******************************************************************************/
+static size_t cache_set(const calc_cache * cache,
+                        calc_op            op,
+                        uint32_t           operand1,
+                        uint32_t           operand2)
+{
+    uint64_t key = ((uint64_t)operand1 << 32) | operand2;
+
+    // Mix the opcode in, then finalise as MurmurHash3 does
+    key ^= (uint64_t)op * 0x9E3779B97F4A7C15u;
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDu;
+    key ^= key >> 33;
+    return (size_t)key & cache->set_mask;
+}
+
+/******************************************************************************
+ * @brief    Look a calculation up
+ * @param    cache       Cache
+ * @param    op          Decoded operator
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @param    length      Set to the length of the cached line on a hit
+ * @param    status      Set to the cached status on a hit
+ * @return   Cached line, valid until the next insertion, or NULL on a miss
+ ******************************************************************************/
+const char * calc_cache_lookup(calc_cache *  cache,
+                               calc_op       op,
+                               uint32_t      operand1,
+                               uint32_t      operand2,
+                               size_t *      length,
+                               calc_status * status)
+{
+    cache_entry * set =
+        &cache->entries[cache_set(cache, op, operand1, operand2) * CACHE_WAYS];
+
+    // Unsupported operators are never cached, and would match empty entries
+    for (unsigned way = 0; CALC_OP_INVALID != op && way < CACHE_WAYS; way++)
+    {
+        cache_entry * entry = &set[way];
+        if (op == entry->op && operand1 == entry->operand1 &&
+            operand2 == entry->operand2)
+        {
+            entry->referenced = 1;
+            *length           = entry->length;
+            *status           = (calc_status)entry->status;
+            cache->stats.hits++;
+            return entry->text;
+        }
+    }
+    cache->stats.misses++;
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Remember the formatted line of a calculation
+ * @param    cache       Cache
+ * @param    op          Decoded operator; CALC_OP_INVALID is not cached
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @param    status      Status of the calculation
+ * @param    text        Formatted line
+ * @param    length      Length of text; longer lines than fit are not cached
+ ******************************************************************************/
+void calc_cache_insert(calc_cache * cache,
+                       calc_op      op,
+                       uint32_t     operand1,
+                       uint32_t     operand2,
+                       calc_status  status,
+                       const char * text,
+                       size_t       length)
+{
+    if (CALC_OP_INVALID == op || length > CACHE_TEXT_MAX)
+    {
+        return;
+    }
+
+    size_t        index = cache_set(cache, op, operand1, operand2);
+    cache_entry * set   = &cache->entries[index * CACHE_WAYS];
+    cache_entry * entry = NULL;
+
+    for (unsigned way = 0; NULL == entry && way < CACHE_WAYS; way++)
+    {
+        if (CALC_OP_INVALID == set[way].op)
+        {
+            entry = &set[way];
+        }
+    }
+    // A full set: give every entry referenced since the last pass a second
+    // chance; after one turn of the hand, every bit is clear
+    while (NULL == entry)
+    {
+        cache_entry * candidate = &set[cache->hands[index]];
+        cache->hands[index]     = (cache->hands[index] + 1) % CACHE_WAYS;
+        if (candidate->referenced)
+        {
+            candidate->referenced = 0;
+        }
+        else
+        {
+            entry = candidate;
+            cache->stats.evictions++;
+        }
+    }
+
+    entry->operand1   = operand1;
+    entry->operand2   = operand2;
+    entry->op         = (uint8_t)op;
+    entry->status     = (uint8_t)status;
+    entry->length     = (uint8_t)length;
+    entry->referenced = 0;
+    memcpy(entry->text, text, length);
+}
+
+/******************************************************************************
+ * @brief    Add a cache's hit, miss and eviction counts to stats
+ ******************************************************************************/
+void calc_cache_add_stats(const calc_cache * cache, calc_cache_stats * stats)
+{
+    stats->hits += cache->stats.hits;
+    stats->misses += cache->stats.misses;
+    stats->evictions += cache->stats.evictions;
+}
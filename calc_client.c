@@ -0,0 +1,678 @@
+/******************************************************************************
+ * @file    calc_client.c
+ * @brief   Non-blocking client for the calculation server
+ * @version 1.6
+ * @date    October 2026
+ *
+ * A client is one connection to a server (see calc_server.c) that any
+ * number of requests share. Nothing blocks but the connect: submitting a
+ * request queues its batch line, and the caller's event loop drives the
+ * rest through calc_client_process once the descriptor is ready, or
+ * calc_client_wait polls it for callers that have no loop.
+ *
+ * The server answers the requests of a connection in order, so none of
+ * them carries its id on the wire: each answer belongs to the oldest
+ * request in flight. Answers go to the callback a request was submitted
+ * with, or else wait for calc_client_next.
+ *
+ * Small requests are coalesced: lines collect in the output buffer and go
+ * out once CLIENT_COALESCE bytes are waiting, or when the loop turns (a
+ * flush, process or wait), so a burst of submissions costs one write and
+ * one segment. The socket has Nagle's algorithm off, as the client does
+ * its own coalescing and a flushed segment should not wait for an ACK.
+ *
+ * Callbacks only run inside calc_client_process, calc_client_wait and
+ * calc_client_destroy, never inside a submission. They may submit more
+ * requests, which go out at the end of the same turn, but must not
+ * process, wait on or destroy the client themselves.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_net.h"
+
+#define CLIENT_COALESCE    (16 * 1024)   // Unsent bytes sent without a flush
+#define CLIENT_OUTPUT_MAX  (1024 * 1024) // Unsent bytes before BUSY
+#define CLIENT_READ_SIZE   (64 * 1024)
+#define CLIENT_RING_SIZE   64            // Initial slots of a ring
+#define CLIENT_LINE_MAX    32            // "4294967295 <<< 4294967295\n"
+#define QUOTIENT_WHOLE_MAX 10            // Digits before the point
+
+/******************************************************************************
+ * @brief    Request in flight
+ ******************************************************************************/
+typedef struct
+{
+    uint64_t             id;
+    calc_op              op;
+    calc_client_callback callback; // NULL to leave the answer for polling
+    void *               context;
+} client_request;
+
+/******************************************************************************
+ * @brief    Ring of fixed-size slots, oldest first; capacity is a power of
+ *           two
+ ******************************************************************************/
+typedef struct
+{
+    unsigned char * slots;
+    size_t          first;
+    size_t          used;
+    size_t          capacity;
+} client_ring;
+
+struct calc_client
+{
+    int         fd;
+    int         broken;    // Set once the connection is unusable
+    uint64_t    next_id;
+    client_ring flight;    // client_request, sent or waiting to be
+    client_ring ready;     // calc_client_answer, waiting for polling
+    size_t      unclaimed; // Requests in flight with no callback
+    calc_buffer output;    // Lines not yet written
+    size_t      sent;      // Bytes of output already written
+    calc_buffer input;     // Answers not yet whole
+};
+
+// Symbol of each operator as a batch line spells it, by opcode
+static const char * const symbols[CALC_OP_COUNT] = {
+    NULL, "+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^", "<<<", ">>>",
+};
+
+static const char result_prefix[] = "Result: ";
+
+/******************************************************************************
+ * @brief    Make room in a ring for more slots
+ * @param    ring    Ring to grow; its slots are moved to the start
+ * @param    needed  Slots to add to those in use
+ * @param    size    Bytes of a slot
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int ring_reserve(client_ring * ring, size_t needed, size_t size)
+{
+    size_t          capacity = ring->capacity;
+    unsigned char * grown;
+
+    if (needed <= capacity - ring->used)
+    {
+        return 1;
+    }
+    if (0 == capacity)
+    {
+        capacity = CLIENT_RING_SIZE;
+    }
+    while (needed > capacity - ring->used)
+    {
+        if (capacity > (SIZE_MAX / 2) / size)
+        {
+            return 0;
+        }
+        capacity *= 2;
+    }
+    grown = malloc(capacity * size);
+    if (NULL == grown)
+    {
+        return 0;
+    }
+    if (0 != ring->used)
+    {
+        size_t head = ring->capacity - ring->first;
+        if (head > ring->used)
+        {
+            head = ring->used;
+        }
+        memcpy(grown, ring->slots + (ring->first * size), head * size);
+        memcpy(grown + (head * size), ring->slots, (ring->used - head) * size);
+    }
+    free(ring->slots);
+    ring->slots    = grown;
+    ring->first    = 0;
+    ring->capacity = capacity;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Slot of a ring, counted from the oldest
+ ******************************************************************************/
+static void * ring_at(const client_ring * ring, size_t index, size_t size)
+{
+    size_t slot = (ring->first + index) & (ring->capacity - 1);
+    return ring->slots + (slot * size);
+}
+
+/******************************************************************************
+ * @brief    Drop the oldest slot of a ring
+ ******************************************************************************/
+static void ring_pop(client_ring * ring)
+{
+    ring->first = (ring->first + 1) & (ring->capacity - 1);
+    ring->used--;
+}
+
+/******************************************************************************
+ * @brief    Parse a quotient as "%.2f" prints it
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+static int parse_quotient(const char * text, size_t length, double * value)
+{
+    int      negative = (0 != length && '-' == text[0]);
+    size_t   point    = length - 3; // Where the '.' must be
+    uint64_t whole    = 0;
+    unsigned hundredths;
+
+    if (length < (size_t)negative + 4 || '.' != text[point] ||
+        point - (size_t)negative > QUOTIENT_WHOLE_MAX)
+    {
+        return 0;
+    }
+    for (size_t i = (size_t)negative; i < length; i++)
+    {
+        if (i != point && (unsigned)(text[i] - '0') > 9)
+        {
+            return 0;
+        }
+    }
+    for (size_t i = (size_t)negative; i < point; i++)
+    {
+        whole = (whole * 10) + (uint64_t)(text[i] - '0');
+    }
+    hundredths = (unsigned)(((text[point + 1] - '0') * 10) +
+                            (text[point + 2] - '0'));
+    *value     = (double)whole + ((double)hundredths / 100.0);
+    if (negative)
+    {
+        *value = -*value;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Parse the answer line to a request
+ * @param    op      Operator of the request
+ * @param    line    Answer, without its newline
+ * @param    length  Bytes of the answer
+ * @param    result  Set to the result or error the line reports
+ * @return   1 if the line is an answer, 0 otherwise
+ ******************************************************************************/
+static int parse_answer(calc_op       op,
+                        const char *  line,
+                        size_t        length,
+                        calc_result * result)
+{
+    size_t prefix = sizeof(result_prefix) - 1;
+
+    memset(result, 0, sizeof(*result));
+    result->status = CALC_OK;
+    result->kind   = calc_op_kind(op);
+    if (length > prefix && 0 == memcmp(line, result_prefix, prefix))
+    {
+        if (CALC_KIND_DOUBLE == result->kind)
+        {
+            return parse_quotient(
+                line + prefix, length - prefix, &result->value.as_double);
+        }
+        // Signed results read back as their two's complement bits
+        return calc_parse_uint32(
+            line + prefix, length - prefix, &result->value.as_uint);
+    }
+    for (int status = CALC_OK + 1; status < CALC_STATUS_COUNT; status++)
+    {
+        const char * message = calc_status_message((calc_status)status);
+        if (strlen(message) == length && 0 == memcmp(line, message, length))
+        {
+            result->status = (calc_status)status;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Complete the oldest request in flight
+ * @param    client  Client with a request in flight
+ * @param    status  CALC_CLIENT_OK if the server answered it
+ * @param    result  The answer, or NULL
+ ******************************************************************************/
+static void complete(calc_client *       client,
+                     calc_client_status  status,
+                     const calc_result * result)
+{
+    client_request     request;
+    calc_client_answer answer;
+
+    memcpy(&request,
+           ring_at(&client->flight, 0, sizeof(request)),
+           sizeof(request));
+    ring_pop(&client->flight);
+
+    memset(&answer, 0, sizeof(answer));
+    answer.id     = request.id;
+    answer.status = status;
+    if (NULL != result)
+    {
+        answer.result = *result;
+    }
+    if (NULL != request.callback)
+    {
+        request.callback(request.context, &answer);
+        return;
+    }
+
+    // Room was reserved when the request was submitted
+    client->unclaimed--;
+    memcpy(ring_at(&client->ready, client->ready.used, sizeof(answer)),
+           &answer,
+           sizeof(answer));
+    client->ready.used++;
+}
+
+/******************************************************************************
+ * @brief    Fail every request in flight, once the connection is unusable
+ ******************************************************************************/
+static void fail_all(calc_client * client)
+{
+    client->output.used = 0;
+    client->sent        = 0;
+    while (0 != client->flight.used)
+    {
+        complete(client, CALC_CLIENT_DISCONNECTED, NULL);
+    }
+}
+
+/******************************************************************************
+ * @brief    Write as much of the queued lines as the socket takes
+ ******************************************************************************/
+static void write_output(calc_client * client)
+{
+    while (!client->broken && client->sent < client->output.used)
+    {
+        ssize_t count = send(client->fd,
+                             client->output.data + client->sent,
+                             client->output.used - client->sent,
+                             MSG_NOSIGNAL);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                client->broken = 1;
+            }
+            break;
+        }
+        client->sent += (size_t)count;
+    }
+
+    // Keep only the unsent tail, so the buffer does not creep
+    if (0 != client->sent)
+    {
+        size_t left = client->output.used - client->sent;
+        memmove(client->output.data, client->output.data + client->sent, left);
+        client->output.used = left;
+        client->sent        = 0;
+    }
+}
+
+/******************************************************************************
+ * @brief    Complete a request for every whole answer line received
+ ******************************************************************************/
+static void take_answers(calc_client * client)
+{
+    const char * data     = client->input.data;
+    size_t       position = 0;
+    size_t       end      = client->input.used;
+
+    while (!client->broken && position < end)
+    {
+        const char *           at      = data + position;
+        const char *           newline = memchr(at, '\n', end - position);
+        const client_request * request;
+        calc_result            result;
+
+        if (NULL == newline)
+        {
+            // No answer is that long
+            client->broken = (end - position > CALC_FORMAT_MAX);
+            break;
+        }
+        if (0 == client->flight.used)
+        {
+            client->broken = 1; // An answer to nothing
+            break;
+        }
+        request = ring_at(&client->flight, 0, sizeof(*request));
+        if (!parse_answer(request->op, at, (size_t)(newline - at), &result))
+        {
+            client->broken = 1;
+            break;
+        }
+        position = (size_t)(newline - data) + 1;
+        complete(client, CALC_CLIENT_OK, &result);
+    }
+
+    size_t left = end - position;
+    if (0 != left && 0 != position)
+    {
+        memmove(client->input.data, data + position, left);
+    }
+    client->input.used = left;
+}
+
+/******************************************************************************
+ * @brief    Read and complete every answer the socket holds
+ ******************************************************************************/
+static void read_answers(calc_client * client)
+{
+    while (!client->broken)
+    {
+        ssize_t count;
+
+        if (!calc_buffer_reserve(&client->input, CLIENT_READ_SIZE))
+        {
+            client->broken = 1;
+            break;
+        }
+        count = recv(client->fd,
+                     client->input.data + client->input.used,
+                     client->input.capacity - client->input.used,
+                     0);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+            {
+                client->broken = 1;
+            }
+            break;
+        }
+        if (0 == count)
+        {
+            client->broken = 1; // The server closed the connection
+            break;
+        }
+        client->input.used += (size_t)count;
+        take_answers(client);
+    }
+}
+
+/******************************************************************************
+ * @brief    Connect to a server
+ * @param    address Socket path (anything with a '/'), "port", "host:port"
+ *                   or "[ipv6 host]:port"
+ * @param    client  Set to the new client, or NULL on failure
+ * @return   CALC_CLIENT_OK, or why the client could not be created
+ * @note     The connect itself blocks; everything after it does not.
+ ******************************************************************************/
+calc_client_status calc_client_connect(const char *   address,
+                                       calc_client ** client)
+{
+    calc_client * created = calloc(1, sizeof(*created));
+
+    *client = NULL;
+    if (NULL == created)
+    {
+        return CALC_CLIENT_NO_MEMORY;
+    }
+    created->fd = calc_net_connect(address);
+    if (created->fd < 0)
+    {
+        free(created);
+        return CALC_CLIENT_ADDRESS_ERROR;
+    }
+    created->next_id = 1;
+    *client          = created;
+    return CALC_CLIENT_OK;
+}
+
+/******************************************************************************
+ * @brief    Close a client; requests still in flight complete with
+ *           CALC_CLIENT_DISCONNECTED first
+ ******************************************************************************/
+void calc_client_destroy(calc_client * client)
+{
+    if (NULL == client)
+    {
+        return;
+    }
+    client->broken = 1;
+    fail_all(client);
+    close(client->fd);
+    free(client->flight.slots);
+    free(client->ready.slots);
+    calc_buffer_free(&client->output);
+    calc_buffer_free(&client->input);
+    free(client);
+}
+
+/******************************************************************************
+ * @brief    Descriptor to watch for reading, and for writing while
+ *           calc_client_writing says so
+ ******************************************************************************/
+int calc_client_fd(const calc_client * client)
+{
+    return client->fd;
+}
+
+/******************************************************************************
+ * @brief    Whether queued requests are waiting for the socket to take them
+ ******************************************************************************/
+int calc_client_writing(const calc_client * client)
+{
+    return !client->broken && client->sent < client->output.used;
+}
+
+/******************************************************************************
+ * @brief    Requests submitted and not yet completed
+ ******************************************************************************/
+size_t calc_client_in_flight(const calc_client * client)
+{
+    return client->flight.used;
+}
+
+/******************************************************************************
+ * @brief    Submit one request
+ * @param    client      Client
+ * @param    op          Operator
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @param    callback    Called with the answer, or NULL to leave it for
+ *                       calc_client_next
+ * @param    context     Passed to the callback
+ * @param    id          Set to the request's id; may be NULL
+ * @return   CALC_CLIENT_OK if the request was queued, or why it was not
+ * @note     A queued request always completes, if only when the
+ *           connection fails.
+ ******************************************************************************/
+calc_client_status calc_client_submit(calc_client *        client,
+                                      calc_op              op,
+                                      uint32_t             operand1,
+                                      uint32_t             operand2,
+                                      calc_client_callback callback,
+                                      void *               context,
+                                      uint64_t *           id)
+{
+    return calc_client_submit_batch(
+        client, op, &operand1, &operand2, 1, callback, context, id);
+}
+
+/******************************************************************************
+ * @brief    Submit one request per pair of operands, all with one operator
+ * @param    client      Client
+ * @param    op          Operator
+ * @param    operand1    count first operands
+ * @param    operand2    count second operands
+ * @param    count       Number of requests
+ * @param    callback    Called with each answer, or NULL to leave them for
+ *                       calc_client_next
+ * @param    context     Passed to the callback
+ * @param    first_id    Set to the id of the first request, the others
+ *                       following it; may be NULL
+ * @return   CALC_CLIENT_OK if every request was queued, or why none was
+ ******************************************************************************/
+calc_client_status calc_client_submit_batch(calc_client *        client,
+                                            calc_op              op,
+                                            const uint32_t *     operand1,
+                                            const uint32_t *     operand2,
+                                            size_t               count,
+                                            calc_client_callback callback,
+                                            void *               context,
+                                            uint64_t *           first_id)
+{
+    const char * symbol;
+    size_t       symbol_length;
+
+    if (client->broken)
+    {
+        return CALC_CLIENT_DISCONNECTED;
+    }
+    if (op <= CALC_OP_INVALID || op >= CALC_OP_COUNT)
+    {
+        return CALC_CLIENT_BAD_REQUEST;
+    }
+    if (client->output.used - client->sent > CLIENT_OUTPUT_MAX)
+    {
+        return CALC_CLIENT_BUSY;
+    }
+    if (count > SIZE_MAX / CLIENT_LINE_MAX ||
+        !ring_reserve(&client->flight, count, sizeof(client_request)) ||
+        (NULL == callback &&
+         !ring_reserve(&client->ready,
+                       client->unclaimed + count,
+                       sizeof(calc_client_answer))) ||
+        !calc_buffer_reserve(&client->output, count * CLIENT_LINE_MAX))
+    {
+        return CALC_CLIENT_NO_MEMORY;
+    }
+
+    if (NULL != first_id)
+    {
+        *first_id = client->next_id;
+    }
+    symbol        = symbols[op];
+    symbol_length = strlen(symbol);
+    for (size_t i = 0; i < count; i++)
+    {
+        char *         line = client->output.data + client->output.used;
+        client_request request;
+
+        line += calc_format_uint32(line, operand1[i]);
+        *line++ = ' ';
+        memcpy(line, symbol, symbol_length);
+        line += symbol_length;
+        *line++ = ' ';
+        line += calc_format_uint32(line, operand2[i]);
+        *line++ = '\n';
+        client->output.used = (size_t)(line - client->output.data);
+
+        memset(&request, 0, sizeof(request));
+        request.id       = client->next_id++;
+        request.op       = op;
+        request.callback = callback;
+        request.context  = context;
+        memcpy(ring_at(&client->flight, client->flight.used, sizeof(request)),
+               &request,
+               sizeof(request));
+        client->flight.used++;
+    }
+    if (NULL == callback)
+    {
+        client->unclaimed += count;
+    }
+
+    // Small requests wait for the loop to turn; a full segment need not
+    if (client->output.used - client->sent >= CLIENT_COALESCE)
+    {
+        write_output(client);
+    }
+    return CALC_CLIENT_OK;
+}
+
+/******************************************************************************
+ * @brief    Write the queued requests, as far as the socket takes them
+ * @return   CALC_CLIENT_OK, or CALC_CLIENT_DISCONNECTED once the connection
+ *           has failed
+ ******************************************************************************/
+calc_client_status calc_client_flush(calc_client * client)
+{
+    write_output(client);
+    return client->broken ? CALC_CLIENT_DISCONNECTED : CALC_CLIENT_OK;
+}
+
+/******************************************************************************
+ * @brief    Write queued requests and complete answered ones, without
+ *           blocking
+ * @return   CALC_CLIENT_OK, or CALC_CLIENT_DISCONNECTED once the connection
+ *           has failed, every request in flight having completed with it
+ * @note     Call when the descriptor is readable or writable, or at the end
+ *           of each turn of the loop.
+ ******************************************************************************/
+calc_client_status calc_client_process(calc_client * client)
+{
+    write_output(client);
+    read_answers(client);
+    write_output(client); // What the callbacks submitted
+    if (client->broken)
+    {
+        fail_all(client);
+        return CALC_CLIENT_DISCONNECTED;
+    }
+    return CALC_CLIENT_OK;
+}
+
+/******************************************************************************
+ * @brief    Wait for answers, for callers without an event loop
+ * @param    client      Client
+ * @param    timeout_ms  Longest wait, or -1 for no limit
+ * @return   As calc_client_process
+ * @note     Returns at once if nothing is in flight.
+ ******************************************************************************/
+calc_client_status calc_client_wait(calc_client * client, int timeout_ms)
+{
+    struct pollfd poller;
+
+    write_output(client);
+    if (!client->broken && 0 != client->flight.used)
+    {
+        memset(&poller, 0, sizeof(poller));
+        poller.fd     = client->fd;
+        poller.events = POLLIN;
+        if (calc_client_writing(client))
+        {
+            poller.events |= POLLOUT;
+        }
+        if (poll(&poller, 1, timeout_ms) < 0 && EINTR != errno)
+        {
+            client->broken = 1;
+        }
+    }
+    return calc_client_process(client);
+}
+
+/******************************************************************************
+ * @brief    Take the oldest answer to a request submitted without a callback
+ * @return   1 if answer was set, 0 if none is waiting
+ ******************************************************************************/
+int calc_client_next(calc_client * client, calc_client_answer * answer)
+{
+    if (0 == client->ready.used)
+    {
+        return 0;
+    }
+    memcpy(answer,
+           ring_at(&client->ready, 0, sizeof(*answer)),
+           sizeof(*answer));
+    ring_pop(&client->ready);
+    return 1;
+}
@@ -0,0 +1,280 @@
+/******************************************************************************
+ * @file    calc_client.hpp
+ * @brief   C++20 coroutine interface to the calculation client
+ * @version 1.6
+ * @date    October 2026
+ *
+ * calc::client owns a calc_client, and eval returns an awaitable, so that
+ *
+ *     calc_client_answer answer = co_await client.eval("+", 3, 4);
+ *
+ * submits one request and suspends the coroutine until it is answered.
+ * Any number of coroutines may be suspended on one client. They resume
+ * inside process() or wait(), which the event loop calls as it would
+ * calc_client_process, on the thread that calls them; destroying the
+ * client resumes those still suspended with CALC_CLIENT_DISCONNECTED. A
+ * request that cannot be submitted resumes at once with the reason.
+ *
+ * Answers are only queued while calc_client_process runs, and their
+ * coroutines resumed once it has returned, so a resumed coroutine may
+ * submit, process, wait on or destroy the client. A client must not be
+ * moved while coroutines are suspended on it.
+ *
+ * The header needs only calc.h and <coroutine>. It brings no task type:
+ * the awaitable works in the coroutines of any runtime.
+ ******************************************************************************/
+
+#ifndef CALC_CLIENT_HPP
+#define CALC_CLIENT_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include "calc.h"
+
+namespace calc
+{
+
+/******************************************************************************
+ * @brief    Connection to a server shared by suspended coroutines
+ ******************************************************************************/
+class client
+{
+public:
+    /**************************************************************************
+     * @brief    One request; co_await yields its calc_client_answer
+     **************************************************************************/
+    class request
+    {
+    public:
+        request(client * owner,
+                calc_op  op,
+                uint32_t operand1,
+                uint32_t operand2) noexcept
+            : owner_(owner), op_(op), operand1_(operand1),
+              operand2_(operand2)
+        {
+            std::memset(&answer_, 0, sizeof(answer_));
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        // Suspends only if the request was queued
+        bool await_suspend(std::coroutine_handle<> waiter) noexcept
+        {
+            waiter_ = waiter;
+            answer_.status =
+                (nullptr == owner_->handle_)
+                    ? CALC_CLIENT_DISCONNECTED
+                    : calc_client_submit(owner_->handle_,
+                                         op_,
+                                         operand1_,
+                                         operand2_,
+                                         &request::complete,
+                                         this,
+                                         &answer_.id);
+            return CALC_CLIENT_OK == answer_.status;
+        }
+
+        calc_client_answer await_resume() const noexcept
+        {
+            return answer_;
+        }
+
+    private:
+        friend class client;
+
+        // Queued in answer order, to be resumed after the callbacks
+        static void complete(void *                     context,
+                             const calc_client_answer * answer) noexcept
+        {
+            request * self = static_cast<request *>(context);
+
+            self->answer_ = *answer;
+            self->next_   = nullptr;
+            *self->owner_->ready_tail_ = self;
+            self->owner_->ready_tail_  = &self->next_;
+        }
+
+        client *                owner_;
+        calc_op                 op_;
+        uint32_t                operand1_;
+        uint32_t                operand2_;
+        calc_client_answer      answer_;
+        std::coroutine_handle<> waiter_;
+        request *               next_ = nullptr;
+    };
+
+    // Connects at once; status() tells whether it succeeded
+    explicit client(const char * address) noexcept
+        : status_(calc_client_connect(address, &handle_))
+    {
+    }
+
+    client(client && other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)),
+          status_(std::exchange(other.status_, CALC_CLIENT_DISCONNECTED))
+    {
+    }
+
+    client & operator=(client && other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            handle_ = std::exchange(other.handle_, nullptr);
+            status_ = std::exchange(other.status_, CALC_CLIENT_DISCONNECTED);
+        }
+        return *this;
+    }
+
+    client(const client &)             = delete;
+    client & operator=(const client &) = delete;
+
+    ~client()
+    {
+        close();
+    }
+
+    // CALC_CLIENT_OK once connected, until a call reports otherwise
+    calc_client_status status() const noexcept
+    {
+        return status_;
+    }
+
+    request eval(calc_op op, uint32_t operand1, uint32_t operand2) noexcept
+    {
+        return request(this, op, operand1, operand2);
+    }
+
+    // An operator as a batch line spells it, such as "+" or "<<<"
+    request eval(const char * symbol,
+                 uint32_t     operand1,
+                 uint32_t     operand2) noexcept
+    {
+        return request(this, calc_parse_operator(symbol), operand1, operand2);
+    }
+
+    // Resumes the coroutines whose answers have arrived
+    calc_client_status process() noexcept
+    {
+        calc_client_status status = track(
+            (nullptr == handle_) ? CALC_CLIENT_DISCONNECTED
+                                 : calc_client_process(handle_));
+
+        resume_ready();
+        return status;
+    }
+
+    // process(), after waiting up to timeout_ms for an answer
+    calc_client_status wait(int timeout_ms) noexcept
+    {
+        calc_client_status status =
+            track((nullptr == handle_)
+                      ? CALC_CLIENT_DISCONNECTED
+                      : calc_client_wait(handle_, timeout_ms));
+
+        resume_ready();
+        return status;
+    }
+
+    calc_client_status flush() noexcept
+    {
+        return track((nullptr == handle_) ? CALC_CLIENT_DISCONNECTED
+                                          : calc_client_flush(handle_));
+    }
+
+    // Watch for reading, and for writing while writing() is true
+    int fd() const noexcept
+    {
+        return (nullptr == handle_) ? -1 : calc_client_fd(handle_);
+    }
+
+    bool writing() const noexcept
+    {
+        return nullptr != handle_ && 0 != calc_client_writing(handle_);
+    }
+
+    std::size_t in_flight() const noexcept
+    {
+        return (nullptr == handle_) ? 0 : calc_client_in_flight(handle_);
+    }
+
+    calc_client * native_handle() const noexcept
+    {
+        return handle_;
+    }
+
+private:
+    calc_client_status track(calc_client_status status) noexcept
+    {
+        if (CALC_CLIENT_OK != status)
+        {
+            status_ = status;
+        }
+        return status;
+    }
+
+    // Resume the answered coroutines in order, stopping should one of them
+    // destroy the client; a nested call resumes those queued after it
+    void resume_ready() noexcept
+    {
+        bool   alive = true;
+        bool * outer = std::exchange(alive_, &alive);
+
+        while (alive && nullptr != ready_)
+        {
+            request * next = ready_;
+
+            ready_ = next->next_;
+            if (nullptr == ready_)
+            {
+                ready_tail_ = &ready_;
+            }
+            next->waiter_.resume(); // May free next, and this
+        }
+        if (alive)
+        {
+            alive_ = outer;
+        }
+        else if (nullptr != outer)
+        {
+            *outer = false;
+        }
+    }
+
+    // Fail what is in flight and resume it, once the client is gone
+    void close() noexcept
+    {
+        calc_client_destroy(std::exchange(handle_, nullptr));
+        if (nullptr != alive_)
+        {
+            *std::exchange(alive_, nullptr) = false;
+        }
+
+        request * ready = std::exchange(ready_, nullptr);
+        ready_tail_     = &ready_;
+        while (nullptr != ready)
+        {
+            request * next = ready;
+
+            ready = next->next_;
+            next->waiter_.resume();
+        }
+    }
+
+    calc_client *      handle_ = nullptr;
+    calc_client_status status_;
+    request *          ready_      = nullptr;  // Answered, not yet resumed
+    request **         ready_tail_ = &ready_;
+    bool *             alive_      = nullptr; // Innermost resume_ready's
+};
+
+} // namespace calc
+
+#endif // CALC_CLIENT_HPP
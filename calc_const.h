@@ -0,0 +1,231 @@
+/******************************************************************************
+ * @file    calc_const.h
+ * @brief   Operator kernels for a second operand shared by every lane
+ *          (internal)
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Dividing by the same value over and over is cheaper as a multiply: a
+ * calc_divisor holds the magic multiplier and shift of Granlund and
+ * Montgomery (Hacker's Delight, 10-1), found once per divisor, which turn
+ * n / d into a high multiply, an add, two shifts and an add of the sign.
+ *
+ * CALC_CONST_KERNEL stamps out one loop per operator with its second
+ * operand hoisted out of it, so shifts and rotates take one count for the
+ * whole array. A kernel called with a literal operand is inlined with it,
+ * and the compiler then folds the constant into immediates and picks its
+ * own multiply for %; the magic divisor only stands in for a divisor known
+ * at run time. Like calc_apply, a kernel sets one error mask bit per
+ * failed lane, and expects the mask cleared (or NULL); the bits are found
+ * only after a lane has failed.
+ ******************************************************************************/
+
+#ifndef CALC_CONST_H
+#define CALC_CONST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "calc.h"
+#include "calc_width.h"
+
+/******************************************************************************
+ * @brief    Divisor prepared for division by multiplication; valid for any
+ *           divisor other than 0, 1 and -1, which kernels handle apart
+ ******************************************************************************/
+typedef struct
+{
+    int32_t  divisor;
+    int32_t  magic;
+    int32_t  add;   // -1, 0 or 1 times the dividend, added to the product
+    unsigned shift; // Arithmetic shift of the corrected product
+} calc_divisor;
+
+/******************************************************************************
+ * @brief    Find the magic number of a divisor
+ * @param    divisor     Any divisor but 0, 1 and -1
+ * @return   Prepared divisor
+ ******************************************************************************/
+static inline calc_divisor calc_divisor_init(int32_t divisor)
+{
+    const uint32_t two31 = UINT32_C(1) << 31;
+    uint32_t       ad    = (divisor < 0) ? 0u - (uint32_t)divisor
+                                         : (uint32_t)divisor;
+    uint32_t       t     = two31 + ((uint32_t)divisor >> 31);
+    uint32_t       anc   = t - 1 - (t % ad); // |nc|, the largest multiple
+    uint32_t       q1    = two31 / anc;
+    uint32_t       r1    = two31 - (q1 * anc);
+    uint32_t       q2    = two31 / ad;
+    uint32_t       r2    = two31 - (q2 * ad);
+    uint32_t       delta;
+    unsigned       p     = 31;
+    calc_divisor   prepared;
+
+    // Smallest p for which 2^p / |nc| exceeds the distance to the multiple
+    do
+    {
+        p++;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc)
+        {
+            q1++;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad)
+        {
+            q2++;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && 0 == r1));
+
+    uint32_t magic   = q2 + 1;
+    prepared.divisor = divisor;
+    prepared.magic   = (int32_t)((divisor < 0) ? 0u - magic : magic);
+    prepared.shift   = p - 32;
+    prepared.add     = 0;
+    if (divisor > 0 && prepared.magic < 0)
+    {
+        prepared.add = 1;
+    }
+    else if (divisor < 0 && prepared.magic > 0)
+    {
+        prepared.add = -1;
+    }
+    return prepared;
+}
+
+/******************************************************************************
+ * @brief    Quotient truncated toward zero, as the / operator gives it
+ ******************************************************************************/
+static inline int32_t calc_divisor_quotient(const calc_divisor * divisor,
+                                            int32_t              dividend)
+{
+    int64_t product = (int64_t)dividend * divisor->magic;
+    int32_t high    = (int32_t)(product >> 32);
+    int32_t q       = (int32_t)((uint32_t)high +
+                                ((uint32_t)dividend * (uint32_t)divisor->add));
+
+    q >>= divisor->shift;
+    return (int32_t)((uint32_t)q + ((uint32_t)q >> 31));
+}
+
+/******************************************************************************
+ * @brief    Remainder with the sign of the dividend, as % gives it
+ ******************************************************************************/
+static inline int32_t calc_divisor_remainder(const calc_divisor * divisor,
+                                             int32_t              dividend)
+{
+    int32_t q = calc_divisor_quotient(divisor, dividend);
+    return (int32_t)((uint32_t)dividend -
+                     ((uint32_t)q * (uint32_t)divisor->divisor));
+}
+
+// Kernels are always inlined, so a literal operand reaches the loop
+#define CALC_CONST_INLINE static inline __attribute__((always_inline))
+
+// One kernel of an operator: COMPUTE sets value from x and operand2, and
+// sets fails when the lane has failed. Lanes run without a branch on
+// fails; only once one has failed is the array walked again for the mask
+#define CALC_CONST_KERNEL(name, COMPUTE)                                   \
+    CALC_CONST_INLINE int const_##name##_32(const uint32_t * operand1,     \
+                                            uint32_t         operand2,     \
+                                            uint32_t *       result,       \
+                                            uint8_t *        error_mask,   \
+                                            size_t           count)        \
+    {                                                                      \
+        int failed = 0;                                                    \
+                                                                           \
+        for (size_t i = 0; i < count; i++)                                 \
+        {                                                                  \
+            uint32_t x     = operand1[i];                                  \
+            uint32_t value = 0;                                            \
+            int      fails = 0;                                            \
+            COMPUTE;                                                       \
+            result[i] = value;                                             \
+            failed |= fails;                                               \
+        }                                                                  \
+        for (size_t i = 0; failed && NULL != error_mask && i < count; i++) \
+        {                                                                  \
+            uint32_t x     = operand1[i];                                  \
+            uint32_t value = 0;                                            \
+            int      fails = 0;                                            \
+            COMPUTE;                                                       \
+            (void)value;                                                   \
+            error_mask[i / 8] |= (uint8_t)((unsigned)fails << (i % 8));    \
+        }                                                                  \
+        return failed;                                                     \
+    }
+
+// Checked operators keep the wrapped value on overflow; the lane is
+// flagged, so its result is unspecified either way
+#define CALC_CONST_CHECKED(builtin)                                        \
+    {                                                                      \
+        int32_t wrapped;                                                   \
+        fails = builtin((int32_t)x, (int32_t)operand2, &wrapped);          \
+        value = (uint32_t)wrapped;                                         \
+    }
+
+CALC_CONST_KERNEL(add, CALC_CONST_CHECKED(__builtin_add_overflow))
+CALC_CONST_KERNEL(sub, CALC_CONST_CHECKED(__builtin_sub_overflow))
+CALC_CONST_KERNEL(mul, CALC_CONST_CHECKED(__builtin_mul_overflow))
+CALC_CONST_KERNEL(and, value = x & operand2)
+CALC_CONST_KERNEL(or, value = x | operand2)
+CALC_CONST_KERNEL(xor, value = x ^ operand2)
+
+// The range checks are loop invariant, so every lane takes the same path
+CALC_CONST_KERNEL(shl, value = width_shl_32(x, operand2))
+CALC_CONST_KERNEL(shr, value = width_shr_32(x, operand2))
+CALC_CONST_KERNEL(rol, value = width_rol_32(x, operand2))
+CALC_CONST_KERNEL(ror, value = width_ror_32(x, operand2))
+
+/******************************************************************************
+ * @brief    Remainders by one divisor: with a literal divisor inline, the
+ *           compiler's own multiply; otherwise the magic divisor
+ * @return   1 if any lane failed (the divisor is 0), 0 otherwise
+ ******************************************************************************/
+CALC_CONST_INLINE int const_mod_32(const uint32_t * operand1,
+                                   uint32_t         operand2,
+                                   uint32_t *       result,
+                                   uint8_t *        error_mask,
+                                   size_t           count)
+{
+    int32_t divisor = (int32_t)operand2;
+
+    if (0 == divisor)
+    {
+        for (size_t i = 0; NULL != error_mask && i < count; i++)
+        {
+            error_mask[i / 8] |= (uint8_t)(1u << (i % 8));
+        }
+        return 0 != count;
+    }
+    if (1 == divisor || -1 == divisor)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            result[i] = 0;
+        }
+        return 0;
+    }
+    if (__builtin_constant_p(divisor))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            result[i] = (uint32_t)((int32_t)operand1[i] % divisor);
+        }
+        return 0;
+    }
+
+    calc_divisor prepared = calc_divisor_init(divisor);
+    for (size_t i = 0; i < count; i++)
+    {
+        result[i] = (uint32_t)calc_divisor_remainder(&prepared,
+                                                     (int32_t)operand1[i]);
+    }
+    return 0;
+}
+
+#endif // CALC_CONST_H
@@ -0,0 +1,877 @@
+/******************************************************************************
+ * @file    calc_coord.c
+ * @brief   Sharded evaluation of a batch across calculation servers
+ * @version 1.6
+ * @date    October 2026
+ *
+ * The coordinator cuts its input into shards and pipelines them to a set
+ * of servers (see calc_server.c), which answer each shard as they would
+ * answer any client: a text shard is a run of batch lines, and a binary
+ * shard is a request of its own holding a slice of both operand columns.
+ * Answers are merged back in input order, so the output is the one batch
+ * or binary mode would have written.
+ *
+ * Flow control is by credits: a node has at most a fixed number of shards
+ * in flight, and gets a credit back with each answer. Answers are kept in
+ * a reorder window of a few shards per credit until every shard before
+ * them is written, and no shard is cut past the window, so a slow node
+ * holds the others back by at most the window rather than by the input.
+ *
+ * A node that goes quiet for the timeout with shards in flight is taken to
+ * have stalled: it is dropped, like one that disconnects or answers out of
+ * protocol, and its shards are sent again, ahead of new ones, to those
+ * that remain. A dropped node is not reconnected. Lines the protocol
+ * cannot carry, those starting with "GET " or the request magic, which a
+ * server takes for HTTP or binary requests, are evaluated locally.
+ *
+ * The input is mapped (or, for pipes, read whole) up front, so any shard
+ * can be sent again without buffering what was sent.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_net.h"
+
+#define COORD_READ_SIZE   (64 * 1024)
+#define COORD_WINDOW      2          // Shards per credit the window holds
+#define COORD_ROWS_MAX    (1u << 22) // Keeps a shard under a server's limit
+#define COORD_PIECES      3          // Header and two columns
+#define ROWS_PER_BYTE     8
+#define MS_PER_SECOND     1000
+#define NS_PER_MS         1000000
+
+/******************************************************************************
+ * @brief    Where a shard is
+ ******************************************************************************/
+typedef enum
+{
+    SHARD_PENDING = 0, // Cut, or sent to a node that was dropped
+    SHARD_SENT,
+    SHARD_DONE         // Answered, waiting for the shards before it
+} shard_state;
+
+/******************************************************************************
+ * @brief    Slice of the input and its answer
+ ******************************************************************************/
+typedef struct
+{
+    size_t      start;    // First byte (text) or row (binary)
+    size_t      length;   // Bytes (text) or rows (binary)
+    size_t      lines;    // Lines of a text shard, each answered by one
+    size_t      received; // Answer lines (text) or bytes (binary) so far
+    int         newline;  // The last line has none, so one is sent after it
+    shard_state state;
+    calc_buffer response;
+} coord_shard;
+
+/******************************************************************************
+ * @brief    Connection to a server
+ ******************************************************************************/
+typedef struct
+{
+    int             fd;     // -1 once dropped
+    size_t *        flight; // Ring of the shards sent, oldest first
+    unsigned        first;  // Oldest shard in flight
+    unsigned        used;   // Shards in flight
+    unsigned        sent;   // Of which written in full
+    size_t          offset; // Bytes of the next shard already written
+    unsigned char   header[CALC_BINARY_HEADER_SIZE]; // Shard being written
+    struct timespec heard;  // Last answer, or when shards went in flight
+} coord_node;
+
+/******************************************************************************
+ * @brief    State of one run
+ ******************************************************************************/
+typedef struct
+{
+    const unsigned char * input;
+    size_t                size;
+    int                   binary;
+    calc_op               op;          // Binary only
+    size_t                width;       // Bytes of a binary result
+    size_t                rows;        // Binary rows in all
+    size_t                cursor;      // First byte or row not yet cut
+    size_t                shard_size;  // Lines or rows
+    coord_shard *         window;      // Ring, by sequence number
+    size_t                window_size;
+    size_t                head;        // Next shard to write
+    size_t                next;        // Next shard to cut
+    size_t                pending;     // Shards to send again
+    coord_node *          nodes;
+    size_t                node_count;
+    size_t                live;        // Nodes not dropped
+    unsigned              credits;
+    unsigned char *       mask;        // Binary failure bitmap, written last
+    char *                scratch;     // COORD_READ_SIZE bytes
+    int                   output_fd;
+    calc_coord_counts *   counts;
+} coord_run;
+
+/******************************************************************************
+ * @brief    Milliseconds from one monotonic time to another
+ ******************************************************************************/
+static long elapsed_ms(const struct timespec * since,
+                       const struct timespec * now)
+{
+    return (long)(now->tv_sec - since->tv_sec) * MS_PER_SECOND +
+           (now->tv_nsec - since->tv_nsec) / NS_PER_MS;
+}
+
+/******************************************************************************
+ * @brief    Map the input, or read it whole if it cannot be mapped
+ * @param    fd      Descriptor to read
+ * @param    map     Set to the mapping, or left NULL
+ * @param    buffer  Filled with the input if it is not mapped
+ * @param    run     Input and size are set
+ * @return   CALC_BATCH_OK, or the error that stopped reading
+ ******************************************************************************/
+static calc_batch_status read_input(int           fd,
+                                    void **       map,
+                                    calc_buffer * buffer,
+                                    coord_run *   run)
+{
+    struct stat info;
+
+    if (0 == fstat(fd, &info) && S_ISREG(info.st_mode) && info.st_size > 0 &&
+        0 == lseek(fd, 0, SEEK_CUR))
+    {
+        void * mapped =
+            mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != mapped)
+        {
+            (void)posix_madvise(
+                mapped, (size_t)info.st_size, POSIX_MADV_SEQUENTIAL);
+            *map       = mapped;
+            run->input = mapped;
+            run->size  = (size_t)info.st_size;
+            return CALC_BATCH_OK;
+        }
+    }
+
+    for (;;)
+    {
+        if (!calc_buffer_reserve(buffer, COORD_READ_SIZE))
+        {
+            return CALC_BATCH_NO_MEMORY;
+        }
+        ssize_t count = read(
+            fd, buffer->data + buffer->used, buffer->capacity - buffer->used);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return CALC_BATCH_READ_ERROR;
+        }
+        if (0 == count)
+        {
+            break;
+        }
+        buffer->used += (size_t)count;
+    }
+    run->input = (const unsigned char *)buffer->data;
+    run->size  = buffer->used;
+    return CALC_BATCH_OK;
+}
+
+/******************************************************************************
+ * @brief    Write all of a buffer
+ * @return   1 if successful, 0 on error
+ ******************************************************************************/
+static int write_all(int fd, const void * bytes, size_t length)
+{
+    const char * at = bytes;
+
+    while (0 != length)
+    {
+        ssize_t count = write(fd, at, length);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return 0;
+        }
+        at += count;
+        length -= (size_t)count;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Whether a line would be taken by a server for another kind of
+ *           request
+ ******************************************************************************/
+static int needs_local(const unsigned char * line, size_t available)
+{
+    return available >= CALC_NET_MAGIC_SIZE &&
+           (0 == memcmp(line, calc_net_request_magic, CALC_NET_MAGIC_SIZE) ||
+            0 == memcmp(line, calc_net_http_method, CALC_NET_MAGIC_SIZE));
+}
+
+/******************************************************************************
+ * @brief    Cut the next shard off the input; a text shard of lines the
+ *           servers cannot take is answered on the spot
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int cut_shard(coord_run * run)
+{
+    coord_shard * shard = &run->window[run->next % run->window_size];
+
+    shard->start         = run->cursor;
+    shard->lines         = 0;
+    shard->received      = 0;
+    shard->newline       = 0;
+    shard->state         = SHARD_PENDING;
+    shard->response.used = 0;
+    run->next++;
+
+    if (run->binary)
+    {
+        size_t left   = run->rows - run->cursor;
+        shard->length = (left < run->shard_size) ? left : run->shard_size;
+        run->cursor += shard->length;
+        return 1;
+    }
+
+    const unsigned char * text     = run->input;
+    size_t                position = run->cursor;
+    int local = needs_local(text + position, run->size - position);
+
+    // Lines up to the shard size, all of them sent or all kept local
+    while (position < run->size && shard->lines < run->shard_size &&
+           (0 == shard->lines ||
+            local == needs_local(text + position, run->size - position)))
+    {
+        const unsigned char * newline =
+            memchr(text + position, '\n', run->size - position);
+        position = (NULL == newline) ? run->size
+                                     : (size_t)(newline - text) + 1;
+        shard->lines++;
+    }
+    shard->length  = position - run->cursor;
+    shard->newline = '\n' != text[position - 1];
+    run->cursor    = position;
+
+    if (local)
+    {
+        calc_batch_counts counts = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+        if (!calc_batch_eval((const char *)text + shard->start,
+                             shard->length,
+                             &shard->response,
+                             NULL,
+                             CALC_WIDTH_32,
+                             calc_net_classic_division,
+                             &counts))
+        {
+            return 0;
+        }
+        shard->state = SHARD_DONE;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Lay out what a shard sends
+ * @param    pieces  Filled with up to COORD_PIECES pieces
+ * @return   Number of pieces
+ ******************************************************************************/
+static int shard_pieces(const coord_run *   run,
+                        coord_node *        node,
+                        const coord_shard * shard,
+                        struct iovec *      pieces)
+{
+    if (!run->binary)
+    {
+        pieces[0].iov_base = (void *)(run->input + shard->start);
+        pieces[0].iov_len  = shard->length;
+        pieces[1].iov_base = (void *)"\n";
+        pieces[1].iov_len  = 1;
+        return shard->newline ? 2 : 1;
+    }
+
+    const unsigned char * column1 = run->input + CALC_BINARY_HEADER_SIZE;
+    const unsigned char * column2 =
+        column1 + (run->rows * sizeof(uint32_t));
+    size_t offset = shard->start * sizeof(uint32_t);
+
+    calc_net_store_le32(node->header, CALC_BINARY_REQUEST_MAGIC);
+    calc_net_store_le16(node->header + 4, CALC_BINARY_VERSION);
+    calc_net_store_le16(node->header + 6, (uint16_t)run->op);
+    calc_net_store_le64(node->header + 8, shard->length);
+    pieces[0].iov_base = node->header;
+    pieces[0].iov_len  = sizeof(node->header);
+    pieces[1].iov_base = (void *)(column1 + offset);
+    pieces[1].iov_len  = shard->length * sizeof(uint32_t);
+    pieces[2].iov_base = (void *)(column2 + offset);
+    pieces[2].iov_len  = shard->length * sizeof(uint32_t);
+    return COORD_PIECES;
+}
+
+/******************************************************************************
+ * @brief    Write as much of the unsent shards as the socket takes
+ * @return   1 if successful, 0 if the node must be dropped
+ ******************************************************************************/
+static int send_shards(coord_run * run, coord_node * node)
+{
+    while (node->sent < node->used)
+    {
+        size_t        sequence = node->flight[(node->first + node->sent) %
+                                              run->credits];
+        coord_shard * shard = &run->window[sequence % run->window_size];
+        struct iovec  pieces[COORD_PIECES];
+        int           count = shard_pieces(run, node, shard, pieces);
+        size_t        skip  = node->offset;
+        int           at    = 0;
+        struct msghdr message;
+
+        // Skip what went out before
+        while (skip >= pieces[at].iov_len)
+        {
+            skip -= pieces[at].iov_len;
+            at++;
+        }
+        pieces[at].iov_base = (char *)pieces[at].iov_base + skip;
+        pieces[at].iov_len -= skip;
+
+        memset(&message, 0, sizeof(message));
+        message.msg_iov    = pieces + at;
+        message.msg_iovlen = (size_t)(count - at);
+        ssize_t written    = sendmsg(node->fd, &message, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return EAGAIN == errno || EWOULDBLOCK == errno;
+        }
+
+        size_t left = 0;
+        for (int i = at; i < count; i++)
+        {
+            left += pieces[i].iov_len;
+        }
+        if ((size_t)written < left)
+        {
+            node->offset += (size_t)written;
+            continue;
+        }
+        node->offset = 0;
+        node->sent++;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Check a binary answer against its shard
+ ******************************************************************************/
+static int answer_matches(const coord_run * run, const coord_shard * shard)
+{
+    const unsigned char * header = (const unsigned char *)shard->response.data;
+
+    return CALC_BINARY_RESPONSE_MAGIC == calc_net_load_le32(header) &&
+           CALC_BINARY_VERSION == calc_net_load_le16(header + 4) &&
+           (uint16_t)calc_op_kind(run->op) == calc_net_load_le16(header + 6) &&
+           shard->length == calc_net_load_le64(header + 8);
+}
+
+/******************************************************************************
+ * @brief    Hand received bytes to the oldest shards in flight
+ * @return   1 if successful, 0 if the node must be dropped
+ ******************************************************************************/
+static int take_answers(coord_run *  run,
+                        coord_node * node,
+                        const char * bytes,
+                        size_t       length)
+{
+    while (0 != length)
+    {
+        if (0 == node->sent)
+        {
+            return 0; // Answers to nothing that was sent
+        }
+
+        coord_shard * shard =
+            &run->window[node->flight[node->first] % run->window_size];
+        size_t take     = length;
+        int    complete = 0;
+
+        if (run->binary)
+        {
+            size_t rows = shard->length;
+            size_t size = CALC_BINARY_HEADER_SIZE + (rows * run->width) +
+                          ((rows + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE);
+            if (size - shard->received <= take)
+            {
+                take     = size - shard->received;
+                complete = 1;
+            }
+            shard->received += take;
+        }
+        else
+        {
+            // Up to the newline that ends the last answer, if it came
+            const char * at  = bytes;
+            const char * end = bytes + length;
+            while (!complete && NULL != (at = memchr(at, '\n', end - at)))
+            {
+                at++;
+                complete = ++shard->received == shard->lines;
+            }
+            if (complete)
+            {
+                take = (size_t)(at - bytes);
+            }
+        }
+
+        if (!calc_buffer_reserve(&shard->response, take))
+        {
+            return 0;
+        }
+        memcpy(shard->response.data + shard->response.used, bytes, take);
+        shard->response.used += take;
+        bytes += take;
+        length -= take;
+
+        if (complete)
+        {
+            if (run->binary && !answer_matches(run, shard))
+            {
+                return 0;
+            }
+            shard->state = SHARD_DONE;
+            node->first  = (node->first + 1) % run->credits;
+            node->used--;
+            node->sent--;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Read what a node has answered
+ * @return   1 if successful, 0 if the node must be dropped
+ ******************************************************************************/
+static int receive_answers(coord_run * run, coord_node * node)
+{
+    for (;;)
+    {
+        ssize_t count = read(node->fd, run->scratch, COORD_READ_SIZE);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return EAGAIN == errno || EWOULDBLOCK == errno;
+        }
+        if (0 == count)
+        {
+            return 0;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &node->heard);
+        if (!take_answers(run, node, run->scratch, (size_t)count))
+        {
+            return 0;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Drop a node and put its shards up to be sent again
+ ******************************************************************************/
+static void drop_node(coord_run * run, coord_node * node)
+{
+    for (unsigned i = 0; i < node->used; i++)
+    {
+        size_t        sequence = node->flight[(node->first + i) % run->credits];
+        coord_shard * shard    = &run->window[sequence % run->window_size];
+        shard->state           = SHARD_PENDING;
+        shard->received        = 0;
+        shard->response.used   = 0;
+    }
+    run->pending += node->used;
+    run->counts->redispatched += node->used;
+    run->counts->nodes_lost++;
+    run->live--;
+    close(node->fd);
+    node->fd     = -1;
+    node->used   = 0;
+    node->sent   = 0;
+    node->offset = 0;
+}
+
+/******************************************************************************
+ * @brief    Hand out the shards to be sent again, then new ones, while nodes
+ *           have credits and the window has room
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int dispatch(coord_run * run)
+{
+    for (size_t n = 0; n < run->node_count; n++)
+    {
+        coord_node * node = &run->nodes[n];
+
+        while (node->fd >= 0 && node->used < run->credits)
+        {
+            size_t sequence = run->next;
+
+            for (size_t s = run->head; 0 != run->pending && s < run->next;
+                 s++)
+            {
+                if (SHARD_PENDING == run->window[s % run->window_size].state)
+                {
+                    sequence = s;
+                    run->pending--;
+                    break;
+                }
+            }
+            if (sequence == run->next)
+            {
+                size_t end = run->binary ? run->rows : run->size;
+                if (run->cursor == end ||
+                    run->next - run->head == run->window_size)
+                {
+                    break;
+                }
+                if (!cut_shard(run))
+                {
+                    return 0;
+                }
+                if (SHARD_DONE == run->window[sequence % run->window_size]
+                                      .state)
+                {
+                    continue; // Answered locally
+                }
+            }
+
+            if (0 == node->used)
+            {
+                clock_gettime(CLOCK_MONOTONIC, &node->heard);
+            }
+            run->window[sequence % run->window_size].state = SHARD_SENT;
+            node->flight[(node->first + node->used) % run->credits] = sequence;
+            node->used++;
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Write the answered shards at the head of the window
+ * @return   1 if successful, 0 on a write error
+ ******************************************************************************/
+static int write_answers(coord_run * run)
+{
+    while (run->head < run->next &&
+           SHARD_DONE == run->window[run->head % run->window_size].state)
+    {
+        coord_shard * shard  = &run->window[run->head % run->window_size];
+        const char *  answer = shard->response.data;
+        size_t        failed = 0;
+
+        if (run->binary)
+        {
+            size_t rows       = shard->length;
+            size_t mask_size  = (rows + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE;
+            const char * mask = answer + CALC_BINARY_HEADER_SIZE +
+                                (rows * run->width);
+
+            // Shards start on a mask byte, so their bitmaps abut
+            memcpy(run->mask + (shard->start / ROWS_PER_BYTE), mask, mask_size);
+            for (size_t i = 0; i < mask_size; i++)
+            {
+                failed += (size_t)__builtin_popcount((unsigned char)mask[i]);
+            }
+            if (!write_all(run->output_fd,
+                           answer + CALC_BINARY_HEADER_SIZE,
+                           rows * run->width))
+            {
+                return 0;
+            }
+            run->counts->lines += rows;
+        }
+        else
+        {
+            const char * end = answer + shard->response.used;
+            for (const char * line = answer; line < end;)
+            {
+                const char * newline = memchr(line, '\n', end - line);
+                failed += 'E' == line[0]; // "Error! ..."
+                line = (NULL != newline) ? newline + 1 : end;
+            }
+            if (!write_all(run->output_fd, answer, shard->response.used))
+            {
+                return 0;
+            }
+            run->counts->lines += shard->lines;
+        }
+        run->counts->failed += failed;
+        run->counts->shards++;
+        run->head++;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Drive the nodes until every shard is written
+ * @param    timeout_ms  Quiet time that drops a node with shards in flight
+ * @return   CALC_BATCH_OK, or the error that stopped the run
+ ******************************************************************************/
+static calc_batch_status coordinate(coord_run * run, unsigned timeout_ms)
+{
+    struct pollfd * polled = calloc(run->node_count, sizeof(*polled));
+    size_t *        polled_node = calloc(run->node_count, sizeof(size_t));
+    size_t          end = run->binary ? run->rows : run->size;
+
+    calc_batch_status status = CALC_BATCH_NO_MEMORY;
+    while (NULL != polled && NULL != polled_node)
+    {
+        struct timespec now;
+        int             wait  = -1;
+        nfds_t          count = 0;
+        size_t          head  = run->head;
+
+        if (!dispatch(run))
+        {
+            break;
+        }
+        if (!write_answers(run))
+        {
+            status = CALC_BATCH_WRITE_ERROR;
+            break;
+        }
+        if (run->head == run->next && run->cursor == end)
+        {
+            status = CALC_BATCH_OK;
+            break;
+        }
+        if (run->head != head)
+        {
+            continue; // The window moved on, so more can be cut
+        }
+        if (0 == run->live)
+        {
+            status = CALC_BATCH_NODE_ERROR;
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (size_t n = 0; n < run->node_count; n++)
+        {
+            coord_node * node = &run->nodes[n];
+            if (node->fd < 0)
+            {
+                continue;
+            }
+            if (0 != node->used)
+            {
+                long left = (long)timeout_ms - elapsed_ms(&node->heard, &now);
+                left      = (left < 0) ? 0 : left;
+                wait      = (wait < 0 || left < wait) ? (int)left : wait;
+            }
+            polled[count].fd      = node->fd;
+            polled[count].events  = POLLIN;
+            polled[count].events |= (node->sent < node->used) ? POLLOUT : 0;
+            polled[count].revents = 0;
+            polled_node[count++]  = n;
+        }
+        if (poll(polled, count, wait) < 0 && EINTR != errno)
+        {
+            status = CALC_BATCH_READ_ERROR;
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (nfds_t i = 0; i < count; i++)
+        {
+            coord_node * node = &run->nodes[polled_node[i]];
+            short        ready = polled[i].revents;
+
+            if ((0 != (ready & POLLOUT) && !send_shards(run, node)) ||
+                (0 != (ready & (POLLIN | POLLHUP | POLLERR)) &&
+                 !receive_answers(run, node)) ||
+                (0 != node->used &&
+                 elapsed_ms(&node->heard, &now) >= (long)timeout_ms))
+            {
+                drop_node(run, node);
+            }
+        }
+    }
+    free(polled);
+    free(polled_node);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a batch across servers, writing what batch or binary
+ *           mode would
+ * @param    input_fd    Descriptor the batch lines, or the binary request,
+ *                       are read from
+ * @param    output_fd   Descriptor the answers are written to
+ * @param    binary      The input is a binary request rather than lines
+ * @param    nodes       Server addresses: socket paths, or [host:]port
+ * @param    node_count  Number of nodes
+ * @param    shard_size  Lines, or rows (rounded up to a multiple of 8), per
+ *                       shard
+ * @param    credits     Shards each node may have in flight
+ * @param    timeout_ms  Quiet time after which a node with shards in flight
+ *                       is dropped and its shards sent to the others
+ * @param    counts      Incremented by what was answered, and by the nodes
+ *                       dropped and the shards they left to the others
+ * @return   CALC_BATCH_OK, CALC_BATCH_BAD_FORMAT if the binary request is
+ *           malformed, CALC_BATCH_NODE_ERROR if every node was dropped with
+ *           shards unanswered, or the I/O or memory error that stopped the
+ *           run
+ ******************************************************************************/
+calc_batch_status calc_coord_run(int                  input_fd,
+                                 int                  output_fd,
+                                 int                  binary,
+                                 const char * const * nodes,
+                                 size_t               node_count,
+                                 size_t               shard_size,
+                                 unsigned             credits,
+                                 unsigned             timeout_ms,
+                                 calc_coord_counts *  counts)
+{
+    coord_run         run;
+    void *            map    = NULL;
+    calc_buffer       buffer = { NULL, 0, 0 };
+    calc_batch_status status = CALC_BATCH_NO_MEMORY;
+
+    memset(&run, 0, sizeof(run));
+    run.binary      = binary;
+    run.shard_size  = (0 == shard_size) ? 1 : shard_size;
+    run.credits     = (0 == credits) ? 1 : credits;
+    run.node_count  = node_count;
+    run.window_size = node_count * run.credits * COORD_WINDOW;
+    run.output_fd   = output_fd;
+    run.counts      = counts;
+    if (binary)
+    {
+        run.shard_size = (run.shard_size > COORD_ROWS_MAX)
+                             ? COORD_ROWS_MAX
+                             : (run.shard_size + ROWS_PER_BYTE - 1) &
+                                   ~(size_t)(ROWS_PER_BYTE - 1);
+    }
+
+    run.window  = calloc((0 == node_count) ? 1 : run.window_size,
+                        sizeof(coord_shard));
+    run.nodes   = calloc((0 == node_count) ? 1 : node_count,
+                       sizeof(coord_node));
+    run.scratch = malloc(COORD_READ_SIZE);
+    for (size_t n = 0; NULL != run.nodes && n < node_count; n++)
+    {
+        run.nodes[n].fd = -1;
+    }
+    if (NULL != run.window && NULL != run.nodes && NULL != run.scratch)
+    {
+        status = read_input(input_fd, &map, &buffer, &run);
+    }
+
+    if (CALC_BATCH_OK == status && binary)
+    {
+        size_t size = 0;
+
+        // Exactly two full columns must follow the header
+        if (run.size < CALC_BINARY_HEADER_SIZE ||
+            !calc_binary_request_size(run.input, &size) || size != run.size)
+        {
+            status = CALC_BATCH_BAD_FORMAT;
+        }
+        else
+        {
+            unsigned char header[CALC_BINARY_HEADER_SIZE];
+            calc_kind     kind;
+
+            run.op    = (calc_op)calc_net_load_le16(run.input + 6);
+            run.rows  = (size_t)calc_net_load_le64(run.input + 8);
+            kind      = calc_op_kind(run.op);
+            run.width = (CALC_KIND_DOUBLE == kind) ? sizeof(double)
+                                                   : sizeof(uint32_t);
+            run.mask  = calloc(1 + (run.rows / ROWS_PER_BYTE), 1);
+
+            calc_net_store_le32(header, CALC_BINARY_RESPONSE_MAGIC);
+            calc_net_store_le16(header + 4, CALC_BINARY_VERSION);
+            calc_net_store_le16(header + 6, (uint16_t)kind);
+            calc_net_store_le64(header + 8, run.rows);
+            if (NULL == run.mask)
+            {
+                status = CALC_BATCH_NO_MEMORY;
+            }
+            else if (!write_all(output_fd, header, sizeof(header)))
+            {
+                status = CALC_BATCH_WRITE_ERROR;
+            }
+        }
+    }
+
+    if (CALC_BATCH_OK == status)
+    {
+        for (size_t n = 0; n < node_count; n++)
+        {
+            run.nodes[n].fd     = calc_net_connect(nodes[n]);
+            run.nodes[n].flight = calloc(run.credits, sizeof(size_t));
+            if (NULL == run.nodes[n].flight)
+            {
+                status = CALC_BATCH_NO_MEMORY;
+            }
+            if (run.nodes[n].fd >= 0)
+            {
+                run.live++;
+            }
+            else
+            {
+                counts->nodes_lost++;
+            }
+        }
+    }
+    if (CALC_BATCH_OK == status)
+    {
+        status = coordinate(&run, timeout_ms);
+    }
+    if (CALC_BATCH_OK == status && binary &&
+        !write_all(output_fd,
+                   run.mask,
+                   (run.rows + ROWS_PER_BYTE - 1) / ROWS_PER_BYTE))
+    {
+        status = CALC_BATCH_WRITE_ERROR;
+    }
+
+    for (size_t n = 0; NULL != run.nodes && n < node_count; n++)
+    {
+        if (run.nodes[n].fd >= 0)
+        {
+            close(run.nodes[n].fd);
+        }
+        free(run.nodes[n].flight);
+    }
+    for (size_t s = 0; NULL != run.window && s < run.window_size; s++)
+    {
+        calc_buffer_free(&run.window[s].response);
+    }
+    if (NULL != map)
+    {
+        munmap(map, run.size);
+    }
+    calc_buffer_free(&buffer);
+    free(run.mask);
+    free(run.scratch);
+    free(run.nodes);
+    free(run.window);
+    return status;
+}
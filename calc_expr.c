@@ -0,0 +1,1488 @@
+/******************************************************************************
+ * @file    calc_expr.c
+ * @brief   Infix expression compiler and bytecode interpreter
+ * @version 1.6
+ * @date    October 2026
+ *
+ * An expression is parsed once into a tree of operators over literals and
+ * named variables, then emitted as three-address code over a register file,
+ * so evaluating it against new bindings is a copy and one pass over the code.
+ *
+ * Between the two, the tree is optimised: constant operators are folded,
+ * identities such as x ^ 0 and x <<< 32 dropped, chains of masks, shifts
+ * and rotates by constants merged, multiplication, division and modulo by
+ * powers of two reduced to shifts and masks where the operand's range
+ * allows, and equal subtrees computed once.
+ *
+ * The tree is an array of nodes linked by index, and the compiled form is
+ * one flat block of constants and code. Both the compiler's scratch and the
+ * result can come from an arena, so compiling an expression per request
+ * costs no call to the system allocator.
+ *
+ * Precedence follows C, loosest first: |, ^, &, shifts and rotates, + and -,
+ * then * / %, all left associative. Literals are decimal or 0x hexadecimal
+ * and must fit in 32 bits. Operators keep their perform_* semantics and
+ * errors. Only a division at the root yields a double; one whose quotient
+ * feeds another operator is truncated towards zero to 32 bits.
+ *
+ * Over columns of bindings the same code runs one instruction at a time
+ * across a block of rows, each through the array kernels. Temporaries that
+ * are no longer read share a column, and the block is sized so that all of
+ * them fit in about 32 KB, a typical L1 data cache.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "calc.h"
+#include "calc_expr.h"
+
+#define CALC_EXPR_DEPTH_MAX 64 // Nested parentheses
+#define BASE_DECIMAL        10
+#define BASE_HEX            16
+#define BITS_IN_UINT32      32
+#define SIGNED_MAX          ((uint32_t)INT32_MAX)
+#define EXPR_BLOCK          1024 // Most rows per block of column evaluation
+#define EXPR_SCRATCH_WORDS  8192 // Intermediate columns of a block: 32 KB,
+                                 // which stays in a typical L1 data cache
+#define LANES_PER_BYTE      8
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+typedef enum
+{
+    NODE_CONST = 0,
+    NODE_VAR,
+    NODE_OP
+} node_kind;
+
+/******************************************************************************
+ * @brief    Tree node; value is the literal or the variable index
+ *
+ * After optimisation the tree is a DAG: equal subtrees are one node. bound
+ * is the largest value, as unsigned, that the node yields when it does not
+ * fail, and fallible is set if evaluating it can fail at all.
+ ******************************************************************************/
+typedef struct
+{
+    node_kind kind;
+    calc_op   op;
+    uint32_t  value;
+    uint32_t  bound;
+    uint8_t   left;
+    uint8_t   right;
+    uint8_t   reg; // Register assigned at emission
+    uint8_t   fallible;
+    uint8_t   interned; // Optimised, and a candidate for reuse
+} expr_node;
+
+typedef struct
+{
+    const char *     text;
+    const char *     cursor;
+    unsigned         depth;
+    calc_expr_status status;
+    size_t           node_count;
+    expr_node        nodes[CALC_EXPR_NODES_MAX];
+    calc_expr *      expr;
+} expr_compiler;
+
+// Binding strength of each binary operator; -1 for none
+static const int8_t precedence[CALC_OP_COUNT] = {
+    [CALC_OP_INVALID] = -1, [CALC_OP_OR] = 0,  [CALC_OP_XOR] = 1,
+    [CALC_OP_AND] = 2,      [CALC_OP_SHL] = 3, [CALC_OP_SHR] = 3,
+    [CALC_OP_ROL] = 3,      [CALC_OP_ROR] = 3, [CALC_OP_ADD] = 4,
+    [CALC_OP_SUB] = 4,      [CALC_OP_MUL] = 5, [CALC_OP_DIV] = 5,
+    [CALC_OP_MOD] = 5,
+};
+
+static int parse_binary(expr_compiler * compiler, int min_precedence);
+
+/******************************************************************************
+ * @brief    Character classes, independent of the locale
+ ******************************************************************************/
+static int is_space(char ch)
+{
+    return ' ' == ch || ('\t' <= ch && ch <= '\r');
+}
+
+static int is_name_start(char ch)
+{
+    return ('a' <= ch && ch <= 'z') || ('A' <= ch && ch <= 'Z') || '_' == ch;
+}
+
+static int is_name_char(char ch)
+{
+    return is_name_start(ch) || ('0' <= ch && ch <= '9');
+}
+
+static int digit_value(char ch)
+{
+    if ('0' <= ch && ch <= '9')
+    {
+        return ch - '0';
+    }
+    if ('a' <= ch && ch <= 'f')
+    {
+        return ch - 'a' + 10;
+    }
+    if ('A' <= ch && ch <= 'F')
+    {
+        return ch - 'A' + 10;
+    }
+    return BASE_HEX;
+}
+
+/******************************************************************************
+ * @brief    Record the first error; the cursor marks where it was found
+ * @return   -1, for the caller to return
+ ******************************************************************************/
+static int fail(expr_compiler * compiler, calc_expr_status status)
+{
+    if (CALC_EXPR_OK == compiler->status)
+    {
+        compiler->status = status;
+    }
+    return -1;
+}
+
+static void skip_space(expr_compiler * compiler)
+{
+    while (is_space(*compiler->cursor))
+    {
+        compiler->cursor++;
+    }
+}
+
+/******************************************************************************
+ * @brief    Append a tree node
+ * @return   Index of the node, or -1 if the expression is too large
+ ******************************************************************************/
+static int add_node(expr_compiler * compiler,
+                    node_kind       kind,
+                    calc_op         op,
+                    uint32_t        value,
+                    int             left,
+                    int             right)
+{
+    if (CALC_EXPR_NODES_MAX == compiler->node_count)
+    {
+        return fail(compiler, CALC_EXPR_TOO_LARGE);
+    }
+
+    expr_node * node = &compiler->nodes[compiler->node_count];
+    node->kind       = kind;
+    node->op         = op;
+    node->value      = value;
+    node->bound      = UINT32_MAX;
+    node->left       = (uint8_t)left;
+    node->right      = (uint8_t)right;
+    node->reg        = 0;
+    node->fallible   = 0;
+    node->interned   = 0;
+    return (int)compiler->node_count++;
+}
+
+/******************************************************************************
+ * @brief    Parse a decimal or 0x hexadecimal literal
+ ******************************************************************************/
+static int parse_literal(expr_compiler * compiler)
+{
+    const char * cursor = compiler->cursor;
+    unsigned     base   = BASE_DECIMAL;
+    uint64_t     value  = 0;
+
+    if ('0' == cursor[0] && ('x' == cursor[1] || 'X' == cursor[1]))
+    {
+        base = BASE_HEX;
+        cursor += 2;
+        if (digit_value(*cursor) >= BASE_HEX)
+        {
+            compiler->cursor = cursor;
+            return fail(compiler, CALC_EXPR_BAD_LITERAL);
+        }
+    }
+
+    for (; (unsigned)digit_value(*cursor) < base; cursor++)
+    {
+        value = (value * base) + (unsigned)digit_value(*cursor);
+        if (value > UINT32_MAX)
+        {
+            return fail(compiler, CALC_EXPR_BAD_LITERAL);
+        }
+    }
+    if (is_name_char(*cursor))
+    {
+        compiler->cursor = cursor;
+        return fail(compiler, CALC_EXPR_BAD_LITERAL);
+    }
+
+    compiler->cursor = cursor;
+    return add_node(
+        compiler, NODE_CONST, CALC_OP_INVALID, (uint32_t)value, 0, 0);
+}
+
+/******************************************************************************
+ * @brief    Parse a variable name, giving new names the next index
+ ******************************************************************************/
+static int parse_variable(expr_compiler * compiler)
+{
+    calc_expr *  expr   = compiler->expr;
+    const char * start  = compiler->cursor;
+    size_t       length = 0;
+    size_t       index;
+
+    while (is_name_char(start[length]))
+    {
+        length++;
+    }
+    if (length >= CALC_EXPR_NAME_MAX)
+    {
+        return fail(compiler, CALC_EXPR_TOO_LARGE);
+    }
+    compiler->cursor = start + length;
+
+    index = calc_expr_find_variable(expr, start, length);
+    if (index == expr->variable_count)
+    {
+        if (CALC_EXPR_VARIABLES_MAX == index)
+        {
+            return fail(compiler, CALC_EXPR_TOO_LARGE);
+        }
+        memcpy(expr->names[index], start, length);
+        expr->names[index][length] = '\0';
+        expr->variable_count++;
+    }
+    return add_node(
+        compiler, NODE_VAR, CALC_OP_INVALID, (uint32_t)index, 0, 0);
+}
+
+/******************************************************************************
+ * @brief    Parse a literal, a variable or a parenthesised expression
+ ******************************************************************************/
+static int parse_primary(expr_compiler * compiler)
+{
+    skip_space(compiler);
+
+    char ch = *compiler->cursor;
+    if ('(' == ch)
+    {
+        if (CALC_EXPR_DEPTH_MAX == compiler->depth)
+        {
+            return fail(compiler, CALC_EXPR_TOO_LARGE);
+        }
+        compiler->cursor++;
+        compiler->depth++;
+        int node = parse_binary(compiler, 0);
+        compiler->depth--;
+        if (node < 0)
+        {
+            return node;
+        }
+        skip_space(compiler);
+        if (')' != *compiler->cursor)
+        {
+            return fail(compiler, CALC_EXPR_SYNTAX_ERROR);
+        }
+        compiler->cursor++;
+        return node;
+    }
+    if ('0' <= ch && ch <= '9')
+    {
+        return parse_literal(compiler);
+    }
+    if (is_name_start(ch))
+    {
+        return parse_variable(compiler);
+    }
+    return fail(compiler, CALC_EXPR_SYNTAX_ERROR);
+}
+
+/******************************************************************************
+ * @brief    Decode the operator at the cursor without consuming it
+ * @param    length  Set to the operator's length
+ * @return   Opcode, or CALC_OP_INVALID if there is no operator
+ ******************************************************************************/
+static calc_op peek_operator(const expr_compiler * compiler, size_t * length)
+{
+    const char * cursor = compiler->cursor;
+
+    // Shifts and rotates are runs of '<' or '>'; longest match wins
+    *length = 1;
+    if ('<' == cursor[0] || '>' == cursor[0])
+    {
+        while (*length < 3 && cursor[*length] == cursor[0])
+        {
+            (*length)++;
+        }
+    }
+    return calc_parse_opcode(cursor, *length);
+}
+
+/******************************************************************************
+ * @brief    Parse operators binding at least as tightly as min_precedence
+ * @return   Index of the subtree, or -1 on error
+ ******************************************************************************/
+static int parse_binary(expr_compiler * compiler, int min_precedence)
+{
+    int left = parse_primary(compiler);
+
+    while (left >= 0)
+    {
+        size_t length;
+
+        skip_space(compiler);
+        calc_op op = peek_operator(compiler, &length);
+        if (CALC_OP_INVALID == op || precedence[op] < min_precedence)
+        {
+            break;
+        }
+        compiler->cursor += length;
+
+        int right = parse_binary(compiler, precedence[op] + 1);
+        if (right < 0)
+        {
+            return right;
+        }
+        left = add_node(compiler, NODE_OP, op, 0, left, right);
+    }
+    return left;
+}
+
+/******************************************************************************
+ * @brief    Smallest all-ones mask covering value
+ ******************************************************************************/
+static uint32_t cover_mask(uint32_t value)
+{
+    for (unsigned shift = 1; shift < BITS_IN_UINT32; shift <<= 1)
+    {
+        value |= value >> shift;
+    }
+    return value;
+}
+
+/******************************************************************************
+ * @brief    Exponent of a power of two that signed arithmetic can shift by
+ * @return   k if value is 2^k with 1 <= k <= 30, otherwise 0
+ ******************************************************************************/
+static unsigned power_of_two(uint32_t value)
+{
+    if (value < 2 || value > (SIGNED_MAX >> 1) + 1 ||
+        0 != (value & (value - 1)))
+    {
+        return 0;
+    }
+    return (unsigned)__builtin_ctz(value);
+}
+
+static int is_commutative(calc_op op)
+{
+    return CALC_OP_ADD == op || CALC_OP_MUL == op || CALC_OP_AND == op ||
+           CALC_OP_OR == op || CALC_OP_XOR == op;
+}
+
+/******************************************************************************
+ * @brief    Work out a node's bound and whether it can fail from its operands
+ ******************************************************************************/
+static void describe(expr_compiler * compiler, expr_node * node)
+{
+    node->fallible = 0;
+    if (NODE_OP != node->kind)
+    {
+        node->bound = (NODE_CONST == node->kind) ? node->value : UINT32_MAX;
+        return;
+    }
+
+    const expr_node * left  = &compiler->nodes[node->left];
+    const expr_node * right = &compiler->nodes[node->right];
+    uint64_t          l     = left->bound;
+    uint64_t          r     = right->bound;
+    uint64_t          bound = UINT32_MAX;
+    int               fails = 0;
+    // Both operands are non-negative as int32, so +, - and * are bounded
+    int natural = l <= SIGNED_MAX && r <= SIGNED_MAX;
+    // A non-zero constant divisor never fails
+    int divides = NODE_CONST == right->kind && 0 != right->value;
+
+    switch (node->op)
+    {
+        case CALC_OP_ADD:
+        case CALC_OP_MUL:
+            bound = (CALC_OP_ADD == node->op) ? l + r : l * r;
+            fails = !natural || bound > SIGNED_MAX;
+            bound = natural ? MIN(bound, SIGNED_MAX) : UINT32_MAX;
+            break;
+        case CALC_OP_SUB:
+            fails = !natural;
+            break;
+        case CALC_OP_DIV:
+            fails = !divides;
+            bound = natural ? l : UINT32_MAX;
+            break;
+        case CALC_OP_MOD:
+            fails = !divides;
+            if (l <= SIGNED_MAX)
+            {
+                // |remainder| < |divisor|, and a zero divisor has failed
+                bound = (natural && 0 != r) ? MIN(l, r - 1) : l;
+            }
+            break;
+        case CALC_OP_SHL:
+        case CALC_OP_SHR:
+            bound = (CALC_OP_SHR == node->op) ? l : UINT32_MAX;
+            if (NODE_CONST == right->kind)
+            {
+                uint32_t count = right->value;
+                if (count >= BITS_IN_UINT32)
+                {
+                    bound = 0;
+                }
+                else if (CALC_OP_SHR == node->op)
+                {
+                    bound = l >> count;
+                }
+                else if (l <= (UINT32_MAX >> count))
+                {
+                    bound = l << count;
+                }
+            }
+            break;
+        case CALC_OP_AND:
+            bound = MIN(l, r);
+            break;
+        case CALC_OP_OR:
+        case CALC_OP_XOR:
+            bound = cover_mask((uint32_t)MAX(l, r));
+            break;
+        default:
+            bound = (0 == l) ? 0 : UINT32_MAX;
+            break;
+    }
+    node->bound    = (uint32_t)bound;
+    node->fallible = (uint8_t)(fails || left->fallible || right->fallible);
+}
+
+/******************************************************************************
+ * @brief    Find an optimised node equal to this one, or make this one such
+ * @return   Index of the node to use in place of index
+ ******************************************************************************/
+static int intern(expr_compiler * compiler, int index)
+{
+    expr_node * node = &compiler->nodes[index];
+
+    if (node->interned)
+    {
+        return index;
+    }
+    for (size_t i = 0; i < compiler->node_count; i++)
+    {
+        const expr_node * other = &compiler->nodes[i];
+        if (other->interned && other->kind == node->kind &&
+            other->op == node->op && other->value == node->value &&
+            other->left == node->left && other->right == node->right)
+        {
+            return (int)i;
+        }
+    }
+    node->interned = 1;
+    return index;
+}
+
+/******************************************************************************
+ * @brief    Find or add an optimised constant
+ * @return   Index of the constant, or -1 if there is no room for it
+ ******************************************************************************/
+static int constant_node(expr_compiler * compiler, uint32_t value)
+{
+    for (size_t i = 0; i < compiler->node_count; i++)
+    {
+        const expr_node * node = &compiler->nodes[i];
+        if (node->interned && NODE_CONST == node->kind && value == node->value)
+        {
+            return (int)i;
+        }
+    }
+    if (CALC_EXPR_NODES_MAX == compiler->node_count)
+    {
+        return -1;
+    }
+
+    int index = add_node(compiler, NODE_CONST, CALC_OP_INVALID, value, 0, 0);
+    describe(compiler, &compiler->nodes[index]);
+    return intern(compiler, index);
+}
+
+/******************************************************************************
+ * @brief    Turn a node into left op value
+ * @return   1 if it was rewritten, 0 if there was no room for the constant
+ ******************************************************************************/
+static int rewrite(expr_compiler * compiler,
+                   int             index,
+                   calc_op         op,
+                   int             left,
+                   uint32_t        value)
+{
+    int right = constant_node(compiler, value);
+    if (right < 0)
+    {
+        return 0;
+    }
+
+    expr_node * node = &compiler->nodes[index];
+    node->op         = op;
+    node->left       = (uint8_t)left;
+    node->right      = (uint8_t)right;
+    return 1;
+}
+
+static void make_constant(expr_node * node, uint32_t value)
+{
+    node->kind  = NODE_CONST;
+    node->op    = CALC_OP_INVALID;
+    node->value = value;
+    node->left  = 0;
+    node->right = 0;
+}
+
+/******************************************************************************
+ * @brief    Fold and simplify an operator whose operands are optimised
+ *
+ * Every rewrite gives the same value and the same first failure as the
+ * original for all bindings: operators are only folded if they succeed,
+ * and an operand is only dropped if it cannot fail.
+ *
+ * @param    root    Set for the root, whose division must stay a division
+ * @return   Index of the node to use in place of index
+ ******************************************************************************/
+static int simplify(expr_compiler * compiler, int index, int root)
+{
+    expr_node *       node  = &compiler->nodes[index];
+    const expr_node * left  = &compiler->nodes[node->left];
+    const expr_node * right = &compiler->nodes[node->right];
+
+    if (NODE_OP != node->kind || (root && CALC_OP_DIV == node->op))
+    {
+        describe(compiler, node);
+        return index;
+    }
+
+    if (NODE_CONST == left->kind && NODE_CONST == right->kind)
+    {
+        calc_result folded = calc_execute(node->op, left->value, right->value);
+        if (CALC_OK == folded.status)
+        {
+            make_constant(node,
+                          (CALC_KIND_DOUBLE == folded.kind)
+                              ? (uint32_t)(int64_t)folded.value.as_double
+                              : folded.value.as_uint);
+            return simplify(compiler, index, root);
+        }
+    }
+    if (NODE_CONST == left->kind && NODE_CONST != right->kind &&
+        is_commutative(node->op))
+    {
+        // Constants go on the right; they cannot fail, so order is moot
+        uint8_t swap = node->left;
+        node->left   = node->right;
+        node->right  = swap;
+        return simplify(compiler, index, root);
+    }
+
+    int      pure  = !left->fallible;
+    uint32_t value = right->value;
+    if (NODE_CONST != right->kind)
+    {
+        // x op x, for the operators where that is x or 0
+        if (node->left == node->right &&
+            (CALC_OP_AND == node->op || CALC_OP_OR == node->op))
+        {
+            return node->left;
+        }
+        if (node->left == node->right && pure &&
+            (CALC_OP_XOR == node->op || CALC_OP_SUB == node->op))
+        {
+            make_constant(node, 0);
+            return simplify(compiler, index, root);
+        }
+        describe(compiler, node);
+        return index;
+    }
+
+    // Operators merged with a left operand of the same kind, and the
+    // value a constant right operand annihilates the operator with
+    int      chain    = NODE_OP == left->kind && node->op == left->op &&
+                NODE_CONST == compiler->nodes[left->right].kind;
+    uint32_t inner    = compiler->nodes[left->right].value;
+    int      absorbed = 0;
+    unsigned shift    = power_of_two(value);
+
+    switch (node->op)
+    {
+        case CALC_OP_ADD:
+        case CALC_OP_SUB:
+            if (0 == value)
+            {
+                return node->left;
+            }
+            break;
+        case CALC_OP_MUL:
+            if (1 == value)
+            {
+                return node->left;
+            }
+            absorbed = 0 == value;
+            // Strength reduction, where the product provably fits
+            if (0 != shift && left->bound <= (SIGNED_MAX >> shift) &&
+                rewrite(compiler, index, CALC_OP_SHL, node->left, shift))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_DIV:
+            if (1 == value)
+            {
+                return node->left; // Not the root, so truncated anyway
+            }
+            if (0 != shift && left->bound <= SIGNED_MAX &&
+                rewrite(compiler, index, CALC_OP_SHR, node->left, shift))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_MOD:
+            absorbed = 1 == value || UINT32_MAX == value; // 1 and -1
+            if (0 != shift && left->bound <= SIGNED_MAX &&
+                rewrite(
+                    compiler, index, CALC_OP_AND, node->left, value - 1))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_SHL:
+        case CALC_OP_SHR:
+            if (0 == value)
+            {
+                return node->left;
+            }
+            absorbed = value >= BITS_IN_UINT32;
+            // Any count of 32 or more shifts everything out
+            if (chain && !absorbed &&
+                rewrite(compiler,
+                        index,
+                        node->op,
+                        left->left,
+                        (uint32_t)MIN((uint64_t)inner + value,
+                                      BITS_IN_UINT32)))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_AND:
+        case CALC_OP_OR:
+        case CALC_OP_XOR:
+            if ((CALC_OP_AND == node->op)
+                    ? 0 == (cover_mask(left->bound) & ~value)
+                    : 0 == value)
+            {
+                return node->left;
+            }
+            absorbed = (CALC_OP_AND == node->op && 0 == value) ||
+                       (CALC_OP_OR == node->op && UINT32_MAX == value);
+            if (chain && !absorbed &&
+                rewrite(compiler,
+                        index,
+                        node->op,
+                        left->left,
+                        calc_execute(node->op, inner, value).value.as_uint))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_ROR:
+            // Only rotate left survives, and its count is taken mod 32
+            if (rewrite(compiler,
+                        index,
+                        CALC_OP_ROL,
+                        node->left,
+                        (BITS_IN_UINT32 - (value % BITS_IN_UINT32)) %
+                            BITS_IN_UINT32))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        case CALC_OP_ROL:
+            if (0 == value % BITS_IN_UINT32)
+            {
+                return node->left;
+            }
+            if ((chain || value >= BITS_IN_UINT32) &&
+                rewrite(compiler,
+                        index,
+                        CALC_OP_ROL,
+                        chain ? left->left : node->left,
+                        ((chain ? inner % BITS_IN_UINT32 : 0) +
+                         (value % BITS_IN_UINT32)) %
+                            BITS_IN_UINT32))
+            {
+                return simplify(compiler, index, root);
+            }
+            break;
+        default:
+            break;
+    }
+    if (absorbed && pure)
+    {
+        make_constant(
+            node, (CALC_OP_OR == node->op) ? UINT32_MAX : 0);
+        return simplify(compiler, index, root);
+    }
+
+    describe(compiler, node);
+    return index;
+}
+
+/******************************************************************************
+ * @brief    Optimise a subtree bottom up, sharing equal subtrees
+ * @return   Index of the node to use in place of index
+ ******************************************************************************/
+static int optimize(expr_compiler * compiler, int index, int root)
+{
+    expr_node * node = &compiler->nodes[index];
+
+    if (NODE_OP == node->kind)
+    {
+        node->left  = (uint8_t)optimize(compiler, node->left, 0);
+        node->right = (uint8_t)optimize(compiler, node->right, 0);
+    }
+    return intern(compiler, simplify(compiler, index, root));
+}
+
+/******************************************************************************
+ * @brief    Give every constant reachable from a node a register
+ ******************************************************************************/
+static void assign_constants(expr_compiler * compiler, int index)
+{
+    expr_node * node = &compiler->nodes[index];
+    calc_expr * expr = compiler->expr;
+
+    if (NODE_OP == node->kind)
+    {
+        assign_constants(compiler, node->left);
+        assign_constants(compiler, node->right);
+        return;
+    }
+    if (NODE_VAR == node->kind)
+    {
+        node->reg = (uint8_t)node->value;
+        return;
+    }
+
+    size_t slot = 0;
+    while (slot < expr->constant_count && expr->constants[slot] != node->value)
+    {
+        slot++;
+    }
+    if (slot == expr->constant_count)
+    {
+        expr->constants[expr->constant_count++] = node->value;
+    }
+    node->reg = (uint8_t)(expr->variable_count + slot);
+}
+
+/******************************************************************************
+ * @brief    Emit the code of a subtree in evaluation order, once per node
+ * @return   Register holding the subtree's value
+ ******************************************************************************/
+static uint8_t emit(expr_compiler * compiler, int index)
+{
+    expr_node * node = &compiler->nodes[index];
+    calc_expr * expr = compiler->expr;
+
+    // Operator registers come after every variable and constant, so 0
+    // marks a shared operator that has not been emitted yet
+    if (NODE_OP == node->kind && 0 == node->reg)
+    {
+        uint8_t     left  = emit(compiler, node->left);
+        uint8_t     right = emit(compiler, node->right);
+        calc_insn * insn  = &expr->code[expr->code_length++];
+
+        insn->op    = (uint8_t)node->op;
+        insn->left  = left;
+        insn->right = right;
+        insn->dest  = (uint8_t)expr->register_count++;
+        node->reg   = insn->dest;
+    }
+    return node->reg;
+}
+
+/******************************************************************************
+ * @brief    Allocate cleared memory from an arena, or the heap without one
+ ******************************************************************************/
+static void * expr_alloc(calc_arena * arena, size_t size)
+{
+    if (NULL == arena)
+    {
+        return calloc(1, size);
+    }
+
+    void * memory = calc_arena_alloc(arena, size);
+    if (NULL != memory)
+    {
+        memset(memory, 0, size);
+    }
+    return memory;
+}
+
+/******************************************************************************
+ * @brief    Compile an infix expression, allocating from arena if not NULL
+ ******************************************************************************/
+static calc_expr_status compile(calc_arena * arena,
+                                const char * text,
+                                calc_expr ** expr,
+                                size_t *     error_offset)
+{
+    expr_compiler * compiler = expr_alloc(arena, sizeof(*compiler));
+
+    *expr = NULL;
+    if (NULL != error_offset)
+    {
+        *error_offset = 0;
+    }
+    if (NULL == compiler)
+    {
+        return CALC_EXPR_NO_MEMORY;
+    }
+    compiler->text   = text;
+    compiler->cursor = text;
+    compiler->expr   = expr_alloc(arena, sizeof(*compiler->expr));
+    if (NULL == compiler->expr)
+    {
+        if (NULL == arena)
+        {
+            free(compiler);
+        }
+        return CALC_EXPR_NO_MEMORY;
+    }
+    compiler->expr->in_arena = (NULL != arena);
+
+    int root = parse_binary(compiler, 0);
+    skip_space(compiler);
+    if (root >= 0 && '\0' != *compiler->cursor)
+    {
+        root = fail(compiler, CALC_EXPR_SYNTAX_ERROR);
+    }
+
+    calc_expr_status status = compiler->status;
+    if (CALC_EXPR_OK == status)
+    {
+        calc_expr * compiled = compiler->expr;
+        // The kind is the written root's, whatever it is optimised to
+        compiled->kind = (NODE_OP == compiler->nodes[root].kind)
+                             ? calc_op_kind(compiler->nodes[root].op)
+                             : CALC_KIND_UINT;
+        root           = optimize(compiler, root, 1);
+        assign_constants(compiler, root);
+        compiled->register_count =
+            compiled->variable_count + compiled->constant_count;
+        compiled->result = emit(compiler, root);
+        *expr            = compiled;
+    }
+    else if (NULL != error_offset)
+    {
+        *error_offset = (size_t)(compiler->cursor - text);
+    }
+    if (NULL == arena)
+    {
+        if (CALC_EXPR_OK != status)
+        {
+            free(compiler->expr);
+        }
+        free(compiler);
+    }
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Compile an infix expression
+ * @param    text            Expression, NUL terminated
+ * @param    expr            Set to the compiled expression, or NULL on error
+ * @param    error_offset    Set to where an error was found; may be NULL
+ * @return   CALC_EXPR_OK, or why the expression could not be compiled
+ ******************************************************************************/
+calc_expr_status calc_expr_compile(const char * text,
+                                   calc_expr ** expr,
+                                   size_t *     error_offset)
+{
+    return compile(NULL, text, expr, error_offset);
+}
+
+/******************************************************************************
+ * @brief    Compile an infix expression into an arena, for expressions that
+ *           live no longer than a batch or request
+ * @param    arena           Arena holding the expression and the compiler's
+ *                           scratch; resetting it releases both
+ * @param    text            Expression, NUL terminated
+ * @param    expr            Set to the compiled expression, or NULL on error
+ * @param    error_offset    Set to where an error was found; may be NULL
+ * @return   CALC_EXPR_OK, or why the expression could not be compiled
+ ******************************************************************************/
+calc_expr_status calc_expr_compile_in(calc_arena * arena,
+                                      const char * text,
+                                      calc_expr ** expr,
+                                      size_t *     error_offset)
+{
+    return compile(arena, text, expr, error_offset);
+}
+
+/******************************************************************************
+ * @brief    Release a compiled expression; one compiled into an arena only
+ *           releases its native code, and must be freed before the arena is
+ *           reset if it was JIT compiled
+ * @param    expr    Expression, may be NULL
+ ******************************************************************************/
+void calc_expr_free(calc_expr * expr)
+{
+    if (NULL != expr)
+    {
+        calc_jit_release(expr);
+        if (!expr->in_arena)
+        {
+            free(expr);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Number of variables an expression is evaluated against
+ ******************************************************************************/
+size_t calc_expr_variable_count(const calc_expr * expr)
+{
+    return expr->variable_count;
+}
+
+/******************************************************************************
+ * @brief    Kind of an expression's result: CALC_KIND_DOUBLE if its root is
+ *           a division, CALC_KIND_UINT otherwise
+ ******************************************************************************/
+calc_kind calc_expr_kind(const calc_expr * expr)
+{
+    return expr->kind;
+}
+
+/******************************************************************************
+ * @brief    Name of a variable, in order of first appearance
+ * @param    expr    Compiled expression
+ * @param    index   Variable index, below calc_expr_variable_count
+ * @return   Variable name
+ ******************************************************************************/
+const char * calc_expr_variable_name(const calc_expr * expr, size_t index)
+{
+    return expr->names[index];
+}
+
+/******************************************************************************
+ * @brief    Look a variable up by name
+ * @param    expr    Compiled expression
+ * @param    name    Name, need not be NUL terminated
+ * @param    length  Length of name
+ * @return   Variable index, or calc_expr_variable_count if there is none
+ ******************************************************************************/
+size_t calc_expr_find_variable(const calc_expr * expr,
+                               const char *      name,
+                               size_t            length)
+{
+    size_t index = 0;
+
+    while (index < expr->variable_count &&
+           !(length < CALC_EXPR_NAME_MAX &&
+             0 == strncmp(expr->names[index], name, length) &&
+             '\0' == expr->names[index][length]))
+    {
+        index++;
+    }
+    return index;
+}
+
+// Signed operators write status and their int32 result into the register
+#define EVAL_INT(function)                                                 \
+    {                                                                      \
+        int32_t value = 0;                                                 \
+        status = function((int32_t)left, (int32_t)right, &value);          \
+        registers[insn->dest] = (uint32_t)value;                           \
+    }                                                                      \
+    break
+
+#define EVAL_UINT(function)                                                \
+    registers[insn->dest] = function(left, right);                         \
+    break
+
+/******************************************************************************
+ * @brief    Evaluate a compiled expression
+ * @param    expr        Compiled expression
+ * @param    bindings    Value of each variable, by index; may be NULL if
+ *                       the expression has none
+ * @return   Result of the first operator that failed, or of the expression
+ ******************************************************************************/
+calc_result calc_expr_eval(const calc_expr * expr, const uint32_t * bindings)
+{
+    uint32_t    registers[CALC_EXPR_NODES_MAX];
+    double      quotient = 0.0;
+    calc_result result   = { CALC_OK, expr->kind, { 0 } };
+
+    if (NULL != expr->jit)
+    {
+        result.status = expr->jit(bindings, registers, &quotient);
+        if (CALC_KIND_DOUBLE == expr->kind)
+        {
+            result.value.as_double = quotient;
+        }
+        else if (CALC_OK == result.status)
+        {
+            result.value.as_uint = registers[expr->result];
+        }
+        return result;
+    }
+
+    if (0 != expr->variable_count)
+    {
+        memcpy(registers, bindings, expr->variable_count * sizeof(uint32_t));
+    }
+    memcpy(registers + expr->variable_count,
+           expr->constants,
+           expr->constant_count * sizeof(uint32_t));
+
+    for (size_t i = 0; i < expr->code_length; i++)
+    {
+        const calc_insn * insn   = &expr->code[i];
+        uint32_t          left   = registers[insn->left];
+        uint32_t          right  = registers[insn->right];
+        calc_status       status = CALC_OK;
+
+        switch ((calc_op)insn->op)
+        {
+            case CALC_OP_ADD:
+                EVAL_INT(perform_addition);
+            case CALC_OP_SUB:
+                EVAL_INT(perform_subtraction);
+            case CALC_OP_MUL:
+                EVAL_INT(perform_multiplication);
+            case CALC_OP_MOD:
+                EVAL_INT(perform_modulo);
+            case CALC_OP_DIV:
+                status = perform_division(
+                    (int32_t)left, (int32_t)right, &quotient);
+                registers[insn->dest] = (uint32_t)(int64_t)quotient;
+                break;
+            case CALC_OP_SHL:
+                EVAL_UINT(perform_left_shift);
+            case CALC_OP_SHR:
+                EVAL_UINT(perform_right_shift);
+            case CALC_OP_AND:
+                EVAL_UINT(perform_and);
+            case CALC_OP_OR:
+                EVAL_UINT(perform_or);
+            case CALC_OP_XOR:
+                EVAL_UINT(perform_xor);
+            case CALC_OP_ROL:
+                EVAL_UINT(rotate_left);
+            case CALC_OP_ROR:
+                EVAL_UINT(rotate_right);
+            default:
+                status = CALC_ERR_UNSUPPORTED_OPERATOR;
+                break;
+        }
+        if (CALC_OK != status)
+        {
+            result.status = status;
+            return result;
+        }
+    }
+
+    if (CALC_KIND_DOUBLE == expr->kind)
+    {
+        result.value.as_double = quotient; // The root is the last instruction
+    }
+    else
+    {
+        result.value.as_uint = registers[expr->result];
+    }
+    return result;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a compiled expression against many sets of bindings
+ * @param    expr        Compiled expression
+ * @param    bindings    count rows of calc_expr_variable_count values
+ * @param    results     Result of each row
+ * @param    count       Number of rows
+ * @return   Number of rows that failed
+ ******************************************************************************/
+size_t calc_expr_eval_array(const calc_expr * expr,
+                            const uint32_t *  bindings,
+                            calc_result *     results,
+                            size_t            count)
+{
+    size_t failed = 0;
+
+    for (size_t row = 0; row < count; row++)
+    {
+        results[row] =
+            calc_expr_eval(expr, bindings + (row * expr->variable_count));
+        failed += (CALC_OK != results[row].status);
+    }
+    return failed;
+}
+
+/******************************************************************************
+ * @brief    Where each register's column lives while a block is evaluated
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t slot[CALC_EXPR_NODES_MAX];      // Scratch column of each
+                                            // temporary
+    uint8_t last_use[CALC_EXPR_NODES_MAX];  // Last instruction reading it
+    uint8_t splat;                          // Column for a constant on the
+                                            // left, if any
+    size_t  slots;
+    size_t  rows;                           // Rows per block
+} column_plan;
+
+/******************************************************************************
+ * @brief    Give every temporary a scratch column, reusing those of values
+ *           that are no longer read, and size the blocks to fit them all
+ *           in EXPR_SCRATCH_WORDS
+ ******************************************************************************/
+static void plan_columns(const calc_expr * expr, column_plan * plan)
+{
+    uint8_t free_slots[CALC_EXPR_NODES_MAX + 1];
+    size_t  free_count = 0;
+    size_t  first_temp = expr->variable_count + expr->constant_count;
+    int     splat      = 0;
+
+    memset(plan->last_use, 0, sizeof(plan->last_use));
+    for (size_t i = 0; i < expr->code_length; i++)
+    {
+        const calc_insn * insn = &expr->code[i];
+        plan->last_use[insn->left]  = (uint8_t)i;
+        plan->last_use[insn->right] = (uint8_t)i;
+        splat |= (insn->left >= expr->variable_count &&
+                  insn->left < first_temp);
+    }
+
+    plan->slots = 0;
+    for (size_t i = 0; i < expr->code_length; i++)
+    {
+        const calc_insn * insn = &expr->code[i];
+
+        // Operands are released only after the result has its own column:
+        // a kernel that fails rereads its operands to find the failed rows
+        plan->slot[insn->dest] = (0 != free_count)
+                                     ? free_slots[--free_count]
+                                     : (uint8_t)plan->slots++;
+        for (int side = 0; side < 2; side++)
+        {
+            uint8_t reg = side ? insn->right : insn->left;
+            if (reg >= first_temp && i == plan->last_use[reg] &&
+                (0 == side || insn->left != insn->right))
+            {
+                free_slots[free_count++] = plan->slot[reg];
+            }
+        }
+    }
+    plan->splat = (uint8_t)plan->slots;
+    plan->slots += (size_t)splat;
+
+    // Whole mask bytes per block, at most EXPR_BLOCK rows
+    size_t rows = (0 == plan->slots) ? EXPR_BLOCK
+                                     : EXPR_SCRATCH_WORDS / plan->slots;
+    rows       = MIN(rows, EXPR_BLOCK);
+    plan->rows = rows - (rows % LANES_PER_BYTE);
+}
+
+/******************************************************************************
+ * @brief    Value of a constant register
+ ******************************************************************************/
+static uint32_t constant_of(const calc_expr * expr, uint8_t reg)
+{
+    return expr->constants[reg - expr->variable_count];
+}
+
+/******************************************************************************
+ * @brief    Column of a variable or temporary for the current block
+ * @param    start   First row of the block
+ ******************************************************************************/
+static const uint32_t * column_of(const calc_expr *       expr,
+                                  const column_plan *     plan,
+                                  const uint32_t * const * columns,
+                                  uint32_t *              scratch,
+                                  uint8_t                 reg,
+                                  size_t                  start)
+{
+    if (reg < expr->variable_count)
+    {
+        return columns[reg] + start;
+    }
+    return scratch + (plan->slot[reg] * plan->rows);
+}
+
+/******************************************************************************
+ * @brief    Copy the result of an expression whose root is no instruction of
+ *           its own into the results of a block
+ ******************************************************************************/
+static void copy_result(const calc_expr *       expr,
+                        const column_plan *     plan,
+                        const uint32_t * const * columns,
+                        uint32_t *              scratch,
+                        uint32_t *              results,
+                        size_t                  start,
+                        size_t                  rows)
+{
+    uint8_t reg = expr->result;
+
+    if (reg >= expr->variable_count &&
+        reg < expr->variable_count + expr->constant_count)
+    {
+        for (size_t row = 0; row < rows; row++)
+        {
+            results[start + row] = constant_of(expr, reg);
+        }
+        return;
+    }
+    memcpy(results + start,
+           column_of(expr, plan, columns, scratch, reg, start),
+           rows * sizeof(uint32_t));
+}
+
+/******************************************************************************
+ * @brief    Divide a block of rows, without a branch on the divisor
+ * @param    quotients   Set to the quotients, for the root division; or NULL
+ * @param    truncated   Set to the quotients truncated to 32 bits otherwise
+ * @return   1 if any row divided by zero, 0 otherwise
+ ******************************************************************************/
+static int divide_column(const uint32_t * operand1,
+                         const uint32_t * operand2,
+                         double *         quotients,
+                         uint32_t *       truncated,
+                         uint8_t *        error_mask,
+                         size_t           rows)
+{
+    unsigned sticky = 0;
+
+    for (size_t i = 0; i < rows; i++)
+    {
+        int32_t  divisor  = (int32_t)operand2[i];
+        unsigned zero     = (0 == divisor);
+        double   quotient = (double)(int32_t)operand1[i] /
+                          (double)(zero ? 1 : divisor);
+
+        if (NULL != quotients)
+        {
+            quotients[i] = quotient;
+        }
+        else
+        {
+            truncated[i] = (uint32_t)(int64_t)quotient;
+        }
+        sticky |= zero;
+    }
+    memset(error_mask, 0, (rows + LANES_PER_BYTE - 1) / LANES_PER_BYTE);
+    for (size_t i = 0; 0 != sticky && i < rows; i++)
+    {
+        error_mask[i / LANES_PER_BYTE] |=
+            (uint8_t)((unsigned)(0 == operand2[i]) << (i % LANES_PER_BYTE));
+    }
+    return 0 != sticky;
+}
+
+/******************************************************************************
+ * @brief    Evaluate a compiled expression over whole columns of bindings
+ * @param    expr        Compiled expression
+ * @param    columns     count values of each variable, by index; may be NULL
+ *                       if the expression has none
+ * @param    results     count results: uint32_t, or double when
+ *                       calc_expr_kind is CALC_KIND_DOUBLE; rows that
+ *                       failed are unspecified. Must not overlap columns.
+ * @param    error_mask  Set to the failed rows, laid out as for calc_apply;
+ *                       may be NULL
+ * @param    count       Number of rows
+ * @return   Number of rows that failed; calc_expr_eval on the bindings of
+ *           one gives its status
+ * @note     Each instruction runs over a block of rows at a time with the
+ *           array kernels, so dispatch is paid once per block rather than
+ *           per row. Intermediate columns of a block stay within
+ *           EXPR_SCRATCH_WORDS, and a column is reused once nothing reads
+ *           it. Every instruction runs on every row, so a row that has
+ *           failed goes on with an unspecified value; its later failures
+ *           only set the same mask bit. Native code from calc_expr_jit is
+ *           not used.
+ ******************************************************************************/
+size_t calc_expr_eval_columns(const calc_expr *       expr,
+                              const uint32_t * const * columns,
+                              void *                  results,
+                              uint8_t *               error_mask,
+                              size_t                  count)
+{
+    uint32_t    scratch[EXPR_SCRATCH_WORDS];
+    uint8_t     insn_mask[EXPR_BLOCK / LANES_PER_BYTE];
+    uint8_t     block_mask[EXPR_BLOCK / LANES_PER_BYTE];
+    column_plan plan;
+    size_t      failed      = 0;
+    size_t      first_temp  = expr->variable_count + expr->constant_count;
+    int         is_double   = (CALC_KIND_DOUBLE == expr->kind);
+    uint32_t *  integers    = results;
+    double *    quotients   = results;
+    size_t      last        = expr->code_length - 1; // Unused without code
+
+    plan_columns(expr, &plan);
+
+    for (size_t start = 0; start < count; start += plan.rows)
+    {
+        size_t rows       = MIN(plan.rows, count - start);
+        size_t mask_bytes = (rows + LANES_PER_BYTE - 1) / LANES_PER_BYTE;
+        int    any        = 0;
+
+        for (size_t i = 0; i < expr->code_length; i++)
+        {
+            const calc_insn * insn  = &expr->code[i];
+            calc_op           op    = (calc_op)insn->op;
+            int               root  =
+                (i == last && (is_double || insn->dest == expr->result));
+            uint32_t *        dest  =
+                (root && !is_double)
+                    ? integers + start
+                    : scratch + (plan.slot[insn->dest] * plan.rows);
+            const uint32_t *  left  = NULL;
+            int               fails = 0;
+
+            if (insn->left >= expr->variable_count && insn->left < first_temp)
+            {
+                uint32_t * splat = scratch + (plan.splat * plan.rows);
+                for (size_t row = 0; row < rows; row++)
+                {
+                    splat[row] = constant_of(expr, insn->left);
+                }
+                left = splat;
+            }
+            else
+            {
+                left = column_of(
+                    expr, &plan, columns, scratch, insn->left, start);
+            }
+
+            if (CALC_OP_DIV == op)
+            {
+                const uint32_t * right = NULL;
+                uint32_t         divisor[EXPR_BLOCK];
+
+                if (insn->right >= expr->variable_count &&
+                    insn->right < first_temp)
+                {
+                    for (size_t row = 0; row < rows; row++)
+                    {
+                        divisor[row] = constant_of(expr, insn->right);
+                    }
+                    right = divisor;
+                }
+                else
+                {
+                    right = column_of(
+                        expr, &plan, columns, scratch, insn->right, start);
+                }
+                fails = divide_column(left,
+                                      right,
+                                      (root && is_double) ? quotients + start
+                                                          : NULL,
+                                      dest,
+                                      insn_mask,
+                                      rows);
+            }
+            else if (insn->right >= expr->variable_count &&
+                     insn->right < first_temp)
+            {
+                fails = CALC_OK != calc_apply_const(
+                                       op,
+                                       left,
+                                       constant_of(expr, insn->right),
+                                       dest,
+                                       insn_mask,
+                                       rows);
+            }
+            else
+            {
+                fails = CALC_OK !=
+                        calc_apply(op,
+                                   left,
+                                   column_of(expr,
+                                             &plan,
+                                             columns,
+                                             scratch,
+                                             insn->right,
+                                             start),
+                                   dest,
+                                   insn_mask,
+                                   rows);
+            }
+
+            // The block's failures are gathered only once an operator fails
+            if (fails)
+            {
+                if (!any)
+                {
+                    memset(block_mask, 0, mask_bytes);
+                    any = 1;
+                }
+                for (size_t byte = 0; byte < mask_bytes; byte++)
+                {
+                    block_mask[byte] |= insn_mask[byte];
+                }
+            }
+        }
+
+        // An expression without an operator is a variable or a constant
+        if (!is_double && (0 == expr->code_length ||
+                           expr->code[last].dest != expr->result))
+        {
+            copy_result(expr, &plan, columns, scratch, integers, start, rows);
+        }
+
+        if (NULL != error_mask)
+        {
+            uint8_t * mask = error_mask + (start / LANES_PER_BYTE);
+            if (any)
+            {
+                memcpy(mask, block_mask, mask_bytes);
+            }
+            else
+            {
+                memset(mask, 0, mask_bytes);
+            }
+        }
+        for (size_t byte = 0; any && byte < mask_bytes; byte++)
+        {
+            failed += (size_t)__builtin_popcount(block_mask[byte]);
+        }
+    }
+    return failed;
+}
+
+/******************************************************************************
+ * @brief    Describe an expression compile status
+ * @return   Error message (without trailing newline)
+ ******************************************************************************/
+const char * calc_expr_status_message(calc_expr_status status)
+{
+    switch (status)
+    {
+        case CALC_EXPR_OK:
+            return "Success.";
+        case CALC_EXPR_SYNTAX_ERROR:
+            return "Error! Invalid expression.";
+        case CALC_EXPR_BAD_LITERAL:
+            return "Error! Invalid literal.";
+        case CALC_EXPR_TOO_LARGE:
+            return "Error! Expression too large.";
+        case CALC_EXPR_NO_MEMORY:
+            return "Error! Out of memory.";
+    }
+    return "Error! Unknown status.";
+}
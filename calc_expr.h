@@ -0,0 +1,66 @@
+/******************************************************************************
+ * @file    calc_expr.h
+ * @brief   Compiled expression layout, shared by the expression back ends
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#ifndef CALC_EXPR_H
+#define CALC_EXPR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "calc.h"
+
+// Most tree nodes, and so registers, in one expression; fits a uint8_t
+#define CALC_EXPR_NODES_MAX 255
+
+/******************************************************************************
+ * @brief    Three-address instruction: dest = left op right
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t op; // calc_op
+    uint8_t dest;
+    uint8_t left;
+    uint8_t right;
+} calc_insn;
+
+/******************************************************************************
+ * @brief    Native code of an expression: evaluates it against bindings,
+ *           using registers for temporaries, and stores the quotient of the
+ *           last division executed
+ * @return   CALC_OK, or the status of the first operator that failed
+ ******************************************************************************/
+typedef calc_status (*calc_jit_fn)(const uint32_t * bindings,
+                                   uint32_t *       registers,
+                                   double *         quotient);
+
+/******************************************************************************
+ * @brief    Compiled expression
+ *
+ * Registers 0 to variable_count - 1 hold the bindings, the next
+ * constant_count hold constants[], and every instruction writes a register
+ * of its own after those. The code is in evaluation order, so when the
+ * result is a double it comes from the last instruction.
+ ******************************************************************************/
+struct calc_expr
+{
+    calc_kind   kind;
+    size_t      variable_count;
+    size_t      constant_count;
+    size_t      register_count;
+    size_t      code_length;
+    uint8_t     result; // Register holding an integer result
+    uint32_t    constants[CALC_EXPR_NODES_MAX];
+    calc_insn   code[CALC_EXPR_NODES_MAX];
+    char        names[CALC_EXPR_VARIABLES_MAX][CALC_EXPR_NAME_MAX];
+    calc_jit_fn jit; // Native code from calc_expr_jit, NULL if interpreted
+    void *      jit_code;
+    size_t      jit_size;
+    int         in_arena; // Released with its arena, not calc_expr_free
+};
+
+void calc_jit_release(calc_expr * expr);
+
+#endif // CALC_EXPR_H
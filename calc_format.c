@@ -0,0 +1,981 @@
+/******************************************************************************
+ * @file    calc_format.c
+ * @brief   Result formatting and buffered output
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "calc.h"
+
+#define DOUBLE_FRACTION_BITS 52
+#define DOUBLE_EXPONENT_BIAS 1075 // Bias plus fraction bits
+#define DOUBLE_EXPONENT_MASK 0x7FF
+#define FIXED2_LIMIT         (1ull << 53) // Larger values use snprintf
+#define UINT64_DIGITS        19 // Decimal digits that always fit a uint64_t
+#define UINT64_POWER         10000000000000000000ull // 10^UINT64_DIGITS
+#define BIG_FORMAT_LOCAL     32 // Limbs formatted without allocating
+#define SHORTEST_DIGITS_MAX  17 // Enough to tell any two doubles apart
+#define SHORTEST_PLAIN_MAX   21 // Larger decimal exponents print as 1e+21
+#define SHORTEST_PLAIN_MIN   -6 // Smaller ones print as 1e-7
+#define SHORTEST_LIMIT       ((calc_uint128)1 << 124) // Times ten still fits
+
+static const char result_prefix[] = "Result: ";
+
+// Room left in a CALC_FORMAT_MAX line after the prefix and the newline
+#define FIXED2_FALLBACK_MAX \
+    (CALC_FORMAT_MAX - (sizeof(result_prefix) - 1) - 1)
+
+// 10^0 to 10^UINT64_DIGITS
+static const uint64_t powers_of_ten[UINT64_DIGITS + 1] = {
+    1ull,
+    10ull,
+    100ull,
+    1000ull,
+    10000ull,
+    100000ull,
+    1000000ull,
+    10000000ull,
+    100000000ull,
+    1000000000ull,
+    10000000000ull,
+    100000000000ull,
+    1000000000000ull,
+    10000000000000ull,
+    100000000000000ull,
+    1000000000000000ull,
+    10000000000000000ull,
+    100000000000000000ull,
+    1000000000000000000ull,
+    UINT64_POWER
+};
+
+// "00" to "99", so two digits are produced per table lookup
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+/******************************************************************************
+ * @brief    Write an unsigned value in decimal
+ * @param    out     Destination, at least 20 bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ ******************************************************************************/
+static size_t format_uint64(char * out, uint64_t value)
+{
+    char   scratch[20];
+    char * cursor = scratch + sizeof(scratch);
+
+    while (value >= 100)
+    {
+        const char * pair = &digit_pairs[(value % 100) * 2];
+        value /= 100;
+        cursor -= 2;
+        memcpy(cursor, pair, 2);
+    }
+    if (value >= 10)
+    {
+        cursor -= 2;
+        memcpy(cursor, &digit_pairs[value * 2], 2);
+    }
+    else
+    {
+        *--cursor = (char)('0' + value);
+    }
+
+    size_t length = (size_t)(scratch + sizeof(scratch) - cursor);
+    memcpy(out, cursor, length);
+    return length;
+}
+
+/******************************************************************************
+ * @brief    Write a 128-bit unsigned value in decimal
+ * @param    out     Destination, at least 39 bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ ******************************************************************************/
+static size_t format_uint128(char * out, calc_uint128 value)
+{
+    if (value <= UINT64_MAX)
+    {
+        return format_uint64(out, (uint64_t)value);
+    }
+
+    // The high digits, then the low UINT64_DIGITS padded with zeros
+    char     low[20];
+    size_t   length = format_uint128(out, value / UINT64_POWER);
+    size_t   digits = format_uint64(low, (uint64_t)(value % UINT64_POWER));
+    size_t   zeros  = UINT64_DIGITS - digits;
+
+    memset(out + length, '0', zeros);
+    memcpy(out + length + zeros, low, digits);
+    return length + UINT64_DIGITS;
+}
+
+/******************************************************************************
+ * @brief    Format an unsigned result as printf("%u") would
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ ******************************************************************************/
+size_t calc_format_uint32(char * out, uint32_t value)
+{
+    return format_uint64(out, value);
+}
+
+/******************************************************************************
+ * @brief    Format a signed result as printf("%d") would
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ ******************************************************************************/
+size_t calc_format_int32(char * out, int32_t value)
+{
+    if (value < 0)
+    {
+        *out = '-';
+        return 1 + format_uint64(out + 1, 0u - (uint64_t)(int64_t)value);
+    }
+    return format_uint64(out, (uint64_t)value);
+}
+
+/******************************************************************************
+ * @brief    Format a double as printf("%.2f") would, using integer arithmetic
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ * @note     The exact binary value is rounded to hundredths, ties to even,
+ *           which is what glibc does in the default rounding mode.
+ ******************************************************************************/
+size_t calc_format_fixed2(char * out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int      negative = (int)(bits >> 63);
+    int      exponent = (int)((bits >> DOUBLE_FRACTION_BITS) &
+                         DOUBLE_EXPONENT_MASK);
+    uint64_t mantissa = bits & ((1ull << DOUBLE_FRACTION_BITS) - 1);
+    uint64_t hundredths;
+
+    if (DOUBLE_EXPONENT_MASK == exponent ||
+        (value < 0 ? -value : value) >= (double)FIXED2_LIMIT)
+    {
+        // Infinities, NaN and huge values (which no int32 division yields)
+        // keep the libc behaviour, cut to what fits in a result line
+        char scratch[FIXED2_FALLBACK_MAX + 1];
+        int  length = snprintf(scratch, sizeof(scratch), "%.2f", value);
+        if (length < 0)
+        {
+            return 0;
+        }
+        if ((size_t)length > FIXED2_FALLBACK_MAX)
+        {
+            length = FIXED2_FALLBACK_MAX;
+        }
+        memcpy(out, scratch, (size_t)length);
+        return (size_t)length;
+    }
+
+    // value = mantissa * 2^exponent with an integer mantissa
+    if (0 == exponent)
+    {
+        exponent = 1 - DOUBLE_EXPONENT_BIAS;
+    }
+    else
+    {
+        mantissa |= 1ull << DOUBLE_FRACTION_BITS;
+        exponent -= DOUBLE_EXPONENT_BIAS;
+    }
+
+    if (exponent >= 0)
+    {
+        hundredths = (mantissa << exponent) * 100;
+    }
+    else if (-exponent < 64)
+    {
+        // mantissa < 2^53, so 100 * mantissa cannot overflow
+        unsigned shift     = (unsigned)-exponent;
+        uint64_t scaled    = mantissa * 100;
+        uint64_t remainder = scaled & ((1ull << shift) - 1);
+        uint64_t half      = 1ull << (shift - 1);
+
+        hundredths = scaled >> shift;
+        if (remainder > half || (remainder == half && (hundredths & 1)))
+        {
+            hundredths++;
+        }
+    }
+    else
+    {
+        hundredths = 0; // Below 2^-11, so nowhere near 0.005
+    }
+
+    size_t length = 0;
+    if (negative)
+    {
+        out[length++] = '-';
+    }
+    length += format_uint64(out + length, hundredths / 100);
+    out[length++] = '.';
+    memcpy(out + length, &digit_pairs[(hundredths % 100) * 2], 2);
+    return length + 2;
+}
+
+/******************************************************************************
+ * @brief    10^exponent, for exponents up to 38
+ ******************************************************************************/
+static calc_uint128 power_of_ten(unsigned exponent)
+{
+    if (exponent <= UINT64_DIGITS)
+    {
+        return powers_of_ten[exponent];
+    }
+    return power_of_ten(exponent - UINT64_DIGITS) * UINT64_POWER;
+}
+
+/******************************************************************************
+ * @brief    Shortest digits of a positive finite double that read back as it
+ * @param    value       Value, positive and finite
+ * @param    digits      Set to the digits, SHORTEST_DIGITS_MAX at most
+ * @param    exponent    Set so that value reads as 0.<digits> * 10^exponent
+ * @return   Number of digits, or 0 if value is too far from 1 for 128-bit
+ *           arithmetic (no quotient of 32-bit integers is)
+ *
+ * This is the free-format algorithm of Steele & White as refined by Burger &
+ * Dybvig: value and the midpoints to its neighbours are scaled to r / s,
+ * (r - minus) / s and (r + plus) / s, and digits are generated until the
+ * digits so far, rounded, lie between the midpoints. Where the midpoints
+ * round to value itself (an even mantissa), they count as inside. A general
+ * implementation such as Ryu needs tables or bignums for this; 32-bit
+ * quotients keep s below 2^120, so 128-bit integers do.
+ ******************************************************************************/
+static size_t shortest_digits(double value, char * digits, int * exponent)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    int      biased   = (int)((bits >> DOUBLE_FRACTION_BITS) &
+                       DOUBLE_EXPONENT_MASK);
+    uint64_t fraction = bits & ((1ull << DOUBLE_FRACTION_BITS) - 1);
+    uint64_t mantissa = fraction;
+    int      binary   = 1 - DOUBLE_EXPONENT_BIAS;
+
+    if (0 != biased)
+    {
+        mantissa |= 1ull << DOUBLE_FRACTION_BITS;
+        binary = biased - DOUBLE_EXPONENT_BIAS;
+    }
+
+    // Above a power of two the gap is twice the one below, so everything
+    // is doubled once more to keep the lower midpoint a whole number
+    unsigned     unequal = (0 == fraction && biased > 1);
+    int          even    = (0 == (mantissa & 1));
+    calc_uint128 r;
+    calc_uint128 s;
+    calc_uint128 minus;
+
+    if (binary > 60 || binary < -120)
+    {
+        return 0;
+    }
+    if (binary >= 0)
+    {
+        r     = (calc_uint128)mantissa << (binary + 1 + (int)unequal);
+        s     = (calc_uint128)2 << unequal;
+        minus = (calc_uint128)1 << binary;
+    }
+    else
+    {
+        r     = (calc_uint128)mantissa << (1 + unequal);
+        s     = (calc_uint128)1 << (1 - binary + (int)unequal);
+        minus = 1;
+    }
+    calc_uint128 plus = minus << unequal;
+
+    // Estimate the decimal exponent from the binary one (1233 / 4096 is
+    // just over log10(2)), scale by it, then correct it by one if need be
+    int top = binary + 63 - __builtin_clzll(mantissa);
+    int k   = (top >= 0) ? (top * 1233) / 4096 + 1
+                         : 1 - (-top * 1233 + 4095) / 4096;
+    if (k >= 0)
+    {
+        calc_uint128 power = power_of_ten((unsigned)k);
+        if (s > SHORTEST_LIMIT / power)
+        {
+            return 0;
+        }
+        s *= power;
+    }
+    else
+    {
+        calc_uint128 power = power_of_ten((unsigned)-k);
+        if (r + plus > SHORTEST_LIMIT / power)
+        {
+            return 0;
+        }
+        r *= power;
+        plus *= power;
+        minus *= power;
+    }
+    while (even ? r + plus >= s : r + plus > s)
+    {
+        if (s > SHORTEST_LIMIT / 10)
+        {
+            return 0;
+        }
+        s *= 10;
+        k++;
+    }
+    while (even ? (r + plus) * 10 < s : (r + plus) * 10 <= s)
+    {
+        r *= 10;
+        plus *= 10;
+        minus *= 10;
+        k--;
+    }
+
+    size_t count = 0;
+    for (;;)
+    {
+        r *= 10;
+        plus *= 10;
+        minus *= 10;
+
+        unsigned digit = (unsigned)(r / s);
+        r %= s;
+
+        int low  = even ? r <= minus : r < minus;
+        int high = even ? r + plus >= s : r + plus > s;
+        if (low || high)
+        {
+            // Round up if only that stays inside, or both do and it is closer
+            if (high && (!low || 2 * r > s || (2 * r == s && (digit & 1))))
+            {
+                digit++;
+            }
+            digits[count++] = (char)('0' + digit);
+            break;
+        }
+        digits[count++] = (char)('0' + digit);
+    }
+    *exponent = k;
+    return count;
+}
+
+/******************************************************************************
+ * @brief    shortest_digits for any positive finite double, by trying ever
+ *           more digits with snprintf until strtod reads value back
+ *
+ * The correctly rounded digits are not always the ones that read back with
+ * the fewest digits: below a power of two the gap to the next double is
+ * half the one above, so the last digit one up or down is tried as well.
+ ******************************************************************************/
+static size_t shortest_fallback(double value, char * digits, int * exponent)
+{
+    char     text[40];
+    uint64_t candidate = 0;
+    int      scale     = 0;
+
+    for (int precision = 1; precision <= SHORTEST_DIGITS_MAX; precision++)
+    {
+        snprintf(text, sizeof(text), "%.*e", precision - 1, value);
+
+        // text reads d[.ddd]e<exponent>: take it as candidate * 10^scale
+        const char * cursor = text;
+        for (candidate = 0; 'e' != *cursor; cursor++)
+        {
+            if ('.' != *cursor)
+            {
+                candidate = (candidate * 10) + (uint64_t)(*cursor - '0');
+            }
+        }
+        scale = atoi(cursor + 1) - (precision - 1);
+
+        const uint64_t tries[] = { candidate, candidate + 1, candidate - 1 };
+        size_t         choice  = 0;
+        for (; choice < sizeof(tries) / sizeof(tries[0]); choice++)
+        {
+            snprintf(
+                text, sizeof(text), "%" PRIu64 "e%d", tries[choice], scale);
+            if (0 != tries[choice] && strtod(text, NULL) == value)
+            {
+                break;
+            }
+        }
+        if (choice < sizeof(tries) / sizeof(tries[0]))
+        {
+            candidate = tries[choice];
+            break;
+        }
+    }
+
+    size_t count = format_uint64(digits, candidate);
+    *exponent    = (int)count + scale;
+    while (count > 1 && '0' == digits[count - 1])
+    {
+        count--;
+    }
+    return count;
+}
+
+/******************************************************************************
+ * @brief    Format a double as the shortest decimal that reads back as it
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    value   Value to format
+ * @return   Number of characters written (not NUL terminated)
+ * @note     Laid out as JavaScript prints numbers: plainly from 1e-6 to
+ *           below 1e21, such as 0.3333333333333333 or 4, and otherwise in
+ *           exponent form, such as 4.656612875245797e-10. A negative zero
+ *           keeps its sign.
+ ******************************************************************************/
+size_t calc_format_shortest(char * out, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    if (DOUBLE_EXPONENT_MASK ==
+        (int)((bits >> DOUBLE_FRACTION_BITS) & DOUBLE_EXPONENT_MASK))
+    {
+        int length = snprintf(out, CALC_FORMAT_MAX, "%g", value);
+        return (length < 0) ? 0 : (size_t)length;
+    }
+
+    size_t length = 0;
+    if (0 != (bits >> 63))
+    {
+        out[length++] = '-';
+        value         = -value;
+    }
+    if (0 == value)
+    {
+        out[length++] = '0';
+        return length;
+    }
+
+    char   digits[UINT64_DIGITS + 1];
+    int    exponent;
+    size_t count = shortest_digits(value, digits, &exponent);
+    if (0 == count)
+    {
+        count = shortest_fallback(value, digits, &exponent);
+    }
+
+    if (exponent >= (int)count && exponent <= SHORTEST_PLAIN_MAX)
+    {
+        memcpy(out + length, digits, count);
+        memset(out + length + count, '0', (size_t)exponent - count);
+        length += (size_t)exponent;
+    }
+    else if (exponent > 0 && exponent <= SHORTEST_PLAIN_MAX)
+    {
+        memcpy(out + length, digits, (size_t)exponent);
+        length += (size_t)exponent;
+        out[length++] = '.';
+        memcpy(out + length, digits + exponent, count - (size_t)exponent);
+        length += count - (size_t)exponent;
+    }
+    else if (exponent > SHORTEST_PLAIN_MIN && exponent <= 0)
+    {
+        out[length++] = '0';
+        out[length++] = '.';
+        memset(out + length, '0', (size_t)-exponent);
+        length += (size_t)-exponent;
+        memcpy(out + length, digits, count);
+        length += count;
+    }
+    else
+    {
+        out[length++] = digits[0];
+        if (count > 1)
+        {
+            out[length++] = '.';
+            memcpy(out + length, digits + 1, count - 1);
+            length += count - 1;
+        }
+        out[length++] = 'e';
+        out[length++] = (exponent > 0) ? '+' : '-';
+        length += format_uint64(
+            out + length, (uint64_t)((exponent > 0) ? exponent - 1
+                                                    : 1 - exponent));
+    }
+    return length;
+}
+
+/******************************************************************************
+ * @brief    Write the exact quotient of two magnitudes to a number of
+ *           decimals, rounded half to even
+ * @param    out         Destination
+ * @param    dividend    Dividend magnitude, at most 2^31
+ * @param    divisor     Divisor magnitude, nonzero and at most 2^31
+ * @param    digits      Decimals, at most CALC_DIV_DIGITS_MAX
+ * @return   Number of characters written (not NUL terminated)
+ ******************************************************************************/
+static size_t format_fixed(char *   out,
+                           uint64_t dividend,
+                           uint64_t divisor,
+                           unsigned digits)
+{
+    uint64_t     power     = powers_of_ten[digits];
+    calc_uint128 scaled    = (calc_uint128)dividend * power;
+    calc_uint128 quotient  = scaled / divisor;
+    uint64_t     remainder = (uint64_t)(scaled % divisor);
+
+    if (remainder > divisor - remainder ||
+        (remainder == divisor - remainder && 0 != (quotient & 1)))
+    {
+        quotient++;
+    }
+
+    size_t length = format_uint64(out, (uint64_t)(quotient / power));
+    if (0 != digits)
+    {
+        char   fraction[20];
+        size_t written =
+            format_uint64(fraction, (uint64_t)(quotient % power));
+
+        out[length++] = '.';
+        memset(out + length, '0', digits - written);
+        memcpy(out + length + digits - written, fraction, written);
+        length += digits;
+    }
+    return length;
+}
+
+/******************************************************************************
+ * @brief    Greatest common divisor, for reducing an exact quotient
+ ******************************************************************************/
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+    while (0 != b)
+    {
+        uint64_t rest = a % b;
+        a             = b;
+        b             = rest;
+    }
+    return a;
+}
+
+/******************************************************************************
+ * @brief    Write the output line of a failed calculation, its status message
+ * @return   Number of characters written, including the newline
+ ******************************************************************************/
+static size_t format_failure(char * out, calc_status status)
+{
+    const char * message = calc_status_message(status);
+    size_t       length  = strlen(message);
+
+    memcpy(out, message, length);
+    out[length] = '\n';
+    return length + 1;
+}
+
+/******************************************************************************
+ * @brief    Format a calculation as its output line
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    result  Result of the calculation
+ * @return   Number of characters written, including the newline
+ * @note     Successful results read "Result: <value>"; failures are the
+ *           status message.
+ ******************************************************************************/
+size_t calc_format_result(char * out, const calc_result * result)
+{
+    size_t length;
+
+    if (CALC_OK != result->status)
+    {
+        return format_failure(out, result->status);
+    }
+
+    memcpy(out, result_prefix, sizeof(result_prefix) - 1);
+    length = sizeof(result_prefix) - 1;
+    switch (result->kind)
+    {
+        case CALC_KIND_INT:
+            length += calc_format_int32(out + length, result->value.as_int);
+            break;
+
+        case CALC_KIND_UINT:
+            length += calc_format_uint32(out + length, result->value.as_uint);
+            break;
+
+        case CALC_KIND_DOUBLE:
+            length +=
+                calc_format_fixed2(out + length, result->value.as_double);
+            break;
+    }
+    out[length] = '\n';
+    return length + 1;
+}
+
+/******************************************************************************
+ * @brief    Format a 32-bit division as its output line
+ * @param    out         Destination, at least CALC_FORMAT_MAX bytes
+ * @param    dividend    First operand
+ * @param    divisor     Second operand
+ * @param    format      How the quotient is printed
+ * @return   Number of characters written, including the newline
+ * @note     Only CALC_DIV_DOUBLE and CALC_DIV_SHORTEST go through a double;
+ *           the others are computed exactly from the operands. Only a
+ *           CALC_DIV_DOUBLE quotient that rounds to zero keeps its sign, as
+ *           the double's %.2f does; every other mode prints zero unsigned,
+ *           as JavaScript does. A zero divisor is a failure.
+ ******************************************************************************/
+size_t calc_format_division(char *          out,
+                            int32_t         dividend,
+                            int32_t         divisor,
+                            calc_div_format format)
+{
+    if (0 == divisor)
+    {
+        return format_failure(out, CALC_ERR_DIV_BY_ZERO);
+    }
+
+    uint64_t top      = (dividend < 0) ? 0u - (uint64_t)(int64_t)dividend
+                                       : (uint64_t)dividend;
+    uint64_t bottom   = (divisor < 0) ? 0u - (uint64_t)(int64_t)divisor
+                                      : (uint64_t)divisor;
+    int      negative = (dividend < 0) != (divisor < 0);
+    size_t   length   = sizeof(result_prefix) - 1;
+
+    memcpy(out, result_prefix, length);
+    switch (format.mode)
+    {
+        case CALC_DIV_FIXED:
+        {
+            unsigned digits = (format.digits < CALC_DIV_DIGITS_MAX)
+                                  ? format.digits
+                                  : CALC_DIV_DIGITS_MAX;
+
+            // Only a quotient over half a unit in the last place is nonzero
+            if (negative &&
+                2 * (calc_uint128)top * powers_of_ten[digits] > bottom)
+            {
+                out[length++] = '-';
+            }
+            length += format_fixed(out + length, top, bottom, digits);
+            break;
+        }
+
+        case CALC_DIV_INTEGER:
+            if (negative && top >= bottom)
+            {
+                out[length++] = '-';
+            }
+            length += format_uint64(out + length, top / bottom);
+            break;
+
+        case CALC_DIV_EXACT:
+        {
+            uint64_t common = gcd(top, bottom);
+            if (negative && 0 != top)
+            {
+                out[length++] = '-';
+            }
+            length += format_uint64(out + length, top / common);
+            if (bottom != common)
+            {
+                out[length++] = '/';
+                length += format_uint64(out + length, bottom / common);
+            }
+            break;
+        }
+
+        case CALC_DIV_SHORTEST:
+            length += calc_format_shortest(
+                out + length,
+                (0 == dividend) ? 0.0 : (double)dividend / divisor);
+            break;
+
+        default:
+            length +=
+                calc_format_fixed2(out + length, (double)dividend / divisor);
+            break;
+    }
+    out[length] = '\n';
+    return length + 1;
+}
+
+/******************************************************************************
+ * @brief    Format a calculation at any width as its output line
+ * @param    out     Destination, at least CALC_FORMAT_MAX bytes
+ * @param    result  Result of the calculation
+ * @return   Number of characters written, including the newline
+ * @note     Lines read as calc_format_result's do; a quotient always has
+ *           two decimals.
+ ******************************************************************************/
+size_t calc_format_wide(char * out, const calc_wide_result * result)
+{
+    size_t length;
+
+    if (CALC_OK != result->status)
+    {
+        return format_failure(out, result->status);
+    }
+
+    memcpy(out, result_prefix, sizeof(result_prefix) - 1);
+    length = sizeof(result_prefix) - 1;
+    switch (result->kind)
+    {
+        case CALC_KIND_INT:
+            if ((calc_int128)result->value < 0)
+            {
+                out[length++] = '-';
+                length += format_uint128(out + length, 0 - result->value);
+            }
+            else
+            {
+                length += format_uint128(out + length, result->value);
+            }
+            break;
+
+        case CALC_KIND_UINT:
+            length += format_uint128(out + length, result->value);
+            break;
+
+        case CALC_KIND_DOUBLE:
+            if (result->negative)
+            {
+                out[length++] = '-';
+            }
+            length += format_uint128(out + length, result->value);
+            out[length++] = '.';
+            memcpy(out + length, &digit_pairs[result->hundredths * 2], 2);
+            length += 2;
+            break;
+    }
+    out[length] = '\n';
+    return length + 1;
+}
+
+/******************************************************************************
+ * @brief    Append the output line of an arbitrary precision calculation
+ * @param    output  Buffer the line is appended to, grown to fit
+ * @param    result  Result of the calculation
+ * @return   1 if successful, 0 if out of memory
+ * @note     Integers print in full and quotients with two decimals, as
+ *           calc_format_wide prints them.
+ ******************************************************************************/
+int calc_format_big(calc_buffer * output, const calc_big_result * result)
+{
+    const calc_big * value = &result->value;
+    size_t           count = value->length;
+    int              point = (CALC_KIND_DOUBLE == result->kind);
+
+    // Prefix, sign, up to 20 digits a limb, "0.00" at least and the newline
+    size_t most = sizeof(result_prefix) + 1 + (UINT64_DIGITS + 1) * count + 5;
+    if (!calc_buffer_reserve(output, most))
+    {
+        return 0;
+    }
+    char * out = output->data + output->used;
+    if (CALC_OK != result->status)
+    {
+        output->used += format_failure(out, result->status);
+        return 1;
+    }
+
+    uint64_t   local[BIG_FORMAT_LOCAL];
+    uint64_t * work = local;
+    if (count > BIG_FORMAT_LOCAL &&
+        NULL == (work = malloc(count * sizeof(*work))))
+    {
+        return 0;
+    }
+    memcpy(work,
+           (NULL != value->heap) ? value->heap : value->small,
+           count * sizeof(*work));
+
+    // UINT64_DIGITS digits at a time from the bottom, written backwards from
+    // the end of the reserved space and moved into place afterwards
+    char * end    = out + most;
+    char * cursor = end;
+    while (0 != count)
+    {
+        calc_uint128 remainder = 0;
+        for (size_t i = count; i-- > 0;)
+        {
+            calc_uint128 part = (remainder << 64) | work[i];
+            work[i]           = (uint64_t)(part / UINT64_POWER);
+            remainder         = part % UINT64_POWER;
+        }
+        while (0 != count && 0 == work[count - 1])
+        {
+            count--;
+        }
+
+        char   chunk[20];
+        size_t digits = format_uint64(chunk, (uint64_t)remainder);
+        cursor -= digits;
+        memcpy(cursor, chunk, digits);
+        if (0 != count)
+        {
+            cursor -= UINT64_DIGITS - digits;
+            memset(cursor, '0', UINT64_DIGITS - digits);
+        }
+    }
+    if (local != work)
+    {
+        free(work);
+    }
+    while (end - cursor < (point ? 3 : 1))
+    {
+        *--cursor = '0';
+    }
+
+    size_t length = sizeof(result_prefix) - 1;
+    size_t digits = (size_t)(end - cursor) - (point ? 2 : 0);
+    memcpy(out, result_prefix, length);
+    if (value->negative && (point || 0 != value->length))
+    {
+        out[length++] = '-';
+    }
+    memmove(out + length, cursor, digits);
+    length += digits;
+    if (point)
+    {
+        out[length++] = '.';
+        memmove(out + length, end - 2, 2);
+        length += 2;
+    }
+    out[length] = '\n';
+    output->used += length + 1;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Make room for more bytes in a buffer
+ * @param    buffer  Buffer to grow
+ * @param    extra   Bytes that must fit after the used part
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+int calc_buffer_reserve(calc_buffer * buffer, size_t extra)
+{
+    if (buffer->capacity - buffer->used >= extra)
+    {
+        return 1;
+    }
+
+    size_t capacity = (0 == buffer->capacity) ? 4096 : buffer->capacity;
+    while (capacity - buffer->used < extra)
+    {
+        capacity *= 2;
+    }
+    char * data = realloc(buffer->data, capacity);
+    if (NULL == data)
+    {
+        return 0;
+    }
+    buffer->data     = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Release a buffer's storage
+ ******************************************************************************/
+void calc_buffer_free(calc_buffer * buffer)
+{
+    free(buffer->data);
+    buffer->data     = NULL;
+    buffer->used     = 0;
+    buffer->capacity = 0;
+}
+
+/******************************************************************************
+ * @brief    Set up a buffered output stream
+ * @param    output      Output stream to initialise
+ * @param    fd          File descriptor the buffer is flushed to
+ * @param    buffer      Caller-owned storage, at least CALC_FORMAT_MAX bytes
+ * @param    capacity    Size of buffer
+ ******************************************************************************/
+void calc_output_init(
+    calc_output * output, int fd, char * buffer, size_t capacity)
+{
+    output->fd       = fd;
+    output->buffer   = buffer;
+    output->used     = 0;
+    output->capacity = capacity;
+    output->failed   = 0;
+}
+
+/******************************************************************************
+ * @brief    Write the buffered bytes with as few write(2) calls as possible
+ * @param    output  Output stream
+ * @return   1 if successful, 0 if a write has failed
+ ******************************************************************************/
+int calc_output_flush(calc_output * output)
+{
+    size_t written = 0;
+
+    while (!output->failed && written < output->used)
+    {
+        ssize_t count = write(
+            output->fd, output->buffer + written, output->used - written);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            output->failed = 1;
+            break;
+        }
+        written += (size_t)count;
+    }
+    output->used = 0;
+    return !output->failed;
+}
+
+/******************************************************************************
+ * @brief    Append bytes to the output buffer
+ * @param    output  Output stream
+ * @param    bytes   Bytes to append
+ * @param    length  Number of bytes
+ * @return   1 if successful, 0 if a write has failed
+ ******************************************************************************/
+int calc_output_write(calc_output * output, const char * bytes, size_t length)
+{
+    while (length > 0)
+    {
+        if (output->used == output->capacity && !calc_output_flush(output))
+        {
+            return 0;
+        }
+
+        size_t room  = output->capacity - output->used;
+        size_t chunk = (length < room) ? length : room;
+        memcpy(output->buffer + output->used, bytes, chunk);
+        output->used += chunk;
+        bytes += chunk;
+        length -= chunk;
+    }
+    return !output->failed;
+}
+
+/******************************************************************************
+ * @brief    Append a calculation's output line to the output buffer
+ * @param    output  Output stream
+ * @param    result  Result of the calculation
+ * @return   1 if successful, 0 if a write has failed
+ ******************************************************************************/
+int calc_output_result(calc_output * output, const calc_result * result)
+{
+    // Format in place whenever a whole line is guaranteed to fit
+    if (output->capacity - output->used < CALC_FORMAT_MAX &&
+        !calc_output_flush(output))
+    {
+        return 0;
+    }
+    output->used += calc_format_result(output->buffer + output->used, result);
+    return 1;
+}
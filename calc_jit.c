@@ -0,0 +1,257 @@
+/******************************************************************************
+ * @file    calc_jit.c
+ * @brief   Native code generation for compiled expressions
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Each three-address instruction becomes a short straight-line x86-64
+ * sequence: the operands are loaded into eax and ecx (bindings from the
+ * caller's array, constants as immediates, temporaries from a scratch
+ * register file), combined, and stored back. Overflow and division by zero
+ * return the operator's calc_status on the spot, so the generated function
+ * fails exactly where calc_expr_eval's interpreter would.
+ *
+ * Code is written into an anonymous mapping that is made executable, and
+ * never writable again, before it is used. Elsewhere, or if the mapping
+ * cannot be made, expressions stay interpreted.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_expr.h"
+
+#if defined(__x86_64__) && defined(__linux__)
+#define CALC_JIT_X86_64 1
+#endif
+
+#if defined(CALC_JIT_X86_64)
+
+#define JIT_INSN_MAX   64 // Longest sequence emitted for one instruction
+#define JIT_FIXED_SIZE 16 // Prologue and epilogue
+#define NO_REGISTER    (-1)
+
+/******************************************************************************
+ * @brief    Code being emitted
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t *         code;
+    size_t            used;
+    const calc_expr * expr;
+    int               in_eax; // Register whose value eax still holds
+} jit_emitter;
+
+static void emit_bytes(jit_emitter * jit, const char * bytes, size_t length)
+{
+    memcpy(jit->code + jit->used, bytes, length);
+    jit->used += length;
+}
+
+static void emit_u32(jit_emitter * jit, uint32_t value)
+{
+    for (int byte = 0; byte < 4; byte++)
+    {
+        jit->code[jit->used++] = (uint8_t)(value >> (8 * byte));
+    }
+}
+
+/******************************************************************************
+ * @brief    Return status from the generated function unless the preceding
+ *           two-byte jcc skips over this
+ ******************************************************************************/
+static void emit_fail(jit_emitter * jit, calc_status status)
+{
+    emit_bytes(jit, "\xB8", 1); // mov eax, status
+    emit_u32(jit, (uint32_t)status);
+    emit_bytes(jit, "\xC3", 1); // ret
+}
+
+/******************************************************************************
+ * @brief    Load a register of the expression into eax (0) or ecx (1)
+ ******************************************************************************/
+static void emit_load(jit_emitter * jit, unsigned target, uint8_t reg)
+{
+    const calc_expr * expr = jit->expr;
+
+    if (reg < expr->variable_count)
+    {
+        // mov r32, [rdi + disp32]
+        jit->code[jit->used++] = 0x8B;
+        jit->code[jit->used++] = (uint8_t)(0x87 | (target << 3));
+        emit_u32(jit, (uint32_t)reg * sizeof(uint32_t));
+    }
+    else if (reg < expr->variable_count + expr->constant_count)
+    {
+        // mov r32, imm32
+        jit->code[jit->used++] = (uint8_t)(0xB8 | target);
+        emit_u32(jit, expr->constants[reg - expr->variable_count]);
+    }
+    else
+    {
+        // mov r32, [rsi + disp32]
+        jit->code[jit->used++] = 0x8B;
+        jit->code[jit->used++] = (uint8_t)(0x86 | (target << 3));
+        emit_u32(jit, (uint32_t)reg * sizeof(uint32_t));
+    }
+}
+
+/******************************************************************************
+ * @brief    Emit one instruction; the result is left in eax and stored
+ ******************************************************************************/
+static void emit_insn(jit_emitter * jit, const calc_insn * insn)
+{
+    // Right operand first, so a left operand already in eax survives
+    if (jit->in_eax == insn->right)
+    {
+        emit_bytes(jit, "\x89\xC1", 2); // mov ecx, eax
+    }
+    else
+    {
+        emit_load(jit, 1, insn->right);
+    }
+    if (jit->in_eax != insn->left)
+    {
+        emit_load(jit, 0, insn->left);
+    }
+
+    switch ((calc_op)insn->op)
+    {
+        case CALC_OP_ADD:
+            emit_bytes(jit, "\x01\xC8\x71\x06", 4); // add eax, ecx; jno +6
+            emit_fail(jit, CALC_ERR_ADD_OVERFLOW);
+            break;
+        case CALC_OP_SUB:
+            emit_bytes(jit, "\x29\xC8\x71\x06", 4); // sub eax, ecx; jno +6
+            emit_fail(jit, CALC_ERR_SUB_OVERFLOW);
+            break;
+        case CALC_OP_MUL:
+            emit_bytes(jit, "\x0F\xAF\xC1\x71\x06", 5); // imul eax, ecx; jno
+            emit_fail(jit, CALC_ERR_MUL_OVERFLOW);
+            break;
+        case CALC_OP_DIV:
+            emit_bytes(jit, "\x85\xC9\x75\x06", 4); // test ecx, ecx; jnz +6
+            emit_fail(jit, CALC_ERR_DIV_BY_ZERO);
+            // cvtsi2sd xmm0, eax; cvtsi2sd xmm1, ecx; divsd xmm0, xmm1
+            emit_bytes(jit, "\xF2\x0F\x2A\xC0\xF2\x0F\x2A\xC9\xF2\x0F\x5E\xC1",
+                       12);
+            // movsd [r8], xmm0; cvttsd2si eax, xmm0 (2^31 gives INT32_MIN,
+            // as the interpreter's truncation does)
+            emit_bytes(jit, "\xF2\x41\x0F\x11\x00\xF2\x0F\x2C\xC0", 9);
+            break;
+        case CALC_OP_MOD:
+            emit_bytes(jit, "\x85\xC9\x75\x06", 4); // test ecx, ecx; jnz +6
+            emit_fail(jit, CALC_ERR_MOD_BY_ZERO);
+            // cmp ecx, -1; jne +4; xor eax, eax; jmp +5
+            emit_bytes(jit, "\x83\xF9\xFF\x75\x04\x31\xC0\xEB\x05", 9);
+            emit_bytes(jit, "\x99\xF7\xF9\x89\xD0", 5); // cdq; idiv; mov
+            break;
+        case CALC_OP_SHL:
+        case CALC_OP_SHR:
+            // xor edx, edx; shl/shr eax, cl; cmp ecx, 32; cmovae eax, edx
+            emit_bytes(jit, "\x31\xD2\xD3", 3);
+            jit->code[jit->used++] = (CALC_OP_SHL == insn->op) ? 0xE0 : 0xE8;
+            emit_bytes(jit, "\x83\xF9\x20\x0F\x43\xC2", 6);
+            break;
+        case CALC_OP_AND:
+            emit_bytes(jit, "\x21\xC8", 2);
+            break;
+        case CALC_OP_OR:
+            emit_bytes(jit, "\x09\xC8", 2);
+            break;
+        case CALC_OP_XOR:
+            emit_bytes(jit, "\x31\xC8", 2);
+            break;
+        case CALC_OP_ROL:
+            emit_bytes(jit, "\xD3\xC0", 2); // The count is taken mod 32
+            break;
+        case CALC_OP_ROR:
+            emit_bytes(jit, "\xD3\xC8", 2);
+            break;
+        default:
+            emit_fail(jit, CALC_ERR_UNSUPPORTED_OPERATOR);
+            break;
+    }
+
+    // mov [rsi + disp32], eax
+    emit_bytes(jit, "\x89\x86", 2);
+    emit_u32(jit, (uint32_t)insn->dest * sizeof(uint32_t));
+    jit->in_eax = insn->dest;
+}
+
+/******************************************************************************
+ * @brief    Generate native code for an expression
+ * @return   1 if the expression now runs natively, 0 otherwise
+ ******************************************************************************/
+int calc_expr_jit(calc_expr * expr)
+{
+    if (NULL != expr->jit || 0 == expr->code_length)
+    {
+        return NULL != expr->jit;
+    }
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = JIT_FIXED_SIZE + (expr->code_length * JIT_INSN_MAX);
+    size        = (size + page - 1) / page * page;
+
+    void * code = mmap(NULL,
+                       size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS,
+                       -1,
+                       0);
+    if (MAP_FAILED == code)
+    {
+        return 0;
+    }
+
+    // calc_jit_fn(rdi = bindings, rsi = registers, rdx = quotient)
+    jit_emitter jit = { code, 0, expr, NO_REGISTER };
+    emit_bytes(&jit, "\x49\x89\xD0", 3); // mov r8, rdx (idiv clobbers rdx)
+    for (size_t i = 0; i < expr->code_length; i++)
+    {
+        emit_insn(&jit, &expr->code[i]);
+    }
+    emit_bytes(&jit, "\x31\xC0\xC3", 3); // xor eax, eax (CALC_OK); ret
+
+    if (0 != mprotect(code, size, PROT_READ | PROT_EXEC))
+    {
+        munmap(code, size);
+        return 0;
+    }
+    expr->jit_code = code;
+    expr->jit_size = size;
+    memcpy(&expr->jit, &code, sizeof(expr->jit)); // No cast in ISO C
+    return 1;
+}
+
+#else
+
+int calc_expr_jit(calc_expr * expr)
+{
+    (void)expr;
+    return 0;
+}
+
+#endif // CALC_JIT_X86_64
+
+/******************************************************************************
+ * @brief    Release an expression's native code, if it has any
+ ******************************************************************************/
+void calc_jit_release(calc_expr * expr)
+{
+#if defined(CALC_JIT_X86_64)
+    if (NULL != expr->jit_code)
+    {
+        munmap(expr->jit_code, expr->jit_size);
+    }
+#endif
+    expr->jit      = NULL;
+    expr->jit_code = NULL;
+    expr->jit_size = 0;
+}
@@ -0,0 +1,126 @@
+/******************************************************************************
+ * @file    calc_net.c
+ * @brief   Connecting to a calculation server
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Shared by the coordinator and the client, which both reach servers by
+ * the addresses the command line takes.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "calc_net.h"
+
+#define NET_HOST_MAX 256
+#define NET_PORT_MAX 16
+
+/******************************************************************************
+ * @brief    Connect to a server
+ * @param    address Socket path (anything with a '/'), "port", "host:port"
+ *                   or "[ipv6 host]:port"
+ * @return   Non-blocking connected descriptor, or -1
+ ******************************************************************************/
+int calc_net_connect(const char * address)
+{
+    int fd = -1;
+
+    if (NULL != strchr(address, '/'))
+    {
+        struct sockaddr_un local;
+
+        if (strlen(address) >= sizeof(local.sun_path))
+        {
+            return -1;
+        }
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        strcpy(local.sun_path, address);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 &&
+            0 != connect(fd, (struct sockaddr *)&local, sizeof(local)))
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    else
+    {
+        char              host[NET_HOST_MAX];
+        char              port[NET_PORT_MAX];
+        const char *      colon     = strrchr(address, ':');
+        const char *      port_text = address; // Port only, on this host
+        struct addrinfo   hints;
+        struct addrinfo * results;
+
+        strcpy(host, "localhost");
+        if (NULL != colon)
+        {
+            const char * start  = address;
+            size_t       length = (size_t)(colon - address);
+            if (length >= 2 && '[' == start[0] && ']' == start[length - 1])
+            {
+                start++;
+                length -= 2;
+            }
+            if (length >= sizeof(host))
+            {
+                return -1;
+            }
+            memcpy(host, start, length);
+            host[length] = '\0';
+            port_text    = colon + 1;
+        }
+        if (strlen(port_text) >= sizeof(port) || '\0' == port_text[0])
+        {
+            return -1;
+        }
+        strcpy(port, port_text);
+
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (0 != getaddrinfo(host, port, &hints, &results))
+        {
+            return -1;
+        }
+        for (struct addrinfo * at = results; fd < 0 && NULL != at;
+             at = at->ai_next)
+        {
+            int nodelay = 1;
+
+            fd = socket(at->ai_family, at->ai_socktype, at->ai_protocol);
+            if (fd >= 0 && 0 != connect(fd, at->ai_addr, at->ai_addrlen))
+            {
+                close(fd);
+                fd = -1;
+            }
+            if (fd >= 0)
+            {
+                // Requests are written whole, so small ones need not wait
+                (void)setsockopt(fd,
+                                 IPPROTO_TCP,
+                                 TCP_NODELAY,
+                                 &nodelay,
+                                 sizeof(nodelay));
+            }
+        }
+        freeaddrinfo(results);
+    }
+
+    if (fd >= 0 && (0 != fcntl(fd, F_SETFL, O_NONBLOCK) ||
+                    0 != fcntl(fd, F_SETFD, FD_CLOEXEC)))
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
@@ -0,0 +1,78 @@
+/******************************************************************************
+ * @file    calc_net.h
+ * @brief   Wire format and connections shared by the binary codec, the
+ *          server, the client and the coordinator (internal)
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Binary requests and responses are little-endian whatever the host; the
+ * helpers here are the one codec every side of the protocol goes through.
+ ******************************************************************************/
+
+#ifndef CALC_NET_H
+#define CALC_NET_H
+
+#include <stdint.h>
+#include "calc.h"
+
+#define CALC_NET_MAGIC_SIZE 4 // Bytes that tell a binary request from text
+
+// Request magic as it appears on the wire
+static const unsigned char calc_net_request_magic[CALC_NET_MAGIC_SIZE] = {
+    (unsigned char)(CALC_BINARY_REQUEST_MAGIC),
+    (unsigned char)(CALC_BINARY_REQUEST_MAGIC >> 8),
+    (unsigned char)(CALC_BINARY_REQUEST_MAGIC >> 16),
+    (unsigned char)(CALC_BINARY_REQUEST_MAGIC >> 24),
+};
+
+// Start of an HTTP request, such as the metrics scrape
+static const char calc_net_http_method[] = "GET ";
+
+// Text requests print quotients as the command line does by default
+static const calc_div_format calc_net_classic_division = { CALC_DIV_DOUBLE,
+                                                           0 };
+
+/******************************************************************************
+ * @brief    Decode little-endian integers
+ ******************************************************************************/
+static inline uint16_t calc_net_load_le16(const unsigned char * bytes)
+{
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+static inline uint32_t calc_net_load_le32(const unsigned char * bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) |
+           ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static inline uint64_t calc_net_load_le64(const unsigned char * bytes)
+{
+    return (uint64_t)calc_net_load_le32(bytes) |
+           ((uint64_t)calc_net_load_le32(bytes + 4) << 32);
+}
+
+/******************************************************************************
+ * @brief    Encode little-endian integers
+ ******************************************************************************/
+static inline void calc_net_store_le16(unsigned char * bytes, uint16_t value)
+{
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+}
+
+static inline void calc_net_store_le32(unsigned char * bytes, uint32_t value)
+{
+    calc_net_store_le16(bytes, (uint16_t)value);
+    calc_net_store_le16(bytes + 2, (uint16_t)(value >> 16));
+}
+
+static inline void calc_net_store_le64(unsigned char * bytes, uint64_t value)
+{
+    calc_net_store_le32(bytes, (uint32_t)value);
+    calc_net_store_le32(bytes + 4, (uint32_t)(value >> 32));
+}
+
+int calc_net_connect(const char * address);
+
+#endif // CALC_NET_H
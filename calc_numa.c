@@ -0,0 +1,253 @@
+/******************************************************************************
+ * @file    calc_numa.c
+ * @brief   NUMA topology, thread pinning and memory placement
+ * @version 1.6
+ * @date    October 2026
+ *
+ * The topology comes from sysfs, each node's cpulist cut down to the CPUs
+ * the process may run on, so a run under taskset or a cpuset only spreads
+ * over what it was given. Without sysfs every allowed CPU is taken to be
+ * on node 0.
+ *
+ * Memory is placed by the node a buffer is first touched from: the thread
+ * that sets one up prefers the node for the while, and touches every page.
+ * The policy goes through the system calls directly, so there is no need
+ * for libnuma; on a kernel without NUMA they fail, and memory lands where
+ * it would have anyway.
+ ******************************************************************************/
+
+#define _GNU_SOURCE // sched_setaffinity(), CPU_SET
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_numa.h"
+
+#define NUMA_LIST_SIZE 4096 // Longest cpulist read
+#define NUMA_PATH_MAX  64
+
+// From <linux/mempolicy.h>, which not every system installs
+#define NUMA_MPOL_DEFAULT   0
+#define NUMA_MPOL_PREFERRED 1
+
+// Bits in a node mask; the kernel reads one fewer than it is told
+#define NUMA_MASK_BITS (8 * sizeof(unsigned long) + 1)
+
+/******************************************************************************
+ * @brief    Read a node's cpulist, such as "0-3,8-11"
+ * @return   Bytes read, 0 if the node has none or does not exist
+ ******************************************************************************/
+static size_t read_cpulist(unsigned node, char * list, size_t size)
+{
+    char    path[NUMA_PATH_MAX];
+    int     fd;
+    ssize_t count;
+
+    snprintf(path,
+             sizeof(path),
+             "/sys/devices/system/node/node%u/cpulist",
+             node);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    count = read(fd, list, size - 1);
+    close(fd);
+    if (count <= 0)
+    {
+        return 0;
+    }
+    list[count] = '\0';
+    return (size_t)count;
+}
+
+/******************************************************************************
+ * @brief    Parse a decimal number of a cpulist
+ ******************************************************************************/
+static unsigned parse_cpu(const char ** cursor)
+{
+    unsigned value = 0;
+
+    while ((unsigned)(**cursor - '0') < 10 && value < CALC_NUMA_CPUS_MAX)
+    {
+        value = (value * 10) + (unsigned)(**cursor - '0');
+        (*cursor)++;
+    }
+    return value;
+}
+
+/******************************************************************************
+ * @brief    Add a node's allowed CPUs to the topology
+ ******************************************************************************/
+static void add_node(calc_numa *       numa,
+                     unsigned          id,
+                     const char *      list,
+                     const cpu_set_t * allowed)
+{
+    const char * at    = list;
+    unsigned     first = (0 == numa->nodes)
+                             ? 0
+                             : numa->first[numa->nodes - 1] +
+                                   numa->count[numa->nodes - 1];
+
+    numa->id[numa->nodes]    = id;
+    numa->first[numa->nodes] = first;
+    numa->count[numa->nodes] = 0;
+
+    while ((unsigned)(*at - '0') < 10)
+    {
+        unsigned low  = parse_cpu(&at);
+        unsigned high = low;
+        if ('-' == *at)
+        {
+            at++;
+            high = parse_cpu(&at);
+        }
+        for (unsigned cpu = low; cpu <= high && cpu < CALC_NUMA_CPUS_MAX;
+             cpu++)
+        {
+            if (CPU_ISSET(cpu, allowed) &&
+                first + numa->count[numa->nodes] < CALC_NUMA_CPUS_MAX)
+            {
+                numa->cpus[first + numa->count[numa->nodes]] = (uint16_t)cpu;
+                numa->count[numa->nodes]++;
+            }
+        }
+        if (',' == *at)
+        {
+            at++;
+        }
+    }
+    if (0 != numa->count[numa->nodes])
+    {
+        numa->nodes++;
+    }
+}
+
+/******************************************************************************
+ * @brief    Find the nodes and CPUs the process may run on
+ * @param    numa        Filled with the topology
+ * @param    node_limit  Most nodes to take, the lowest numbered first
+ * @return   1 if there is at least one CPU to pin to, 0 otherwise
+ ******************************************************************************/
+int calc_numa_detect(calc_numa * numa, unsigned node_limit)
+{
+    cpu_set_t allowed;
+    char      list[NUMA_LIST_SIZE];
+
+    memset(numa, 0, sizeof(*numa));
+    if (0 != sched_getaffinity(0, sizeof(allowed), &allowed))
+    {
+        return 0;
+    }
+    for (unsigned id = 0;
+         CALC_NUMA_NODES_MAX > id && numa->nodes < node_limit;
+         id++)
+    {
+        if (0 != read_cpulist(id, list, sizeof(list)))
+        {
+            add_node(numa, id, list, &allowed);
+        }
+    }
+
+    // No sysfs: one node holding every allowed CPU
+    if (0 == numa->nodes && 0 != node_limit)
+    {
+        for (unsigned cpu = 0; CALC_NUMA_CPUS_MAX > cpu; cpu++)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+            {
+                numa->cpus[numa->count[0]++] = (uint16_t)cpu;
+            }
+        }
+        numa->nodes = (0 != numa->count[0]);
+    }
+    return 0 != numa->nodes;
+}
+
+/******************************************************************************
+ * @brief    Where a worker runs: workers are dealt over the nodes in turn,
+ *           and over each node's CPUs in turn
+ * @param    numa    Topology from calc_numa_detect
+ * @param    worker  Index of the worker
+ * @param    cpu     Set to the CPU to pin it to
+ * @return   Kernel number of its node
+ ******************************************************************************/
+unsigned calc_numa_place(const calc_numa * numa,
+                         unsigned          worker,
+                         unsigned *        cpu)
+{
+    unsigned node  = worker % numa->nodes;
+    unsigned index = (worker / numa->nodes) % numa->count[node];
+
+    *cpu = numa->cpus[numa->first[node] + index];
+    return numa->id[node];
+}
+
+/******************************************************************************
+ * @brief    Pin the calling thread to one CPU
+ * @return   1 if successful, 0 otherwise
+ ******************************************************************************/
+int calc_numa_pin(unsigned cpu)
+{
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return 0 == sched_setaffinity(0, sizeof(set), &set);
+}
+
+/******************************************************************************
+ * @brief    Have the calling thread allocate pages on a node, until
+ *           calc_numa_restore
+ * @param    node    Kernel number of the node
+ * @param    saved   Set to the policy to restore
+ ******************************************************************************/
+void calc_numa_prefer(unsigned node, calc_numa_policy * saved)
+{
+    unsigned long mask = 1UL << node;
+
+    memset(saved, 0, sizeof(*saved));
+    saved->saved = (0 == syscall(SYS_get_mempolicy,
+                                 &saved->mode,
+                                 &saved->nodes,
+                                 NUMA_MASK_BITS,
+                                 NULL,
+                                 0UL));
+    if (saved->saved)
+    {
+        (void)syscall(
+            SYS_set_mempolicy, NUMA_MPOL_PREFERRED, &mask, NUMA_MASK_BITS);
+    }
+}
+
+/******************************************************************************
+ * @brief    Restore the policy calc_numa_prefer replaced
+ ******************************************************************************/
+void calc_numa_restore(const calc_numa_policy * saved)
+{
+    if (saved->saved)
+    {
+        (void)syscall(SYS_set_mempolicy,
+                      saved->mode,
+                      (NUMA_MPOL_DEFAULT == saved->mode) ? NULL
+                                                         : &saved->nodes,
+                      NUMA_MASK_BITS);
+    }
+}
+
+/******************************************************************************
+ * @brief    Nodes with CPUs the process may run on, for calc_batch_run
+ * @return   Node count, at least 1
+ ******************************************************************************/
+unsigned calc_numa_nodes(void)
+{
+    calc_numa numa;
+
+    return calc_numa_detect(&numa, CALC_NUMA_NODES_MAX) ? numa.nodes : 1;
+}
@@ -0,0 +1,46 @@
+/******************************************************************************
+ * @file    calc_numa.h
+ * @brief   NUMA topology, thread pinning and memory placement (internal)
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#ifndef CALC_NUMA_H
+#define CALC_NUMA_H
+
+#include <stdint.h>
+
+#define CALC_NUMA_NODES_MAX 64   // Node numbers above are ignored
+#define CALC_NUMA_CPUS_MAX  1024 // CPU numbers above are ignored
+
+/******************************************************************************
+ * @brief    Nodes with CPUs the process may run on, and those CPUs
+ ******************************************************************************/
+typedef struct
+{
+    unsigned nodes;
+    unsigned id[CALC_NUMA_NODES_MAX];    // Kernel number of each node
+    unsigned first[CALC_NUMA_NODES_MAX]; // First of its CPUs in cpus
+    unsigned count[CALC_NUMA_NODES_MAX]; // CPUs of each node
+    uint16_t cpus[CALC_NUMA_CPUS_MAX];   // Node by node
+} calc_numa;
+
+/******************************************************************************
+ * @brief    Memory policy of the calling thread, to be restored
+ ******************************************************************************/
+typedef struct
+{
+    int           mode;
+    unsigned long nodes;
+    int           saved; // The policy could be read, so is restored
+} calc_numa_policy;
+
+int      calc_numa_detect(calc_numa * numa, unsigned node_limit);
+unsigned calc_numa_place(const calc_numa * numa,
+                         unsigned          worker,
+                         unsigned *        cpu);
+int      calc_numa_pin(unsigned cpu);
+void     calc_numa_prefer(unsigned node, calc_numa_policy * saved);
+void     calc_numa_restore(const calc_numa_policy * saved);
+
+#endif // CALC_NUMA_H
@@ -0,0 +1,255 @@
+/******************************************************************************
+ * @file    calc_parse.c
+ * @brief   Decimal operand parsing
+ * @version 1.6
+ * @date    October 2026
+ *
+ * The parser accepts exactly what the original strtoul() based conversion
+ * accepted, and yields the same value: optional C-locale whitespace, an
+ * optional sign, then decimal digits. Values up to ULONG_MAX are reduced
+ * modulo 2^32 (so "-1" is 4294967295) and larger ones are rejected. An
+ * empty string converts to 0, because strtoul() leaves nothing unparsed.
+ * 64 and 128-bit operands follow the same syntax with the width's range.
+ ******************************************************************************/
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "calc.h"
+
+// Digits that always fit in a uint64_t (10^19 - 1 < 2^64)
+#define SAFE_DIGITS_UINT64 19
+#define SWAR_DIGITS        8
+#define BASE_DECIMAL       10
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define CALC_PARSE_SWAR 1
+#endif
+
+/******************************************************************************
+ * @brief    Whitespace as classified by isspace() in the C locale
+ ******************************************************************************/
+static int is_space(char ch)
+{
+    return ' ' == ch || ('\t' <= ch && ch <= '\r');
+}
+
+/******************************************************************************
+ * @brief    Decimal digit check that does not consult the locale
+ ******************************************************************************/
+static int is_digit(char ch)
+{
+    return (unsigned char)(ch - '0') < 10;
+}
+
+#if defined(CALC_PARSE_SWAR)
+
+/******************************************************************************
+ * @brief    Load 8 characters as a little-endian word
+ ******************************************************************************/
+static uint64_t load_chunk(const char * text)
+{
+    uint64_t chunk;
+    memcpy(&chunk, text, sizeof(chunk));
+    return chunk;
+}
+
+/******************************************************************************
+ * @brief    Check that all 8 bytes of a chunk are '0'..'9'
+ ******************************************************************************/
+static int is_eight_digits(uint64_t chunk)
+{
+    // High nibble must be 3 and adding 6 must not carry out of the low one
+    const uint64_t high  = 0xF0F0F0F0F0F0F0F0u;
+    uint64_t       carry = ((chunk + 0x0606060606060606u) & high) >> 4;
+    return 0x3333333333333333u == ((chunk & high) | carry);
+}
+
+/******************************************************************************
+ * @brief    Convert 8 ASCII digits, first digit in the low byte
+ * @return   Value in the range 0..99999999
+ ******************************************************************************/
+static uint32_t parse_eight_digits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FFu;
+    const uint64_t mul1 = 100 + (1000000ull << 32);
+    const uint64_t mul2 = 1 + (10000ull << 32);
+
+    chunk -= 0x3030303030303030u;
+    chunk = (chunk * 10) + (chunk >> 8); // Combine digit pairs
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)chunk;
+}
+
+static const uint32_t powers_of_ten[SWAR_DIGITS] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000
+};
+
+#endif // CALC_PARSE_SWAR
+
+/******************************************************************************
+ * @brief    Convert a decimal operand of known length
+ * @param    text    Operand characters, need not be NUL terminated
+ * @param    length  Number of characters
+ * @param    value   Converted operand
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int calc_parse_uint32(const char * text, size_t length, uint32_t * value)
+{
+    const char * cursor   = text;
+    const char * end      = text + length;
+    int          negative = 0;
+    size_t       digits   = 0;
+    uint64_t     number   = 0;
+
+    while (cursor < end && is_space(*cursor))
+    {
+        cursor++;
+    }
+    if (cursor < end && ('+' == *cursor || '-' == *cursor))
+    {
+        negative = ('-' == *cursor);
+        cursor++;
+    }
+
+    // No conversion at all: only the empty string is left fully consumed
+    if (cursor == end || !is_digit(*cursor))
+    {
+        *value = 0;
+        return 0 == length;
+    }
+
+    // Leading zeros never count against the range
+    while (cursor < end && '0' == *cursor)
+    {
+        cursor++;
+    }
+
+#if defined(CALC_PARSE_SWAR)
+    // Everything left must be digits, so its length is the digit count
+    size_t remaining = (size_t)(end - cursor);
+
+    if (remaining <= SAFE_DIGITS_UINT64 && length >= SWAR_DIGITS)
+    {
+        while ((size_t)(end - cursor) >= SWAR_DIGITS)
+        {
+            uint64_t chunk = load_chunk(cursor);
+            if (!is_eight_digits(chunk))
+            {
+                return 0;
+            }
+            number = (number * 100000000u) + parse_eight_digits(chunk);
+            cursor += SWAR_DIGITS;
+        }
+
+        // Load the last few digits as the end of the word that finishes
+        // with them, forcing the bytes that come before them to '0'
+        size_t tail = (size_t)(end - cursor);
+        if (0 != tail)
+        {
+            uint64_t before = (1ull << (8 * (SWAR_DIGITS - tail))) - 1;
+            uint64_t chunk  = load_chunk(end - SWAR_DIGITS);
+            chunk = (chunk & ~before) | (0x3030303030303030u & before);
+            if (!is_eight_digits(chunk))
+            {
+                return 0;
+            }
+            number = (number * powers_of_ten[tail]) + parse_eight_digits(chunk);
+            cursor = end;
+        }
+        digits = remaining;
+    }
+#endif
+
+    for (; cursor < end && is_digit(*cursor); cursor++)
+    {
+        uint32_t digit = (uint32_t)(*cursor - '0');
+        if (digits >= SAFE_DIGITS_UINT64 &&
+            number > (UINT64_MAX - digit) / BASE_DECIMAL)
+        {
+            return 0; // Out of range (ERANGE)
+        }
+        number = (number * BASE_DECIMAL) + digit;
+        digits++;
+    }
+
+    if (cursor != end || number > ULONG_MAX)
+    {
+        return 0;
+    }
+
+    *value = negative ? 0u - (uint32_t)number : (uint32_t)number;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Convert a decimal operand of known length at a given width
+ * @param    text    Operand characters, need not be NUL terminated
+ * @param    length  Number of characters
+ * @param    width   Operand width
+ * @param    value   Converted operand, zero extended from the width
+ * @return   1 if valid, 0 otherwise
+ * @note     32 bits keeps calc_parse_uint32's strtoul() rules. Wider widths
+ *           accept the same syntax but any value that fits in the width,
+ *           and "-" negates modulo 2^width, so "-1" is all ones.
+ ******************************************************************************/
+int calc_parse_wide(const char *   text,
+                    size_t         length,
+                    calc_width     width,
+                    calc_uint128 * value)
+{
+    const char * cursor   = text;
+    const char * end      = text + length;
+    int          negative = 0;
+    calc_uint128 number   = 0;
+    calc_uint128 limit    = (calc_uint128)UINT64_MAX;
+
+    if (CALC_WIDTH_32 == width)
+    {
+        uint32_t narrow;
+        int      valid = calc_parse_uint32(text, length, &narrow);
+        *value         = narrow;
+        return valid;
+    }
+    if (CALC_WIDTH_128 == width)
+    {
+        limit = ~(calc_uint128)0;
+    }
+    else if (CALC_WIDTH_BIG == width)
+    {
+        return 0; // See calc_big_parse
+    }
+
+    while (cursor < end && is_space(*cursor))
+    {
+        cursor++;
+    }
+    if (cursor < end && ('+' == *cursor || '-' == *cursor))
+    {
+        negative = ('-' == *cursor);
+        cursor++;
+    }
+
+    *value = 0;
+    if (cursor == end || !is_digit(*cursor))
+    {
+        return 0 == length;
+    }
+    for (; cursor < end && is_digit(*cursor); cursor++)
+    {
+        unsigned digit = (unsigned)(*cursor - '0');
+        if (number > (limit - digit) / BASE_DECIMAL)
+        {
+            return 0; // Does not fit in the width
+        }
+        number = (number * BASE_DECIMAL) + digit;
+    }
+    if (cursor != end)
+    {
+        return 0;
+    }
+
+    *value = (negative ? 0 - number : number) & limit;
+    return 1;
+}
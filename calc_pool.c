@@ -0,0 +1,296 @@
+/******************************************************************************
+ * @file    calc_pool.c
+ * @brief   Work-stealing worker pool
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Tasks are plain indices. Each worker owns a deque that submissions are
+ * dealt into round-robin; a worker takes the oldest task from its own deque
+ * and, once that is empty, steals the newest task from another worker's, so
+ * a run of expensive tasks on one worker gets spread over the idle ones.
+ *
+ * Given a NUMA topology, each worker pins itself to a CPU of the node it
+ * is placed on (see calc_numa_place), and steals from the workers of its
+ * own node before crossing to another, so a task's data mostly stays on
+ * the node its owner set it up for.
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "calc_pool.h"
+
+/******************************************************************************
+ * @brief    Fixed-capacity ring of task indices
+ ******************************************************************************/
+typedef struct
+{
+    pthread_mutex_t lock;
+    size_t *        tasks;
+    size_t          head;
+    size_t          count;
+    size_t          capacity;
+} task_deque;
+
+typedef struct
+{
+    calc_pool * pool;
+    unsigned    index;
+    unsigned    node;   // Kernel number of its node; 0 when not pinned
+    unsigned    cpu;
+    int         pinned; // Pins itself to cpu when it starts
+} pool_worker;
+
+struct calc_pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  wake;
+    size_t          pending; // Tasks sitting in any deque
+    int             stopping;
+    unsigned        workers;
+    unsigned        next_deque;
+    unsigned        started;
+    pthread_t *     threads;
+    pool_worker *   worker_args;
+    task_deque *    deques;
+    calc_task       run;
+    void *          context;
+};
+
+/******************************************************************************
+ * @brief    Take the oldest task of a deque (owner side)
+ ******************************************************************************/
+static int deque_pop_front(task_deque * deque, size_t * task)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        *task       = deque->tasks[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+/******************************************************************************
+ * @brief    Take the newest task of a deque (thief side)
+ ******************************************************************************/
+static int deque_pop_back(task_deque * deque, size_t * task)
+{
+    int found = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count > 0)
+    {
+        deque->count--;
+        *task = deque->tasks[(deque->head + deque->count) % deque->capacity];
+        found = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+/******************************************************************************
+ * @brief    Find work for a worker: its own deque first, then its peers'
+ ******************************************************************************/
+static int take_task(calc_pool * pool, unsigned self, size_t * task)
+{
+    unsigned node = pool->worker_args[self].node;
+
+    if (deque_pop_front(&pool->deques[self], task))
+    {
+        return 1;
+    }
+
+    // Peers on the same node first, then the rest
+    for (int local = 1; local >= 0; local--)
+    {
+        for (unsigned offset = 1; offset < pool->workers; offset++)
+        {
+            unsigned victim = (self + offset) % pool->workers;
+            if ((node == pool->worker_args[victim].node) == local &&
+                deque_pop_back(&pool->deques[victim], task))
+            {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Worker thread body
+ ******************************************************************************/
+static void * worker_main(void * argument)
+{
+    pool_worker * worker = argument;
+    calc_pool *   pool   = worker->pool;
+    size_t        task;
+
+    if (worker->pinned)
+    {
+        (void)calc_numa_pin(worker->cpu);
+    }
+    for (;;)
+    {
+        if (take_task(pool, worker->index, &task))
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->pending--;
+            pthread_mutex_unlock(&pool->lock);
+
+            pool->run(pool->context, task, worker->index);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (0 == pool->pending && !pool->stopping)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        int finished = (0 == pool->pending && pool->stopping);
+        pthread_mutex_unlock(&pool->lock);
+        if (finished)
+        {
+            break;
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Start a pool of worker threads
+ * @param    workers     Number of threads, at least 1
+ * @param    max_tasks   Most tasks that are ever submitted but not yet run
+ * @param    run         Task function
+ * @param    context     Passed to every call of run
+ * @param    numa        Nodes to place the workers on, or NULL to leave
+ *                       them to the scheduler
+ * @return   Pool, or NULL if it could not be started
+ ******************************************************************************/
+calc_pool * calc_pool_create(unsigned          workers,
+                             size_t            max_tasks,
+                             calc_task         run,
+                             void *            context,
+                             const calc_numa * numa)
+{
+    calc_pool * pool = calloc(1, sizeof(*pool));
+
+    if (NULL == pool)
+    {
+        return NULL;
+    }
+    pool->workers     = (0 == workers) ? 1 : workers;
+    pool->run         = run;
+    pool->context     = context;
+    pool->threads     = calloc(pool->workers, sizeof(*pool->threads));
+    pool->worker_args = calloc(pool->workers, sizeof(*pool->worker_args));
+    pool->deques      = calloc(pool->workers, sizeof(*pool->deques));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    if (NULL == pool->threads || NULL == pool->worker_args ||
+        NULL == pool->deques)
+    {
+        calc_pool_destroy(pool);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < pool->workers; i++)
+    {
+        task_deque * deque = &pool->deques[i];
+        pthread_mutex_init(&deque->lock, NULL);
+        deque->capacity = (0 == max_tasks) ? 1 : max_tasks;
+        deque->tasks    = malloc(deque->capacity * sizeof(*deque->tasks));
+        if (NULL == deque->tasks)
+        {
+            calc_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    for (unsigned i = 0; i < pool->workers; i++)
+    {
+        pool->worker_args[i].pool  = pool;
+        pool->worker_args[i].index = i;
+        if (NULL != numa)
+        {
+            pool->worker_args[i].node =
+                calc_numa_place(numa, i, &pool->worker_args[i].cpu);
+            pool->worker_args[i].pinned = 1;
+        }
+        if (0 != pthread_create(&pool->threads[i],
+                                NULL,
+                                worker_main,
+                                &pool->worker_args[i]))
+        {
+            calc_pool_destroy(pool);
+            return NULL;
+        }
+        pool->started++;
+    }
+    return pool;
+}
+
+/******************************************************************************
+ * @brief    Queue a task
+ * @param    pool    Worker pool
+ * @param    task    Task index passed to the task function
+ ******************************************************************************/
+void calc_pool_submit(calc_pool * pool, size_t task)
+{
+    // Holding the pool lock keeps pending in step with the deques
+    pthread_mutex_lock(&pool->lock);
+    task_deque * deque = &pool->deques[pool->next_deque];
+    pool->next_deque   = (pool->next_deque + 1) % pool->workers;
+
+    pthread_mutex_lock(&deque->lock);
+    deque->tasks[(deque->head + deque->count) % deque->capacity] = task;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+
+    pool->pending++;
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/******************************************************************************
+ * @brief    Run every queued task, then stop the workers and free the pool
+ * @param    pool    Worker pool, may be NULL
+ ******************************************************************************/
+void calc_pool_destroy(calc_pool * pool)
+{
+    if (NULL == pool)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (unsigned i = 0; i < pool->started; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    if (NULL != pool->deques)
+    {
+        for (unsigned i = 0; i < pool->workers; i++)
+        {
+            if (0 != pool->deques[i].capacity)
+            {
+                pthread_mutex_destroy(&pool->deques[i].lock);
+            }
+            free(pool->deques[i].tasks);
+        }
+    }
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool->worker_args);
+    free(pool->threads);
+    free(pool);
+}
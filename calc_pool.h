@@ -0,0 +1,27 @@
+/******************************************************************************
+ * @file    calc_pool.h
+ * @brief   Work-stealing worker pool (internal)
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#ifndef CALC_POOL_H
+#define CALC_POOL_H
+
+#include <stddef.h>
+#include "calc_numa.h"
+
+typedef struct calc_pool calc_pool;
+
+// Runs one task; worker is the index of the thread running it
+typedef void (*calc_task)(void * context, size_t task, unsigned worker);
+
+calc_pool * calc_pool_create(unsigned          workers,
+                             size_t            max_tasks,
+                             calc_task         run,
+                             void *            context,
+                             const calc_numa * numa);
+void        calc_pool_submit(calc_pool * pool, size_t task);
+void        calc_pool_destroy(calc_pool * pool);
+
+#endif // CALC_POOL_H
@@ -0,0 +1,717 @@
+/******************************************************************************
+ * @file    calc_reduce.c
+ * @brief   Reductions of a column of 32-bit values: sum, bitwise folds,
+ *          minimum, maximum and population count
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Each instruction set folds whole vectors into an accumulator of the same
+ * width, whose lanes are folded into the partial once at the end; sums
+ * widen every lane to 64 bits first, so no lane can overflow. The scalar
+ * loop finishes the remaining values. AVX-512 runs the AVX2 kernels, which
+ * already load more than memory delivers.
+ *
+ * A sum keeps perform_addition's bounds: unless it is wide, the total must
+ * fit in 32 bits, or the reduction fails with CALC_ERR_ADD_OVERFLOW. It is
+ * the total that is checked, not each running sum, as that is what stays
+ * the same however the values are split between lanes and threads. A wide
+ * sum only fails if the 64-bit total overflows.
+ *
+ * With threads, the values are cut into tasks of REDUCE_TASK values for a
+ * work-stealing pool, and the partials of the tasks are merged pairwise as
+ * a tree of fixed shape, so the result never depends on scheduling.
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "calc.h"
+#include "calc_pool.h"
+#include "calc_reduce.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CALC_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define CALC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define REDUCE_TASK (64 * 1024) // Values per task, and per kernel call
+
+/******************************************************************************
+ * @brief    Work shared by the tasks of a threaded reduction
+ ******************************************************************************/
+typedef struct
+{
+    calc_isa              isa;
+    calc_reduce_op        op;
+    const uint32_t *      values;
+    size_t                count;
+    calc_reduce_partial * partials; // One per task
+} reduce_job;
+
+/******************************************************************************
+ * @brief    Fold values into a partial value one at a time
+ * @param    op      Operator
+ * @param    values  Values
+ * @param    count   Number of values
+ * @param    folded  Partial value, updated
+ ******************************************************************************/
+static void reduce_scalar(calc_reduce_op   op,
+                          const uint32_t * values,
+                          size_t           count,
+                          int64_t *        folded)
+{
+    int64_t  value = *folded;
+    uint32_t bits  = (uint32_t)value;
+    int32_t  bound = (int32_t)value;
+
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+            for (size_t i = 0; i < count; i++)
+            {
+                value += (int32_t)values[i];
+            }
+            break;
+        case CALC_REDUCE_XOR:
+            for (size_t i = 0; i < count; i++)
+            {
+                bits ^= values[i];
+            }
+            value = bits;
+            break;
+        case CALC_REDUCE_AND:
+            for (size_t i = 0; i < count; i++)
+            {
+                bits &= values[i];
+            }
+            value = bits;
+            break;
+        case CALC_REDUCE_OR:
+            for (size_t i = 0; i < count; i++)
+            {
+                bits |= values[i];
+            }
+            value = bits;
+            break;
+        case CALC_REDUCE_MIN:
+            for (size_t i = 0; i < count; i++)
+            {
+                bound = ((int32_t)values[i] < bound) ? (int32_t)values[i]
+                                                     : bound;
+            }
+            value = bound;
+            break;
+        case CALC_REDUCE_MAX:
+            for (size_t i = 0; i < count; i++)
+            {
+                bound = ((int32_t)values[i] > bound) ? (int32_t)values[i]
+                                                     : bound;
+            }
+            value = bound;
+            break;
+        case CALC_REDUCE_POPCOUNT:
+            for (size_t i = 0; i < count; i++)
+            {
+                value += __builtin_popcount(values[i]);
+            }
+            break;
+        default:
+            break;
+    }
+    *folded = value;
+}
+
+#if defined(CALC_SIMD_X86)
+
+// Bitwise folds, minima and maxima: fold whole vectors into acc with COMBINE,
+// starting from the identity in every lane, then fold the lanes of acc
+#define REDUCE_LANES(type, width, load, store, set1, COMBINE)              \
+    {                                                                      \
+        type     acc = set1((int)(uint32_t)calc_reduce_identity(op).value); \
+        uint32_t lanes[width];                                             \
+        for (; i + (width) <= count; i += (width))                         \
+        {                                                                  \
+            type x = load((const type *)(values + i));                     \
+            acc    = COMBINE;                                              \
+        }                                                                  \
+        store((type *)lanes, acc);                                         \
+        reduce_scalar(op, lanes, (width), folded);                         \
+    }
+
+/******************************************************************************
+ * @brief    Sum of the 64-bit lanes of an accumulator
+ ******************************************************************************/
+static int64_t add_lanes(const int64_t * lanes, size_t count)
+{
+    int64_t total = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        total += lanes[i];
+    }
+    return total;
+}
+
+/******************************************************************************
+ * @brief    SSE2 kernels; SSE2 lacks a sign extension, a 32-bit minimum and
+ *           a byte shuffle, which are made of compares and masks
+ * @return   Number of values folded
+ ******************************************************************************/
+__attribute__((target("sse2"))) static size_t reduce_sse2(
+    calc_reduce_op op, const uint32_t * values, size_t count, int64_t * folded)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t        i    = 0;
+
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+        {
+            __m128i low  = zero;
+            __m128i high = zero;
+            int64_t lanes[2];
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i x    = _mm_loadu_si128((const __m128i *)(values + i));
+                __m128i sign = _mm_srai_epi32(x, 31);
+                low          = _mm_add_epi64(low, _mm_unpacklo_epi32(x, sign));
+                high = _mm_add_epi64(high, _mm_unpackhi_epi32(x, sign));
+            }
+            _mm_storeu_si128((__m128i *)lanes, _mm_add_epi64(low, high));
+            *folded += add_lanes(lanes, 2);
+            break;
+        }
+        case CALC_REDUCE_XOR:
+            REDUCE_LANES(__m128i,
+                         4,
+                         _mm_loadu_si128,
+                         _mm_storeu_si128,
+                         _mm_set1_epi32,
+                         _mm_xor_si128(acc, x))
+            break;
+        case CALC_REDUCE_AND:
+            REDUCE_LANES(__m128i,
+                         4,
+                         _mm_loadu_si128,
+                         _mm_storeu_si128,
+                         _mm_set1_epi32,
+                         _mm_and_si128(acc, x))
+            break;
+        case CALC_REDUCE_OR:
+            REDUCE_LANES(__m128i,
+                         4,
+                         _mm_loadu_si128,
+                         _mm_storeu_si128,
+                         _mm_set1_epi32,
+                         _mm_or_si128(acc, x))
+            break;
+        case CALC_REDUCE_MIN:
+            REDUCE_LANES(__m128i,
+                         4,
+                         _mm_loadu_si128,
+                         _mm_storeu_si128,
+                         _mm_set1_epi32,
+                         _mm_or_si128(
+                             _mm_and_si128(_mm_cmpgt_epi32(acc, x), x),
+                             _mm_andnot_si128(_mm_cmpgt_epi32(acc, x), acc)))
+            break;
+        case CALC_REDUCE_MAX:
+            REDUCE_LANES(__m128i,
+                         4,
+                         _mm_loadu_si128,
+                         _mm_storeu_si128,
+                         _mm_set1_epi32,
+                         _mm_or_si128(
+                             _mm_and_si128(_mm_cmpgt_epi32(x, acc), x),
+                             _mm_andnot_si128(_mm_cmpgt_epi32(x, acc), acc)))
+            break;
+        case CALC_REDUCE_POPCOUNT:
+        {
+            // Bits counted in pairs, nibbles, then bytes, which psadbw sums
+            const __m128i pairs   = _mm_set1_epi8(0x55);
+            const __m128i nibbles = _mm_set1_epi8(0x33);
+            const __m128i bytes   = _mm_set1_epi8(0x0f);
+            __m128i       acc     = zero;
+            int64_t       lanes[2];
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i *)(values + i));
+                x = _mm_sub_epi8(x, _mm_and_si128(_mm_srli_epi16(x, 1), pairs));
+                x = _mm_add_epi8(_mm_and_si128(x, nibbles),
+                                 _mm_and_si128(_mm_srli_epi16(x, 2), nibbles));
+                x = _mm_and_si128(_mm_add_epi8(x, _mm_srli_epi16(x, 4)), bytes);
+                acc = _mm_add_epi64(acc, _mm_sad_epu8(x, zero));
+            }
+            _mm_storeu_si128((__m128i *)lanes, acc);
+            *folded += add_lanes(lanes, 2);
+            break;
+        }
+        default:
+            break;
+    }
+    return i;
+}
+
+/******************************************************************************
+ * @brief    AVX2 kernels
+ * @return   Number of values folded
+ ******************************************************************************/
+__attribute__((target("avx2"))) static size_t reduce_avx2(
+    calc_reduce_op op, const uint32_t * values, size_t count, int64_t * folded)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    size_t        i    = 0;
+
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+        {
+            __m256i low  = zero;
+            __m256i high = zero;
+            int64_t lanes[4];
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i x =
+                    _mm256_loadu_si256((const __m256i *)(values + i));
+                __m128i first  = _mm256_castsi256_si128(x);
+                __m128i second = _mm256_extracti128_si256(x, 1);
+                low  = _mm256_add_epi64(low, _mm256_cvtepi32_epi64(first));
+                high = _mm256_add_epi64(high, _mm256_cvtepi32_epi64(second));
+            }
+            _mm256_storeu_si256((__m256i *)lanes, _mm256_add_epi64(low, high));
+            *folded += add_lanes(lanes, 4);
+            break;
+        }
+        case CALC_REDUCE_XOR:
+            REDUCE_LANES(__m256i,
+                         8,
+                         _mm256_loadu_si256,
+                         _mm256_storeu_si256,
+                         _mm256_set1_epi32,
+                         _mm256_xor_si256(acc, x))
+            break;
+        case CALC_REDUCE_AND:
+            REDUCE_LANES(__m256i,
+                         8,
+                         _mm256_loadu_si256,
+                         _mm256_storeu_si256,
+                         _mm256_set1_epi32,
+                         _mm256_and_si256(acc, x))
+            break;
+        case CALC_REDUCE_OR:
+            REDUCE_LANES(__m256i,
+                         8,
+                         _mm256_loadu_si256,
+                         _mm256_storeu_si256,
+                         _mm256_set1_epi32,
+                         _mm256_or_si256(acc, x))
+            break;
+        case CALC_REDUCE_MIN:
+            REDUCE_LANES(__m256i,
+                         8,
+                         _mm256_loadu_si256,
+                         _mm256_storeu_si256,
+                         _mm256_set1_epi32,
+                         _mm256_min_epi32(acc, x))
+            break;
+        case CALC_REDUCE_MAX:
+            REDUCE_LANES(__m256i,
+                         8,
+                         _mm256_loadu_si256,
+                         _mm256_storeu_si256,
+                         _mm256_set1_epi32,
+                         _mm256_max_epi32(acc, x))
+            break;
+        case CALC_REDUCE_POPCOUNT:
+        {
+            // Each nibble's count looked up in a table, as Mula's popcount
+            const __m256i table = _mm256_setr_epi8(
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i nibble = _mm256_set1_epi8(0x0f);
+            __m256i       acc    = zero;
+            int64_t       lanes[4];
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256i x =
+                    _mm256_loadu_si256((const __m256i *)(values + i));
+                __m256i bits = _mm256_add_epi8(
+                    _mm256_shuffle_epi8(table, _mm256_and_si256(x, nibble)),
+                    _mm256_shuffle_epi8(
+                        table,
+                        _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+                acc = _mm256_add_epi64(acc, _mm256_sad_epu8(bits, zero));
+            }
+            _mm256_storeu_si256((__m256i *)lanes, acc);
+            *folded += add_lanes(lanes, 4);
+            break;
+        }
+        default:
+            break;
+    }
+    return i;
+}
+
+#endif // CALC_SIMD_X86
+
+#if defined(CALC_SIMD_NEON)
+
+/******************************************************************************
+ * @brief    NEON kernels
+ * @return   Number of values folded
+ ******************************************************************************/
+static size_t reduce_neon(calc_reduce_op   op,
+                          const uint32_t * values,
+                          size_t           count,
+                          int64_t *        folded)
+{
+    uint32x4_t acc = vdupq_n_u32((uint32_t)calc_reduce_identity(op).value);
+    uint32_t   lanes[4];
+    size_t     i = 0;
+
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+        {
+            int64x2_t total = vdupq_n_s64(0);
+            for (; i + 4 <= count; i += 4)
+            {
+                int32x4_t x = vreinterpretq_s32_u32(vld1q_u32(values + i));
+                total       = vpadalq_s32(total, x);
+            }
+            *folded += vaddvq_s64(total);
+            return i;
+        }
+        case CALC_REDUCE_POPCOUNT:
+        {
+            uint64x2_t total = vdupq_n_u64(0);
+            for (; i + 4 <= count; i += 4)
+            {
+                uint8x16_t bits =
+                    vcntq_u8(vreinterpretq_u8_u32(vld1q_u32(values + i)));
+                total = vpadalq_u32(total, vpaddlq_u16(vpaddlq_u8(bits)));
+            }
+            *folded += (int64_t)vaddvq_u64(total);
+            return i;
+        }
+        case CALC_REDUCE_XOR:
+            for (; i + 4 <= count; i += 4)
+            {
+                acc = veorq_u32(acc, vld1q_u32(values + i));
+            }
+            break;
+        case CALC_REDUCE_AND:
+            for (; i + 4 <= count; i += 4)
+            {
+                acc = vandq_u32(acc, vld1q_u32(values + i));
+            }
+            break;
+        case CALC_REDUCE_OR:
+            for (; i + 4 <= count; i += 4)
+            {
+                acc = vorrq_u32(acc, vld1q_u32(values + i));
+            }
+            break;
+        case CALC_REDUCE_MIN:
+            for (; i + 4 <= count; i += 4)
+            {
+                acc = vreinterpretq_u32_s32(
+                    vminq_s32(vreinterpretq_s32_u32(acc),
+                              vreinterpretq_s32_u32(vld1q_u32(values + i))));
+            }
+            break;
+        case CALC_REDUCE_MAX:
+            for (; i + 4 <= count; i += 4)
+            {
+                acc = vreinterpretq_u32_s32(
+                    vmaxq_s32(vreinterpretq_s32_u32(acc),
+                              vreinterpretq_s32_u32(vld1q_u32(values + i))));
+            }
+            break;
+        default:
+            return 0;
+    }
+    vst1q_u32(lanes, acc);
+    reduce_scalar(op, lanes, 4, folded);
+    return i;
+}
+
+#endif // CALC_SIMD_NEON
+
+/******************************************************************************
+ * @brief    Partial of no values
+ * @param    op      Operator
+ * @return   Partial whose value is the identity of op
+ ******************************************************************************/
+calc_reduce_partial calc_reduce_identity(calc_reduce_op op)
+{
+    calc_reduce_partial partial = { 0, 0, 0 };
+
+    switch (op)
+    {
+        case CALC_REDUCE_AND:
+            partial.value = UINT32_MAX;
+            break;
+        case CALC_REDUCE_MIN:
+            partial.value = INT32_MAX;
+            break;
+        case CALC_REDUCE_MAX:
+            partial.value = INT32_MIN;
+            break;
+        default:
+            break;
+    }
+    return partial;
+}
+
+/******************************************************************************
+ * @brief    Fold values into a partial
+ * @param    isa     Instruction set, which must be supported
+ * @param    op      Operator
+ * @param    values  Values
+ * @param    count   Number of values
+ * @param    partial Partial, updated
+ ******************************************************************************/
+void calc_reduce_values(calc_isa              isa,
+                        calc_reduce_op        op,
+                        const uint32_t *      values,
+                        size_t                count,
+                        calc_reduce_partial * partial)
+{
+    // Kernel calls are kept short enough that a 64-bit lane cannot overflow
+    for (size_t start = 0; start < count; start += REDUCE_TASK)
+    {
+        size_t              length = (count - start < REDUCE_TASK)
+                                         ? count - start
+                                         : REDUCE_TASK;
+        const uint32_t *    block  = values + start;
+        calc_reduce_partial piece  = calc_reduce_identity(op);
+        size_t              done   = 0;
+
+        switch (isa)
+        {
+#if defined(CALC_SIMD_X86)
+            case CALC_ISA_SSE2:
+                done = reduce_sse2(op, block, length, &piece.value);
+                break;
+            case CALC_ISA_AVX2:
+            case CALC_ISA_AVX512:
+                done = reduce_avx2(op, block, length, &piece.value);
+                break;
+#endif
+#if defined(CALC_SIMD_NEON)
+            case CALC_ISA_NEON:
+                done = reduce_neon(op, block, length, &piece.value);
+                break;
+#endif
+            default:
+                break;
+        }
+        reduce_scalar(op, block + done, length - done, &piece.value);
+        piece.count = length;
+        calc_reduce_merge(op, partial, &piece);
+    }
+}
+
+/******************************************************************************
+ * @brief    Merge one partial into another
+ * @param    op      Operator
+ * @param    into    Partial, updated to cover the values of both
+ * @param    from    Partial to merge
+ ******************************************************************************/
+void calc_reduce_merge(calc_reduce_op              op,
+                       calc_reduce_partial *       into,
+                       const calc_reduce_partial * from)
+{
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+            into->overflow |= __builtin_add_overflow(
+                into->value, from->value, &into->value);
+            break;
+        case CALC_REDUCE_XOR:
+            into->value ^= from->value;
+            break;
+        case CALC_REDUCE_AND:
+            into->value &= from->value;
+            break;
+        case CALC_REDUCE_OR:
+            into->value |= from->value;
+            break;
+        case CALC_REDUCE_MIN:
+            into->value = (from->value < into->value) ? from->value
+                                                      : into->value;
+            break;
+        case CALC_REDUCE_MAX:
+            into->value = (from->value > into->value) ? from->value
+                                                      : into->value;
+            break;
+        case CALC_REDUCE_POPCOUNT:
+            into->value += from->value;
+            break;
+        default:
+            break;
+    }
+    into->overflow |= from->overflow;
+    into->count += from->count;
+}
+
+/******************************************************************************
+ * @brief    Result of a reduction from the partial of every value
+ * @param    op      Operator
+ * @param    partial Partial of every value
+ * @param    wide    Nonzero if a sum may take 64 bits
+ * @return   Result of the reduction
+ ******************************************************************************/
+calc_reduction calc_reduce_finish(calc_reduce_op              op,
+                                  const calc_reduce_partial * partial,
+                                  int                         wide)
+{
+    calc_reduction result = { CALC_OK, partial->value, partial->count };
+
+    if ((unsigned)op >= CALC_REDUCE_COUNT || CALC_REDUCE_INVALID == op)
+    {
+        result.status = CALC_ERR_UNSUPPORTED_OPERATOR;
+    }
+    else if (CALC_REDUCE_SUM == op &&
+             (partial->overflow ||
+              (!wide && (partial->value < INT32_MIN ||
+                         partial->value > INT32_MAX))))
+    {
+        result.status = CALC_ERR_ADD_OVERFLOW;
+    }
+    else if ((CALC_REDUCE_MIN == op || CALC_REDUCE_MAX == op) &&
+             0 == partial->count)
+    {
+        result.status = CALC_ERR_EMPTY;
+    }
+    return result;
+}
+
+/******************************************************************************
+ * @brief    Pool task: reduce one task's share of the values
+ ******************************************************************************/
+static void reduce_task(void * context, size_t task, unsigned worker)
+{
+    reduce_job * job   = context;
+    size_t       start = task * REDUCE_TASK;
+    size_t       count = (job->count - start < REDUCE_TASK) ? job->count - start
+                                                            : REDUCE_TASK;
+
+    (void)worker;
+    job->partials[task] = calc_reduce_identity(job->op);
+    calc_reduce_values(
+        job->isa, job->op, job->values + start, count, &job->partials[task]);
+}
+
+/******************************************************************************
+ * @brief    Decode the name of a reduction
+ * @param    name    "+", "^", "&", "|", "min", "max" or "popcount"
+ * @return   Operator, or CALC_REDUCE_INVALID if unknown
+ ******************************************************************************/
+calc_reduce_op calc_parse_reduction(const char * name)
+{
+    static const struct
+    {
+        const char *   name;
+        calc_reduce_op op;
+    } names[] = {
+        { "+", CALC_REDUCE_SUM },         { "^", CALC_REDUCE_XOR },
+        { "&", CALC_REDUCE_AND },         { "|", CALC_REDUCE_OR },
+        { "min", CALC_REDUCE_MIN },       { "max", CALC_REDUCE_MAX },
+        { "popcount", CALC_REDUCE_POPCOUNT },
+    };
+
+    for (size_t i = 0; NULL != name && i < sizeof(names) / sizeof(names[0]);
+         i++)
+    {
+        if (0 == strcmp(name, names[i].name))
+        {
+            return names[i].op;
+        }
+    }
+    return CALC_REDUCE_INVALID;
+}
+
+/******************************************************************************
+ * @brief    Reduce a column of values using a given instruction set
+ * @param    isa     Instruction set; an unsupported one falls back to scalar
+ * @param    op      Operator
+ * @param    values  Values
+ * @param    count   Number of values
+ * @param    threads Most threads to use; 0 or 1 reduces on the caller
+ * @param    wide    Nonzero if a sum may take 64 bits rather than 32
+ * @return   Result of the reduction: CALC_ERR_ADD_OVERFLOW for a sum out of
+ *           bounds, CALC_ERR_EMPTY for a minimum or maximum of no values,
+ *           CALC_ERR_NO_MEMORY if the threads could not be started
+ ******************************************************************************/
+calc_reduction calc_reduce_isa(calc_isa         isa,
+                               calc_reduce_op   op,
+                               const uint32_t * values,
+                               size_t           count,
+                               unsigned         threads,
+                               int              wide)
+{
+    calc_reduce_partial total = calc_reduce_identity(op);
+    size_t              tasks = (count + REDUCE_TASK - 1) / REDUCE_TASK;
+
+    if (!calc_isa_supported(isa))
+    {
+        isa = CALC_ISA_SCALAR;
+    }
+    if (threads <= 1 || tasks <= 1)
+    {
+        calc_reduce_values(isa, op, values, count, &total);
+        return calc_reduce_finish(op, &total, wide);
+    }
+
+    reduce_job job = { isa, op, values, count, NULL };
+    job.partials   = malloc(tasks * sizeof(*job.partials));
+    calc_pool * pool =
+        (NULL != job.partials)
+            ? calc_pool_create(
+                  (threads < tasks) ? threads : (unsigned)tasks,
+                  tasks,
+                  reduce_task,
+                  &job,
+                  NULL)
+            : NULL;
+    if (NULL == pool)
+    {
+        calc_reduction failure = { CALC_ERR_NO_MEMORY, 0, 0 };
+        free(job.partials);
+        return failure;
+    }
+    for (size_t task = 0; task < tasks; task++)
+    {
+        calc_pool_submit(pool, task);
+    }
+    calc_pool_destroy(pool); // Runs every task first
+
+    // Merge neighbours, then neighbouring pairs, and so on up the tree
+    for (size_t stride = 1; stride < tasks; stride *= 2)
+    {
+        for (size_t i = 0; i + stride < tasks; i += 2 * stride)
+        {
+            calc_reduce_merge(op, &job.partials[i], &job.partials[i + stride]);
+        }
+    }
+    calc_reduce_merge(op, &total, &job.partials[0]);
+    free(job.partials);
+    return calc_reduce_finish(op, &total, wide);
+}
+
+/******************************************************************************
+ * @brief    Reduce a column of values with the widest instruction set
+ * @see      calc_reduce_isa, whose contract this follows
+ ******************************************************************************/
+calc_reduction calc_reduce(calc_reduce_op   op,
+                           const uint32_t * values,
+                           size_t           count,
+                           unsigned         threads,
+                           int              wide)
+{
+    return calc_reduce_isa(calc_isa_detect(), op, values, count, threads, wide);
+}
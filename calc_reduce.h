@@ -0,0 +1,44 @@
+/******************************************************************************
+ * @file    calc_reduce.h
+ * @brief   Partial reductions shared by the array, batch and binary drivers
+ *          (internal)
+ * @version 1.6
+ * @date    October 2026
+ *
+ * A reduction is built from partials: each covers some of the values, and
+ * merging two gives the partial of both. Every operator is associative and
+ * commutative (a sum is kept exact in 64 bits), so partials can be formed
+ * in any order, on any thread, and merged as a tree.
+ ******************************************************************************/
+
+#ifndef CALC_REDUCE_H
+#define CALC_REDUCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "calc.h"
+
+/******************************************************************************
+ * @brief    Reduction of some of the values
+ ******************************************************************************/
+typedef struct
+{
+    int64_t  value;    // Total, extreme, folded bits or bit count so far
+    uint64_t count;    // Values folded in
+    int      overflow; // The 64-bit total overflowed
+} calc_reduce_partial;
+
+calc_reduce_partial calc_reduce_identity(calc_reduce_op op);
+void                calc_reduce_values(calc_isa              isa,
+                                       calc_reduce_op        op,
+                                       const uint32_t *      values,
+                                       size_t                count,
+                                       calc_reduce_partial * partial);
+void                calc_reduce_merge(calc_reduce_op              op,
+                                      calc_reduce_partial *       into,
+                                      const calc_reduce_partial * from);
+calc_reduction      calc_reduce_finish(calc_reduce_op              op,
+                                       const calc_reduce_partial * partial,
+                                       int                         wide);
+
+#endif // CALC_REDUCE_H
@@ -0,0 +1,1253 @@
+/******************************************************************************
+ * @file    calc_server.c
+ * @brief   Persistent calculation server over Unix and TCP sockets
+ * @version 1.6
+ * @date    October 2026
+ *
+ * One thread serves every connection from an epoll loop. Clients may
+ * pipeline requests freely: each read is split into whole requests, every
+ * one of them is answered into the connection's output buffer, and the
+ * answers go out in as few writes as the socket allows. A request is either
+ * a batch line ("operand1 operator operand2\n", answered with the line
+ * batch mode would print) or a binary request, recognised by its magic and
+ * answered with the binary response (see calc.h); both kinds may be mixed
+ * on one connection and are answered in order.
+ *
+ * A request that starts with "GET ", as no batch line can, is taken for an
+ * HTTP/1.0 request instead: GET /metrics is answered with the statistics
+ * of every thread in the Prometheus text format, anything else with 404,
+ * and the connection is closed once the answer is sent.
+ *
+ * A client that stops reading has its connection stop being read too, once
+ * a bounded amount of output is waiting for it. A client that sends a
+ * malformed binary header is disconnected, as the stream cannot be resynced.
+ *
+ * With io_uring the loop is driven by completions instead: listeners keep a
+ * multishot accept armed, and clients a multishot recv that picks from a
+ * ring of provided buffers, so a busy connection costs no system call per
+ * read. Answers are sent from a second buffer while new ones are appended
+ * to the first, and every request submitted in one pass goes out in the
+ * io_uring_enter() that waits for the next completions. Backpressure
+ * cancels the recv, and a client is only freed once the kernel has
+ * finished every request that refers to it.
+ ******************************************************************************/
+
+#define _GNU_SOURCE // accept4()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_net.h"
+#include "calc_uring.h"
+
+#define SERVER_EVENTS      256
+#define SERVER_BACKLOG     1024
+#define SERVER_READ_SIZE   (64 * 1024)
+#define SERVER_OUTPUT_HIGH (1024 * 1024) // Unsent bytes before reading pauses
+#define SERVER_BINARY_MAX  (64 * 1024 * 1024) // Largest binary request
+#define SERVER_ARENA_BLOCK (128 * 1024) // Scratch of a typical binary request
+#define SERVER_PORT_MAX    16
+#define SERVER_RING_SIZE   1024
+#define SERVER_BUFFERS     256         // Provided receive buffers
+#define SERVER_BUFFER_SIZE (16 * 1024)
+#define SERVER_OP_MASK     3u          // Low bits of ring user_data
+#define SERVER_HTTP_MAX    8192        // Longest HTTP request head
+#define SERVER_HTTP_HEADER 160         // Status line and headers of a reply
+
+typedef enum
+{
+    ENDPOINT_CLIENT = 0,
+    ENDPOINT_UNIX,
+    ENDPOINT_TCP,
+    ENDPOINT_WAKE
+} endpoint_kind;
+
+// Ring request an endpoint has in flight, tagged onto its address
+typedef enum
+{
+    SERVER_OP_INPUT = 0, // Wake-up read, accept or recv, by endpoint kind
+    SERVER_OP_SEND,
+    SERVER_OP_CANCEL
+} server_op;
+
+/******************************************************************************
+ * @brief    Anything registered with epoll: a listener, the wake-up event or
+ *           a client connection
+ ******************************************************************************/
+typedef struct server_endpoint
+{
+    int                      fd;
+    endpoint_kind            kind;
+    uint32_t                 events;     // Registered with epoll
+    int                      discarding; // Dropping the rest of a long line
+    int                      finished;   // Peer sent everything it will
+    int                      replied;    // Answered HTTP, input is dropped
+    calc_buffer              input;      // Unanswered requests
+    calc_buffer              output;
+    calc_buffer              outgoing;   // Output being sent through a ring
+    size_t                   sent;       // Bytes of output, or of outgoing
+                                         // with a ring, already written
+    unsigned                 operations; // Ring requests in flight
+    int                      receiving;  // Ring input request armed
+    int                      sending;
+    int                      paused;     // Recv cancelled for backpressure
+    int                      closing;    // Freed once operations is 0
+    struct server_endpoint * previous;
+    struct server_endpoint * next;
+} server_endpoint;
+
+struct calc_server
+{
+    int               epoll_fd;
+    int               spare_fd; // Closed to shed a client when out of fds
+    server_endpoint   wake;     // Written by calc_server_stop
+    server_endpoint   unix_listener;
+    server_endpoint   tcp_listener;
+    server_endpoint * clients;
+    calc_cache *      cache;
+    calc_arena *      arena; // Reset after every binary request
+    calc_batch_counts counts;
+    int               ringed;       // Driven by ring instead of epoll
+    int               oneshot_recv; // Kernel lacks multishot recv
+    unsigned          operations;   // Ring requests in flight, in total
+    uint64_t          wake_value;
+    calc_uring        ring;
+    char              unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+};
+
+static const char metrics_path[] = "/metrics";
+
+/******************************************************************************
+ * @brief    Whether bytes start, or may yet start, a binary request
+ ******************************************************************************/
+static int starts_binary(const char * bytes, size_t available)
+{
+    size_t length =
+        (available < CALC_NET_MAGIC_SIZE) ? available : CALC_NET_MAGIC_SIZE;
+    return 0 == memcmp(bytes, calc_net_request_magic, length);
+}
+
+/******************************************************************************
+ * @brief    Whether bytes start, or may yet start, an HTTP request
+ ******************************************************************************/
+static int starts_http(const char * bytes, size_t available)
+{
+    size_t method = sizeof(calc_net_http_method) - 1;
+    size_t length = (available < method) ? available : method;
+    return 0 == memcmp(bytes, calc_net_http_method, length);
+}
+
+/******************************************************************************
+ * @brief    Answer an HTTP request for the statistics, once its head is in
+ * @param    client      Client connection
+ * @param    request     Request, starting with its method
+ * @param    available   Bytes of the request received so far
+ * @return   1 if answered or still incomplete, 0 if the client must be
+ *           disconnected
+ ******************************************************************************/
+static int answer_http(server_endpoint * client,
+                       const char *      request,
+                       size_t            available)
+{
+    size_t       scan  = (available < SERVER_HTTP_MAX) ? available
+                                                       : SERVER_HTTP_MAX;
+    const char * head  = request;
+    const char * end   = NULL;
+    size_t       path  = sizeof(calc_net_http_method) - 1;
+    size_t       match = sizeof(metrics_path) - 1;
+
+    // The head ends with an empty line; requests carry no body to wait for
+    for (size_t i = 0; NULL == end && i + 1 < scan; i++)
+    {
+        if ('\n' == head[i] &&
+            ('\n' == head[i + 1] ||
+             (i + 2 < scan && '\r' == head[i + 1] && '\n' == head[i + 2])))
+        {
+            end = head + i;
+        }
+    }
+    if (NULL == end)
+    {
+        return !client->finished && available < SERVER_HTTP_MAX;
+    }
+
+    int found = (size_t)(end - head) > path + match &&
+                0 == memcmp(head + path, metrics_path, match) &&
+                NULL != memchr(" ?", head[path + match], 2);
+
+    calc_buffer body = { NULL, 0, 0 };
+    calc_stats  stats;
+    if (found)
+    {
+        calc_stats_snapshot(&stats);
+        if (!calc_stats_format(&body, &stats))
+        {
+            calc_buffer_free(&body);
+            return 0;
+        }
+    }
+    else if (calc_buffer_reserve(&body, sizeof("Not found\n")))
+    {
+        memcpy(body.data, "Not found\n", sizeof("Not found\n") - 1);
+        body.used = sizeof("Not found\n") - 1;
+    }
+    if (NULL == body.data ||
+        !calc_buffer_reserve(&client->output, SERVER_HTTP_HEADER + body.used))
+    {
+        calc_buffer_free(&body);
+        return 0;
+    }
+
+    int written = snprintf(client->output.data + client->output.used,
+                           SERVER_HTTP_HEADER,
+                           "HTTP/1.0 %s\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: %zu\r\n"
+                           "Connection: close\r\n\r\n",
+                           found ? "200 OK" : "404 Not Found",
+                           body.used);
+    client->output.used += (size_t)written;
+    memcpy(client->output.data + client->output.used, body.data, body.used);
+    client->output.used += body.used;
+    calc_buffer_free(&body);
+
+    // Close once the answer is out, whatever else the client sends
+    client->replied  = 1;
+    client->finished = 1;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Register or re-register an endpoint with epoll
+ * @return   1 if successful, 0 otherwise
+ ******************************************************************************/
+static int watch(calc_server *     server,
+                 server_endpoint * endpoint,
+                 int               op,
+                 uint32_t          events)
+{
+    struct epoll_event event;
+
+    if (EPOLL_CTL_MOD == op && events == endpoint->events)
+    {
+        return 1;
+    }
+    memset(&event, 0, sizeof(event));
+    event.events   = events;
+    event.data.ptr = endpoint;
+    if (0 != epoll_ctl(server->epoll_fd, op, endpoint->fd, &event))
+    {
+        return 0;
+    }
+    endpoint->events = events;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Open a Unix domain socket listener, replacing a stale socket
+ * @return   Listening descriptor, or -1
+ ******************************************************************************/
+static int listen_unix(const char * path)
+{
+    struct sockaddr_un address;
+    struct stat        info;
+
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        return -1;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    // Only ever remove a socket, never a file that happens to be in the way
+    if (0 == lstat(path, &info) && S_ISSOCK(info.st_mode))
+    {
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0 &&
+        (0 != bind(fd, (struct sockaddr *)&address, sizeof(address)) ||
+         0 != listen(fd, SERVER_BACKLOG)))
+    {
+        close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+/******************************************************************************
+ * @brief    Open a TCP listener
+ * @param    address "port", "host:port" or "[ipv6 host]:port"
+ * @return   Listening descriptor, or -1
+ ******************************************************************************/
+static int listen_tcp(const char * address)
+{
+    char              host[NI_MAXHOST];
+    char              port[SERVER_PORT_MAX];
+    const char *      colon     = strrchr(address, ':');
+    const char *      port_text = address; // Port only
+    struct addrinfo   hints;
+    struct addrinfo * results;
+    int               fd        = -1;
+
+    host[0] = '\0';
+    if (NULL != colon)
+    {
+        const char * start  = address;
+        size_t       length = (size_t)(colon - address);
+        if (length >= 2 && '[' == start[0] && ']' == start[length - 1])
+        {
+            start++;
+            length -= 2;
+        }
+        if (length >= sizeof(host))
+        {
+            return -1;
+        }
+        memcpy(host, start, length);
+        host[length] = '\0';
+        port_text    = colon + 1;
+    }
+    if (strlen(port_text) >= sizeof(port) || '\0' == port_text[0])
+    {
+        return -1;
+    }
+    strcpy(port, port_text);
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags    = AI_PASSIVE;
+    if (0 != getaddrinfo(
+                 ('\0' == host[0]) ? NULL : host, port, &hints, &results))
+    {
+        return -1;
+    }
+
+    for (struct addrinfo * at = results; fd < 0 && NULL != at;
+         at = at->ai_next)
+    {
+        int reuse = 1;
+
+        fd = socket(at->ai_family,
+                    at->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                    at->ai_protocol);
+        if (fd >= 0 &&
+            (0 != setsockopt(
+                      fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) ||
+             0 != bind(fd, at->ai_addr, at->ai_addrlen) ||
+             0 != listen(fd, SERVER_BACKLOG)))
+        {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(results);
+    return fd;
+}
+
+/******************************************************************************
+ * @brief    Create a server listening on a Unix socket, TCP, or both
+ * @param    unix_path       Socket path, or NULL
+ * @param    tcp_address     "port", "host:port" or "[ipv6 host]:port", or NULL
+ * @param    cache_entries   Size of the result cache; 0 for none
+ * @param    io              Event loop: io_uring where the kernel supports
+ *                           it, or epoll
+ * @param    server          Set to the new server, or NULL on error
+ * @return   CALC_SERVER_OK, or why the server could not be created
+ ******************************************************************************/
+calc_server_status calc_server_create(const char *  unix_path,
+                                      const char *  tcp_address,
+                                      size_t        cache_entries,
+                                      calc_io       io,
+                                      calc_server ** server)
+{
+    calc_server * created = calloc(1, sizeof(*created));
+
+    *server = NULL;
+    if (NULL == created)
+    {
+        return CALC_SERVER_NO_MEMORY;
+    }
+    created->epoll_fd         = epoll_create1(EPOLL_CLOEXEC);
+    created->spare_fd         = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    created->wake.fd          = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    created->wake.kind        = ENDPOINT_WAKE;
+    created->unix_listener.fd = -1;
+    created->tcp_listener.fd  = -1;
+    created->arena            = calc_arena_create(SERVER_ARENA_BLOCK);
+    if (NULL == created->arena)
+    {
+        calc_server_destroy(created);
+        return CALC_SERVER_NO_MEMORY;
+    }
+    if (created->epoll_fd < 0 || created->wake.fd < 0 ||
+        !watch(created, &created->wake, EPOLL_CTL_ADD, EPOLLIN))
+    {
+        calc_server_destroy(created);
+        return CALC_SERVER_POLL_ERROR;
+    }
+
+    // The epoll set is cheap, and needed anyway if the ring cannot be set up
+    if (CALC_IO_URING == io)
+    {
+        created->ringed =
+            calc_uring_init(&created->ring, SERVER_RING_SIZE) &&
+            calc_uring_provide_buffers(
+                &created->ring, SERVER_BUFFERS, SERVER_BUFFER_SIZE);
+        if (!created->ringed)
+        {
+            calc_uring_exit(&created->ring);
+        }
+    }
+
+    if (0 != cache_entries)
+    {
+        created->cache = calc_cache_create(cache_entries);
+        if (NULL == created->cache)
+        {
+            calc_server_destroy(created);
+            return CALC_SERVER_NO_MEMORY;
+        }
+    }
+
+    int listening = 0;
+    if (NULL != unix_path)
+    {
+        created->unix_listener.fd   = listen_unix(unix_path);
+        created->unix_listener.kind = ENDPOINT_UNIX;
+        if (created->unix_listener.fd < 0)
+        {
+            calc_server_destroy(created);
+            return CALC_SERVER_ADDRESS_ERROR;
+        }
+        strcpy(created->unix_path, unix_path);
+        listening = watch(
+            created, &created->unix_listener, EPOLL_CTL_ADD, EPOLLIN);
+    }
+    if (NULL != tcp_address && (NULL == unix_path || listening))
+    {
+        created->tcp_listener.fd   = listen_tcp(tcp_address);
+        created->tcp_listener.kind = ENDPOINT_TCP;
+        if (created->tcp_listener.fd < 0)
+        {
+            calc_server_destroy(created);
+            return CALC_SERVER_ADDRESS_ERROR;
+        }
+        listening =
+            watch(created, &created->tcp_listener, EPOLL_CTL_ADD, EPOLLIN);
+    }
+    if (!listening)
+    {
+        calc_server_destroy(created);
+        return (NULL == unix_path && NULL == tcp_address)
+                   ? CALC_SERVER_ADDRESS_ERROR
+                   : CALC_SERVER_POLL_ERROR;
+    }
+
+    *server = created;
+    return CALC_SERVER_OK;
+}
+
+/******************************************************************************
+ * @brief    Close a client connection
+ ******************************************************************************/
+static void close_client(calc_server * server, server_endpoint * client)
+{
+    if (NULL != client->previous)
+    {
+        client->previous->next = client->next;
+    }
+    else
+    {
+        server->clients = client->next;
+    }
+    if (NULL != client->next)
+    {
+        client->next->previous = client->previous;
+    }
+    close(client->fd); // Also removes it from the epoll set
+    calc_buffer_free(&client->input);
+    calc_buffer_free(&client->output);
+    calc_buffer_free(&client->outgoing);
+    free(client);
+}
+
+/******************************************************************************
+ * @brief    Turn the next client away when out of descriptors, rather than
+ *           let the listener stay readable forever
+ ******************************************************************************/
+static void shed_client(calc_server * server, const server_endpoint * listener)
+{
+    close(server->spare_fd);
+    int fd = accept(listener->fd, NULL, NULL);
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    server->spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+}
+
+/******************************************************************************
+ * @brief    Start serving a connection accepted on a listener
+ * @return   New client, or NULL if out of memory, in which case fd is closed
+ ******************************************************************************/
+static server_endpoint * add_client(calc_server *           server,
+                                    const server_endpoint * listener,
+                                    int                     fd)
+{
+    if (ENDPOINT_TCP == listener->kind)
+    {
+        int on = 1; // Answers are small; never hold them back
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+
+    server_endpoint * client = calloc(1, sizeof(*client));
+    if (NULL == client)
+    {
+        close(fd);
+        return NULL;
+    }
+    client->fd   = fd;
+    client->kind = ENDPOINT_CLIENT;
+    client->next = server->clients;
+    if (NULL != server->clients)
+    {
+        server->clients->previous = client;
+    }
+    server->clients = client;
+    return client;
+}
+
+/******************************************************************************
+ * @brief    Accept every pending connection on a listener
+ ******************************************************************************/
+static void accept_clients(calc_server * server, server_endpoint * listener)
+{
+    for (;;)
+    {
+        int fd =
+            accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if ((EMFILE == errno || ENFILE == errno) && server->spare_fd >= 0)
+            {
+                shed_client(server, listener);
+                continue;
+            }
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+            return; // EAGAIN once the backlog is empty
+        }
+
+        server_endpoint * client = add_client(server, listener, fd);
+        if (NULL != client && !watch(server, client, EPOLL_CTL_ADD, EPOLLIN))
+        {
+            close_client(server, client);
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Answer every whole request a client has sent
+ * @param    server  Server
+ * @param    client  Client connection
+ * @return   1 if successful, 0 if the client must be disconnected
+ ******************************************************************************/
+static int answer_requests(calc_server * server, server_endpoint * client)
+{
+    const char * data     = client->input.data;
+    size_t       position = 0;
+    size_t       end      = client->input.used;
+
+    if (client->replied)
+    {
+        client->input.used = 0;
+        return 1;
+    }
+    while (position < end)
+    {
+        const char * at        = data + position;
+        size_t       available = end - position;
+
+        if (client->discarding)
+        {
+            const char * newline = memchr(at, '\n', available);
+            if (NULL == newline)
+            {
+                position = end;
+                break;
+            }
+            position += (size_t)(newline - at) + 1;
+            client->discarding = 0;
+            continue;
+        }
+
+        if (starts_http(at, available) &&
+            (available >= sizeof(calc_net_http_method) - 1 ||
+             !client->finished))
+        {
+            if (!answer_http(client, at, available))
+            {
+                return 0;
+            }
+            if (!client->replied)
+            {
+                break; // The rest of the head is still to come
+            }
+            position = end;
+            break;
+        }
+
+        if (starts_binary(at, available))
+        {
+            size_t size;
+            if (available < CALC_BINARY_HEADER_SIZE)
+            {
+                if (client->finished)
+                {
+                    position = end; // Truncated; nothing to answer
+                }
+                break;
+            }
+            if (!calc_binary_request_size(at, &size) ||
+                size > SERVER_BINARY_MAX)
+            {
+                return 0;
+            }
+            if (available < size)
+            {
+                if (client->finished)
+                {
+                    position = end;
+                }
+                break;
+            }
+            calc_batch_status status = calc_binary_eval(
+                at, size, &client->output, server->arena, &server->counts);
+            calc_arena_reset(server->arena);
+            if (CALC_BATCH_OK != status)
+            {
+                return 0;
+            }
+            position += size;
+            continue;
+        }
+
+        // A run of whole lines, up to whatever may be another kind of request
+        size_t stop = position;
+        for (;;)
+        {
+            const char * newline = memchr(data + stop, '\n', end - stop);
+            if (NULL == newline)
+            {
+                break;
+            }
+            stop = (size_t)(newline - data) + 1;
+            if (stop == end || starts_binary(data + stop, end - stop) ||
+                starts_http(data + stop, end - stop))
+            {
+                break;
+            }
+        }
+        if (stop == position)
+        {
+            if (client->finished)
+            {
+                stop = end; // The last line needs no newline
+            }
+            else if (available > CALC_LINE_MAX)
+            {
+                // Enough of an overlong line to report it, then skip the rest
+                stop               = position + CALC_LINE_MAX + 1;
+                client->discarding = 1;
+            }
+            else
+            {
+                break;
+            }
+        }
+        if (!calc_batch_eval(at,
+                             stop - position,
+                             &client->output,
+                             server->cache,
+                             CALC_WIDTH_32,
+                             calc_net_classic_division,
+                             &server->counts))
+        {
+            return 0;
+        }
+        position = stop;
+    }
+
+    // Keep only the unanswered tail
+    size_t left = end - position;
+    if (0 != left && 0 != position)
+    {
+        memmove(client->input.data, data + position, left);
+    }
+    client->input.used = left;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Write as much pending output as the socket takes
+ * @return   1 if successful, 0 if the client must be disconnected
+ ******************************************************************************/
+static int send_output(server_endpoint * client)
+{
+    while (client->sent < client->output.used)
+    {
+        ssize_t count = send(client->fd,
+                             client->output.data + client->sent,
+                             client->output.used - client->sent,
+                             MSG_NOSIGNAL);
+        if (count < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return EAGAIN == errno || EWOULDBLOCK == errno;
+        }
+        client->sent += (size_t)count;
+    }
+    client->output.used = 0;
+    client->sent        = 0;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Read from a client, answer it and write back what it can take
+ * @return   1 if the client stays connected, 0 if it must be closed
+ ******************************************************************************/
+static int serve_client(calc_server *     server,
+                        server_endpoint * client,
+                        uint32_t          events)
+{
+    if (0 != (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+        0 != (client->events & EPOLLIN))
+    {
+        if (!calc_buffer_reserve(&client->input, SERVER_READ_SIZE))
+        {
+            return 0;
+        }
+        ssize_t count = read(client->fd,
+                             client->input.data + client->input.used,
+                             client->input.capacity - client->input.used);
+        if (count > 0)
+        {
+            client->input.used += (size_t)count;
+        }
+        else if (0 == count)
+        {
+            client->finished = 1;
+        }
+        else if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+        {
+            return 0;
+        }
+        if (!answer_requests(server, client))
+        {
+            return 0;
+        }
+    }
+
+    if (!send_output(client))
+    {
+        return 0;
+    }
+    size_t pending = client->output.used - client->sent;
+    if (client->finished && 0 == pending)
+    {
+        return 0;
+    }
+
+    uint32_t wanted = 0;
+    if (!client->finished && pending < SERVER_OUTPUT_HIGH)
+    {
+        wanted |= EPOLLIN;
+    }
+    if (0 != pending)
+    {
+        wanted |= EPOLLOUT;
+    }
+    return watch(server, client, EPOLL_CTL_MOD, wanted);
+}
+
+/******************************************************************************
+ * @brief    Queue a ring request on behalf of an endpoint
+ * @return   SQE to fill in, or NULL if the ring is full even after flushing
+ ******************************************************************************/
+static struct io_uring_sqe * ring_sqe(calc_server *     server,
+                                      server_endpoint * endpoint,
+                                      server_op         op)
+{
+    struct io_uring_sqe * sqe = calc_uring_sqe(&server->ring);
+
+    if (NULL == sqe)
+    {
+        (void)calc_uring_submit(&server->ring, 0);
+        sqe = calc_uring_sqe(&server->ring);
+    }
+    if (NULL != sqe)
+    {
+        sqe->user_data = (uint64_t)(uintptr_t)endpoint | op;
+        endpoint->operations++;
+        server->operations++;
+    }
+    return sqe;
+}
+
+/******************************************************************************
+ * @brief    Arm the input request of an endpoint: a read of the wake-up
+ *           event, a multishot accept, or a recv into provided buffers
+ * @return   1 if successful, 0 otherwise
+ ******************************************************************************/
+static int arm_input(calc_server * server, server_endpoint * endpoint)
+{
+    struct io_uring_sqe * sqe = ring_sqe(server, endpoint, SERVER_OP_INPUT);
+
+    if (NULL == sqe)
+    {
+        return 0;
+    }
+    sqe->fd = endpoint->fd;
+    switch (endpoint->kind)
+    {
+        case ENDPOINT_WAKE:
+            sqe->opcode = IORING_OP_READ;
+            sqe->addr   = (uint64_t)(uintptr_t)&server->wake_value;
+            sqe->len    = sizeof(server->wake_value);
+            break;
+        case ENDPOINT_UNIX:
+        case ENDPOINT_TCP:
+            sqe->opcode       = IORING_OP_ACCEPT;
+            sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags = SOCK_CLOEXEC;
+            break;
+        case ENDPOINT_CLIENT:
+            sqe->opcode    = IORING_OP_RECV;
+            sqe->ioprio    = server->oneshot_recv ? 0 : IORING_RECV_MULTISHOT;
+            sqe->flags     = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = CALC_URING_BUFFER_GROUP;
+            break;
+    }
+    endpoint->receiving = 1;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Start closing a ring client; shutting the socket down ends its
+ *           requests, and it is freed once the last one has completed
+ ******************************************************************************/
+static void retire_client(calc_server * server, server_endpoint * client)
+{
+    if (!client->closing)
+    {
+        client->closing = 1;
+        (void)shutdown(client->fd, SHUT_RDWR);
+    }
+    if (0 == client->operations)
+    {
+        close_client(server, client);
+    }
+}
+
+/******************************************************************************
+ * @brief    Send what a ring client has been answered, and arm or cancel its
+ *           recv depending on how much is still unsent
+ * @return   1 if the client stays connected, 0 if it must be closed
+ ******************************************************************************/
+static int update_client(calc_server * server, server_endpoint * client)
+{
+    // Answers move to the send buffer whenever it is idle and empty
+    if (!client->sending && client->sent == client->outgoing.used &&
+        0 != client->output.used)
+    {
+        calc_buffer sending = client->outgoing;
+        client->outgoing    = client->output;
+        client->output      = sending;
+        client->output.used = 0;
+        client->sent        = 0;
+    }
+    if (!client->sending && client->sent < client->outgoing.used)
+    {
+        struct io_uring_sqe * sqe = ring_sqe(server, client, SERVER_OP_SEND);
+        if (NULL == sqe)
+        {
+            return 0;
+        }
+        sqe->opcode    = IORING_OP_SEND;
+        sqe->fd        = client->fd;
+        sqe->addr      = (uint64_t)(uintptr_t)(client->outgoing.data +
+                                         client->sent);
+        sqe->len       = (uint32_t)(client->outgoing.used - client->sent);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        client->sending = 1;
+    }
+
+    size_t pending =
+        client->output.used + client->outgoing.used - client->sent;
+    if (client->finished && 0 == pending)
+    {
+        return 0;
+    }
+
+    int wanted = !client->finished && pending < SERVER_OUTPUT_HIGH;
+    if (wanted && !client->receiving)
+    {
+        client->paused = 0;
+        return arm_input(server, client);
+    }
+    if (!wanted && client->receiving && !client->paused)
+    {
+        struct io_uring_sqe * sqe =
+            ring_sqe(server, client, SERVER_OP_CANCEL);
+        if (NULL == sqe)
+        {
+            return 0;
+        }
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr   = (uint64_t)(uintptr_t)client | SERVER_OP_INPUT;
+    }
+    client->paused = !wanted;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Handle the completion of a ring client's request
+ ******************************************************************************/
+static void complete_client(calc_server *     server,
+                            server_endpoint * client,
+                            server_op         op,
+                            int32_t           result,
+                            uint32_t          flags)
+{
+    int ok = 1;
+
+    if (SERVER_OP_INPUT == op)
+    {
+        if (0 != (flags & IORING_CQE_F_BUFFER))
+        {
+            unsigned id = flags >> IORING_CQE_BUFFER_SHIFT;
+            if (result > 0 && !client->closing)
+            {
+                ok = calc_buffer_reserve(&client->input, (size_t)result);
+                if (ok)
+                {
+                    memcpy(client->input.data + client->input.used,
+                           calc_uring_buffer(&server->ring, id),
+                           (size_t)result);
+                    client->input.used += (size_t)result;
+                }
+            }
+            calc_uring_recycle(&server->ring, id);
+        }
+        if (0 == result)
+        {
+            client->finished = 1;
+        }
+        else if (-EINVAL == result && !server->oneshot_recv)
+        {
+            server->oneshot_recv = 1; // Multishot recv needs Linux 6.0
+        }
+        else if (result < 0 && -ENOBUFS != result && -ECANCELED != result &&
+                 -EINTR != result)
+        {
+            ok = 0;
+        }
+        if (ok && !client->closing && (result > 0 || client->finished))
+        {
+            ok = answer_requests(server, client);
+        }
+    }
+    else if (SERVER_OP_SEND == op)
+    {
+        if (result > 0)
+        {
+            client->sent += (size_t)result;
+        }
+        else if (-EINTR != result && -EAGAIN != result)
+        {
+            ok = 0;
+        }
+    }
+
+    if (!ok || client->closing || !update_client(server, client))
+    {
+        retire_client(server, client);
+    }
+}
+
+/******************************************************************************
+ * @brief    Handle the completion of a ring request
+ * @return   0 once the server has been woken up to stop, 1 otherwise
+ ******************************************************************************/
+static int complete(calc_server * server, const struct io_uring_cqe * cqe)
+{
+    uintptr_t         tag      = (uintptr_t)cqe->user_data;
+    uintptr_t         address  = tag & ~(uintptr_t)SERVER_OP_MASK;
+    server_endpoint * endpoint = (server_endpoint *)address;
+    server_op         op       = (server_op)(tag & SERVER_OP_MASK);
+    int32_t           result   = cqe->res;
+
+    // Multishot requests keep going for as long as they set F_MORE
+    if (SERVER_OP_INPUT != op || 0 == (cqe->flags & IORING_CQE_F_MORE))
+    {
+        endpoint->operations--;
+        server->operations--;
+        if (SERVER_OP_INPUT == op)
+        {
+            endpoint->receiving = 0;
+        }
+        else if (SERVER_OP_SEND == op)
+        {
+            endpoint->sending = 0;
+        }
+    }
+
+    switch (endpoint->kind)
+    {
+        case ENDPOINT_WAKE:
+            return SERVER_OP_INPUT != op;
+        case ENDPOINT_UNIX:
+        case ENDPOINT_TCP:
+            if (result >= 0)
+            {
+                server_endpoint * client = add_client(server, endpoint, result);
+                if (NULL != client && !arm_input(server, client))
+                {
+                    close_client(server, client);
+                }
+            }
+            else if ((-EMFILE == result || -ENFILE == result) &&
+                     server->spare_fd >= 0)
+            {
+                shed_client(server, endpoint);
+            }
+            if (!endpoint->receiving)
+            {
+                (void)arm_input(server, endpoint);
+            }
+            break;
+        case ENDPOINT_CLIENT:
+            complete_client(server, endpoint, op, result, cqe->flags);
+            break;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Serve clients from completions until woken up
+ ******************************************************************************/
+static calc_server_status run_ring(calc_server * server)
+{
+    server_endpoint * inputs[] = { &server->wake,
+                                   &server->unix_listener,
+                                   &server->tcp_listener };
+
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++)
+    {
+        if (inputs[i]->fd >= 0 && !inputs[i]->receiving &&
+            !arm_input(server, inputs[i]))
+        {
+            return CALC_SERVER_POLL_ERROR;
+        }
+    }
+
+    for (int running = 1; running;)
+    {
+        // Everything queued while handling the last completions goes too
+        int status = calc_uring_submit(&server->ring, 1);
+        if (0 != status && -EINTR != status && -EBUSY != status)
+        {
+            return CALC_SERVER_POLL_ERROR;
+        }
+
+        struct io_uring_cqe * cqe;
+        while (NULL != (cqe = calc_uring_peek(&server->ring)))
+        {
+            struct io_uring_cqe seen = *cqe;
+            calc_uring_seen(&server->ring);
+            running &= complete(server, &seen);
+        }
+    }
+    return CALC_SERVER_OK;
+}
+
+/******************************************************************************
+ * @brief    Serve clients from epoll until woken up
+ ******************************************************************************/
+static calc_server_status run_poll(calc_server * server)
+{
+    struct epoll_event events[SERVER_EVENTS];
+
+    for (int running = 1; running;)
+    {
+        int ready = epoll_wait(server->epoll_fd, events, SERVER_EVENTS, -1);
+        if (ready < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            return CALC_SERVER_POLL_ERROR;
+        }
+
+        for (int i = 0; i < ready; i++)
+        {
+            server_endpoint * endpoint = events[i].data.ptr;
+            switch (endpoint->kind)
+            {
+                case ENDPOINT_WAKE:
+                {
+                    uint64_t value;
+                    (void)read(endpoint->fd, &value, sizeof(value));
+                    running = 0;
+                    break;
+                }
+                case ENDPOINT_UNIX:
+                case ENDPOINT_TCP:
+                    accept_clients(server, endpoint);
+                    break;
+                case ENDPOINT_CLIENT:
+                    if (!serve_client(server, endpoint, events[i].events))
+                    {
+                        close_client(server, endpoint);
+                    }
+                    break;
+            }
+        }
+    }
+    return CALC_SERVER_OK;
+}
+
+/******************************************************************************
+ * @brief    Serve clients until calc_server_stop is called
+ * @param    server  Server
+ * @param    counts  Incremented by the lines and rows answered, those that
+ *                   failed, and the activity of the result cache and the
+ *                   scratch arena
+ * @return   CALC_SERVER_OK once stopped, or CALC_SERVER_POLL_ERROR
+ ******************************************************************************/
+calc_server_status calc_server_run(calc_server *       server,
+                                   calc_batch_counts * counts)
+{
+    calc_server_status status =
+        server->ringed ? run_ring(server) : run_poll(server);
+
+    counts->lines += server->counts.lines;
+    counts->failed += server->counts.failed;
+    server->counts.lines  = 0;
+    server->counts.failed = 0;
+    if (NULL != server->cache)
+    {
+        calc_cache_add_stats(server->cache, &counts->cache);
+    }
+    calc_arena_add_stats(server->arena, &counts->arena);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Make calc_server_run return; safe to call from a signal handler
+ *           or another thread
+ ******************************************************************************/
+void calc_server_stop(calc_server * server)
+{
+    uint64_t one = 1;
+    (void)write(server->wake.fd, &one, sizeof(one));
+}
+
+/******************************************************************************
+ * @brief    Cancel every ring request and wait for them all to complete, so
+ *           that the kernel has let go of whatever they point to
+ ******************************************************************************/
+static void drain_ring(calc_server * server)
+{
+    struct io_uring_sqe * sqe =
+        ring_sqe(server, &server->wake, SERVER_OP_CANCEL);
+
+    if (NULL == sqe)
+    {
+        return;
+    }
+    sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+    calc_server_stop(server); // Completes the wake-up read regardless
+    while (0 != server->operations)
+    {
+        struct io_uring_cqe * cqe = calc_uring_wait(&server->ring);
+        if (NULL == cqe)
+        {
+            return;
+        }
+        if (SERVER_OP_INPUT != (cqe->user_data & SERVER_OP_MASK) ||
+            0 == (cqe->flags & IORING_CQE_F_MORE))
+        {
+            server->operations--;
+        }
+        calc_uring_seen(&server->ring);
+    }
+}
+
+/******************************************************************************
+ * @brief    Close every connection and listener and release a server
+ * @param    server  Server, may be NULL
+ ******************************************************************************/
+void calc_server_destroy(calc_server * server)
+{
+    if (NULL == server)
+    {
+        return;
+    }
+    if (server->ringed)
+    {
+        drain_ring(server);
+        calc_uring_exit(&server->ring);
+    }
+    while (NULL != server->clients)
+    {
+        close_client(server, server->clients);
+    }
+    if (server->unix_listener.fd >= 0)
+    {
+        close(server->unix_listener.fd);
+        unlink(server->unix_path);
+    }
+    if (server->tcp_listener.fd >= 0)
+    {
+        close(server->tcp_listener.fd);
+    }
+    if (server->wake.fd >= 0)
+    {
+        close(server->wake.fd);
+    }
+    if (server->spare_fd >= 0)
+    {
+        close(server->spare_fd);
+    }
+    if (server->epoll_fd >= 0)
+    {
+        close(server->epoll_fd);
+    }
+    calc_cache_destroy(server->cache);
+    calc_arena_destroy(server->arena);
+    free(server);
+}
@@ -0,0 +1,1341 @@
+/******************************************************************************
+ * @file    calc_simd.c
+ * @brief   Element-wise evaluation of one operator over operand arrays
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Each kernel processes blocks of 8 lanes so that every block produces one
+ * whole byte of the error mask; the remaining lanes, and the operators an
+ * instruction set has no vector form for, are finished by the scalar loop.
+ *
+ * 64-bit lanes (calc_apply64) work the same way with the 64-bit kernels.
+ * No x86 instruction set before AVX-512DQ multiplies 64-bit lanes, so their
+ * products always take the scalar loop, as do 64-bit lanes on NEON.
+ ******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "calc.h"
+#include "calc_const.h"
+#include "calc_width.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CALC_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define CALC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define LANES_PER_MASK_BYTE 8
+#define UNIFORM_BLOCK       64 // Lanes compared between checks
+#define SCALAR_BLOCK        64 // Lanes evaluated between failure checks
+
+#define SCALAR_LOOP_UINT(function)                                         \
+    for (; i < count; i++)                                                 \
+    {                                                                      \
+        result[i] = function(operand1[i], operand2[i]);                    \
+    }
+
+// Fallible operators run branch-free over a block of lanes, ORing each
+// lane's failure into a sticky flag; only a block that failed is walked
+// again to find its failed lanes for the error mask
+#define SCALAR_LOOP_FLAGGED(stype, utype, kernel)                          \
+    for (; i < count; i += SCALAR_BLOCK)                                   \
+    {                                                                      \
+        size_t   end    = (count - i < SCALAR_BLOCK) ? count               \
+                                                     : i + SCALAR_BLOCK;   \
+        unsigned sticky = 0;                                               \
+        for (size_t lane = i; lane < end; lane++)                          \
+        {                                                                  \
+            stype value;                                                   \
+            sticky |= kernel((stype)operand1[lane],                        \
+                             (stype)operand2[lane],                        \
+                             &value);                                      \
+            result[lane] = (utype)value;                                   \
+        }                                                                  \
+        if (0 != sticky)                                                   \
+        {                                                                  \
+            failed = 1;                                                    \
+            for (size_t lane = i; NULL != error_mask && lane < end;        \
+                 lane++)                                                   \
+            {                                                              \
+                stype    value;                                            \
+                unsigned fail = kernel((stype)operand1[lane],              \
+                                       (stype)operand2[lane],              \
+                                       &value);                            \
+                error_mask[lane / LANES_PER_MASK_BYTE] |= (uint8_t)(       \
+                    fail << (lane % LANES_PER_MASK_BYTE));                 \
+            }                                                              \
+        }                                                                  \
+    }
+
+/******************************************************************************
+ * @brief    Finish an array with the scalar kernels
+ * @param    start   First lane to process, a multiple of 8
+ * @return   1 if any lane failed, 0 otherwise
+ ******************************************************************************/
+static int apply_scalar(calc_op          op,
+                        const uint32_t * operand1,
+                        const uint32_t * operand2,
+                        uint32_t *       result,
+                        uint8_t *        error_mask,
+                        size_t           start,
+                        size_t           count)
+{
+    size_t i      = start;
+    int    failed = 0;
+
+    if (NULL != error_mask && start < count)
+    {
+        size_t first = start / LANES_PER_MASK_BYTE;
+        size_t last  = (count + LANES_PER_MASK_BYTE - 1) / LANES_PER_MASK_BYTE;
+        memset(error_mask + first, 0, last - first);
+    }
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            SCALAR_LOOP_FLAGGED(int32_t, uint32_t, width_add_32_flagged)
+            break;
+        case CALC_OP_SUB:
+            SCALAR_LOOP_FLAGGED(int32_t, uint32_t, width_sub_32_flagged)
+            break;
+        case CALC_OP_MUL:
+            SCALAR_LOOP_FLAGGED(int32_t, uint32_t, width_mul_32_flagged)
+            break;
+        case CALC_OP_MOD:
+            SCALAR_LOOP_FLAGGED(int32_t, uint32_t, width_mod_32_flagged)
+            break;
+        case CALC_OP_SHL:
+            SCALAR_LOOP_UINT(width_shl_32)
+            break;
+        case CALC_OP_SHR:
+            SCALAR_LOOP_UINT(width_shr_32)
+            break;
+        case CALC_OP_AND:
+            SCALAR_LOOP_UINT(width_and_32)
+            break;
+        case CALC_OP_OR:
+            SCALAR_LOOP_UINT(width_or_32)
+            break;
+        case CALC_OP_XOR:
+            SCALAR_LOOP_UINT(width_xor_32)
+            break;
+        case CALC_OP_ROL:
+            SCALAR_LOOP_UINT(width_rol_32)
+            break;
+        case CALC_OP_ROR:
+            SCALAR_LOOP_UINT(width_ror_32)
+            break;
+        default:
+            break;
+    }
+    return failed;
+}
+
+/******************************************************************************
+ * @brief    Finish an array of 64-bit lanes with the 64-bit kernels
+ * @param    start   First lane to process, a multiple of 8
+ * @return   1 if any lane failed, 0 otherwise
+ ******************************************************************************/
+static int apply64_scalar(calc_op          op,
+                          const uint64_t * operand1,
+                          const uint64_t * operand2,
+                          uint64_t *       result,
+                          uint8_t *        error_mask,
+                          size_t           start,
+                          size_t           count)
+{
+    size_t i      = start;
+    int    failed = 0;
+
+    if (NULL != error_mask && start < count)
+    {
+        size_t first = start / LANES_PER_MASK_BYTE;
+        size_t last  = (count + LANES_PER_MASK_BYTE - 1) / LANES_PER_MASK_BYTE;
+        memset(error_mask + first, 0, last - first);
+    }
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            SCALAR_LOOP_FLAGGED(int64_t, uint64_t, width_add_64_flagged)
+            break;
+        case CALC_OP_SUB:
+            SCALAR_LOOP_FLAGGED(int64_t, uint64_t, width_sub_64_flagged)
+            break;
+        case CALC_OP_MUL:
+            SCALAR_LOOP_FLAGGED(int64_t, uint64_t, width_mul_64_flagged)
+            break;
+        case CALC_OP_MOD:
+            SCALAR_LOOP_FLAGGED(int64_t, uint64_t, width_mod_64_flagged)
+            break;
+        case CALC_OP_SHL:
+            SCALAR_LOOP_UINT(width_shl_64)
+            break;
+        case CALC_OP_SHR:
+            SCALAR_LOOP_UINT(width_shr_64)
+            break;
+        case CALC_OP_AND:
+            SCALAR_LOOP_UINT(width_and_64)
+            break;
+        case CALC_OP_OR:
+            SCALAR_LOOP_UINT(width_or_64)
+            break;
+        case CALC_OP_XOR:
+            SCALAR_LOOP_UINT(width_xor_64)
+            break;
+        case CALC_OP_ROL:
+            SCALAR_LOOP_UINT(width_rol_64)
+            break;
+        case CALC_OP_ROR:
+            SCALAR_LOOP_UINT(width_ror_64)
+            break;
+        default:
+            break;
+    }
+    return failed;
+}
+
+#if defined(CALC_SIMD_X86)
+
+// Shared block loop: COMPUTE sets r from x and y, ov holds failed lanes in
+// its sign bits, and MASK_BITS turns ov into an integer with one bit per lane
+#define VECTOR_LOOP(type, width, load, store, MASK_BITS, COMPUTE)          \
+    for (; i + (width) <= count; i += (width))                             \
+    {                                                                      \
+        type     x = load((const type *)(operand1 + i));                   \
+        type     y = load((const type *)(operand2 + i));                   \
+        type     r;                                                        \
+        type     ov;                                                       \
+        unsigned bits;                                                     \
+        COMPUTE;                                                           \
+        store((type *)(result + i), r);                                    \
+        bits = (unsigned)(MASK_BITS);                                      \
+        if (NULL != error_mask)                                            \
+        {                                                                  \
+            for (size_t byte = 0; byte < (width) / LANES_PER_MASK_BYTE;    \
+                 byte++)                                                   \
+            {                                                              \
+                error_mask[i / LANES_PER_MASK_BYTE + byte] =               \
+                    (uint8_t)(bits >> (byte * LANES_PER_MASK_BYTE));       \
+            }                                                              \
+        }                                                                  \
+        failed |= (0 != bits);                                             \
+    }
+
+/******************************************************************************
+ * @brief    SSE2 kernels; SSE2 lacks per-lane shifts and a 32-bit multiply
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("sse2"))) static size_t apply_sse2(
+    calc_op          op,
+    const uint32_t * operand1,
+    const uint32_t * operand2,
+    uint32_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t i      = 0;
+    int    failed = 0;
+
+// Two 4-lane vectors make up one 8-lane block
+#define SSE2_LOOP(COMPUTE)                                                 \
+    for (; i + 8 <= count; i += 8)                                         \
+    {                                                                      \
+        unsigned bits = 0;                                                 \
+        for (size_t half = 0; half < 8; half += 4)                         \
+        {                                                                  \
+            __m128i x =                                                    \
+                _mm_loadu_si128((const __m128i *)(operand1 + i + half));   \
+            __m128i y =                                                    \
+                _mm_loadu_si128((const __m128i *)(operand2 + i + half));   \
+            __m128i r;                                                     \
+            __m128i ov;                                                    \
+            COMPUTE;                                                       \
+            _mm_storeu_si128((__m128i *)(result + i + half), r);           \
+            bits |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(ov))        \
+                    << half;                                               \
+        }                                                                  \
+        if (NULL != error_mask)                                            \
+        {                                                                  \
+            error_mask[i / LANES_PER_MASK_BYTE] = (uint8_t)bits;           \
+        }                                                                  \
+        failed |= (0 != bits);                                             \
+    }
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            SSE2_LOOP(r  = _mm_add_epi32(x, y);
+                      ov = _mm_and_si128(_mm_xor_si128(x, r),
+                                         _mm_xor_si128(y, r)))
+            break;
+        case CALC_OP_SUB:
+            SSE2_LOOP(r  = _mm_sub_epi32(x, y);
+                      ov = _mm_and_si128(_mm_xor_si128(x, y),
+                                         _mm_xor_si128(x, r)))
+            break;
+        case CALC_OP_AND:
+            SSE2_LOOP(r = _mm_and_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        case CALC_OP_OR:
+            SSE2_LOOP(r = _mm_or_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        case CALC_OP_XOR:
+            SSE2_LOOP(r = _mm_xor_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        default:
+            break;
+    }
+#undef SSE2_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+/******************************************************************************
+ * @brief    Flag 32-bit products that do not fit in int32 (AVX2)
+ * @param    x       First operands
+ * @param    y       Second operands
+ * @param    lo      Low halves of the products
+ * @return   Lanes whose full product differs from the sign-extended low half
+ ******************************************************************************/
+__attribute__((target("avx2"))) static __m256i
+mul_overflow_avx2(__m256i x, __m256i y, __m256i lo)
+{
+    __m256i even = _mm256_mul_epi32(x, y);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(x, 32),
+                                    _mm256_srli_epi64(y, 32));
+    __m256i hi   = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    __m256i same = _mm256_cmpeq_epi32(hi, _mm256_srai_epi32(lo, 31));
+    return _mm256_xor_si256(same, _mm256_set1_epi32(-1));
+}
+
+/******************************************************************************
+ * @brief    AVX2 kernels
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("avx2"))) static size_t apply_avx2(
+    calc_op          op,
+    const uint32_t * operand1,
+    const uint32_t * operand2,
+    uint32_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t        i      = 0;
+    int           failed = 0;
+    const __m256i limit  = _mm256_set1_epi32(31);
+    const __m256i bits32 = _mm256_set1_epi32(32);
+
+#define AVX2_LOOP(COMPUTE)                                                 \
+    VECTOR_LOOP(__m256i,                                                   \
+                8,                                                         \
+                _mm256_loadu_si256,                                        \
+                _mm256_storeu_si256,                                       \
+                _mm256_movemask_ps(_mm256_castsi256_ps(ov)),               \
+                COMPUTE)
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            AVX2_LOOP(r  = _mm256_add_epi32(x, y);
+                      ov = _mm256_and_si256(_mm256_xor_si256(x, r),
+                                            _mm256_xor_si256(y, r)))
+            break;
+        case CALC_OP_SUB:
+            AVX2_LOOP(r  = _mm256_sub_epi32(x, y);
+                      ov = _mm256_and_si256(_mm256_xor_si256(x, y),
+                                            _mm256_xor_si256(x, r)))
+            break;
+        case CALC_OP_MUL:
+            AVX2_LOOP(r  = _mm256_mullo_epi32(x, y);
+                      ov = mul_overflow_avx2(x, y, r))
+            break;
+        case CALC_OP_SHL:
+            // Variable shifts already yield 0 for counts of 32 or more
+            AVX2_LOOP(r  = _mm256_sllv_epi32(x, y);
+                      ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_SHR:
+            AVX2_LOOP(r  = _mm256_srlv_epi32(x, y);
+                      ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_AND:
+            AVX2_LOOP(r = _mm256_and_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_OR:
+            AVX2_LOOP(r = _mm256_or_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_XOR:
+            AVX2_LOOP(r = _mm256_xor_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_ROL:
+            AVX2_LOOP(__m256i c = _mm256_and_si256(y, limit);
+                      r         = _mm256_or_si256(
+                          _mm256_sllv_epi32(x, c),
+                          _mm256_srlv_epi32(x, _mm256_sub_epi32(bits32, c)));
+                      ov        = _mm256_setzero_si256())
+            break;
+        case CALC_OP_ROR:
+            AVX2_LOOP(__m256i c = _mm256_and_si256(y, limit);
+                      r         = _mm256_or_si256(
+                          _mm256_srlv_epi32(x, c),
+                          _mm256_sllv_epi32(x, _mm256_sub_epi32(bits32, c)));
+                      ov        = _mm256_setzero_si256())
+            break;
+        default:
+            break;
+    }
+#undef AVX2_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+/******************************************************************************
+ * @brief    AVX-512 kernels
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("avx512f"))) static size_t apply_avx512(
+    calc_op          op,
+    const uint32_t * operand1,
+    const uint32_t * operand2,
+    uint32_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t        i      = 0;
+    int           failed = 0;
+    const __m512i zero   = _mm512_setzero_si512();
+
+#define AVX512_LOOP(COMPUTE)                                               \
+    VECTOR_LOOP(__m512i,                                                   \
+                16,                                                        \
+                _mm512_loadu_si512,                                        \
+                _mm512_storeu_si512,                                       \
+                _mm512_cmplt_epi32_mask(ov, zero),                         \
+                COMPUTE)
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            AVX512_LOOP(r  = _mm512_add_epi32(x, y);
+                        ov = _mm512_and_si512(_mm512_xor_si512(x, r),
+                                              _mm512_xor_si512(y, r)))
+            break;
+        case CALC_OP_SUB:
+            AVX512_LOOP(r  = _mm512_sub_epi32(x, y);
+                        ov = _mm512_and_si512(_mm512_xor_si512(x, y),
+                                              _mm512_xor_si512(x, r)))
+            break;
+        case CALC_OP_MUL:
+            AVX512_LOOP(
+                __m512i even = _mm512_mul_epi32(x, y);
+                __m512i odd  = _mm512_mul_epi32(_mm512_srli_epi64(x, 32),
+                                               _mm512_srli_epi64(y, 32));
+                __m512i hi   = _mm512_mask_blend_epi32(
+                    0xAAAA, _mm512_srli_epi64(even, 32), odd);
+                r  = _mm512_mullo_epi32(x, y);
+                ov = _mm512_maskz_mov_epi32(
+                    _mm512_cmpneq_epi32_mask(hi, _mm512_srai_epi32(r, 31)),
+                    _mm512_set1_epi32(-1)))
+            break;
+        case CALC_OP_SHL:
+            AVX512_LOOP(r = _mm512_sllv_epi32(x, y); ov = zero)
+            break;
+        case CALC_OP_SHR:
+            AVX512_LOOP(r = _mm512_srlv_epi32(x, y); ov = zero)
+            break;
+        case CALC_OP_AND:
+            AVX512_LOOP(r = _mm512_and_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_OR:
+            AVX512_LOOP(r = _mm512_or_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_XOR:
+            AVX512_LOOP(r = _mm512_xor_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_ROL:
+            // The rotate instructions reduce the count modulo 32 themselves
+            AVX512_LOOP(r = _mm512_rolv_epi32(x, y); ov = zero)
+            break;
+        case CALC_OP_ROR:
+            AVX512_LOOP(r = _mm512_rorv_epi32(x, y); ov = zero)
+            break;
+        default:
+            break;
+    }
+#undef AVX512_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+// 64-bit lanes: each 8-lane block spans 8 / lanes vectors, whose SIGN_BITS
+// (one bit per lane of ov) are gathered into the block's mask byte
+#define VECTOR64_LOOP(type, lanes, load, store, SIGN_BITS, COMPUTE)        \
+    for (; i + 8 <= count; i += 8)                                         \
+    {                                                                      \
+        unsigned bits = 0;                                                 \
+        for (size_t part = 0; part < 8; part += (lanes))                   \
+        {                                                                  \
+            type x = load((const type *)(operand1 + i + part));            \
+            type y = load((const type *)(operand2 + i + part));            \
+            type r;                                                        \
+            type ov;                                                       \
+            COMPUTE;                                                       \
+            store((type *)(result + i + part), r);                         \
+            bits |= (unsigned)(SIGN_BITS) << part;                         \
+        }                                                                  \
+        if (NULL != error_mask)                                            \
+        {                                                                  \
+            error_mask[i / LANES_PER_MASK_BYTE] = (uint8_t)bits;           \
+        }                                                                  \
+        failed |= (0 != bits);                                             \
+    }
+
+/******************************************************************************
+ * @brief    SSE2 kernels for 64-bit lanes
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("sse2"))) static size_t apply64_sse2(
+    calc_op          op,
+    const uint64_t * operand1,
+    const uint64_t * operand2,
+    uint64_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t i      = 0;
+    int    failed = 0;
+
+#define SSE2_LOOP(COMPUTE)                                                 \
+    VECTOR64_LOOP(__m128i,                                                 \
+                  2,                                                       \
+                  _mm_loadu_si128,                                         \
+                  _mm_storeu_si128,                                        \
+                  _mm_movemask_pd(_mm_castsi128_pd(ov)),                   \
+                  COMPUTE)
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            SSE2_LOOP(r  = _mm_add_epi64(x, y);
+                      ov = _mm_and_si128(_mm_xor_si128(x, r),
+                                         _mm_xor_si128(y, r)))
+            break;
+        case CALC_OP_SUB:
+            SSE2_LOOP(r  = _mm_sub_epi64(x, y);
+                      ov = _mm_and_si128(_mm_xor_si128(x, y),
+                                         _mm_xor_si128(x, r)))
+            break;
+        case CALC_OP_AND:
+            SSE2_LOOP(r = _mm_and_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        case CALC_OP_OR:
+            SSE2_LOOP(r = _mm_or_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        case CALC_OP_XOR:
+            SSE2_LOOP(r = _mm_xor_si128(x, y); ov = _mm_setzero_si128())
+            break;
+        default:
+            break;
+    }
+#undef SSE2_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+/******************************************************************************
+ * @brief    AVX2 kernels for 64-bit lanes
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("avx2"))) static size_t apply64_avx2(
+    calc_op          op,
+    const uint64_t * operand1,
+    const uint64_t * operand2,
+    uint64_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t        i      = 0;
+    int           failed = 0;
+    const __m256i limit  = _mm256_set1_epi64x(63);
+    const __m256i bits64 = _mm256_set1_epi64x(64);
+
+#define AVX2_LOOP(COMPUTE)                                                 \
+    VECTOR64_LOOP(__m256i,                                                 \
+                  4,                                                       \
+                  _mm256_loadu_si256,                                      \
+                  _mm256_storeu_si256,                                     \
+                  _mm256_movemask_pd(_mm256_castsi256_pd(ov)),             \
+                  COMPUTE)
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            AVX2_LOOP(r  = _mm256_add_epi64(x, y);
+                      ov = _mm256_and_si256(_mm256_xor_si256(x, r),
+                                            _mm256_xor_si256(y, r)))
+            break;
+        case CALC_OP_SUB:
+            AVX2_LOOP(r  = _mm256_sub_epi64(x, y);
+                      ov = _mm256_and_si256(_mm256_xor_si256(x, y),
+                                            _mm256_xor_si256(x, r)))
+            break;
+        case CALC_OP_SHL:
+            // Variable shifts already yield 0 for counts of 64 or more
+            AVX2_LOOP(r  = _mm256_sllv_epi64(x, y);
+                      ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_SHR:
+            AVX2_LOOP(r  = _mm256_srlv_epi64(x, y);
+                      ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_AND:
+            AVX2_LOOP(r = _mm256_and_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_OR:
+            AVX2_LOOP(r = _mm256_or_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_XOR:
+            AVX2_LOOP(r = _mm256_xor_si256(x, y); ov = _mm256_setzero_si256())
+            break;
+        case CALC_OP_ROL:
+            AVX2_LOOP(__m256i c = _mm256_and_si256(y, limit);
+                      r         = _mm256_or_si256(
+                          _mm256_sllv_epi64(x, c),
+                          _mm256_srlv_epi64(x, _mm256_sub_epi64(bits64, c)));
+                      ov        = _mm256_setzero_si256())
+            break;
+        case CALC_OP_ROR:
+            AVX2_LOOP(__m256i c = _mm256_and_si256(y, limit);
+                      r         = _mm256_or_si256(
+                          _mm256_srlv_epi64(x, c),
+                          _mm256_sllv_epi64(x, _mm256_sub_epi64(bits64, c)));
+                      ov        = _mm256_setzero_si256())
+            break;
+        default:
+            break;
+    }
+#undef AVX2_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+/******************************************************************************
+ * @brief    AVX-512 kernels for 64-bit lanes
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("avx512f"))) static size_t apply64_avx512(
+    calc_op          op,
+    const uint64_t * operand1,
+    const uint64_t * operand2,
+    uint64_t *       result,
+    uint8_t *        error_mask,
+    size_t           count,
+    int *            any_failed)
+{
+    size_t        i      = 0;
+    int           failed = 0;
+    const __m512i zero   = _mm512_setzero_si512();
+
+#define AVX512_LOOP(COMPUTE)                                               \
+    VECTOR64_LOOP(__m512i,                                                 \
+                  8,                                                       \
+                  _mm512_loadu_si512,                                      \
+                  _mm512_storeu_si512,                                     \
+                  _mm512_cmplt_epi64_mask(ov, zero),                       \
+                  COMPUTE)
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            AVX512_LOOP(r  = _mm512_add_epi64(x, y);
+                        ov = _mm512_and_si512(_mm512_xor_si512(x, r),
+                                              _mm512_xor_si512(y, r)))
+            break;
+        case CALC_OP_SUB:
+            AVX512_LOOP(r  = _mm512_sub_epi64(x, y);
+                        ov = _mm512_and_si512(_mm512_xor_si512(x, y),
+                                              _mm512_xor_si512(x, r)))
+            break;
+        case CALC_OP_SHL:
+            AVX512_LOOP(r = _mm512_sllv_epi64(x, y); ov = zero)
+            break;
+        case CALC_OP_SHR:
+            AVX512_LOOP(r = _mm512_srlv_epi64(x, y); ov = zero)
+            break;
+        case CALC_OP_AND:
+            AVX512_LOOP(r = _mm512_and_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_OR:
+            AVX512_LOOP(r = _mm512_or_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_XOR:
+            AVX512_LOOP(r = _mm512_xor_si512(x, y); ov = zero)
+            break;
+        case CALC_OP_ROL:
+            AVX512_LOOP(r = _mm512_rolv_epi64(x, y); ov = zero)
+            break;
+        case CALC_OP_ROR:
+            AVX512_LOOP(r = _mm512_rorv_epi64(x, y); ov = zero)
+            break;
+        default:
+            break;
+    }
+#undef AVX512_LOOP
+
+    *any_failed |= failed;
+    return i;
+}
+
+// Loop of a shared second operand: COMPUTE sets r from x; no lane fails
+#define CONST_LOOP(type, width, load, store, COMPUTE)                      \
+    for (; i + (width) <= count; i += (width))                             \
+    {                                                                      \
+        type x = load((const type *)(operand1 + i));                       \
+        type r;                                                            \
+        COMPUTE;                                                           \
+        store((type *)(result + i), r);                                    \
+    }
+
+/******************************************************************************
+ * @brief    SSE2 kernels for a shared shift or rotate count, which SSE2 can
+ *           shift all lanes by; counts of 32 or more shift everything out
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("sse2"))) static size_t apply_const_sse2(
+    calc_op op, const uint32_t * operand1, uint32_t operand2,
+    uint32_t * result, size_t count)
+{
+    __m128i left  = _mm_cvtsi32_si128((int)operand2);
+    __m128i right = _mm_cvtsi32_si128((int)(32 - (operand2 % 32)));
+    size_t  i     = 0;
+
+    if (CALC_OP_ROL == op || CALC_OP_ROR == op)
+    {
+        left = _mm_cvtsi32_si128((int)(operand2 % 32));
+    }
+    switch (op)
+    {
+        case CALC_OP_SHL:
+            CONST_LOOP(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                       r = _mm_sll_epi32(x, left))
+            break;
+        case CALC_OP_SHR:
+            CONST_LOOP(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                       r = _mm_srl_epi32(x, left))
+            break;
+        case CALC_OP_ROL:
+            CONST_LOOP(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                       r = _mm_or_si128(_mm_sll_epi32(x, left),
+                                        _mm_srl_epi32(x, right)))
+            break;
+        case CALC_OP_ROR:
+            CONST_LOOP(__m128i, 4, _mm_loadu_si128, _mm_storeu_si128,
+                       r = _mm_or_si128(_mm_srl_epi32(x, left),
+                                        _mm_sll_epi32(x, right)))
+            break;
+        default:
+            break;
+    }
+    return i & ~(size_t)(LANES_PER_MASK_BYTE - 1);
+}
+
+/******************************************************************************
+ * @brief    AVX2 kernels for a shared second operand: shifts and rotates by
+ *           one count, and remainders by a magic divisor, whose high
+ *           products come from two VPMULDQs over the even and odd lanes
+ * @param    divisor     Prepared divisor of CALC_OP_MOD, or NULL
+ * @return   Number of lanes processed
+ ******************************************************************************/
+__attribute__((target("avx2"))) static size_t apply_const_avx2(
+    calc_op op, const uint32_t * operand1, uint32_t operand2,
+    const calc_divisor * divisor, uint32_t * result, size_t count)
+{
+    __m128i left  = _mm_cvtsi32_si128((int)operand2);
+    __m128i right = _mm_cvtsi32_si128((int)(32 - (operand2 % 32)));
+    size_t  i     = 0;
+
+    if (CALC_OP_ROL == op || CALC_OP_ROR == op)
+    {
+        left = _mm_cvtsi32_si128((int)(operand2 % 32));
+    }
+    switch (op)
+    {
+        case CALC_OP_SHL:
+            CONST_LOOP(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                       r = _mm256_sll_epi32(x, left))
+            break;
+        case CALC_OP_SHR:
+            CONST_LOOP(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                       r = _mm256_srl_epi32(x, left))
+            break;
+        case CALC_OP_ROL:
+            CONST_LOOP(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                       r = _mm256_or_si256(_mm256_sll_epi32(x, left),
+                                           _mm256_srl_epi32(x, right)))
+            break;
+        case CALC_OP_ROR:
+            CONST_LOOP(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                       r = _mm256_or_si256(_mm256_srl_epi32(x, left),
+                                           _mm256_sll_epi32(x, right)))
+            break;
+        case CALC_OP_MOD:
+        {
+            __m256i magic = _mm256_set1_epi32(divisor->magic);
+            __m256i add   = _mm256_set1_epi32(divisor->add);
+            __m256i d     = _mm256_set1_epi32(divisor->divisor);
+            __m128i shift = _mm_cvtsi32_si128((int)divisor->shift);
+
+            // VPSIGND adds the dividend times -1, 0 or 1 without a branch
+            CONST_LOOP(__m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256,
+                       __m256i even = _mm256_srli_epi64(
+                           _mm256_mul_epi32(x, magic), 32);
+                       __m256i odd = _mm256_mul_epi32(
+                           _mm256_srli_epi64(x, 32), magic);
+                       __m256i q = _mm256_blend_epi32(even, odd, 0xAA);
+                       q = _mm256_add_epi32(q, _mm256_sign_epi32(x, add));
+                       q = _mm256_sra_epi32(q, shift);
+                       q = _mm256_add_epi32(q, _mm256_srli_epi32(q, 31));
+                       r = _mm256_sub_epi32(x, _mm256_mullo_epi32(q, d)))
+            break;
+        }
+        default:
+            break;
+    }
+    return i;
+}
+
+#undef CONST_LOOP
+
+#endif // CALC_SIMD_X86
+
+#if defined(CALC_SIMD_NEON)
+
+/******************************************************************************
+ * @brief    NEON kernels
+ * @return   Number of lanes processed
+ ******************************************************************************/
+static size_t apply_neon(calc_op          op,
+                         const uint32_t * operand1,
+                         const uint32_t * operand2,
+                         uint32_t *       result,
+                         uint8_t *        error_mask,
+                         size_t           count,
+                         int *            any_failed)
+{
+    static const uint32_t weights[4] = { 1, 2, 4, 8 };
+    const uint32x4_t      weight     = vld1q_u32(weights);
+    const uint32x4_t      limit      = vdupq_n_u32(31);
+    const uint32x4_t      bits32     = vdupq_n_u32(32);
+    size_t                i          = 0;
+    int                   failed     = 0;
+
+// COMPUTE sets r and an all-ones-per-failed-lane ov from x and y
+#define NEON_LOOP(COMPUTE)                                                 \
+    for (; i + 8 <= count; i += 8)                                         \
+    {                                                                      \
+        unsigned bits = 0;                                                 \
+        for (size_t half = 0; half < 8; half += 4)                         \
+        {                                                                  \
+            uint32x4_t x = vld1q_u32(operand1 + i + half);                 \
+            uint32x4_t y = vld1q_u32(operand2 + i + half);                 \
+            uint32x4_t r;                                                  \
+            uint32x4_t ov;                                                 \
+            COMPUTE;                                                       \
+            vst1q_u32(result + i + half, r);                               \
+            bits |= vaddvq_u32(vandq_u32(ov, weight)) << half;             \
+        }                                                                  \
+        if (NULL != error_mask)                                            \
+        {                                                                  \
+            error_mask[i / LANES_PER_MASK_BYTE] = (uint8_t)bits;           \
+        }                                                                  \
+        failed |= (0 != bits);                                             \
+    }
+
+// Broadcast each lane's sign bit across the lane
+#define NEON_SIGN_MASK(v)                                                  \
+    vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(v), 31))
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            NEON_LOOP(r  = vaddq_u32(x, y);
+                      ov = NEON_SIGN_MASK(
+                          vandq_u32(veorq_u32(x, r), veorq_u32(y, r))))
+            break;
+        case CALC_OP_SUB:
+            NEON_LOOP(r  = vsubq_u32(x, y);
+                      ov = NEON_SIGN_MASK(
+                          vandq_u32(veorq_u32(x, y), veorq_u32(x, r))))
+            break;
+        case CALC_OP_MUL:
+            NEON_LOOP(
+                int32x4_t sx = vreinterpretq_s32_u32(x);
+                int32x4_t sy = vreinterpretq_s32_u32(y);
+                int64x2_t lo = vmull_s32(vget_low_s32(sx), vget_low_s32(sy));
+                int64x2_t hi = vmull_high_s32(sx, sy);
+                uint64x2_t fits_lo = vceqq_s64(lo, vmovl_s32(vmovn_s64(lo)));
+                uint64x2_t fits_hi = vceqq_s64(hi, vmovl_s32(vmovn_s64(hi)));
+                r  = vreinterpretq_u32_s32(vmulq_s32(sx, sy));
+                ov = vmvnq_u32(
+                    vcombine_u32(vmovn_u64(fits_lo), vmovn_u64(fits_hi))))
+            break;
+        case CALC_OP_SHL:
+            // VSHL only looks at the low byte of the count, so mask big ones
+            NEON_LOOP(r  = vbicq_u32(vshlq_u32(x, vreinterpretq_s32_u32(y)),
+                                    vcgeq_u32(y, bits32));
+                      ov = vdupq_n_u32(0))
+            break;
+        case CALC_OP_SHR:
+            NEON_LOOP(r  = vbicq_u32(vshlq_u32(x,
+                                              vnegq_s32(
+                                                  vreinterpretq_s32_u32(y))),
+                                    vcgeq_u32(y, bits32));
+                      ov = vdupq_n_u32(0))
+            break;
+        case CALC_OP_AND:
+            NEON_LOOP(r = vandq_u32(x, y); ov = vdupq_n_u32(0))
+            break;
+        case CALC_OP_OR:
+            NEON_LOOP(r = vorrq_u32(x, y); ov = vdupq_n_u32(0))
+            break;
+        case CALC_OP_XOR:
+            NEON_LOOP(r = veorq_u32(x, y); ov = vdupq_n_u32(0))
+            break;
+        case CALC_OP_ROL:
+            NEON_LOOP(int32x4_t c = vreinterpretq_s32_u32(vandq_u32(y, limit));
+                      r           = vorrq_u32(
+                          vshlq_u32(x, c),
+                          vshlq_u32(x,
+                                    vsubq_s32(c,
+                                              vreinterpretq_s32_u32(bits32))));
+                      ov          = vdupq_n_u32(0))
+            break;
+        case CALC_OP_ROR:
+            NEON_LOOP(int32x4_t c = vreinterpretq_s32_u32(vandq_u32(y, limit));
+                      r           = vorrq_u32(
+                          vshlq_u32(x, vnegq_s32(c)),
+                          vshlq_u32(x,
+                                    vsubq_s32(vreinterpretq_s32_u32(bits32),
+                                              c)));
+                      ov          = vdupq_n_u32(0))
+            break;
+        default:
+            break;
+    }
+#undef NEON_LOOP
+#undef NEON_SIGN_MASK
+
+    *any_failed |= failed;
+    return i;
+}
+
+#endif // CALC_SIMD_NEON
+
+/******************************************************************************
+ * @brief    Check whether an instruction set is usable on this machine
+ * @param    isa     Instruction set
+ * @return   1 if supported, 0 otherwise
+ ******************************************************************************/
+int calc_isa_supported(calc_isa isa)
+{
+    switch (isa)
+    {
+        case CALC_ISA_SCALAR:
+            return 1;
+#if defined(CALC_SIMD_X86)
+        case CALC_ISA_SSE2:
+            return __builtin_cpu_supports("sse2");
+        case CALC_ISA_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case CALC_ISA_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+#if defined(CALC_SIMD_NEON)
+        case CALC_ISA_NEON:
+            return 1;
+#endif
+        default:
+            return 0;
+    }
+}
+
+/******************************************************************************
+ * @brief    Pick the widest instruction set this machine supports
+ * @return   Instruction set
+ ******************************************************************************/
+calc_isa calc_isa_detect(void)
+{
+    static const calc_isa preference[] = {
+        CALC_ISA_AVX512, CALC_ISA_AVX2, CALC_ISA_NEON, CALC_ISA_SSE2
+    };
+
+    for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++)
+    {
+        if (calc_isa_supported(preference[i]))
+        {
+            return preference[i];
+        }
+    }
+    return CALC_ISA_SCALAR;
+}
+
+/******************************************************************************
+ * @brief    Name of an instruction set
+ * @param    isa     Instruction set
+ * @return   Name as string
+ ******************************************************************************/
+const char * calc_isa_name(calc_isa isa)
+{
+    switch (isa)
+    {
+        case CALC_ISA_SCALAR:
+            return "scalar";
+        case CALC_ISA_SSE2:
+            return "sse2";
+        case CALC_ISA_AVX2:
+            return "avx2";
+        case CALC_ISA_AVX512:
+            return "avx512";
+        case CALC_ISA_NEON:
+            return "neon";
+        default:
+            return "unknown";
+    }
+}
+
+/******************************************************************************
+ * @brief    Status of an array in which some lane failed; every operator has
+ *           a single way to fail
+ ******************************************************************************/
+static calc_status failure_status(calc_op op)
+{
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            return CALC_ERR_ADD_OVERFLOW;
+        case CALC_OP_SUB:
+            return CALC_ERR_SUB_OVERFLOW;
+        case CALC_OP_MUL:
+            return CALC_ERR_MUL_OVERFLOW;
+        default:
+            return CALC_ERR_MOD_BY_ZERO;
+    }
+}
+
+/******************************************************************************
+ * @brief    Apply one operator element-wise using a given instruction set
+ * @param    isa         Instruction set; unsupported ones run the scalar path
+ * @param    op          Operator; division has no 32-bit result and is
+ *                       rejected along with CALC_OP_INVALID
+ * @param    operand1    First operands
+ * @param    operand2    Second operands
+ * @param    result      Results; lanes flagged in error_mask are unspecified
+ * @param    error_mask  Bitmap of failed lanes, bit (i % 8) of byte (i / 8)
+ *                       for lane i, (count + 7) / 8 bytes; may be NULL
+ * @param    count       Number of lanes
+ * @return   CALC_OK if no lane failed, the operator's error status if any
+ *           did, or CALC_ERR_UNSUPPORTED_OPERATOR
+ ******************************************************************************/
+calc_status calc_apply_isa(calc_isa         isa,
+                           calc_op          op,
+                           const uint32_t * operand1,
+                           const uint32_t * operand2,
+                           uint32_t *       result,
+                           uint8_t *        error_mask,
+                           size_t           count)
+{
+    size_t done   = 0;
+    int    failed = 0;
+
+    if ((unsigned)op >= CALC_OP_COUNT || CALC_OP_INVALID == op ||
+        CALC_OP_DIV == op)
+    {
+        return CALC_ERR_UNSUPPORTED_OPERATOR;
+    }
+    if (!calc_isa_supported(isa))
+    {
+        isa = CALC_ISA_SCALAR;
+    }
+
+    switch (isa)
+    {
+#if defined(CALC_SIMD_X86)
+        case CALC_ISA_SSE2:
+            done = apply_sse2(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+        case CALC_ISA_AVX2:
+            done = apply_avx2(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+        case CALC_ISA_AVX512:
+            done = apply_avx512(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+#endif
+#if defined(CALC_SIMD_NEON)
+        case CALC_ISA_NEON:
+            done = apply_neon(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    failed |= apply_scalar(
+        op, operand1, operand2, result, error_mask, done, count);
+    return failed ? failure_status(op) : CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Apply one operator element-wise with a second operand shared by
+ *           every lane, such as x >> 7 or x % 1000
+ * @param    op          Operator; division is rejected as by calc_apply
+ * @param    operand1    First operands
+ * @param    operand2    Second operand of every lane
+ * @param    result      Results; lanes flagged in error_mask are unspecified
+ * @param    error_mask  Bitmap of failed lanes as for calc_apply; may be NULL
+ * @param    count       Number of lanes
+ * @return   CALC_OK if no lane failed, the operator's error status if any
+ *           did, or CALC_ERR_UNSUPPORTED_OPERATOR
+ * @note     Shifts and rotates move every lane by one count, and remainders
+ *           multiply by the divisor's magic number instead of dividing.
+ ******************************************************************************/
+calc_status calc_apply_const(calc_op          op,
+                             const uint32_t * operand1,
+                             uint32_t         operand2,
+                             uint32_t *       result,
+                             uint8_t *        error_mask,
+                             size_t           count)
+{
+    size_t done   = 0;
+    int    failed = 0;
+
+    if ((unsigned)op >= CALC_OP_COUNT || CALC_OP_INVALID == op ||
+        CALC_OP_DIV == op)
+    {
+        return CALC_ERR_UNSUPPORTED_OPERATOR;
+    }
+    if (NULL != error_mask)
+    {
+        memset(error_mask, 0, (count + LANES_PER_MASK_BYTE - 1) /
+                                  LANES_PER_MASK_BYTE);
+    }
+
+    int32_t      divisor  = (int32_t)operand2;
+    int          magic    = (CALC_OP_MOD == op && 0 != divisor &&
+                          1 != divisor && -1 != divisor);
+    calc_divisor prepared = { 0, 0, 0, 0 };
+    if (magic)
+    {
+        prepared = calc_divisor_init(divisor);
+    }
+
+#if defined(CALC_SIMD_X86)
+    if (calc_isa_supported(CALC_ISA_AVX2))
+    {
+        if (magic || CALC_OP_SHL == op || CALC_OP_SHR == op ||
+            CALC_OP_ROL == op || CALC_OP_ROR == op)
+        {
+            done = apply_const_avx2(
+                op, operand1, operand2, &prepared, result, count);
+        }
+    }
+    else if (calc_isa_supported(CALC_ISA_SSE2))
+    {
+        done = apply_const_sse2(op, operand1, operand2, result, count);
+    }
+#endif
+
+    const uint32_t * x    = operand1 + done;
+    uint32_t *       r    = result + done;
+    uint8_t *        mask = (NULL != error_mask)
+                                ? error_mask + (done / LANES_PER_MASK_BYTE)
+                                : NULL;
+    size_t           left = count - done;
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            failed = const_add_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_SUB:
+            failed = const_sub_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_MUL:
+            failed = const_mul_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_MOD:
+            failed = const_mod_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_SHL:
+            failed = const_shl_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_SHR:
+            failed = const_shr_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_AND:
+            failed = const_and_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_OR:
+            failed = const_or_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_XOR:
+            failed = const_xor_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_ROL:
+            failed = const_rol_32(x, operand2, r, mask, left);
+            break;
+        case CALC_OP_ROR:
+            failed = const_ror_32(x, operand2, r, mask, left);
+            break;
+        default:
+            break;
+    }
+    return failed ? failure_status(op) : CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Whether every lane has the same second operand
+ ******************************************************************************/
+static int uniform_lanes(const uint32_t * operand2, size_t count)
+{
+    uint32_t differ = 0;
+
+    // Blocks without an early exit inside, which the compiler vectorizes
+    for (size_t start = 0; start < count && 0 == differ;
+         start += UNIFORM_BLOCK)
+    {
+        size_t stop = (count - start < UNIFORM_BLOCK) ? count
+                                                      : start + UNIFORM_BLOCK;
+        for (size_t i = start; i < stop; i++)
+        {
+            differ |= operand2[i] ^ operand2[0];
+        }
+    }
+    return 0 != count && 0 == differ;
+}
+
+/******************************************************************************
+ * @brief    Apply one operator element-wise with the best instruction set
+ * @note     An array whose second operands are all equal is handed to
+ *           calc_apply_const when that saves work: for remainders, which
+ *           no instruction set divides, and for shifts and rotates where
+ *           the instruction set cannot shift lanes by counts of their own.
+ *           Random operands differ within the first block of lanes, so the
+ *           check is cheap.
+ * @see      calc_apply_isa
+ ******************************************************************************/
+calc_status calc_apply(calc_op          op,
+                       const uint32_t * operand1,
+                       const uint32_t * operand2,
+                       uint32_t *       result,
+                       uint8_t *        error_mask,
+                       size_t           count)
+{
+    calc_isa isa     = calc_isa_detect();
+    int      shifted = (CALC_OP_SHL == op || CALC_OP_SHR == op ||
+                   CALC_OP_ROL == op || CALC_OP_ROR == op);
+
+    if ((CALC_OP_MOD == op ||
+         (shifted && (CALC_ISA_SSE2 == isa || CALC_ISA_SCALAR == isa))) &&
+        uniform_lanes(operand2, count))
+    {
+        return calc_apply_const(
+            op, operand1, operand2[0], result, error_mask, count);
+    }
+    return calc_apply_isa(isa,
+                          op,
+                          operand1,
+                          operand2,
+                          result,
+                          error_mask,
+                          count);
+}
+
+/******************************************************************************
+ * @brief    Apply one operator element-wise to 64-bit lanes using a given
+ *           instruction set
+ * @see      calc_apply_isa, whose contract this follows at 64 bits
+ ******************************************************************************/
+calc_status calc_apply64_isa(calc_isa         isa,
+                             calc_op          op,
+                             const uint64_t * operand1,
+                             const uint64_t * operand2,
+                             uint64_t *       result,
+                             uint8_t *        error_mask,
+                             size_t           count)
+{
+    size_t done   = 0;
+    int    failed = 0;
+
+    if ((unsigned)op >= CALC_OP_COUNT || CALC_OP_INVALID == op ||
+        CALC_OP_DIV == op)
+    {
+        return CALC_ERR_UNSUPPORTED_OPERATOR;
+    }
+    if (!calc_isa_supported(isa))
+    {
+        isa = CALC_ISA_SCALAR;
+    }
+
+    switch (isa)
+    {
+#if defined(CALC_SIMD_X86)
+        case CALC_ISA_SSE2:
+            done = apply64_sse2(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+        case CALC_ISA_AVX2:
+            done = apply64_avx2(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+        case CALC_ISA_AVX512:
+            done = apply64_avx512(
+                op, operand1, operand2, result, error_mask, count, &failed);
+            break;
+#endif
+        default:
+            break;
+    }
+
+    failed |= apply64_scalar(
+        op, operand1, operand2, result, error_mask, done, count);
+    return failed ? failure_status(op) : CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    Apply one operator element-wise to 64-bit lanes with the best
+ *           instruction set
+ * @see      calc_apply64_isa
+ ******************************************************************************/
+calc_status calc_apply64(calc_op          op,
+                         const uint64_t * operand1,
+                         const uint64_t * operand2,
+                         uint64_t *       result,
+                         uint8_t *        error_mask,
+                         size_t           count)
+{
+    return calc_apply64_isa(calc_isa_detect(),
+                            op,
+                            operand1,
+                            operand2,
+                            result,
+                            error_mask,
+                            count);
+}
@@ -0,0 +1,445 @@
+/******************************************************************************
+ * @file    calc_stats.c
+ * @brief   Registry of per-thread statistics, snapshots and their exposition
+ * @version 1.6
+ * @date    October 2026
+ *
+ * A thread's block is created the first time it records and linked into a
+ * registry. When the thread exits, its counts are folded into a block of
+ * retired totals and the block is freed, so a snapshot, which sums the
+ * retired totals and every live block under the registry lock, always
+ * covers every thread the process has run.
+ *
+ * Latency buckets follow HdrHistogram with two significant bits: exact
+ * below 4 ns, then four buckets to a power of two, so any sample is placed
+ * within 25% of its value however long it took.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "calc.h"
+#include "calc_stats.h"
+
+#define STATS_SUB_BITS     2 // Significant bits below the top one
+#define STATS_SUB_BUCKETS  (1u << STATS_SUB_BITS)
+#define STATS_NANOSECONDS  1000000000u
+
+// Label values for the exposition, indexed by opcode, status and stage
+static const char * const op_names[CALC_OP_COUNT] = {
+    [CALC_OP_INVALID] = "invalid", [CALC_OP_ADD] = "add",
+    [CALC_OP_SUB] = "sub",         [CALC_OP_MUL] = "mul",
+    [CALC_OP_DIV] = "div",         [CALC_OP_MOD] = "mod",
+    [CALC_OP_SHL] = "shl",         [CALC_OP_SHR] = "shr",
+    [CALC_OP_AND] = "and",         [CALC_OP_OR] = "or",
+    [CALC_OP_XOR] = "xor",         [CALC_OP_ROL] = "rol",
+    [CALC_OP_ROR] = "ror",
+};
+
+static const char * const status_names[CALC_STATUS_COUNT] = {
+    [CALC_OK]                       = "ok",
+    [CALC_ERR_ADD_OVERFLOW]         = "add_overflow",
+    [CALC_ERR_SUB_OVERFLOW]         = "sub_overflow",
+    [CALC_ERR_MUL_OVERFLOW]         = "mul_overflow",
+    [CALC_ERR_DIV_BY_ZERO]          = "div_by_zero",
+    [CALC_ERR_MOD_BY_ZERO]          = "mod_by_zero",
+    [CALC_ERR_UNSUPPORTED_OPERATOR] = "unsupported_operator",
+    [CALC_ERR_TOO_LARGE]            = "too_large",
+    [CALC_ERR_NO_MEMORY]            = "no_memory",
+    [CALC_ERR_EMPTY]                = "empty",
+};
+
+static const char * const stage_names[CALC_STAGE_COUNT] = {
+    [CALC_STAGE_PARSE]    = "parse",
+    [CALC_STAGE_DISPATCH] = "dispatch",
+    [CALC_STAGE_COMPUTE]  = "compute",
+    [CALC_STAGE_FORMAT]   = "format",
+};
+
+/******************************************************************************
+ * @brief    Upper bound of a latency bucket
+ * @param    bucket  Bucket, below CALC_STATS_BUCKETS
+ * @return   Largest number of nanoseconds the bucket holds; UINT64_MAX for
+ *           the last one
+ ******************************************************************************/
+uint64_t calc_stats_bucket_limit(size_t bucket)
+{
+    if (bucket + 1 >= CALC_STATS_BUCKETS)
+    {
+        return UINT64_MAX;
+    }
+    if (bucket < STATS_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    // Bucket i of a power of two 2^top holds (4 + i) << (top - 2) onwards
+    unsigned top = (unsigned)(bucket / STATS_SUB_BUCKETS) + 1;
+    uint64_t sub = bucket % STATS_SUB_BUCKETS;
+    return ((STATS_SUB_BUCKETS + sub + 1) << (top - STATS_SUB_BITS)) - 1;
+}
+
+#if defined(CALC_NO_STATS)
+
+/******************************************************************************
+ * @brief    Whether the library was built with statistics
+ ******************************************************************************/
+int calc_stats_enabled(void)
+{
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Sum the statistics of every thread; all zero when compiled out
+ ******************************************************************************/
+void calc_stats_snapshot(calc_stats * stats)
+{
+    memset(stats, 0, sizeof(*stats));
+}
+
+#else
+
+_Thread_local calc_stats_block * calc_stats_self;
+
+static pthread_mutex_t    registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t     registry_once = PTHREAD_ONCE_INIT;
+static pthread_key_t      registry_key;
+static calc_stats_block * registry;
+static calc_stats_block   retired;  // Totals of the threads that exited
+static calc_stats_block   overflow; // Shared when a block cannot be made
+
+/******************************************************************************
+ * @brief    Add every counter of one block to another
+ ******************************************************************************/
+static void add_block(calc_stats_block * into, calc_stats_block * from)
+{
+    for (size_t i = 0; i < CALC_OP_COUNT; i++)
+    {
+        atomic_fetch_add_explicit(
+            &into->ops[i],
+            atomic_load_explicit(&from->ops[i], memory_order_relaxed),
+            memory_order_relaxed);
+    }
+    for (size_t i = 0; i < CALC_STATUS_COUNT; i++)
+    {
+        atomic_fetch_add_explicit(
+            &into->errors[i],
+            atomic_load_explicit(&from->errors[i], memory_order_relaxed),
+            memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(
+        &into->rejected,
+        atomic_load_explicit(&from->rejected, memory_order_relaxed),
+        memory_order_relaxed);
+    for (size_t stage = 0; stage < CALC_STAGE_COUNT; stage++)
+    {
+        for (size_t i = 0; i < CALC_STATS_BUCKETS; i++)
+        {
+            atomic_fetch_add_explicit(
+                &into->latency[stage][i],
+                atomic_load_explicit(&from->latency[stage][i],
+                                     memory_order_relaxed),
+                memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(
+            &into->latency_sum[stage],
+            atomic_load_explicit(&from->latency_sum[stage],
+                                 memory_order_relaxed),
+            memory_order_relaxed);
+    }
+}
+
+/******************************************************************************
+ * @brief    Thread exit: fold the thread's block into the retired totals
+ ******************************************************************************/
+static void retire_block(void * value)
+{
+    calc_stats_block * block = value;
+
+    pthread_mutex_lock(&registry_lock);
+    for (calc_stats_block ** link = &registry; NULL != *link;
+         link = &(*link)->next)
+    {
+        if (block == *link)
+        {
+            *link = block->next;
+            break;
+        }
+    }
+    add_block(&retired, block);
+    pthread_mutex_unlock(&registry_lock);
+    free(block);
+}
+
+static void create_key(void)
+{
+    if (0 != pthread_key_create(&registry_key, retire_block))
+    {
+        abort(); // Only fails when the process is out of keys
+    }
+}
+
+/******************************************************************************
+ * @brief    Give the calling thread a block of its own and register it
+ * @return   The block, or a shared one if out of memory, whose counts may
+ *           then lose updates when threads race on it
+ ******************************************************************************/
+calc_stats_block * calc_stats_attach(void)
+{
+    calc_stats_block * block = calloc(1, sizeof(*block));
+
+    pthread_once(&registry_once, create_key);
+    if (NULL == block || 0 != pthread_setspecific(registry_key, block))
+    {
+        free(block);
+        calc_stats_self = &overflow;
+        return &overflow;
+    }
+
+    pthread_mutex_lock(&registry_lock);
+    block->next = registry;
+    registry    = block;
+    pthread_mutex_unlock(&registry_lock);
+    calc_stats_self = block;
+    return block;
+}
+
+/******************************************************************************
+ * @brief    Monotonic time in nanoseconds, never 0
+ ******************************************************************************/
+calc_stats_time calc_stats_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * STATS_NANOSECONDS) +
+           (uint64_t)now.tv_nsec + 1;
+}
+
+/******************************************************************************
+ * @brief    Place one sample of a stage in its latency bucket
+ ******************************************************************************/
+void calc_stats_record(calc_stage stage, uint64_t nanoseconds)
+{
+    calc_stats_block * self   = calc_stats_block_get();
+    size_t             bucket = (size_t)nanoseconds;
+
+    if (nanoseconds >= STATS_SUB_BUCKETS)
+    {
+        unsigned top = 63u - (unsigned)__builtin_clzll(nanoseconds);
+        bucket = ((size_t)(top - 1) * STATS_SUB_BUCKETS) +
+                 (size_t)((nanoseconds >> (top - STATS_SUB_BITS)) &
+                          (STATS_SUB_BUCKETS - 1));
+    }
+    if (bucket >= CALC_STATS_BUCKETS)
+    {
+        bucket = CALC_STATS_BUCKETS - 1;
+    }
+    calc_stats_add(&self->latency[stage][bucket], 1);
+    calc_stats_add(&self->latency_sum[stage], nanoseconds);
+}
+
+/******************************************************************************
+ * @brief    Count a block of binary rows, all of one operator
+ * @param    op      Operator of the rows
+ * @param    rows    Rows evaluated
+ * @param    failed  Rows that failed, all with the status the operator
+ *                   fails with
+ ******************************************************************************/
+void calc_stats_count_rows(calc_op op, uint64_t rows, uint64_t failed)
+{
+    static const calc_status failures[CALC_OP_COUNT] = {
+        [CALC_OP_INVALID] = CALC_ERR_UNSUPPORTED_OPERATOR,
+        [CALC_OP_ADD]     = CALC_ERR_ADD_OVERFLOW,
+        [CALC_OP_SUB]     = CALC_ERR_SUB_OVERFLOW,
+        [CALC_OP_MUL]     = CALC_ERR_MUL_OVERFLOW,
+        [CALC_OP_DIV]     = CALC_ERR_DIV_BY_ZERO,
+        [CALC_OP_MOD]     = CALC_ERR_MOD_BY_ZERO,
+    };
+    calc_stats_block * self  = calc_stats_block_get();
+    unsigned           index = (unsigned)op < CALC_OP_COUNT ? op : 0;
+
+    calc_stats_add(&self->ops[index], rows);
+    if (0 != failed)
+    {
+        calc_stats_add(&self->errors[failures[index]], failed);
+    }
+}
+
+/******************************************************************************
+ * @brief    Whether the library was built with statistics
+ ******************************************************************************/
+int calc_stats_enabled(void)
+{
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Sum the statistics of every thread, live or exited
+ * @param    stats   Filled with the totals
+ * @note     Counters of live threads are read while they are being updated,
+ *           so the totals are each exact but not from one single instant.
+ ******************************************************************************/
+void calc_stats_snapshot(calc_stats * stats)
+{
+    calc_stats_block total;
+
+    memset(&total, 0, sizeof(total));
+    pthread_mutex_lock(&registry_lock);
+    add_block(&total, &retired);
+    add_block(&total, &overflow);
+    for (calc_stats_block * block = registry; NULL != block;
+         block = block->next)
+    {
+        add_block(&total, block);
+    }
+    pthread_mutex_unlock(&registry_lock);
+
+    for (size_t i = 0; i < CALC_OP_COUNT; i++)
+    {
+        stats->ops[i] = atomic_load(&total.ops[i]);
+    }
+    for (size_t i = 0; i < CALC_STATUS_COUNT; i++)
+    {
+        stats->errors[i] = atomic_load(&total.errors[i]);
+    }
+    stats->rejected = atomic_load(&total.rejected);
+    for (size_t stage = 0; stage < CALC_STAGE_COUNT; stage++)
+    {
+        for (size_t i = 0; i < CALC_STATS_BUCKETS; i++)
+        {
+            stats->latency[stage][i] = atomic_load(&total.latency[stage][i]);
+        }
+        stats->latency_sum[stage] = atomic_load(&total.latency_sum[stage]);
+    }
+}
+
+#endif // CALC_NO_STATS
+
+/******************************************************************************
+ * @brief    Append formatted text to a buffer, grown to fit
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+static int append(calc_buffer * output, const char * format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static int append(calc_buffer * output, const char * format, ...)
+{
+    va_list arguments;
+    va_list again;
+
+    va_start(arguments, format);
+    va_copy(again, arguments);
+    int length = vsnprintf(NULL, 0, format, arguments);
+    int ok = (length >= 0) && calc_buffer_reserve(output, (size_t)length + 1);
+    if (ok)
+    {
+        vsnprintf(
+            output->data + output->used, (size_t)length + 1, format, again);
+        output->used += (size_t)length;
+    }
+    va_end(again);
+    va_end(arguments);
+    return ok;
+}
+
+/******************************************************************************
+ * @brief    Append statistics in the Prometheus text exposition format
+ * @param    output  Buffer the exposition is appended to, grown to fit
+ * @param    stats   Statistics, from calc_stats_snapshot
+ * @return   1 if successful, 0 if out of memory
+ * @note     Latencies are a histogram in seconds, whose bucket bounds are
+ *           calc_stats_bucket_limit; empty buckets above the highest sample
+ *           of a stage are left out, as the cumulative counts allow.
+ ******************************************************************************/
+int calc_stats_format(calc_buffer * output, const calc_stats * stats)
+{
+    int ok = 1;
+
+    if (!calc_stats_enabled())
+    {
+        return append(output, "# calc statistics were compiled out\n");
+    }
+
+    ok = ok && append(output,
+                      "# HELP calc_operations_total Evaluations by "
+                      "operator.\n"
+                      "# TYPE calc_operations_total counter\n");
+    for (size_t i = 0; ok && i < CALC_OP_COUNT; i++)
+    {
+        ok = append(output,
+                    "calc_operations_total{op=\"%s\"} %" PRIu64 "\n",
+                    op_names[i],
+                    stats->ops[i]);
+    }
+
+    ok = ok && append(output,
+                      "# HELP calc_errors_total Failed evaluations by kind; "
+                      "invalid_input is a line that was not evaluated.\n"
+                      "# TYPE calc_errors_total counter\n");
+    for (size_t i = CALC_OK + 1; ok && i < CALC_STATUS_COUNT; i++)
+    {
+        ok = append(output,
+                    "calc_errors_total{kind=\"%s\"} %" PRIu64 "\n",
+                    status_names[i],
+                    stats->errors[i]);
+    }
+    ok = ok && append(output,
+                      "calc_errors_total{kind=\"invalid_input\"} %" PRIu64
+                      "\n",
+                      stats->rejected);
+
+    ok = ok && append(output,
+                      "# HELP calc_stage_duration_seconds Time spent in each "
+                      "stage of a batch line, sampled 1 in %u.\n"
+                      "# TYPE calc_stage_duration_seconds histogram\n",
+                      CALC_STATS_SAMPLE);
+    for (size_t stage = 0; ok && stage < CALC_STAGE_COUNT; stage++)
+    {
+        const uint64_t * buckets = stats->latency[stage];
+        size_t           last    = 0;
+        uint64_t         count   = 0;
+
+        for (size_t i = 0; i < CALC_STATS_BUCKETS - 1; i++)
+        {
+            last = (0 != buckets[i]) ? i : last;
+        }
+        for (size_t i = 0; ok && i <= last; i++)
+        {
+            uint64_t limit = calc_stats_bucket_limit(i);
+            count += buckets[i];
+            ok = append(output,
+                        "calc_stage_duration_seconds_bucket{stage=\"%s\","
+                        "le=\"%" PRIu64 ".%09" PRIu64 "\"} %" PRIu64 "\n",
+                        stage_names[stage],
+                        limit / STATS_NANOSECONDS,
+                        limit % STATS_NANOSECONDS,
+                        count);
+        }
+        for (size_t i = last + 1; i < CALC_STATS_BUCKETS; i++)
+        {
+            count += buckets[i];
+        }
+        ok = ok && append(output,
+                          "calc_stage_duration_seconds_bucket{stage=\"%s\","
+                          "le=\"+Inf\"} %" PRIu64 "\n"
+                          "calc_stage_duration_seconds_sum{stage=\"%s\"} "
+                          "%" PRIu64 ".%09" PRIu64 "\n"
+                          "calc_stage_duration_seconds_count{stage=\"%s\"} "
+                          "%" PRIu64 "\n",
+                          stage_names[stage],
+                          count,
+                          stage_names[stage],
+                          stats->latency_sum[stage] / STATS_NANOSECONDS,
+                          stats->latency_sum[stage] % STATS_NANOSECONDS,
+                          stage_names[stage],
+                          count);
+    }
+    return ok;
+}
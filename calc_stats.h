@@ -0,0 +1,173 @@
+/******************************************************************************
+ * @file    calc_stats.h
+ * @brief   Per-thread counters and stage latency histograms (internal)
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Every thread that evaluates requests records into a block of its own,
+ * which no other thread writes: a counter is bumped with a relaxed load and
+ * store, which compile to a plain add, never a locked instruction, while
+ * calc_stats_snapshot can still read the block from another thread. Only
+ * one 32-bit batch line in CALC_STATS_SAMPLE reads the clock.
+ *
+ * Building with CALC_NO_STATS defined (make STATS=0) turns all of this into
+ * empty inline functions, so the instrumentation compiles to nothing.
+ ******************************************************************************/
+
+#ifndef CALC_STATS_H
+#define CALC_STATS_H
+
+#include <stdint.h>
+#include "calc.h"
+
+// Nanoseconds on a monotonic clock; 0 for a line that is not timed
+typedef uint64_t calc_stats_time;
+
+#if defined(CALC_NO_STATS)
+
+static inline void calc_stats_count(calc_op op, calc_status status)
+{
+    (void)op;
+    (void)status;
+}
+
+static inline void calc_stats_count_rows(calc_op  op,
+                                         uint64_t rows,
+                                         uint64_t failed)
+{
+    (void)op;
+    (void)rows;
+    (void)failed;
+}
+
+static inline void calc_stats_reject(void)
+{
+}
+
+static inline calc_stats_time calc_stats_start(void)
+{
+    return 0;
+}
+
+static inline calc_stats_time calc_stats_lap(calc_stats_time since,
+                                             calc_stage      stage)
+{
+    (void)since;
+    (void)stage;
+    return 0;
+}
+
+#else
+
+#include <stdatomic.h>
+
+/******************************************************************************
+ * @brief    Counters of one thread, linked into the registry of every block
+ ******************************************************************************/
+typedef struct calc_stats_block
+{
+    _Atomic uint64_t          ops[CALC_OP_COUNT];
+    _Atomic uint64_t          errors[CALC_STATUS_COUNT];
+    _Atomic uint64_t          rejected;
+    _Atomic uint64_t          latency[CALC_STAGE_COUNT][CALC_STATS_BUCKETS];
+    _Atomic uint64_t          latency_sum[CALC_STAGE_COUNT];
+    _Atomic unsigned          countdown; // Lines until the next timed one
+    struct calc_stats_block * next;
+} calc_stats_block;
+
+extern _Thread_local calc_stats_block * calc_stats_self;
+
+calc_stats_block * calc_stats_attach(void);
+calc_stats_time    calc_stats_now(void);
+void               calc_stats_count_rows(calc_op  op,
+                                         uint64_t rows,
+                                         uint64_t failed);
+void               calc_stats_record(calc_stage stage, uint64_t nanoseconds);
+
+/******************************************************************************
+ * @brief    The calling thread's block, registered on first use
+ ******************************************************************************/
+static inline calc_stats_block * calc_stats_block_get(void)
+{
+    calc_stats_block * self = calc_stats_self;
+    return (NULL != self) ? self : calc_stats_attach();
+}
+
+/******************************************************************************
+ * @brief    Add to a counter only the calling thread writes
+ ******************************************************************************/
+static inline void calc_stats_add(_Atomic uint64_t * counter, uint64_t amount)
+{
+    atomic_store_explicit(
+        counter,
+        atomic_load_explicit(counter, memory_order_relaxed) + amount,
+        memory_order_relaxed);
+}
+
+/******************************************************************************
+ * @brief    Count one evaluation and, if it failed, its status
+ ******************************************************************************/
+static inline void calc_stats_count(calc_op op, calc_status status)
+{
+    calc_stats_block * self = calc_stats_block_get();
+
+    calc_stats_add(&self->ops[(unsigned)op < CALC_OP_COUNT ? op : 0], 1);
+    if (CALC_OK != status)
+    {
+        calc_stats_add(
+            &self->errors[(unsigned)status < CALC_STATUS_COUNT ? status : 0],
+            1);
+    }
+}
+
+/******************************************************************************
+ * @brief    Count a line that was answered with an error before evaluation
+ ******************************************************************************/
+static inline void calc_stats_reject(void)
+{
+    calc_stats_add(&calc_stats_block_get()->rejected, 1);
+}
+
+/******************************************************************************
+ * @brief    Start timing a line, if it is the one in CALC_STATS_SAMPLE
+ * @return   The time now, or 0 if the line is not timed
+ ******************************************************************************/
+static inline calc_stats_time calc_stats_start(void)
+{
+    calc_stats_block * self = calc_stats_block_get();
+    unsigned           left =
+        atomic_load_explicit(&self->countdown, memory_order_relaxed);
+
+    if (0 != left)
+    {
+        atomic_store_explicit(&self->countdown, left - 1, memory_order_relaxed);
+        return 0;
+    }
+    atomic_store_explicit(
+        &self->countdown, CALC_STATS_SAMPLE - 1, memory_order_relaxed);
+    return calc_stats_now();
+}
+
+/******************************************************************************
+ * @brief    End a stage of a timed line
+ * @param    since   Start of the stage, from calc_stats_start or the
+ *                   previous lap; 0 if the line is not timed
+ * @param    stage   Stage that ends now
+ * @return   Start of the next stage, or 0 if the line is not timed
+ ******************************************************************************/
+static inline calc_stats_time calc_stats_lap(calc_stats_time since,
+                                             calc_stage      stage)
+{
+    if (0 == since)
+    {
+        return 0;
+    }
+
+    calc_stats_time now = calc_stats_now();
+    calc_stats_record(stage, now - since);
+    return now;
+}
+
+#endif // CALC_NO_STATS
+
+#endif // CALC_STATS_H
@@ -0,0 +1,333 @@
+/******************************************************************************
+ * @file    calc_uring.c
+ * @brief   Minimal io_uring rings over the raw system calls
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Just enough of io_uring for batch and server I/O, without liburing: the
+ * rings are mapped once, SQEs are queued in user space and handed to the
+ * kernel in one io_uring_enter() together with the wait for completions.
+ * Every index shared with the kernel is read with acquire and written with
+ * release ordering.
+ *
+ * Kernels without io_uring, or with it disabled, fail calc_uring_init(),
+ * and callers fall back to plain system calls. Rings need a kernel that
+ * maps both rings at once, never drops completions and can read and write
+ * at the file position (Linux 5.6); provided buffer rings need Linux 5.19.
+ ******************************************************************************/
+
+#define _DEFAULT_SOURCE // syscall()
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_uring.h"
+
+#define URING_FEATURES \
+    (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS)
+
+/******************************************************************************
+ * @brief    Address of a ring field at an offset the kernel reported
+ ******************************************************************************/
+static unsigned * ring_field(const calc_uring * ring, uint32_t offset)
+{
+    return (unsigned *)((char *)ring->ring_map + offset);
+}
+
+/******************************************************************************
+ * @brief    Set up a ring
+ * @param    ring    Ring to initialise; calc_uring_exit releases it either way
+ * @param    entries Submission queue size, rounded up by the kernel
+ * @return   1 if successful, 0 if io_uring is unavailable
+ ******************************************************************************/
+int calc_uring_init(calc_uring * ring, unsigned entries)
+{
+    struct io_uring_params params;
+
+    memset(ring, 0, sizeof(*ring));
+    memset(&params, 0, sizeof(params));
+    ring->ring_map = MAP_FAILED;
+    ring->sqes     = MAP_FAILED;
+    ring->fd       = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0 || URING_FEATURES != (params.features & URING_FEATURES))
+    {
+        return 0;
+    }
+
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ring_size = (sq_size > cq_size) ? sq_size : cq_size;
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->ring_map  = mmap(NULL,
+                          ring->ring_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          ring->fd,
+                          IORING_OFF_SQ_RING);
+    ring->sqes      = mmap(NULL,
+                      ring->sqes_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      ring->fd,
+                      IORING_OFF_SQES);
+    if (MAP_FAILED == ring->ring_map || MAP_FAILED == ring->sqes)
+    {
+        return 0;
+    }
+
+    ring->sq_head    = ring_field(ring, params.sq_off.head);
+    ring->sq_tail    = ring_field(ring, params.sq_off.tail);
+    ring->sq_mask    = *ring_field(ring, params.sq_off.ring_mask);
+    ring->sq_entries = params.sq_entries;
+    ring->sq_queued  = *ring->sq_tail;
+    ring->cq_head    = ring_field(ring, params.cq_off.head);
+    ring->cq_tail    = ring_field(ring, params.cq_off.tail);
+    ring->cq_mask    = *ring_field(ring, params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)ring_field(ring, params.cq_off.cqes);
+
+    // Slot i of the submission queue always holds SQE i
+    unsigned * array = ring_field(ring, params.sq_off.array);
+    for (unsigned i = 0; i < params.sq_entries; i++)
+    {
+        array[i] = i;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Release a ring; outstanding requests are cancelled
+ ******************************************************************************/
+void calc_uring_exit(calc_uring * ring)
+{
+    if (ring->fd >= 0)
+    {
+        close(ring->fd);
+        ring->fd = -1;
+    }
+    if (MAP_FAILED != ring->sqes && NULL != ring->sqes)
+    {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (MAP_FAILED != ring->ring_map && NULL != ring->ring_map)
+    {
+        munmap(ring->ring_map, ring->ring_size);
+    }
+    if (NULL != ring->buffers)
+    {
+        munmap(ring->buffers, ring->buffers_size);
+    }
+    free(ring->buffer_data);
+    ring->sqes        = NULL;
+    ring->ring_map    = NULL;
+    ring->buffers     = NULL;
+    ring->buffer_data = NULL;
+}
+
+/******************************************************************************
+ * @brief    Queue a cleared SQE, submitted by the next calc_uring_submit
+ * @return   SQE to fill in, or NULL if the submission queue is full
+ ******************************************************************************/
+struct io_uring_sqe * calc_uring_sqe(calc_uring * ring)
+{
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (ring->sq_queued - head >= ring->sq_entries)
+    {
+        return NULL;
+    }
+    struct io_uring_sqe * sqe = &ring->sqes[ring->sq_queued & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_queued++;
+    return sqe;
+}
+
+/******************************************************************************
+ * @brief    Submit every queued SQE and optionally wait for completions, in
+ *           one system call
+ * @param    ring    Ring
+ * @param    wait    Completions to wait for; 0 only submits
+ * @return   0 if successful, or a negative errno such as -EINTR
+ ******************************************************************************/
+int calc_uring_submit(calc_uring * ring, unsigned wait)
+{
+    __atomic_store_n(ring->sq_tail, ring->sq_queued, __ATOMIC_RELEASE);
+
+    unsigned pending =
+        ring->sq_queued - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (0 == pending && 0 == wait)
+    {
+        return 0;
+    }
+    long entered = syscall(__NR_io_uring_enter,
+                           ring->fd,
+                           pending,
+                           wait,
+                           (0 != wait) ? IORING_ENTER_GETEVENTS : 0,
+                           NULL,
+                           0);
+    return (entered < 0) ? -errno : 0;
+}
+
+/******************************************************************************
+ * @brief    Oldest unseen completion
+ * @return   Completion, valid until calc_uring_seen, or NULL if none is ready
+ ******************************************************************************/
+struct io_uring_cqe * calc_uring_peek(calc_uring * ring)
+{
+    unsigned head = *ring->cq_head;
+
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE))
+    {
+        return NULL;
+    }
+    return &ring->cqes[head & ring->cq_mask];
+}
+
+/******************************************************************************
+ * @brief    Wait for the oldest unseen completion, submitting queued SQEs
+ * @return   Completion, valid until calc_uring_seen, or NULL on error
+ ******************************************************************************/
+struct io_uring_cqe * calc_uring_wait(calc_uring * ring)
+{
+    for (;;)
+    {
+        struct io_uring_cqe * cqe = calc_uring_peek(ring);
+        if (NULL != cqe)
+        {
+            return cqe;
+        }
+        int status = calc_uring_submit(ring, 1);
+        if (0 != status && -EINTR != status)
+        {
+            return NULL;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Hand the oldest completion's slot back to the kernel
+ ******************************************************************************/
+void calc_uring_seen(calc_uring * ring)
+{
+    __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************
+ * @brief    Register buffers for IORING_OP_READ_FIXED and WRITE_FIXED; the
+ *           index of each in buffers is its buf_index
+ * @return   1 if successful, 0 otherwise (for example over RLIMIT_MEMLOCK)
+ ******************************************************************************/
+int calc_uring_register_buffers(calc_uring *         ring,
+                                const struct iovec * buffers,
+                                unsigned             count)
+{
+    return 0 == syscall(__NR_io_uring_register,
+                        ring->fd,
+                        IORING_REGISTER_BUFFERS,
+                        buffers,
+                        count);
+}
+
+/******************************************************************************
+ * @brief    Give the kernel a ring of receive buffers to pick from, as
+ *           buffer group CALC_URING_BUFFER_GROUP
+ * @param    ring    Ring
+ * @param    count   Buffers, a power of two up to 32768
+ * @param    size    Bytes in each buffer
+ * @return   1 if successful, 0 if out of memory or unsupported
+ ******************************************************************************/
+int calc_uring_provide_buffers(calc_uring * ring, unsigned count, size_t size)
+{
+    struct io_uring_buf_reg registration;
+
+    // The ring itself must be page aligned
+    ring->buffers_size = count * sizeof(struct io_uring_buf);
+    ring->buffers      = mmap(NULL,
+                         ring->buffers_size,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1,
+                         0);
+    ring->buffer_data  = malloc(count * size);
+    if (MAP_FAILED == ring->buffers)
+    {
+        ring->buffers = NULL;
+        return 0;
+    }
+    if (NULL == ring->buffer_data)
+    {
+        return 0;
+    }
+
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr    = (uint64_t)(uintptr_t)ring->buffers;
+    registration.ring_entries = count;
+    registration.bgid         = CALC_URING_BUFFER_GROUP;
+    if (0 != syscall(__NR_io_uring_register,
+                     ring->fd,
+                     IORING_REGISTER_PBUF_RING,
+                     &registration,
+                     1))
+    {
+        return 0;
+    }
+
+    ring->buffer_size  = size;
+    ring->buffer_count = count;
+    for (unsigned id = 0; id < count; id++)
+    {
+        calc_uring_recycle(ring, id);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Data of a provided buffer the kernel picked
+ * @param    ring    Ring
+ * @param    id      Buffer ID, cqe->flags >> IORING_CQE_BUFFER_SHIFT
+ ******************************************************************************/
+const char * calc_uring_buffer(const calc_uring * ring, unsigned id)
+{
+    return ring->buffer_data + (size_t)id * ring->buffer_size;
+}
+
+/******************************************************************************
+ * @brief    Return a provided buffer for the kernel to fill again
+ ******************************************************************************/
+void calc_uring_recycle(calc_uring * ring, unsigned id)
+{
+    struct io_uring_buf * buffer =
+        &ring->buffers->bufs[ring->buffer_tail & (ring->buffer_count - 1)];
+
+    buffer->addr = (uint64_t)(uintptr_t)calc_uring_buffer(ring, id);
+    buffer->len  = (uint32_t)ring->buffer_size;
+    buffer->bid  = (uint16_t)id;
+    ring->buffer_tail++;
+    __atomic_store_n(
+        &ring->buffers->tail, (uint16_t)ring->buffer_tail, __ATOMIC_RELEASE);
+}
+
+/******************************************************************************
+ * @brief    Whether an I/O backend works here, rather than falling back
+ * @param    io  Backend
+ * @return   1 if batch and server mode can use it, 0 otherwise
+ ******************************************************************************/
+int calc_io_supported(calc_io io)
+{
+    calc_uring ring;
+
+    if (CALC_IO_URING != io)
+    {
+        return CALC_IO_POSIX == io;
+    }
+    int supported =
+        calc_uring_init(&ring, 2) && calc_uring_provide_buffers(&ring, 1, 64);
+    calc_uring_exit(&ring);
+    return supported;
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * @file    calc_uring.h
+ * @brief   Minimal io_uring rings over the raw system calls (internal)
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#ifndef CALC_URING_H
+#define CALC_URING_H
+
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <sys/uio.h>
+
+// Buffer group of the provided buffers, see calc_uring_provide_buffers
+#define CALC_URING_BUFFER_GROUP 0
+
+/******************************************************************************
+ * @brief    Submission and completion rings shared with the kernel, plus an
+ *           optional ring of provided receive buffers
+ ******************************************************************************/
+typedef struct
+{
+    int                        fd;
+    unsigned *                 sq_head;
+    unsigned *                 sq_tail;
+    unsigned                   sq_mask;
+    unsigned                   sq_entries;
+    unsigned                   sq_queued; // Tail including unsubmitted SQEs
+    struct io_uring_sqe *      sqes;
+    unsigned *                 cq_head;
+    unsigned *                 cq_tail;
+    unsigned                   cq_mask;
+    struct io_uring_cqe *      cqes;
+    void *                     ring_map;
+    size_t                     ring_size;
+    size_t                     sqes_size;
+    struct io_uring_buf_ring * buffers;
+    size_t                     buffers_size;
+    char *                     buffer_data;
+    size_t                     buffer_size;
+    unsigned                   buffer_count;
+    unsigned                   buffer_tail;
+} calc_uring;
+
+int                   calc_uring_init(calc_uring * ring, unsigned entries);
+void                  calc_uring_exit(calc_uring * ring);
+struct io_uring_sqe * calc_uring_sqe(calc_uring * ring);
+int                   calc_uring_submit(calc_uring * ring, unsigned wait);
+struct io_uring_cqe * calc_uring_peek(calc_uring * ring);
+struct io_uring_cqe * calc_uring_wait(calc_uring * ring);
+void                  calc_uring_seen(calc_uring * ring);
+int                   calc_uring_register_buffers(calc_uring *         ring,
+                                                  const struct iovec * buffers,
+                                                  unsigned             count);
+int                   calc_uring_provide_buffers(calc_uring * ring,
+                                                 unsigned     count,
+                                                 size_t       size);
+const char *          calc_uring_buffer(const calc_uring * ring, unsigned id);
+void                  calc_uring_recycle(calc_uring * ring, unsigned id);
+
+#endif // CALC_URING_H
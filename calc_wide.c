@@ -0,0 +1,217 @@
+/******************************************************************************
+ * @file    calc_wide.c
+ * @brief   Calculations on 32, 64 and 128-bit operands
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Operands travel as 128-bit bit patterns and are cut to the width first,
+ * so "-1" parsed at 64 bits is all ones in the low 64 bits only. Every
+ * operator keeps its 32-bit semantics at the wider width: signed + - * and
+ * % fail on overflow or a zero divisor, shifts by the width or more yield
+ * 0, and rotates take the count modulo the width.
+ *
+ * Division cannot go through a double once operands pass 2^53, so the
+ * quotient is kept exact: a whole part and two decimals rounded half to
+ * even, as CALC_DIV_FIXED prints it. At 32 bits that can differ from
+ * calc_execute's double on a tie: 5 / 1000 is 0.00 exactly, but the double
+ * nearest 0.005 lies just above it and prints as 0.01.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include "calc.h"
+#include "calc_width.h"
+
+#define WIDE_DECIMAL    10
+#define WIDE_HUNDREDTHS 100 // In one
+
+/******************************************************************************
+ * @brief    Operand width in bits, 0 for CALC_WIDTH_BIG
+ ******************************************************************************/
+unsigned calc_width_bits(calc_width width)
+{
+    switch (width)
+    {
+        case CALC_WIDTH_64:
+            return 64;
+        case CALC_WIDTH_128:
+            return 128;
+        case CALC_WIDTH_BIG:
+            return 0;
+        default:
+            return 32;
+    }
+}
+
+/******************************************************************************
+ * @brief    Magnitude of a signed value, which fits even for the minimum
+ ******************************************************************************/
+static calc_uint128 magnitude(calc_int128 value)
+{
+    return (value < 0) ? 0 - (calc_uint128)value : (calc_uint128)value;
+}
+
+/******************************************************************************
+ * @brief    Next decimal of remainder / divisor, where remainder < divisor
+ *
+ * Ten times the remainder can overflow, so it is built up by repeated
+ * addition, each step reduced modulo divisor; divisor is at most 2^127, so
+ * the sum of two reduced values always fits.
+ ******************************************************************************/
+static unsigned next_decimal(calc_uint128 * remainder, calc_uint128 divisor)
+{
+    calc_uint128 sum   = 0;
+    unsigned     digit = 0;
+
+    for (unsigned i = 0; i < WIDE_DECIMAL; i++)
+    {
+        sum += *remainder;
+        if (sum >= divisor)
+        {
+            sum -= divisor;
+            digit++;
+        }
+    }
+    *remainder = sum;
+    return digit;
+}
+
+/******************************************************************************
+ * @brief    Exact quotient to the hundredth, rounded half to even
+ * @param    dividend    Dividend, sign extended from the width
+ * @param    divisor     Divisor, sign extended from the width
+ * @param    result      Quotient
+ ******************************************************************************/
+static void divide(calc_int128        dividend,
+                   calc_int128        divisor,
+                   calc_wide_result * result)
+{
+    if (0 == divisor)
+    {
+        result->status = CALC_ERR_DIV_BY_ZERO;
+        return;
+    }
+
+    calc_uint128 top       = magnitude(dividend);
+    calc_uint128 bottom    = magnitude(divisor);
+    calc_uint128 whole     = top / bottom;
+    calc_uint128 remainder = top % bottom;
+    unsigned     tenths    = next_decimal(&remainder, bottom);
+    unsigned     hundredths =
+        (tenths * WIDE_DECIMAL) + next_decimal(&remainder, bottom);
+
+    // What is left is below one hundredth: compare it with half of one
+    if (remainder > bottom - remainder ||
+        (remainder == bottom - remainder && 0 != (hundredths & 1)))
+    {
+        hundredths++;
+    }
+    if (WIDE_HUNDREDTHS == hundredths)
+    {
+        whole++;
+        hundredths = 0;
+    }
+
+    // As for a double, the sign survives a quotient that rounds to zero
+    result->value      = whole;
+    result->hundredths = (uint8_t)hundredths;
+    result->negative   = (dividend < 0) != (divisor < 0);
+}
+
+// One evaluator per width: cut the operands to it, then sign or zero
+// extend the result back to 128 bits according to the operator's kind
+#define EXECUTE_WIDTH(bits, stype, utype)                                  \
+    static void execute_##bits(calc_op            op,                      \
+                               utype              x,                       \
+                               utype              y,                       \
+                               calc_wide_result * result)                  \
+    {                                                                      \
+        stype value   = 0;                                                 \
+        utype pattern = 0;                                                 \
+                                                                           \
+        switch (op)                                                        \
+        {                                                                  \
+            case CALC_OP_ADD:                                              \
+                result->status = width_add_##bits(                         \
+                    (stype)x, (stype)y, &value);                           \
+                break;                                                     \
+            case CALC_OP_SUB:                                              \
+                result->status = width_sub_##bits(                         \
+                    (stype)x, (stype)y, &value);                           \
+                break;                                                     \
+            case CALC_OP_MUL:                                              \
+                result->status = width_mul_##bits(                         \
+                    (stype)x, (stype)y, &value);                           \
+                break;                                                     \
+            case CALC_OP_MOD:                                              \
+                result->status = width_mod_##bits(                         \
+                    (stype)x, (stype)y, &value);                           \
+                break;                                                     \
+            case CALC_OP_DIV:                                              \
+                divide((stype)x, (stype)y, result);                        \
+                return;                                                    \
+            case CALC_OP_SHL:                                              \
+                pattern = width_shl_##bits(x, y);                          \
+                break;                                                     \
+            case CALC_OP_SHR:                                              \
+                pattern = width_shr_##bits(x, y);                          \
+                break;                                                     \
+            case CALC_OP_AND:                                              \
+                pattern = width_and_##bits(x, y);                          \
+                break;                                                     \
+            case CALC_OP_OR:                                               \
+                pattern = width_or_##bits(x, y);                           \
+                break;                                                     \
+            case CALC_OP_XOR:                                              \
+                pattern = width_xor_##bits(x, y);                          \
+                break;                                                     \
+            case CALC_OP_ROL:                                              \
+                pattern = width_rol_##bits(x, y);                          \
+                break;                                                     \
+            case CALC_OP_ROR:                                              \
+                pattern = width_ror_##bits(x, y);                          \
+                break;                                                     \
+            default:                                                       \
+                result->status = CALC_ERR_UNSUPPORTED_OPERATOR;            \
+                return;                                                    \
+        }                                                                  \
+        result->value = (CALC_KIND_INT == result->kind)                    \
+                            ? (calc_uint128)(calc_int128)value             \
+                            : (calc_uint128)pattern;                       \
+    }
+
+EXECUTE_WIDTH(32, int32_t, uint32_t)
+EXECUTE_WIDTH(64, int64_t, uint64_t)
+EXECUTE_WIDTH(128, calc_int128, calc_uint128)
+
+/******************************************************************************
+ * @brief    Execute a decoded operator at a given width
+ * @param    width       Operand width
+ * @param    op          Opcode from calc_parse_operator
+ * @param    operand1    First operand; bits above the width are ignored
+ * @param    operand2    Second operand; bits above the width are ignored
+ * @return   Result of the calculation, with its status and kind
+ ******************************************************************************/
+calc_wide_result calc_execute_wide(calc_width   width,
+                                   calc_op      op,
+                                   calc_uint128 operand1,
+                                   calc_uint128 operand2)
+{
+    calc_wide_result result = { CALC_OK, calc_op_kind(op), 0, 0, 0 };
+
+    switch (width)
+    {
+        case CALC_WIDTH_64:
+            execute_64(op, (uint64_t)operand1, (uint64_t)operand2, &result);
+            break;
+        case CALC_WIDTH_128:
+            execute_128(op, operand1, operand2, &result);
+            break;
+        case CALC_WIDTH_BIG:
+            result.status = CALC_ERR_UNSUPPORTED_OPERATOR; // calc_big_execute
+            break;
+        default:
+            execute_32(op, (uint32_t)operand1, (uint32_t)operand2, &result);
+            break;
+    }
+    return result;
+}
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * @file    calc_width.h
+ * @brief   Operator kernels generated for each operand width (internal)
+ * @version 1.6
+ * @date    October 2026
+ *
+ * CALC_WIDTH_KERNELS stamps out the fallible and bit-counting operators for
+ * one signed/unsigned type pair, so 32, 64 and 128-bit operands share one
+ * definition of each operator. Overflow is detected with the compiler's
+ * checked arithmetic rather than by widening, which has nowhere to widen to
+ * at 128 bits. As in perform_*, a failed operator leaves *result alone.
+ *
+ * The _flagged forms are for bulk evaluation: they never branch, always
+ * store a result (the wrapped one on overflow, 0 for a zero divisor) and
+ * return 1 for a failed lane, which callers OR into an error mask and act
+ * on once per block rather than once per lane.
+ ******************************************************************************/
+
+#ifndef CALC_WIDTH_H
+#define CALC_WIDTH_H
+
+#include <stdint.h>
+#include "calc.h"
+
+#define CALC_WIDTH_CHECKED(bits, name, stype, builtin, error)             \
+    static inline calc_status width_##name##_##bits(                      \
+        stype operand1, stype operand2, stype * result)                   \
+    {                                                                     \
+        stype value;                                                      \
+        if (builtin(operand1, operand2, &value))                          \
+        {                                                                 \
+            return error;                                                 \
+        }                                                                 \
+        *result = value;                                                  \
+        return CALC_OK;                                                   \
+    }
+
+#define CALC_WIDTH_FLAGGED(bits, name, stype, builtin)                    \
+    static inline unsigned width_##name##_##bits##_flagged(               \
+        stype operand1, stype operand2, stype * result)                   \
+    {                                                                     \
+        return (unsigned)builtin(operand1, operand2, result);             \
+    }
+
+#define CALC_WIDTH_KERNELS(bits, stype, utype)                            \
+    CALC_WIDTH_CHECKED(                                                   \
+        bits, add, stype, __builtin_add_overflow, CALC_ERR_ADD_OVERFLOW)  \
+    CALC_WIDTH_CHECKED(                                                   \
+        bits, sub, stype, __builtin_sub_overflow, CALC_ERR_SUB_OVERFLOW)  \
+    CALC_WIDTH_CHECKED(                                                   \
+        bits, mul, stype, __builtin_mul_overflow, CALC_ERR_MUL_OVERFLOW)  \
+    CALC_WIDTH_FLAGGED(bits, add, stype, __builtin_add_overflow)          \
+    CALC_WIDTH_FLAGGED(bits, sub, stype, __builtin_sub_overflow)          \
+    CALC_WIDTH_FLAGGED(bits, mul, stype, __builtin_mul_overflow)          \
+                                                                          \
+    /* The minimum % -1 traps on most targets, though the result is 0 */  \
+    static inline calc_status width_mod_##bits(                           \
+        stype operand1, stype operand2, stype * result)                   \
+    {                                                                     \
+        if (0 == operand2)                                                \
+        {                                                                 \
+            return CALC_ERR_MOD_BY_ZERO;                                  \
+        }                                                                 \
+        *result = (-1 == operand2) ? 0 : operand1 % operand2;             \
+        return CALC_OK;                                                   \
+    }                                                                     \
+                                                                          \
+    /* 0 and -1 divide as 1: -1 gives 0 anyway, and 0 is flagged */     \
+    static inline unsigned width_mod_##bits##_flagged(                    \
+        stype operand1, stype operand2, stype * result)                   \
+    {                                                                     \
+        unsigned zero = (0 == operand2);                                  \
+        stype    safe = (zero || -1 == operand2) ? 1 : operand2;          \
+        *result       = operand1 % safe;                                  \
+        return zero;                                                      \
+    }                                                                     \
+                                                                          \
+    static inline utype width_and_##bits(utype value, utype mask)         \
+    {                                                                     \
+        return value & mask;                                              \
+    }                                                                     \
+                                                                          \
+    static inline utype width_or_##bits(utype value, utype mask)          \
+    {                                                                     \
+        return value | mask;                                              \
+    }                                                                     \
+                                                                          \
+    static inline utype width_xor_##bits(utype value, utype mask)         \
+    {                                                                     \
+        return value ^ mask;                                              \
+    }                                                                     \
+                                                                          \
+    /* Shifting by the width or more yields 0 */                          \
+    static inline utype width_shl_##bits(utype value, utype count)        \
+    {                                                                     \
+        return (count < (bits)) ? (utype)(value << count) : 0;            \
+    }                                                                     \
+                                                                          \
+    static inline utype width_shr_##bits(utype value, utype count)        \
+    {                                                                     \
+        return (count < (bits)) ? (utype)(value >> count) : 0;            \
+    }                                                                     \
+                                                                          \
+    /* Rotates take the count modulo the width, and reduce the           \
+       complementary count too so a count of 0 never shifts by it */      \
+    static inline utype width_rol_##bits(utype value, utype count)        \
+    {                                                                     \
+        unsigned shift = (unsigned)(count % (bits));                      \
+        return (utype)(value << shift) |                                  \
+               (utype)(value >> (((bits) - shift) % (bits)));             \
+    }                                                                     \
+                                                                          \
+    static inline utype width_ror_##bits(utype value, utype count)        \
+    {                                                                     \
+        unsigned shift = (unsigned)(count % (bits));                      \
+        return (utype)(value >> shift) |                                  \
+               (utype)(value << (((bits) - shift) % (bits)));             \
+    }
+
+CALC_WIDTH_KERNELS(32, int32_t, uint32_t)
+CALC_WIDTH_KERNELS(64, int64_t, uint64_t)
+CALC_WIDTH_KERNELS(128, calc_int128, calc_uint128)
+
+#endif // CALC_WIDTH_H
@@ -0,0 +1,151 @@
+/******************************************************************************
+ * @file    client_check.cpp
+ * @brief   Check of calc_client.hpp against a server in the same process
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Serves a Unix socket on a second thread and awaits answers from it in
+ * coroutines, as a C++20 service would. Several are suspended on the one
+ * client at once, so their answers arrive together, and each processes the
+ * client again from inside its own resumption before awaiting a division
+ * by zero, answered as the server's error. Built and run by make (see
+ * Makefile), so the header keeps compiling as C++20 and the client keeps
+ * answering; exits with EXIT_FAILURE otherwise.
+ ******************************************************************************/
+
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <unistd.h>
+#include "calc.h"
+#include "calc_client.hpp"
+
+#define CHECK_WAIT_MS 100 // Each wait for answers
+#define CHECK_WAITS   50  // Waits before the server is taken to have hung
+#define CHECK_TASKS   8   // Coroutines suspended on the client together
+
+namespace
+{
+
+/******************************************************************************
+ * @brief    A coroutine that starts at once and frees itself when done
+ ******************************************************************************/
+struct task
+{
+    struct promise_type
+    {
+        task get_return_object() noexcept
+        {
+            return task();
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::abort();
+        }
+    };
+};
+
+/******************************************************************************
+ * @brief    Whether an answer is the expected result
+ ******************************************************************************/
+bool answered(const calc_client_answer & answer,
+              calc_status                status,
+              uint32_t                   value)
+{
+    return CALC_CLIENT_OK == answer.status &&
+           status == answer.result.status &&
+           (CALC_OK != status || value == answer.result.value.as_uint);
+}
+
+/******************************************************************************
+ * @brief    Await two requests in turn, counting those answered as expected
+ * @param    client  Connection to the server
+ * @param    index   Which coroutine this is, its first operand
+ * @param    passed  Incremented by each answer as expected
+ * @param    done    Incremented once the last answer is in
+ ******************************************************************************/
+task run(calc::client & client, uint32_t index, int & passed, int & done)
+{
+    calc_client_answer answer = co_await client.eval("+", index, 1);
+    passed += answered(answer, CALC_OK, index + 1);
+
+    // Resumed from process(): processing again, with the answers of the
+    // others still to take, must neither lose nor misplace any of them
+    client.process();
+    answer = co_await client.eval("/", index, 0);
+    passed += answered(answer, CALC_ERR_DIV_BY_ZERO, 0);
+    done++;
+}
+
+} // namespace
+
+int main(void)
+{
+    char          path[64];
+    calc_server * server = nullptr;
+    int           passed = 0;
+    int           done   = 0;
+
+    std::snprintf(
+        path, sizeof(path), "/tmp/calc-client-check-%ld.sock", (long)getpid());
+    if (CALC_SERVER_OK !=
+        calc_server_create(path, nullptr, 0, CALC_IO_POSIX, &server))
+    {
+        std::fprintf(stderr, "Error! Unable to serve %s.\n", path);
+        return EXIT_FAILURE;
+    }
+
+    calc_batch_counts counts  = {};
+    std::thread       serving = std::thread(
+        [server, &counts]() { calc_server_run(server, &counts); });
+    {
+        calc::client client(path);
+
+        if (CALC_CLIENT_OK == client.status())
+        {
+            for (uint32_t i = 0; i < CHECK_TASKS; i++)
+            {
+                run(client, i, passed, done);
+            }
+            for (int i = 0; CHECK_TASKS != done && i < CHECK_WAITS; i++)
+            {
+                if (CALC_CLIENT_OK != client.wait(CHECK_WAIT_MS))
+                {
+                    break;
+                }
+            }
+        }
+    }
+    calc_server_stop(server);
+    serving.join();
+    calc_server_destroy(server);
+    unlink(path);
+
+    if (CHECK_TASKS != done || 2 * CHECK_TASKS != passed)
+    {
+        std::fprintf(stderr,
+                     "Error! calc_client.hpp: %d of %d answers as expected.\n",
+                     passed,
+                     2 * CHECK_TASKS);
+        return EXIT_FAILURE;
+    }
+    std::printf("calc-client-check: %d answers as expected\n",
+                2 * CHECK_TASKS);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,2312 @@
+/******************************************************************************
+ * @file    fuzz.c
+ * @brief   Differential fuzzing of every evaluation path against perform_*
+ * @version 1.6
+ * @date    October 2026
+ *
+ * Streams of operand pairs, random ones of random magnitude and adversarial
+ * ones built from edge values (0, 1, 31, 32, 33, INT32_MIN, -1 and so on,
+ * every pair of them, shift counts past the width, divisors around zero,
+ * and a second operand shared by every row), are run under each operator
+ * through the reference, direct calls of the perform_* functions, and
+ * through every engine that evaluates the same operator:
+ *
+ * - calc_execute and perform_calculation, the scalar dispatch;
+ * - calc_apply_isa on each instruction set the machine has, over the whole
+ *   array and again cut into pieces of every length at odd offsets, so
+ *   vector tails and unaligned loads are covered, and calc_apply itself;
+ * - calc_apply_const and calc_const.h's kernels inlined with literals,
+ *   for the streams whose second operand is shared;
+ * - calc_execute_wide at 32 bits, which must agree exactly, and at 64 and
+ *   128 bits, calc_apply64_isa and calc_big_execute on the operands sign
+ *   extended, which must agree wherever their semantics coincide (a result
+ *   fits in 32 bits exactly when the 32-bit operator does not overflow);
+ * - compiled expressions interpreted, over arrays and columns of bindings,
+ *   JIT compiled, with the second operand as a literal, and with both,
+ *   folded to a constant;
+ * - binary requests and text batch lines, with and without a result cache,
+ *   whose output is compared byte for byte with the reference formatted by
+ *   printf;
+ * - reductions of each stream on each instruction set and thread count,
+ *   and of every short prefix of it, against a fold of the values;
+ * - calc_format_division in every --div mode, against known lines and, on
+ *   each stream, for a zero quotient printed with a sign.
+ *
+ * Last, a threaded batch run is made to fail to place its slot buffers, by
+ * the allocator (realloc is wrapped at link time, see Makefile) refusing
+ * them, and must return CALC_BATCH_NO_MEMORY, neither hanging nor leaving a
+ * thread behind.
+ *
+ * Results and error statuses are compared row by row, and the status an
+ * array call returns with them. The time each engine takes on the random
+ * stream is reported alongside, so the same run shows what each path costs.
+ * Any divergence makes the run fail, and with it the build (see Makefile);
+ * --seed repeats a run, which prints its seed.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "calc.h"
+#include "calc_const.h"
+
+#define FUZZ_ROWS          100003 // Rows of the random stream, the timed one
+#define FUZZ_SHARED_ROWS   1031   // Rows of each shared operand stream
+#define FUZZ_MIXED_ROWS    4099   // Rows of the other adversarial streams
+#define FUZZ_PIECE_MAX     67     // Longest piece of an array cut into calls
+#define FUZZ_PIECE_STRIDE  37     // Prime, so piece lengths cycle through all
+#define FUZZ_FOLD_ROWS     1100   // Most rows compiled one by one as literals
+#define FUZZ_SHIFT_MAX     72     // Shift counts go past both 32 and 64
+#define FUZZ_DIVISOR_RANGE 4      // Divisors from -4 to 4
+#define FUZZ_CACHE_ENTRIES 4096
+#define FUZZ_ARENA_BLOCK   (64 * 1024)
+#define FUZZ_REPORT        5 // Divergences printed per engine
+#define FUZZ_TALLIES       64
+#define FUZZ_NAME_MAX      48
+#define FUZZ_TEXT_MAX      96
+#define FUZZ_FIXED_STREAMS 5 // Before the one per shared edge
+#define FUZZ_STREAMS_MAX   48
+#define FUZZ_DEFAULT_SEED  1
+#define FUZZ_FAULT_SIZE    (512 * 1024) // Smallest reallocation refused:
+                                        // a batch slot's output buffer
+#define FUZZ_FAULT_LINES   1000
+#define FUZZ_FAULT_SECONDS 10 // A run that takes longer has hung
+
+/******************************************************************************
+ * @brief    Operand pairs every engine is run over
+ ******************************************************************************/
+typedef struct
+{
+    char       name[FUZZ_NAME_MAX];
+    uint32_t * operand1;
+    uint32_t * operand2;
+    size_t     count;
+    int        shared; // operand2 is the same on every row
+    int        timed;  // Throughput is recorded on this stream
+} fuzz_stream;
+
+/******************************************************************************
+ * @brief    What one engine compared, found and took
+ ******************************************************************************/
+typedef struct
+{
+    char     name[FUZZ_NAME_MAX];
+    uint64_t rows;        // Rows compared
+    uint64_t divergences; // Rows, or calls, that disagreed
+    uint64_t timed_rows;  // Rows of the timed stream
+    double   seconds;     // Time spent on them
+} fuzz_tally;
+
+typedef int (*fuzz_literal_fn)(calc_op          op,
+                               const uint32_t * operand1,
+                               uint32_t *       result,
+                               uint8_t *        error_mask,
+                               size_t           count);
+
+/******************************************************************************
+ * @brief    One operator over one stream, with the reference results and
+ *           the scratch the engines evaluate into
+ ******************************************************************************/
+typedef struct
+{
+    calc_op             op;
+    const char *        symbol;
+    calc_isa            isa;    // For the engines run per instruction set
+    int                 pieces; // Cut array calls into pieces
+    const fuzz_stream * stream;
+    calc_result *       expected;
+    calc_result *       actual;
+    calc_buffer         expected_text; // Reference output of the lines
+    calc_buffer         lines;         // The stream as batch lines
+    calc_buffer         output;        // Batch output or binary response
+    calc_buffer         request;       // Binary request
+    uint32_t *          result;
+    double *            quotients;
+    uint64_t *          wide1;
+    uint64_t *          wide2;
+    uint64_t *          wide_result;
+    uint8_t *           error_mask;
+    uint32_t *          bindings; // Two per row
+    calc_cache *        cache;
+    calc_arena *        arena;
+    fuzz_literal_fn     literal;
+    int                 returned_wrong; // A call returned the wrong status
+} fuzz_case;
+
+typedef int (*fuzz_fn)(fuzz_case * run);
+typedef calc_status (*fuzz_array_fn)(fuzz_case * run,
+                                     size_t      start,
+                                     size_t      count);
+
+typedef struct
+{
+    const char * name;
+    fuzz_fn      fn;      // 0 if the engine does not apply, 1 once run
+    int          per_isa; // Run once per supported instruction set
+    int          pieces;  // Cut array calls into pieces
+    int          text;    // Writes batch output rather than results
+} fuzz_engine;
+
+typedef struct
+{
+    const char * symbol;
+    calc_op      op;
+} fuzz_operator;
+
+/******************************************************************************
+ * @brief    Whole run: tallies by engine, in the order first seen
+ ******************************************************************************/
+typedef struct
+{
+    fuzz_tally tallies[FUZZ_TALLIES];
+    size_t     tally_count;
+    uint64_t   divergences;
+} fuzz_state;
+
+static const fuzz_operator operators[] = {
+    { "+", CALC_OP_ADD },  { "-", CALC_OP_SUB },   { "*", CALC_OP_MUL },
+    { "/", CALC_OP_DIV },  { "%", CALC_OP_MOD },   { "<<", CALC_OP_SHL },
+    { ">>", CALC_OP_SHR }, { "&", CALC_OP_AND },   { "|", CALC_OP_OR },
+    { "^", CALC_OP_XOR },  { "<<<", CALC_OP_ROL }, { ">>>", CALC_OP_ROR },
+};
+
+#define OPERATOR_COUNT (sizeof(operators) / sizeof(operators[0]))
+
+// Where the operators change behaviour: shift and rotate counts around the
+// width, overflow bounds of each operator and bit patterns
+static const uint32_t edges[] = {
+    0u,          1u,          2u,          3u,          7u,
+    10u,         31u,         32u,         33u,         63u,
+    64u,         65u,         127u,        128u,        255u,
+    46340u,      46341u,      65535u,      65536u,      0x40000000u,
+    0x55555555u, 0x7FFFFFFEu, 0x7FFFFFFFu, 0x80000000u, 0x80000001u,
+    0xAAAAAAAAu, 0xC0000000u, 0xFFFF0000u, 0xFFFFFFFEu, 0xFFFFFFFFu,
+};
+
+#define EDGE_COUNT (sizeof(edges) / sizeof(edges[0]))
+
+// Every kernel of calc_const.h with its second operand written out, as a
+// caller that knows it when building would use it; division has none
+#define LITERAL_KERNELS(name, constant)                                    \
+    static int name(calc_op          op,                                   \
+                    const uint32_t * operand1,                             \
+                    uint32_t *       result,                               \
+                    uint8_t *        error_mask,                           \
+                    size_t           count)                                \
+    {                                                                      \
+        switch (op)                                                        \
+        {                                                                  \
+            case CALC_OP_ADD:                                              \
+                return const_add_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_SUB:                                              \
+                return const_sub_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_MUL:                                              \
+                return const_mul_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_MOD:                                              \
+                return const_mod_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_SHL:                                              \
+                return const_shl_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_SHR:                                              \
+                return const_shr_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_AND:                                              \
+                return const_and_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_OR:                                               \
+                return const_or_32(                                        \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_XOR:                                              \
+                return const_xor_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            case CALC_OP_ROL:                                              \
+                return const_rol_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+            default:                                                       \
+                return const_ror_32(                                       \
+                    operand1, constant, result, error_mask, count);        \
+        }                                                                  \
+    }
+
+LITERAL_KERNELS(literal_0, 0u)
+LITERAL_KERNELS(literal_1, 1u)
+LITERAL_KERNELS(literal_2, 2u)
+LITERAL_KERNELS(literal_7, 7u)
+LITERAL_KERNELS(literal_31, 31u)
+LITERAL_KERNELS(literal_32, 32u)
+LITERAL_KERNELS(literal_33, 33u)
+LITERAL_KERNELS(literal_int32_min, 0x80000000u)
+LITERAL_KERNELS(literal_all_ones, 0xFFFFFFFFu)
+
+static const struct
+{
+    uint32_t        value;
+    fuzz_literal_fn kernels;
+} literals[] = {
+    { 0u, literal_0 },
+    { 1u, literal_1 },
+    { 2u, literal_2 },
+    { 7u, literal_7 },
+    { 31u, literal_31 },
+    { 32u, literal_32 },
+    { 33u, literal_33 },
+    { 0x80000000u, literal_int32_min },
+    { 0xFFFFFFFFu, literal_all_ones },
+};
+
+/******************************************************************************
+ * @brief    Division lines whose every byte is known, around zero and ties
+ ******************************************************************************/
+static const struct
+{
+    int32_t         dividend;
+    int32_t         divisor;
+    calc_div_format format;
+    const char *    line;
+} division_lines[] = {
+    { 0, -5, { CALC_DIV_DOUBLE, 0 }, "Result: -0.00\n" }, // As %.2f prints
+    { 0, -5, { CALC_DIV_FIXED, 2 }, "Result: 0.00\n" },
+    { 0, -5, { CALC_DIV_FIXED, 0 }, "Result: 0\n" },
+    { 0, -5, { CALC_DIV_INTEGER, 0 }, "Result: 0\n" },
+    { 0, -5, { CALC_DIV_EXACT, 0 }, "Result: 0\n" },
+    { 0, -5, { CALC_DIV_SHORTEST, 0 }, "Result: 0\n" },
+    { -1, 1000, { CALC_DIV_FIXED, 2 }, "Result: 0.00\n" },
+    { -1, 1000, { CALC_DIV_FIXED, 3 }, "Result: -0.001\n" },
+    { -1, 200, { CALC_DIV_FIXED, 2 }, "Result: 0.00\n" }, // Ties to even
+    { -3, 200, { CALC_DIV_FIXED, 2 }, "Result: -0.02\n" },
+    { -1, 2, { CALC_DIV_FIXED, 0 }, "Result: 0\n" },
+    { -3, 2, { CALC_DIV_FIXED, 0 }, "Result: -2\n" },
+    { -1, 1000, { CALC_DIV_INTEGER, 0 }, "Result: 0\n" },
+    { -7, 2, { CALC_DIV_INTEGER, 0 }, "Result: -3\n" },
+    { -7, 2, { CALC_DIV_EXACT, 0 }, "Result: -7/2\n" },
+    { -1, 1000, { CALC_DIV_SHORTEST, 0 }, "Result: -0.001\n" },
+    { INT32_MIN, -1, { CALC_DIV_INTEGER, 0 }, "Result: 2147483648\n" },
+};
+
+// Modes whose zero quotient prints unsigned
+static const calc_div_format unsigned_zero_formats[] = {
+    { CALC_DIV_FIXED, 0 },   { CALC_DIV_FIXED, 2 },
+    { CALC_DIV_FIXED, CALC_DIV_DIGITS_MAX },
+    { CALC_DIV_INTEGER, 0 }, { CALC_DIV_EXACT, 0 },
+    { CALC_DIV_SHORTEST, 0 },
+};
+
+static uint64_t fuzz_seed = FUZZ_DEFAULT_SEED;
+
+// Reallocations of at least this many bytes fail while it is nonzero
+static size_t fuzz_fail_size;
+
+// Function Prototypes
+void *         __real_realloc(void * data, size_t size);
+void *         __wrap_realloc(void * data, size_t size);
+double         now_seconds(void);
+uint32_t       random_word(void);
+uint32_t       random_operand(void);
+calc_result    reference(calc_op op, uint32_t operand1, uint32_t operand2);
+calc_status    failure_status(calc_op op);
+int            narrowable(calc_op op);
+void           narrow(calc_op       op,
+                      int           fits,
+                      int64_t       value,
+                      calc_result * actual);
+int            same_result(const calc_result * expected,
+                           const calc_result * actual);
+void           describe(char * out, size_t size, const calc_result * result);
+size_t         reference_line(char *              out,
+                              size_t              size,
+                              const calc_result * result);
+void           collect_lanes(fuzz_case * run,
+                             size_t      start,
+                             size_t      count,
+                             calc_status returned);
+void           apply_in_pieces(fuzz_case * run, fuzz_array_fn call);
+calc_status    call_apply_isa(fuzz_case * run, size_t start, size_t count);
+calc_status    call_apply(fuzz_case * run, size_t start, size_t count);
+calc_status    call_apply_const(fuzz_case * run, size_t start, size_t count);
+calc_status    call_literal(fuzz_case * run, size_t start, size_t count);
+int            run_execute(fuzz_case * run);
+int            run_calculation(fuzz_case * run);
+int            run_apply_isa(fuzz_case * run);
+int            run_apply(fuzz_case * run);
+int            run_apply_const(fuzz_case * run);
+int            run_literal(fuzz_case * run);
+int            run_apply64(fuzz_case * run);
+int            run_wide(fuzz_case * run, calc_width width);
+int            run_wide32(fuzz_case * run);
+int            run_wide64(fuzz_case * run);
+int            run_wide128(fuzz_case * run);
+int            run_big(fuzz_case * run);
+calc_expr *    compile_expression(fuzz_case * run,
+                                  const char * operand2,
+                                  size_t *     index1,
+                                  size_t *     index2);
+void           bind_row(const fuzz_case * run,
+                        size_t            row,
+                        size_t            index1,
+                        size_t            index2,
+                        uint32_t *        bindings);
+void           eval_rows(fuzz_case * run,
+                         calc_expr * expr,
+                         size_t      index1,
+                         size_t      index2);
+void           eval_columns(fuzz_case * run,
+                            calc_expr * expr,
+                            size_t      index1,
+                            size_t      index2);
+int            run_expr(fuzz_case * run);
+int            run_expr_array(fuzz_case * run);
+int            run_expr_columns(fuzz_case * run);
+int            run_expr_jit(fuzz_case * run);
+int            run_expr_literal(fuzz_case * run);
+int            run_expr_literal_columns(fuzz_case * run);
+int            run_expr_folded(fuzz_case * run);
+int            run_binary(fuzz_case * run);
+int            run_batch(fuzz_case * run);
+int            run_batch_cache(fuzz_case * run);
+fuzz_tally *   find_tally(fuzz_state * state, const char * name);
+void           report(fuzz_state *       state,
+                      fuzz_tally *       tally,
+                      const fuzz_case *  run,
+                      size_t             row,
+                      const char *       expected,
+                      const char *       actual);
+void           compare_results(fuzz_state * state,
+                               fuzz_tally * tally,
+                               fuzz_case *  run);
+void           compare_lines(fuzz_state * state,
+                             fuzz_tally * tally,
+                             fuzz_case *  run);
+void           check_engine(fuzz_state *        state,
+                            const fuzz_engine * engine,
+                            const char *        name,
+                            fuzz_case *         run);
+int            prepare_case(fuzz_case * run);
+void           check_stream(fuzz_state * state, fuzz_case * run);
+calc_reduction reference_reduction(calc_reduce_op   op,
+                                   const uint32_t * values,
+                                   size_t           count,
+                                   int              wide);
+void           check_reduction(fuzz_state *     state,
+                               calc_isa         isa,
+                               calc_reduce_op   op,
+                               const uint32_t * values,
+                               size_t           count,
+                               unsigned         threads,
+                               int              wide,
+                               int              timed);
+void           check_reductions(fuzz_state * state, const fuzz_stream * stream);
+int            make_streams(fuzz_stream * streams, size_t * count, size_t rows);
+int            signed_zero(const char * line, size_t length);
+void           check_division_lines(fuzz_state * state);
+void           check_divisions(fuzz_state * state, const fuzz_stream * stream);
+size_t         thread_count(void);
+void           check_batch_fault(fuzz_state * state);
+void           print_tallies(const fuzz_state * state);
+
+static const fuzz_engine engines[] = {
+    { "execute", run_execute, 0, 0, 0 },
+    { "calculation", run_calculation, 0, 0, 0 },
+    { "apply", run_apply_isa, 1, 0, 0 },
+    { "apply/pieces", run_apply_isa, 1, 1, 0 },
+    { "apply/detect", run_apply, 0, 1, 0 },
+    { "apply_const", run_apply_const, 0, 1, 0 },
+    { "const/literal", run_literal, 0, 1, 0 },
+    { "apply64", run_apply64, 1, 0, 0 },
+    { "wide/32", run_wide32, 0, 0, 0 },
+    { "wide/64", run_wide64, 0, 0, 0 },
+    { "wide/128", run_wide128, 0, 0, 0 },
+    { "big", run_big, 0, 0, 0 },
+    { "expr", run_expr, 0, 0, 0 },
+    { "expr/array", run_expr_array, 0, 0, 0 },
+    { "expr/columns", run_expr_columns, 0, 0, 0 },
+    { "expr/jit", run_expr_jit, 0, 0, 0 },
+    { "expr/literal", run_expr_literal, 0, 0, 0 },
+    { "expr/literal/columns", run_expr_literal_columns, 0, 0, 0 },
+    { "expr/folded", run_expr_folded, 0, 0, 0 },
+    { "binary", run_binary, 0, 0, 0 },
+    { "batch", run_batch, 0, 0, 1 },
+    { "batch/cache", run_batch_cache, 0, 0, 1 },
+};
+
+#define ENGINE_COUNT (sizeof(engines) / sizeof(engines[0]))
+
+/******************************************************************************
+ * @brief    Monotonic clock in seconds
+ ******************************************************************************/
+double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/******************************************************************************
+ * @brief    realloc, which the library calls through this (--wrap=realloc)
+ *           so that large reallocations can be made to fail
+ ******************************************************************************/
+void * __wrap_realloc(void * data, size_t size)
+{
+    if (0 != fuzz_fail_size && size >= fuzz_fail_size)
+    {
+        return NULL;
+    }
+    return __real_realloc(data, size);
+}
+
+/******************************************************************************
+ * @brief    Next 32 random bits (xorshift64*), reproducible from the seed
+ ******************************************************************************/
+uint32_t random_word(void)
+{
+    fuzz_seed ^= fuzz_seed >> 12;
+    fuzz_seed ^= fuzz_seed << 25;
+    fuzz_seed ^= fuzz_seed >> 27;
+    return (uint32_t)((fuzz_seed * UINT64_C(0x2545F4914F6CDD1D)) >> 32);
+}
+
+/******************************************************************************
+ * @brief    Random 32-bit operand of random magnitude, either sign
+ ******************************************************************************/
+uint32_t random_operand(void)
+{
+    uint32_t value = random_word() >> (random_word() % 32);
+
+    return (0 != (random_word() & 1)) ? 0u - value : value;
+}
+
+/******************************************************************************
+ * @brief    The semantics every engine must match: the perform_* functions
+ * @param    op          Operator
+ * @param    operand1    First operand
+ * @param    operand2    Second operand
+ * @return   Result of the calculation, with its status and kind
+ ******************************************************************************/
+calc_result reference(calc_op op, uint32_t operand1, uint32_t operand2)
+{
+    calc_result result  = { CALC_OK, CALC_KIND_UINT, { 0 } };
+    int32_t     signed1 = (int32_t)operand1;
+    int32_t     signed2 = (int32_t)operand2;
+
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            result.kind   = CALC_KIND_INT;
+            result.status =
+                perform_addition(signed1, signed2, &result.value.as_int);
+            break;
+        case CALC_OP_SUB:
+            result.kind   = CALC_KIND_INT;
+            result.status =
+                perform_subtraction(signed1, signed2, &result.value.as_int);
+            break;
+        case CALC_OP_MUL:
+            result.kind   = CALC_KIND_INT;
+            result.status =
+                perform_multiplication(signed1, signed2, &result.value.as_int);
+            break;
+        case CALC_OP_DIV:
+            result.kind   = CALC_KIND_DOUBLE;
+            result.status =
+                perform_division(signed1, signed2, &result.value.as_double);
+            break;
+        case CALC_OP_MOD:
+            result.kind   = CALC_KIND_INT;
+            result.status =
+                perform_modulo(signed1, signed2, &result.value.as_int);
+            break;
+        case CALC_OP_SHL:
+            result.value.as_uint = perform_left_shift(operand1, operand2);
+            break;
+        case CALC_OP_SHR:
+            result.value.as_uint = perform_right_shift(operand1, operand2);
+            break;
+        case CALC_OP_AND:
+            result.value.as_uint = perform_and(operand1, operand2);
+            break;
+        case CALC_OP_OR:
+            result.value.as_uint = perform_or(operand1, operand2);
+            break;
+        case CALC_OP_XOR:
+            result.value.as_uint = perform_xor(operand1, operand2);
+            break;
+        case CALC_OP_ROL:
+            result.value.as_uint = rotate_left(operand1, operand2);
+            break;
+        case CALC_OP_ROR:
+            result.value.as_uint = rotate_right(operand1, operand2);
+            break;
+        default:
+            result.status = CALC_ERR_UNSUPPORTED_OPERATOR;
+            break;
+    }
+    return result;
+}
+
+/******************************************************************************
+ * @brief    Status of a failed row where an engine only flags the failure
+ ******************************************************************************/
+calc_status failure_status(calc_op op)
+{
+    switch (op)
+    {
+        case CALC_OP_ADD:
+            return CALC_ERR_ADD_OVERFLOW;
+        case CALC_OP_SUB:
+            return CALC_ERR_SUB_OVERFLOW;
+        case CALC_OP_MUL:
+            return CALC_ERR_MUL_OVERFLOW;
+        case CALC_OP_DIV:
+            return CALC_ERR_DIV_BY_ZERO;
+        case CALC_OP_MOD:
+            return CALC_ERR_MOD_BY_ZERO;
+        default:
+            return CALC_ERR_UNSUPPORTED_OPERATOR;
+    }
+}
+
+/******************************************************************************
+ * @brief    Whether an operator on 32-bit operands sign extended to a wider
+ *           width gives the 32-bit result wherever that one fits; shifts,
+ *           rotates and exact quotients do not
+ ******************************************************************************/
+int narrowable(calc_op op)
+{
+    switch (op)
+    {
+        case CALC_OP_ADD:
+        case CALC_OP_SUB:
+        case CALC_OP_MUL:
+        case CALC_OP_MOD:
+        case CALC_OP_AND:
+        case CALC_OP_OR:
+        case CALC_OP_XOR:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/******************************************************************************
+ * @brief    Turn a wider result of a narrowable operator into the 32-bit one
+ * @param    op      Operator
+ * @param    fits    Whether value holds the result (it fits in 64 bits)
+ * @param    value   The result
+ * @param    actual  Set to the 32-bit result: arithmetic out of 32 bits is
+ *                   the overflow the 32-bit operator reports
+ ******************************************************************************/
+void narrow(calc_op op, int fits, int64_t value, calc_result * actual)
+{
+    actual->status = CALC_OK;
+    if (CALC_OP_AND == op || CALC_OP_OR == op || CALC_OP_XOR == op)
+    {
+        actual->kind          = CALC_KIND_UINT;
+        actual->value.as_uint = (uint32_t)value;
+        return;
+    }
+    actual->kind = CALC_KIND_INT;
+    if (!fits || value < INT32_MIN || value > INT32_MAX)
+    {
+        actual->status = failure_status(op);
+        return;
+    }
+    actual->value.as_int = (int32_t)value;
+}
+
+/******************************************************************************
+ * @brief    Whether two results agree: the same status and, if successful,
+ *           the same kind and value (a quotient to the bit, so -0.0 is not
+ *           0.0)
+ ******************************************************************************/
+int same_result(const calc_result * expected, const calc_result * actual)
+{
+    if (expected->status != actual->status)
+    {
+        return 0;
+    }
+    if (CALC_OK != expected->status)
+    {
+        return 1;
+    }
+    if (expected->kind != actual->kind)
+    {
+        return 0;
+    }
+    if (CALC_KIND_DOUBLE == expected->kind)
+    {
+        return 0 == memcmp(&expected->value.as_double,
+                           &actual->value.as_double,
+                           sizeof(double));
+    }
+    return expected->value.as_uint == actual->value.as_uint;
+}
+
+/******************************************************************************
+ * @brief    Describe a result for a divergence report
+ ******************************************************************************/
+void describe(char * out, size_t size, const calc_result * result)
+{
+    if (CALC_OK != result->status)
+    {
+        snprintf(out, size, "%s", calc_status_message(result->status));
+        return;
+    }
+    switch (result->kind)
+    {
+        case CALC_KIND_INT:
+            snprintf(out, size, "%" PRId32, result->value.as_int);
+            break;
+        case CALC_KIND_UINT:
+            snprintf(
+                out, size, "%" PRIu32 " (unsigned)", result->value.as_uint);
+            break;
+        default:
+            snprintf(out, size, "%.17g", result->value.as_double);
+            break;
+    }
+}
+
+/******************************************************************************
+ * @brief    Batch output line of a result, as printf writes it
+ * @return   Length of the line, with its newline
+ ******************************************************************************/
+size_t reference_line(char * out, size_t size, const calc_result * result)
+{
+    int length;
+
+    if (CALC_OK != result->status)
+    {
+        length =
+            snprintf(out, size, "%s\n", calc_status_message(result->status));
+    }
+    else if (CALC_KIND_INT == result->kind)
+    {
+        length = snprintf(out, size, "Result: %" PRId32 "\n",
+                          result->value.as_int);
+    }
+    else if (CALC_KIND_UINT == result->kind)
+    {
+        length = snprintf(out, size, "Result: %" PRIu32 "\n",
+                          result->value.as_uint);
+    }
+    else
+    {
+        length = snprintf(out, size, "Result: %.2f\n", result->value.as_double);
+    }
+    return (length < 0) ? 0 : (size_t)length;
+}
+
+/******************************************************************************
+ * @brief    Turn the lanes of one array call into results
+ * @param    run         Case; result holds the lanes from start, error_mask
+ *                       the failures of this call only
+ * @param    start       First row of the call
+ * @param    count       Rows of the call
+ * @param    returned    Status the call returned, checked against its lanes
+ ******************************************************************************/
+void collect_lanes(fuzz_case * run,
+                   size_t      start,
+                   size_t      count,
+                   calc_status returned)
+{
+    calc_status failure = failure_status(run->op);
+    int         failed  = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        calc_result * actual = &run->actual[start + i];
+
+        // Arrays carry no kind; there is only the reference's to take
+        actual->kind          = run->expected[start + i].kind;
+        actual->value.as_uint = run->result[start + i];
+        actual->status        = CALC_OK;
+        if (0 != ((run->error_mask[i / 8] >> (i % 8)) & 1))
+        {
+            actual->status = failure;
+            failed         = 1;
+        }
+    }
+    if (returned != (failed ? failure : CALC_OK))
+    {
+        run->returned_wrong = 1;
+    }
+}
+
+/******************************************************************************
+ * @brief    Run an array call over a stream, whole or cut into pieces whose
+ *           lengths go through every tail up to FUZZ_PIECE_MAX and whose
+ *           starts fall at every alignment
+ ******************************************************************************/
+void apply_in_pieces(fuzz_case * run, fuzz_array_fn call)
+{
+    size_t count = run->stream->count;
+    size_t piece = count;
+    size_t calls = 0;
+
+    for (size_t start = 0; start < count; start += piece, calls++)
+    {
+        if (run->pieces)
+        {
+            piece = 1 + ((calls * FUZZ_PIECE_STRIDE) % FUZZ_PIECE_MAX);
+        }
+        piece = (piece < count - start) ? piece : count - start;
+        memset(run->error_mask, 0, (piece + 7) / 8);
+        collect_lanes(run, start, piece, call(run, start, piece));
+    }
+}
+
+calc_status call_apply_isa(fuzz_case * run, size_t start, size_t count)
+{
+    return calc_apply_isa(run->isa,
+                          run->op,
+                          run->stream->operand1 + start,
+                          run->stream->operand2 + start,
+                          run->result + start,
+                          run->error_mask,
+                          count);
+}
+
+calc_status call_apply(fuzz_case * run, size_t start, size_t count)
+{
+    return calc_apply(run->op,
+                      run->stream->operand1 + start,
+                      run->stream->operand2 + start,
+                      run->result + start,
+                      run->error_mask,
+                      count);
+}
+
+calc_status call_apply_const(fuzz_case * run, size_t start, size_t count)
+{
+    return calc_apply_const(run->op,
+                            run->stream->operand1 + start,
+                            run->stream->operand2[0],
+                            run->result + start,
+                            run->error_mask,
+                            count);
+}
+
+calc_status call_literal(fuzz_case * run, size_t start, size_t count)
+{
+    int failed = run->literal(run->op,
+                              run->stream->operand1 + start,
+                              run->result + start,
+                              run->error_mask,
+                              count);
+
+    return failed ? failure_status(run->op) : CALC_OK;
+}
+
+/******************************************************************************
+ * @brief    calc_execute, row by row
+ ******************************************************************************/
+int run_execute(fuzz_case * run)
+{
+    const fuzz_stream * stream = run->stream;
+
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        run->actual[i] =
+            calc_execute(run->op, stream->operand1[i], stream->operand2[i]);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    perform_calculation, which decodes the operator every row
+ ******************************************************************************/
+int run_calculation(fuzz_case * run)
+{
+    const fuzz_stream * stream = run->stream;
+
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        run->actual[i] = perform_calculation(
+            stream->operand1[i], run->symbol, stream->operand2[i]);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_apply_isa on the case's instruction set
+ ******************************************************************************/
+int run_apply_isa(fuzz_case * run)
+{
+    if (CALC_OP_DIV == run->op)
+    {
+        return 0;
+    }
+    apply_in_pieces(run, call_apply_isa);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_apply, which detects a shared second operand by itself
+ ******************************************************************************/
+int run_apply(fuzz_case * run)
+{
+    if (CALC_OP_DIV == run->op)
+    {
+        return 0;
+    }
+    apply_in_pieces(run, call_apply);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_apply_const, on streams whose second operand is shared
+ ******************************************************************************/
+int run_apply_const(fuzz_case * run)
+{
+    if (CALC_OP_DIV == run->op || !run->stream->shared)
+    {
+        return 0;
+    }
+    apply_in_pieces(run, call_apply_const);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_const.h's kernels inlined with the shared second operand,
+ *           where it is one of the literals
+ ******************************************************************************/
+int run_literal(fuzz_case * run)
+{
+    if (CALC_OP_DIV == run->op || !run->stream->shared)
+    {
+        return 0;
+    }
+    run->literal = NULL;
+    for (size_t i = 0; i < sizeof(literals) / sizeof(literals[0]); i++)
+    {
+        if (literals[i].value == run->stream->operand2[0])
+        {
+            run->literal = literals[i].kernels;
+        }
+    }
+    if (NULL == run->literal)
+    {
+        return 0;
+    }
+    apply_in_pieces(run, call_literal);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_apply64_isa on the operands sign extended
+ ******************************************************************************/
+int run_apply64(fuzz_case * run)
+{
+    const fuzz_stream * stream  = run->stream;
+    calc_status         failure = failure_status(run->op);
+    int                 failed  = 0;
+
+    if (!narrowable(run->op))
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        run->wide1[i] = (uint64_t)(int64_t)(int32_t)stream->operand1[i];
+        run->wide2[i] = (uint64_t)(int64_t)(int32_t)stream->operand2[i];
+    }
+    memset(run->error_mask, 0, (stream->count + 7) / 8);
+    calc_status returned = calc_apply64_isa(run->isa,
+                                            run->op,
+                                            run->wide1,
+                                            run->wide2,
+                                            run->wide_result,
+                                            run->error_mask,
+                                            stream->count);
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        if (0 != ((run->error_mask[i / 8] >> (i % 8)) & 1))
+        {
+            run->actual[i].status = failure;
+            failed                = 1;
+        }
+        else
+        {
+            narrow(run->op, 1, (int64_t)run->wide_result[i], &run->actual[i]);
+        }
+    }
+    if (returned != (failed ? failure : CALC_OK))
+    {
+        run->returned_wrong = 1;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    calc_execute_wide: at 32 bits the same operator, which must match
+ *           exactly but for quotients, which it gives exact; wider, on the
+ *           operands sign extended
+ ******************************************************************************/
+int run_wide(fuzz_case * run, calc_width width)
+{
+    const fuzz_stream * stream = run->stream;
+
+    if ((CALC_WIDTH_32 == width) ? CALC_OP_DIV == run->op
+                                 : !narrowable(run->op))
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        calc_result *    actual = &run->actual[i];
+        calc_wide_result result = calc_execute_wide(
+            width,
+            run->op,
+            (calc_uint128)(calc_int128)(int32_t)stream->operand1[i],
+            (calc_uint128)(calc_int128)(int32_t)stream->operand2[i]);
+
+        if (CALC_OK != result.status)
+        {
+            actual->status = result.status;
+        }
+        else if (CALC_WIDTH_32 == width)
+        {
+            actual->status        = CALC_OK;
+            actual->kind          = result.kind;
+            actual->value.as_uint = (uint32_t)result.value;
+        }
+        else
+        {
+            narrow(run->op, 1, (int64_t)(uint64_t)result.value, actual);
+        }
+    }
+    return 1;
+}
+
+int run_wide32(fuzz_case * run)
+{
+    return run_wide(run, CALC_WIDTH_32);
+}
+
+int run_wide64(fuzz_case * run)
+{
+    return run_wide(run, CALC_WIDTH_64);
+}
+
+int run_wide128(fuzz_case * run)
+{
+    return run_wide(run, CALC_WIDTH_128);
+}
+
+/******************************************************************************
+ * @brief    calc_big_execute on the operands as signed integers
+ ******************************************************************************/
+int run_big(fuzz_case * run)
+{
+    const fuzz_stream * stream = run->stream;
+    calc_big            operand1;
+    calc_big            operand2;
+    calc_big_result     result;
+
+    if (!narrowable(run->op))
+    {
+        return 0;
+    }
+    calc_big_init(&operand1);
+    calc_big_init(&operand2);
+    calc_big_init(&result.value);
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        calc_big_set_int(&operand1, (int32_t)stream->operand1[i]);
+        calc_big_set_int(&operand2, (int32_t)stream->operand2[i]);
+        calc_big_execute(run->op, &operand1, &operand2, &result);
+        if (CALC_OK != result.status)
+        {
+            run->actual[i].status = result.status;
+            continue;
+        }
+
+        // Products of 32-bit operands fit in one limb, with a bit to spare
+        const uint64_t * limbs = (NULL != result.value.heap)
+                                     ? result.value.heap
+                                     : result.value.small;
+        uint64_t         magnitude = (0 == result.value.length) ? 0 : limbs[0];
+        int              fits      = result.value.length <= 1 &&
+                         magnitude <= (uint64_t)INT64_MAX;
+        int64_t          value     = fits ? (int64_t)magnitude : 0;
+
+        narrow(run->op,
+               fits,
+               result.value.negative ? -value : value,
+               &run->actual[i]);
+    }
+    calc_big_free(&result.value);
+    calc_big_free(&operand2);
+    calc_big_free(&operand1);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Compile "a OP operand2"
+ * @param    run         Case
+ * @param    operand2    Text of the second operand, "b" or a literal
+ * @param    index1      Set to the binding of a, SIZE_MAX if it was
+ *                       optimised away
+ * @param    index2      Set to the binding of b, SIZE_MAX if none
+ * @return   Expression, or NULL if it did not compile
+ ******************************************************************************/
+calc_expr * compile_expression(fuzz_case *  run,
+                               const char * operand2,
+                               size_t *     index1,
+                               size_t *     index2)
+{
+    char        text[FUZZ_TEXT_MAX];
+    calc_expr * expr   = NULL;
+    size_t      offset = 0;
+
+    snprintf(text, sizeof(text), "a %s %s", run->symbol, operand2);
+    if (CALC_EXPR_OK != calc_expr_compile(text, &expr, &offset))
+    {
+        return NULL;
+    }
+    *index1 = calc_expr_find_variable(expr, "a", 1);
+    *index2 = calc_expr_find_variable(expr, "b", 1);
+    if (calc_expr_variable_count(expr) == *index1)
+    {
+        *index1 = SIZE_MAX;
+    }
+    if (calc_expr_variable_count(expr) == *index2)
+    {
+        *index2 = SIZE_MAX;
+    }
+    return expr;
+}
+
+/******************************************************************************
+ * @brief    Bindings of one row, for variables the expression kept
+ ******************************************************************************/
+void bind_row(const fuzz_case * run,
+              size_t            row,
+              size_t            index1,
+              size_t            index2,
+              uint32_t *        bindings)
+{
+    if (index1 < 2)
+    {
+        bindings[index1] = run->stream->operand1[row];
+    }
+    if (index2 < 2)
+    {
+        bindings[index2] = run->stream->operand2[row];
+    }
+}
+
+/******************************************************************************
+ * @brief    Evaluate an expression row by row, or fail every row
+ ******************************************************************************/
+void eval_rows(fuzz_case * run,
+               calc_expr * expr,
+               size_t      index1,
+               size_t      index2)
+{
+    uint32_t bindings[2] = { 0, 0 };
+
+    for (size_t i = 0; i < run->stream->count; i++)
+    {
+        if (NULL == expr)
+        {
+            run->actual[i].status = CALC_ERR_UNSUPPORTED_OPERATOR;
+            continue;
+        }
+        bind_row(run, i, index1, index2, bindings);
+        run->actual[i] = calc_expr_eval(expr, bindings);
+    }
+}
+
+/******************************************************************************
+ * @brief    Evaluate an expression over the stream as columns
+ ******************************************************************************/
+void eval_columns(fuzz_case * run,
+                  calc_expr * expr,
+                  size_t      index1,
+                  size_t      index2)
+{
+    const fuzz_stream * stream     = run->stream;
+    const uint32_t *    columns[2] = { NULL, NULL };
+
+    if (NULL == expr)
+    {
+        eval_rows(run, NULL, index1, index2);
+        return;
+    }
+    if (index1 < 2)
+    {
+        columns[index1] = stream->operand1;
+    }
+    if (index2 < 2)
+    {
+        columns[index2] = stream->operand2;
+    }
+
+    calc_kind kind    = calc_expr_kind(expr);
+    void *    results = (CALC_KIND_DOUBLE == kind) ? (void *)run->quotients
+                                                   : (void *)run->result;
+    memset(run->error_mask, 0, (stream->count + 7) / 8);
+    (void)calc_expr_eval_columns(
+        expr, columns, results, run->error_mask, stream->count);
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        calc_result * actual = &run->actual[i];
+
+        actual->status = CALC_OK;
+        actual->kind   = kind;
+        if (0 != ((run->error_mask[i / 8] >> (i % 8)) & 1))
+        {
+            actual->status = failure_status(run->op);
+        }
+        else if (CALC_KIND_DOUBLE == kind)
+        {
+            actual->value.as_double = run->quotients[i];
+        }
+        else
+        {
+            actual->value.as_uint = run->result[i];
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    "a OP b" interpreted, row by row
+ ******************************************************************************/
+int run_expr(fuzz_case * run)
+{
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr = compile_expression(run, "b", &index1, &index2);
+
+    eval_rows(run, expr, index1, index2);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "a OP b" over an array of rows of bindings
+ ******************************************************************************/
+int run_expr_array(fuzz_case * run)
+{
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr = compile_expression(run, "b", &index1, &index2);
+
+    if (NULL == expr)
+    {
+        eval_rows(run, NULL, index1, index2);
+        return 1;
+    }
+
+    size_t width = calc_expr_variable_count(expr);
+    for (size_t i = 0; i < run->stream->count; i++)
+    {
+        bind_row(run, i, index1, index2, run->bindings + (i * width));
+    }
+    (void)calc_expr_eval_array(
+        expr, run->bindings, run->actual, run->stream->count);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "a OP b" over columns of bindings
+ ******************************************************************************/
+int run_expr_columns(fuzz_case * run)
+{
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr = compile_expression(run, "b", &index1, &index2);
+
+    eval_columns(run, expr, index1, index2);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "a OP b" compiled to native code, where the JIT can
+ ******************************************************************************/
+int run_expr_jit(fuzz_case * run)
+{
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr = compile_expression(run, "b", &index1, &index2);
+
+    if (NULL == expr || !calc_expr_jit(expr))
+    {
+        calc_expr_free(expr);
+        return 0;
+    }
+    eval_rows(run, expr, index1, index2);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "a OP literal", which the compiler folds and reduces, row by row
+ ******************************************************************************/
+int run_expr_literal(fuzz_case * run)
+{
+    char        literal[FUZZ_TEXT_MAX];
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr;
+
+    if (!run->stream->shared)
+    {
+        return 0;
+    }
+    snprintf(literal, sizeof(literal), "%" PRIu32, run->stream->operand2[0]);
+    expr = compile_expression(run, literal, &index1, &index2);
+    eval_rows(run, expr, index1, index2);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "a OP literal" over a column of bindings
+ ******************************************************************************/
+int run_expr_literal_columns(fuzz_case * run)
+{
+    char        literal[FUZZ_TEXT_MAX];
+    size_t      index1;
+    size_t      index2;
+    calc_expr * expr;
+
+    if (!run->stream->shared)
+    {
+        return 0;
+    }
+    snprintf(literal, sizeof(literal), "%" PRIu32, run->stream->operand2[0]);
+    expr = compile_expression(run, literal, &index1, &index2);
+    eval_columns(run, expr, index1, index2);
+    calc_expr_free(expr);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    "literal OP literal", folded to a constant as it is compiled, on
+ *           the short streams
+ ******************************************************************************/
+int run_expr_folded(fuzz_case * run)
+{
+    const fuzz_stream * stream = run->stream;
+
+    if (stream->count > FUZZ_FOLD_ROWS)
+    {
+        return 0;
+    }
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        char        text[FUZZ_TEXT_MAX];
+        calc_expr * expr   = NULL;
+        size_t      offset = 0;
+
+        snprintf(text,
+                 sizeof(text),
+                 "%" PRIu32 " %s %" PRIu32,
+                 stream->operand1[i],
+                 run->symbol,
+                 stream->operand2[i]);
+        calc_arena_reset(run->arena);
+        if (CALC_EXPR_OK !=
+            calc_expr_compile_in(run->arena, text, &expr, &offset))
+        {
+            run->actual[i].status = CALC_ERR_UNSUPPORTED_OPERATOR;
+            continue;
+        }
+        run->actual[i] = calc_expr_eval(expr, run->bindings);
+    }
+    calc_arena_reset(run->arena);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    The stream as one binary request
+ ******************************************************************************/
+int run_binary(fuzz_case * run)
+{
+    const fuzz_stream * stream  = run->stream;
+    calc_batch_counts   counts  = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    uint64_t            rows    = stream->count;
+    uint32_t            magic   = CALC_BINARY_REQUEST_MAGIC;
+    uint16_t            version = CALC_BINARY_VERSION;
+    uint16_t            opcode  = (uint16_t)run->op;
+    unsigned char *     request;
+
+    // This harness runs little-endian, as the format is
+    run->request.used = 0;
+    if (!calc_buffer_reserve(&run->request,
+                             CALC_BINARY_HEADER_SIZE +
+                                 (2 * stream->count * sizeof(uint32_t))))
+    {
+        return 0;
+    }
+    request = (unsigned char *)run->request.data;
+    memcpy(request, &magic, sizeof(magic));
+    memcpy(request + 4, &version, sizeof(version));
+    memcpy(request + 6, &opcode, sizeof(opcode));
+    memcpy(request + 8, &rows, sizeof(rows));
+    memcpy(request + CALC_BINARY_HEADER_SIZE,
+           stream->operand1,
+           stream->count * sizeof(uint32_t));
+    memcpy(request + CALC_BINARY_HEADER_SIZE +
+               (stream->count * sizeof(uint32_t)),
+           stream->operand2,
+           stream->count * sizeof(uint32_t));
+    run->request.used =
+        CALC_BINARY_HEADER_SIZE + (2 * stream->count * sizeof(uint32_t));
+
+    run->output.used = 0;
+    calc_batch_status status = calc_binary_eval(run->request.data,
+                                                run->request.used,
+                                                &run->output,
+                                                run->arena,
+                                                &counts);
+
+    const unsigned char * response = (const unsigned char *)run->output.data;
+    uint16_t              kind     = 0;
+    if (CALC_BATCH_OK == status)
+    {
+        memcpy(&kind, response + 6, sizeof(kind));
+    }
+    size_t width = (CALC_KIND_DOUBLE == kind) ? sizeof(double)
+                                              : sizeof(uint32_t);
+    const unsigned char * mask =
+        response + CALC_BINARY_HEADER_SIZE + (stream->count * width);
+
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        calc_result * actual = &run->actual[i];
+        const void *  value = response + CALC_BINARY_HEADER_SIZE + (i * width);
+
+        actual->status = CALC_OK;
+        actual->kind   = (calc_kind)kind;
+        if (CALC_BATCH_OK != status)
+        {
+            actual->status = CALC_ERR_UNSUPPORTED_OPERATOR;
+        }
+        else if (0 != ((mask[i / 8] >> (i % 8)) & 1))
+        {
+            actual->status = failure_status(run->op);
+        }
+        else if (CALC_KIND_DOUBLE == kind)
+        {
+            memcpy(&actual->value.as_double, value, sizeof(double));
+        }
+        else
+        {
+            memcpy(&actual->value.as_uint, value, sizeof(uint32_t));
+        }
+    }
+    calc_arena_reset(run->arena);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    The stream as text batch lines
+ ******************************************************************************/
+int run_batch(fuzz_case * run)
+{
+    calc_batch_counts counts   = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    calc_div_format   division = { CALC_DIV_DOUBLE, 0 };
+
+    run->output.used = 0;
+    (void)calc_batch_eval(run->lines.data,
+                          run->lines.used,
+                          &run->output,
+                          NULL,
+                          CALC_WIDTH_32,
+                          division,
+                          &counts);
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    The stream as text batch lines through a result cache, twice, so
+ *           that the second run answers repeated lines from it
+ ******************************************************************************/
+int run_batch_cache(fuzz_case * run)
+{
+    calc_batch_counts counts   = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    calc_div_format   division = { CALC_DIV_DOUBLE, 0 };
+
+    for (int pass = 0; pass < 2; pass++)
+    {
+        run->output.used = 0;
+        (void)calc_batch_eval(run->lines.data,
+                              run->lines.used,
+                              &run->output,
+                              run->cache,
+                              CALC_WIDTH_32,
+                              division,
+                              &counts);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Tally of an engine, added the first time it is seen
+ * @return   Tally, or NULL if there are too many engines
+ ******************************************************************************/
+fuzz_tally * find_tally(fuzz_state * state, const char * name)
+{
+    for (size_t i = 0; i < state->tally_count; i++)
+    {
+        if (0 == strcmp(state->tallies[i].name, name))
+        {
+            return &state->tallies[i];
+        }
+    }
+    if (FUZZ_TALLIES == state->tally_count)
+    {
+        return NULL;
+    }
+
+    fuzz_tally * tally = &state->tallies[state->tally_count++];
+    memset(tally, 0, sizeof(*tally));
+    snprintf(tally->name, sizeof(tally->name), "%s", name);
+    return tally;
+}
+
+/******************************************************************************
+ * @brief    Count a divergence, printing the first few of each engine
+ * @param    state       Run
+ * @param    tally       Engine that diverged
+ * @param    run         Case it diverged on
+ * @param    row         Row of the stream, SIZE_MAX for a whole call
+ * @param    expected    What the reference gives
+ * @param    actual      What the engine gave
+ ******************************************************************************/
+void report(fuzz_state *      state,
+            fuzz_tally *      tally,
+            const fuzz_case * run,
+            size_t            row,
+            const char *      expected,
+            const char *      actual)
+{
+    if (tally->divergences < FUZZ_REPORT)
+    {
+        if (SIZE_MAX == row)
+        {
+            printf("DIVERGED %s: %s on %s: expected %s, got %s\n",
+                   tally->name,
+                   run->symbol,
+                   run->stream->name,
+                   expected,
+                   actual);
+        }
+        else
+        {
+            printf("DIVERGED %s: %" PRIu32 " %s %" PRIu32
+                   " (%s row %zu): expected %s, got %s\n",
+                   tally->name,
+                   run->stream->operand1[row],
+                   run->symbol,
+                   run->stream->operand2[row],
+                   run->stream->name,
+                   row,
+                   expected,
+                   actual);
+        }
+    }
+    tally->divergences++;
+    state->divergences++;
+}
+
+/******************************************************************************
+ * @brief    Compare an engine's results with the reference, row by row
+ ******************************************************************************/
+void compare_results(fuzz_state * state, fuzz_tally * tally, fuzz_case * run)
+{
+    char expected[FUZZ_TEXT_MAX];
+    char actual[FUZZ_TEXT_MAX];
+
+    for (size_t i = 0; i < run->stream->count; i++)
+    {
+        if (!same_result(&run->expected[i], &run->actual[i]))
+        {
+            describe(expected, sizeof(expected), &run->expected[i]);
+            describe(actual, sizeof(actual), &run->actual[i]);
+            report(state, tally, run, i, expected, actual);
+        }
+    }
+    if (run->returned_wrong)
+    {
+        report(state,
+               tally,
+               run,
+               SIZE_MAX,
+               "the status of its failed lanes",
+               "another from the call");
+    }
+}
+
+/******************************************************************************
+ * @brief    Compare an engine's batch output with the reference, line by line
+ ******************************************************************************/
+void compare_lines(fuzz_state * state, fuzz_tally * tally, fuzz_case * run)
+{
+    const char * expected     = run->expected_text.data;
+    const char * expected_end = expected + run->expected_text.used;
+    const char * actual       = run->output.data;
+    const char * actual_end   = actual + run->output.used;
+
+    for (size_t i = 0; i < run->stream->count; i++)
+    {
+        const char * expected_line = expected;
+        const char * actual_line   = actual;
+
+        expected = memchr(expected, '\n', (size_t)(expected_end - expected));
+        expected = (NULL == expected) ? expected_end : expected + 1;
+        actual   = (actual < actual_end)
+                       ? memchr(actual, '\n', (size_t)(actual_end - actual))
+                       : NULL;
+        actual   = (NULL == actual) ? actual_end : actual + 1;
+
+        size_t expected_length = (size_t)(expected - expected_line);
+        size_t actual_length   = (size_t)(actual - actual_line);
+        if (expected_length != actual_length ||
+            0 != memcmp(expected_line, actual_line, expected_length))
+        {
+            char wanted[FUZZ_TEXT_MAX];
+            char got[FUZZ_TEXT_MAX];
+
+            // Without their newlines
+            snprintf(wanted,
+                     sizeof(wanted),
+                     "\"%.*s\"",
+                     (int)((0 == expected_length) ? 0 : expected_length - 1),
+                     expected_line);
+            snprintf(got,
+                     sizeof(got),
+                     "\"%.*s\"",
+                     (int)((0 == actual_length) ? 0 : actual_length - 1),
+                     actual_line);
+            report(state, tally, run, i, wanted, got);
+        }
+    }
+    if (actual != actual_end)
+    {
+        report(state, tally, run, SIZE_MAX, "no more lines", "more");
+    }
+}
+
+/******************************************************************************
+ * @brief    Run one engine on a case, time it and compare what it gave
+ ******************************************************************************/
+void check_engine(fuzz_state *        state,
+                  const fuzz_engine * engine,
+                  const char *        name,
+                  fuzz_case *         run)
+{
+    fuzz_tally * tally = find_tally(state, name);
+
+    if (NULL == tally)
+    {
+        return;
+    }
+    run->pieces         = engine->pieces;
+    run->returned_wrong = 0;
+
+    double start = now_seconds();
+    if (!engine->fn(run))
+    {
+        return;
+    }
+    double elapsed = now_seconds() - start;
+
+    tally->rows += run->stream->count;
+    if (run->stream->timed)
+    {
+        tally->timed_rows += run->stream->count;
+        tally->seconds += elapsed;
+    }
+    if (engine->text)
+    {
+        compare_lines(state, tally, run);
+    }
+    else
+    {
+        compare_results(state, tally, run);
+    }
+}
+
+/******************************************************************************
+ * @brief    Find the reference results of a case, its batch lines and their
+ *           reference output
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+int prepare_case(fuzz_case * run)
+{
+    const fuzz_stream * stream = run->stream;
+
+    run->lines.used         = 0;
+    run->expected_text.used = 0;
+    for (size_t i = 0; i < stream->count; i++)
+    {
+        run->expected[i] =
+            reference(run->op, stream->operand1[i], stream->operand2[i]);
+        if (!calc_buffer_reserve(&run->lines, CALC_LINE_MAX) ||
+            !calc_buffer_reserve(&run->expected_text, FUZZ_TEXT_MAX))
+        {
+            return 0;
+        }
+        run->lines.used += (size_t)snprintf(run->lines.data + run->lines.used,
+                                            CALC_LINE_MAX,
+                                            "%" PRIu32 " %s %" PRIu32 "\n",
+                                            stream->operand1[i],
+                                            run->symbol,
+                                            stream->operand2[i]);
+        run->expected_text.used +=
+            reference_line(run->expected_text.data + run->expected_text.used,
+                           FUZZ_TEXT_MAX,
+                           &run->expected[i]);
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Run every operator of a stream through every engine
+ ******************************************************************************/
+void check_stream(fuzz_state * state, fuzz_case * run)
+{
+    char name[FUZZ_NAME_MAX];
+
+    for (size_t i = 0; i < OPERATOR_COUNT; i++)
+    {
+        run->op     = operators[i].op;
+        run->symbol = operators[i].symbol;
+        if (!prepare_case(run))
+        {
+            fprintf(stderr, "Error! Out of memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t e = 0; e < ENGINE_COUNT; e++)
+        {
+            if (!engines[e].per_isa)
+            {
+                run->isa = calc_isa_detect();
+                check_engine(state, &engines[e], engines[e].name, run);
+                continue;
+            }
+            for (int isa = 0; isa < CALC_ISA_COUNT; isa++)
+            {
+                if (calc_isa_supported((calc_isa)isa))
+                {
+                    run->isa = (calc_isa)isa;
+                    snprintf(name,
+                             sizeof(name),
+                             "%s/%s",
+                             engines[e].name,
+                             calc_isa_name(run->isa));
+                    check_engine(state, &engines[e], name, run);
+                }
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Reduction of a column as the documented fold: the 64-bit total
+ *           held to 32 bits unless wide, as perform_addition holds a sum
+ ******************************************************************************/
+calc_reduction reference_reduction(calc_reduce_op   op,
+                                   const uint32_t * values,
+                                   size_t           count,
+                                   int              wide)
+{
+    calc_reduction result  = { CALC_OK, 0, count };
+    uint32_t       folded  = (CALC_REDUCE_AND == op) ? UINT32_MAX : 0;
+    int64_t        total   = 0;
+    int32_t        lowest  = INT32_MAX;
+    int32_t        highest = INT32_MIN;
+    uint64_t       bits    = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int32_t value = (int32_t)values[i];
+
+        total += value;
+        folded = (CALC_REDUCE_XOR == op)   ? folded ^ values[i]
+                 : (CALC_REDUCE_AND == op) ? folded & values[i]
+                                           : folded | values[i];
+        lowest  = (value < lowest) ? value : lowest;
+        highest = (value > highest) ? value : highest;
+        for (uint32_t v = values[i]; 0 != v; v &= v - 1)
+        {
+            bits++;
+        }
+    }
+
+    switch (op)
+    {
+        case CALC_REDUCE_SUM:
+            result.value = total;
+            if (!wide && (total < INT32_MIN || total > INT32_MAX))
+            {
+                result.status = CALC_ERR_ADD_OVERFLOW;
+            }
+            break;
+        case CALC_REDUCE_MIN:
+        case CALC_REDUCE_MAX:
+            result.value  = (CALC_REDUCE_MIN == op) ? lowest : highest;
+            result.status = (0 == count) ? CALC_ERR_EMPTY : CALC_OK;
+            break;
+        case CALC_REDUCE_POPCOUNT:
+            result.value = (int64_t)bits;
+            break;
+        default:
+            result.value = folded;
+            break;
+    }
+    return result;
+}
+
+/******************************************************************************
+ * @brief    Compare one reduction with the reference fold
+ ******************************************************************************/
+void check_reduction(fuzz_state *     state,
+                     calc_isa         isa,
+                     calc_reduce_op   op,
+                     const uint32_t * values,
+                     size_t           count,
+                     unsigned         threads,
+                     int              wide,
+                     int              timed)
+{
+    char         name[FUZZ_NAME_MAX];
+    fuzz_tally * tally;
+
+    snprintf(name,
+             sizeof(name),
+             "reduce/%s%s",
+             calc_isa_name(isa),
+             (threads > 1) ? "/threads" : "");
+    tally = find_tally(state, name);
+    if (NULL == tally)
+    {
+        return;
+    }
+
+    calc_reduction expected = reference_reduction(op, values, count, wide);
+    double         start    = now_seconds();
+    calc_reduction actual =
+        calc_reduce_isa(isa, op, values, count, threads, wide);
+    double elapsed = now_seconds() - start;
+
+    tally->rows += count;
+    if (timed)
+    {
+        tally->timed_rows += count;
+        tally->seconds += elapsed;
+    }
+    if (expected.status != actual.status ||
+        (CALC_OK == expected.status &&
+         (expected.value != actual.value || expected.count != actual.count)))
+    {
+        if (tally->divergences < FUZZ_REPORT)
+        {
+            printf("DIVERGED %s: reduction %d%s of %zu values: expected "
+                   "%" PRId64 " (%s), got %" PRId64 " (%s)\n",
+                   name,
+                   (int)op,
+                   wide ? " (wide)" : "",
+                   count,
+                   expected.value,
+                   calc_status_message(expected.status),
+                   actual.value,
+                   calc_status_message(actual.status));
+        }
+        tally->divergences++;
+        state->divergences++;
+    }
+}
+
+/******************************************************************************
+ * @brief    Reduce the first operands of a stream, whole and by every short
+ *           prefix, with every operator on every instruction set
+ ******************************************************************************/
+void check_reductions(fuzz_state * state, const fuzz_stream * stream)
+{
+    for (int isa = 0; isa < CALC_ISA_COUNT; isa++)
+    {
+        if (!calc_isa_supported((calc_isa)isa))
+        {
+            continue;
+        }
+        for (int op = CALC_REDUCE_SUM; op < CALC_REDUCE_COUNT; op++)
+        {
+            for (int wide = 0; wide <= (CALC_REDUCE_SUM == op); wide++)
+            {
+                for (size_t length = 0;
+                     length <= FUZZ_PIECE_MAX && length < stream->count;
+                     length++)
+                {
+                    check_reduction(state,
+                                    (calc_isa)isa,
+                                    (calc_reduce_op)op,
+                                    stream->operand1,
+                                    length,
+                                    1,
+                                    wide,
+                                    0);
+                }
+                for (unsigned threads = 1; threads <= 2; threads++)
+                {
+                    check_reduction(state,
+                                    (calc_isa)isa,
+                                    (calc_reduce_op)op,
+                                    stream->operand1,
+                                    stream->count,
+                                    threads,
+                                    wide,
+                                    stream->timed);
+                }
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Generate the streams: random, every pair of edges, shift counts,
+ *           small divisors, random against edges, then one stream per edge
+ *           shared as the second operand
+ * @return   1 if successful, 0 if out of memory
+ ******************************************************************************/
+int make_streams(fuzz_stream * streams, size_t * count, size_t rows)
+{
+    static const char * const names[FUZZ_FIXED_STREAMS] = {
+        "random", "edges", "counts", "divisors", "random/edges",
+    };
+
+    *count = 0;
+    for (size_t s = 0; s < FUZZ_FIXED_STREAMS + EDGE_COUNT; s++)
+    {
+        fuzz_stream * stream = &streams[(*count)++];
+        size_t        length = FUZZ_SHARED_ROWS;
+
+        if (0 == s)
+        {
+            length = rows;
+        }
+        else if (1 == s)
+        {
+            length = EDGE_COUNT * EDGE_COUNT;
+        }
+        else if (s < FUZZ_FIXED_STREAMS)
+        {
+            length = FUZZ_MIXED_ROWS;
+        }
+
+        stream->operand1 = malloc(length * sizeof(uint32_t));
+        stream->operand2 = malloc(length * sizeof(uint32_t));
+        stream->count    = length;
+        stream->shared   = (s >= FUZZ_FIXED_STREAMS);
+        stream->timed    = (0 == s);
+        if (NULL == stream->operand1 || NULL == stream->operand2)
+        {
+            return 0;
+        }
+
+        for (size_t i = 0; i < length; i++)
+        {
+            uint32_t edge = edges[random_word() % EDGE_COUNT];
+            uint32_t any  = (0 != (random_word() & 1)) ? edge
+                                                       : random_operand();
+            uint32_t divisor =
+                (uint32_t)((int32_t)(random_word() %
+                                     (2 * FUZZ_DIVISOR_RANGE + 1)) -
+                           FUZZ_DIVISOR_RANGE);
+
+            switch (s)
+            {
+                case 0:
+                    stream->operand1[i] = random_operand();
+                    stream->operand2[i] = random_operand();
+                    break;
+                case 1:
+                    stream->operand1[i] = edges[i / EDGE_COUNT];
+                    stream->operand2[i] = edges[i % EDGE_COUNT];
+                    break;
+                case 2:
+                    stream->operand1[i] = any;
+                    stream->operand2[i] = random_word() % FUZZ_SHIFT_MAX;
+                    break;
+                case 3:
+                    stream->operand1[i] = any;
+                    stream->operand2[i] = divisor;
+                    break;
+                case 4:
+                    stream->operand1[i] = random_operand();
+                    stream->operand2[i] = edge;
+                    break;
+                default:
+                    stream->operand1[i] = any;
+                    stream->operand2[i] = edges[s - FUZZ_FIXED_STREAMS];
+                    break;
+            }
+        }
+
+        if (s < FUZZ_FIXED_STREAMS)
+        {
+            snprintf(stream->name, sizeof(stream->name), "%s", names[s]);
+        }
+        else
+        {
+            snprintf(stream->name,
+                     sizeof(stream->name),
+                     "shared/%" PRIu32,
+                     edges[s - FUZZ_FIXED_STREAMS]);
+        }
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Whether an output line is a zero printed with a sign
+ ******************************************************************************/
+int signed_zero(const char * line, size_t length)
+{
+    static const char prefix[] = "Result: -";
+    size_t            i        = sizeof(prefix) - 1;
+
+    if (length <= i || 0 != memcmp(line, prefix, i))
+    {
+        return 0;
+    }
+    while ('0' == line[i] || '.' == line[i])
+    {
+        i++;
+    }
+    return '\n' == line[i];
+}
+
+/******************************************************************************
+ * @brief    Compare calc_format_division with the known lines
+ ******************************************************************************/
+void check_division_lines(fuzz_state * state)
+{
+    fuzz_tally * tally = find_tally(state, "format/division");
+
+    if (NULL == tally)
+    {
+        return;
+    }
+    for (size_t i = 0; i < sizeof(division_lines) / sizeof(division_lines[0]);
+         i++)
+    {
+        char   line[CALC_FORMAT_MAX];
+        size_t length = calc_format_division(line,
+                                             division_lines[i].dividend,
+                                             division_lines[i].divisor,
+                                             division_lines[i].format);
+
+        tally->rows++;
+        if (strlen(division_lines[i].line) != length ||
+            0 != memcmp(division_lines[i].line, line, length))
+        {
+            if (tally->divergences < FUZZ_REPORT)
+            {
+                printf("DIVERGED %s: %" PRId32 " / %" PRId32
+                       " (mode %d, %u digits): expected %.*s, got %.*s\n",
+                       tally->name,
+                       division_lines[i].dividend,
+                       division_lines[i].divisor,
+                       (int)division_lines[i].format.mode,
+                       division_lines[i].format.digits,
+                       (int)strlen(division_lines[i].line) - 1,
+                       division_lines[i].line,
+                       (int)length - 1,
+                       line);
+            }
+            tally->divergences++;
+            state->divergences++;
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Format every quotient of a stream in each mode that prints zero
+ *           unsigned and look for a signed one
+ ******************************************************************************/
+void check_divisions(fuzz_state * state, const fuzz_stream * stream)
+{
+    fuzz_tally * tally = find_tally(state, "format/division/zero");
+    size_t       count = sizeof(unsigned_zero_formats) /
+                   sizeof(unsigned_zero_formats[0]);
+
+    if (NULL == tally)
+    {
+        return;
+    }
+    for (size_t row = 0; row < stream->count; row++)
+    {
+        int32_t dividend = (int32_t)stream->operand1[row];
+        int32_t divisor  = (int32_t)stream->operand2[row];
+
+        for (size_t f = 0; f < count; f++)
+        {
+            char   line[CALC_FORMAT_MAX];
+            size_t length = calc_format_division(
+                line, dividend, divisor, unsigned_zero_formats[f]);
+
+            tally->rows++;
+            if (signed_zero(line, length))
+            {
+                if (tally->divergences < FUZZ_REPORT)
+                {
+                    printf("DIVERGED %s: %" PRId32 " / %" PRId32
+                           " (%s row %zu, mode %d): got %.*s\n",
+                           tally->name,
+                           dividend,
+                           divisor,
+                           stream->name,
+                           row,
+                           (int)unsigned_zero_formats[f].mode,
+                           (int)length - 1,
+                           line);
+                }
+                tally->divergences++;
+                state->divergences++;
+            }
+        }
+    }
+}
+
+/******************************************************************************
+ * @brief    Threads the process has, from /proc/self/task
+ *
+ * @return   The count, or 0 where it cannot be read
+ ******************************************************************************/
+size_t thread_count(void)
+{
+    DIR *           tasks = opendir("/proc/self/task");
+    size_t          count = 0;
+    struct dirent * entry;
+
+    if (NULL == tasks)
+    {
+        return 0;
+    }
+    while (NULL != (entry = readdir(tasks)))
+    {
+        count += ('.' != entry->d_name[0]);
+    }
+    closedir(tasks);
+    return count;
+}
+
+/******************************************************************************
+ * @brief    Run a threaded batch whose slot buffers cannot be placed on
+ *           their nodes: it must fail with CALC_BATCH_NO_MEMORY and join
+ *           every thread it started, in a child that an alarm kills should
+ *           it hang instead
+ ******************************************************************************/
+void check_batch_fault(fuzz_state * state)
+{
+    char         path[] = "/tmp/calc-fuzz-XXXXXX";
+    int          input  = mkstemp(path);
+    int          output = open("/dev/null", O_WRONLY);
+    int          status = 0;
+    fuzz_tally * tally  = find_tally(state, "batch/numa/no_memory");
+
+    if (NULL == tally || input < 0 || output < 0)
+    {
+        fprintf(stderr, "Error! Unable to set up the batch fault.\n");
+        exit(EXIT_FAILURE);
+    }
+    unlink(path);
+    for (size_t i = 0; i < FUZZ_FAULT_LINES; i++)
+    {
+        char   line[FUZZ_TEXT_MAX];
+        size_t length = (size_t)snprintf(
+            line, sizeof(line), "%zu + %zu\n", i, FUZZ_FAULT_LINES - i);
+
+        if (write(input, line, length) != (ssize_t)length)
+        {
+            fprintf(stderr, "Error! Unable to set up the batch fault.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    lseek(input, 0, SEEK_SET);
+
+    fflush(stdout);
+    pid_t child = fork();
+    if (0 == child)
+    {
+        calc_batch_counts counts   = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+        calc_div_format   division = { CALC_DIV_DOUBLE, 0 };
+        calc_batch_status result;
+
+        alarm(FUZZ_FAULT_SECONDS);
+        fuzz_fail_size = FUZZ_FAULT_SIZE;
+        result         = calc_batch_run(input,
+                                        output,
+                                        2,
+                                        1,
+                                        0,
+                                        CALC_WIDTH_32,
+                                        division,
+                                        CALC_IO_POSIX,
+                                        &counts);
+        _exit((CALC_BATCH_NO_MEMORY == result && 1 == thread_count())
+                  ? EXIT_SUCCESS
+                  : EXIT_FAILURE);
+    }
+    close(input);
+    close(output);
+
+    tally->rows++;
+    if (child < 0 || waitpid(child, &status, 0) != child ||
+        !WIFEXITED(status) || EXIT_SUCCESS != WEXITSTATUS(status))
+    {
+        printf("DIVERGED %s: the run %s\n",
+               tally->name,
+               (child > 0 && WIFSIGNALED(status) &&
+                SIGALRM == WTERMSIG(status))
+                   ? "hung"
+                   : "did not fail with only its own thread left");
+        tally->divergences++;
+        state->divergences++;
+    }
+}
+
+/******************************************************************************
+ * @brief    Print what each engine compared, found and took
+ ******************************************************************************/
+void print_tallies(const fuzz_state * state)
+{
+    printf("%-28s %12s %12s %12s\n", "engine", "rows", "ns/row", "diverged");
+    for (size_t i = 0; i < state->tally_count; i++)
+    {
+        const fuzz_tally * tally = &state->tallies[i];
+
+        if (0 == tally->timed_rows)
+        {
+            printf("%-28s %12" PRIu64 " %12s %12" PRIu64 "\n",
+                   tally->name,
+                   tally->rows,
+                   "-",
+                   tally->divergences);
+            continue;
+        }
+        printf("%-28s %12" PRIu64 " %12.2f %12" PRIu64 "\n",
+               tally->name,
+               tally->rows,
+               1e9 * tally->seconds / (double)tally->timed_rows,
+               tally->divergences);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    static fuzz_state  state;
+    static fuzz_stream streams[FUZZ_STREAMS_MAX];
+    static fuzz_case   run;
+    size_t             stream_count = 0;
+    size_t             rows         = FUZZ_ROWS;
+    size_t             longest;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--seed") && i + 1 < argc)
+        {
+            fuzz_seed = strtoull(argv[++i], NULL, 0);
+        }
+        else if (0 == strcmp(argv[i], "--rows") && i + 1 < argc)
+        {
+            rows = (size_t)strtoull(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Usage: ./calc-fuzz [--seed N] [--rows N]\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if (0 == fuzz_seed || 0 == rows)
+    {
+        fprintf(stderr, "Error! Seed and rows must be nonzero.\n");
+        return EXIT_FAILURE;
+    }
+    printf("calc-fuzz: seed %" PRIu64 ", %zu random rows\n", fuzz_seed, rows);
+
+    longest = (rows > FUZZ_MIXED_ROWS) ? rows : FUZZ_MIXED_ROWS;
+    longest = (longest > EDGE_COUNT * EDGE_COUNT) ? longest
+                                                  : EDGE_COUNT * EDGE_COUNT;
+    run.expected    = malloc(longest * sizeof(calc_result));
+    run.actual      = malloc(longest * sizeof(calc_result));
+    run.result      = malloc(longest * sizeof(uint32_t));
+    run.quotients   = malloc(longest * sizeof(double));
+    run.wide1       = malloc(longest * sizeof(uint64_t));
+    run.wide2       = malloc(longest * sizeof(uint64_t));
+    run.wide_result = malloc(longest * sizeof(uint64_t));
+    run.error_mask  = malloc((longest + 7) / 8);
+    run.bindings    = malloc(2 * longest * sizeof(uint32_t));
+    run.cache       = calc_cache_create(FUZZ_CACHE_ENTRIES);
+    run.arena       = calc_arena_create(FUZZ_ARENA_BLOCK);
+    if (NULL == run.expected || NULL == run.actual || NULL == run.result ||
+        NULL == run.quotients || NULL == run.wide1 || NULL == run.wide2 ||
+        NULL == run.wide_result || NULL == run.error_mask ||
+        NULL == run.bindings || NULL == run.cache || NULL == run.arena ||
+        !make_streams(streams, &stream_count, rows))
+    {
+        fprintf(stderr, "Error! Out of memory.\n");
+        return EXIT_FAILURE;
+    }
+
+    for (size_t s = 0; s < stream_count; s++)
+    {
+        run.stream = &streams[s];
+        check_stream(&state, &run);
+        check_reductions(&state, &streams[s]);
+        check_divisions(&state, &streams[s]);
+    }
+    check_division_lines(&state);
+    check_batch_fault(&state);
+    print_tallies(&state);
+
+    for (size_t s = 0; s < stream_count; s++)
+    {
+        free(streams[s].operand1);
+        free(streams[s].operand2);
+    }
+    calc_buffer_free(&run.expected_text);
+    calc_buffer_free(&run.lines);
+    calc_buffer_free(&run.output);
+    calc_buffer_free(&run.request);
+    calc_arena_destroy(run.arena);
+    calc_cache_destroy(run.cache);
+    free(run.bindings);
+    free(run.error_mask);
+    free(run.wide_result);
+    free(run.wide2);
+    free(run.wide1);
+    free(run.quotients);
+    free(run.result);
+    free(run.actual);
+    free(run.expected);
+
+    if (0 != state.divergences)
+    {
+        printf("%" PRIu64 " divergence(s) from perform_*\n",
+               state.divergences);
+        return EXIT_FAILURE;
+    }
+    printf("No divergences\n");
+    return EXIT_SUCCESS;
+}
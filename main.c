@@ -0,0 +1,1149 @@
+/******************************************************************************
+ * @file    main.c
+ * @brief   Simple calculator program
+ * @version 1.6
+ * @date    October 2026
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "calc.h"
+#define THREADS_MAX     256
+#define CACHE_MAX       (1u << 24) // Entries in a result cache
+#define NODES_MAX       64
+#define SHARD_MAX       (1u << 20) // Lines or rows in a shard
+#define SHARD_LINES     4096       // Default shard of batch lines
+#define SHARD_ROWS      65536      // Default shard of binary rows
+#define CREDITS_MAX     64
+#define CREDITS_DEFAULT 4
+#define TIMEOUT_MAX     3600000    // Milliseconds
+#define TIMEOUT_DEFAULT 5000
+
+// Server that SIGINT and SIGTERM stop
+static calc_server * volatile serving;
+
+// Quotients as the calculator has always printed them
+static const calc_div_format classic_division = { CALC_DIV_DOUBLE, 0 };
+
+// Function Prototypes
+void print_usage(void);
+void print_result(FILE * stream, const calc_result * result);
+void print_memory(const calc_arena_stats * arena);
+void print_stats(void);
+void * dump_stats(void * argument);
+void watch_stats(void);
+int  parse_count(const char * text, uint32_t maximum, uint32_t * count);
+int  parse_io(const char * name, calc_io * io);
+int  parse_width(const char * name, calc_width * width);
+int  parse_division(const char * name, calc_div_format * format);
+int  report_batch_status(calc_batch_status status);
+int  run_wide(int argc, char * argv[]);
+int  run_big(char * argv[]);
+int  run_calculation(char * argv[], calc_div_format format);
+int  run_division(int argc, char * argv[]);
+int  run_batch(int argc, char * argv[]);
+int  run_reduce(int argc, char * argv[]);
+int  run_expression(int argc, char * argv[]);
+int  run_server(int argc, char * argv[]);
+int  run_coordinator(int argc, char * argv[]);
+void stop_server(int signal_number);
+void handle_error(const char * message);
+
+/******************************************************************************
+ * @brief    Print the usage of the program
+ ******************************************************************************/
+void print_usage(void)
+{
+    printf("Usage: ./simplecalc operand1 operator operand2\n");
+    printf("       ./simplecalc --width 32|64|128|big operand1 operator"
+           " operand2\n");
+    printf("       ./simplecalc --div MODE operand1 operator operand2\n");
+    printf("       ./simplecalc --batch [--threads N] [--numa] [--cache N]"
+           " [--width 32|64|128|big] [--div MODE] [--io uring|posix]"
+           " [--stats] [file]\n");
+    printf("       ./simplecalc --binary [--stats] [file]\n");
+    printf("       ./simplecalc --reduce OP [--threads N] [--wide] [--binary]"
+           " [file]\n");
+    printf("       ./simplecalc --expr expression [name=value ...]\n");
+    printf("       ./simplecalc --serve [--unix path] [--tcp [host:]port]"
+           " [--cache N] [--io uring|posix] [--stats]\n");
+    printf("       ./simplecalc --coordinate --node path|[host:]port ..."
+           " [--shard N] [--credits N] [--timeout ms] [--binary]"
+           " [file]\n");
+    printf("Supported Operators:\n");
+    printf(" (+)  addition\n");
+    printf(" (-)  subtraction\n");
+    printf(" (*)  multiplication\n");
+    printf(" (/)  divide\n");
+    printf(" (%%)  modulo\n");
+    printf(" (<<) left shift\n");
+    printf(" (>>) right shift\n");
+    printf(" (&)  bitwise AND\n");
+    printf(" (|)  bitwise OR\n");
+    printf(" (^)  bitwise XOR\n");
+    printf(" (<<<) rotate left\n");
+    printf(" (>>>) rotate right\n");
+    printf("Batch mode reads one \"operand1 operator operand2\" per line\n");
+    printf("from file (or stdin) and prints one result per line, in order,\n");
+    printf("using N worker threads (default 1). --cache keeps up to N\n");
+    printf("results per thread for repeated lines and reports its hits.\n");
+    printf("--numa pins the threads, spread over the NUMA nodes, and keeps\n");
+    printf("each one's buffers and cache on its own node.\n");
+    printf("--width evaluates 64 or 128-bit operands instead of 32-bit\n");
+    printf("ones, or integers of any size with big (no rotates; shifts\n");
+    printf("and bitwise operators act on two's complement); wide results\n");
+    printf("are not cached.\n");
+    printf("--div prints 32-bit quotients as MODE: double (default, the\n");
+    printf("double to two decimals), a number of decimals from 0 to 18 of\n");
+    printf("the exact quotient, int (truncated), exact (a reduced\n");
+    printf("fraction) or shortest (the shortest decimal of the double).\n");
+    printf("Binary mode reads a columnar request (see calc.h) and writes\n");
+    printf("the binary response to stdout.\n");
+    printf("--reduce folds the operands of file (or stdin), one per line\n");
+    printf("or with --binary a bare column of little-endian 32-bit values,\n");
+    printf("with OP: + (sum), ^, &, |, min, max (signed) or popcount (set\n");
+    printf("bits). A sum must fit in 32 bits, or in 64 with --wide.\n");
+    printf("Expressions combine these operators (with C precedence),\n");
+    printf("parentheses, literals and variables bound as name=value.\n");
+    printf("Server mode answers batch lines and binary requests, pipelined,\n");
+    printf("on a Unix socket and/or TCP until interrupted.\n");
+    printf("Coordinator mode splits file (or stdin), lines or a binary\n");
+    printf("request, into shards of N lines or rows, pipelines them to the\n");
+    printf("servers given with --node, up to --credits shards each\n");
+    printf("(default 4), and prints what batch or binary mode would. A\n");
+    printf("node that answers nothing for --timeout ms (default 5000) is\n");
+    printf("dropped and its shards are sent to the others.\n");
+    printf("Batch and server I/O use io_uring (default) where the kernel\n");
+    printf("supports it, or plain system calls and epoll with --io posix.\n");
+    printf("--stats reports scratch allocations, peak memory and the\n");
+    printf("operation counters and stage latencies on exit; those are also\n");
+    printf("printed on SIGUSR1, and served at GET /metrics in server mode.\n");
+}
+
+/******************************************************************************
+ * @brief    Print the result line of a calculation
+ * @param    stream  Stream to print to
+ * @param    result  Result of the calculation
+ ******************************************************************************/
+void print_result(FILE * stream, const calc_result * result)
+{
+    char line[CALC_FORMAT_MAX];
+    fwrite(line, 1, calc_format_result(line, result), stream);
+}
+
+/******************************************************************************
+ * @brief    Report scratch arena activity and the peak resident set size
+ * @param    arena   Arena activity of the run
+ ******************************************************************************/
+void print_memory(const calc_arena_stats * arena)
+{
+    struct rusage usage;
+
+    if (0 != getrusage(RUSAGE_SELF, &usage))
+    {
+        usage.ru_maxrss = 0;
+    }
+    fprintf(stderr,
+            "Memory: %" PRIu64 " allocations from %" PRIu64
+            " blocks, %zu bytes peak scratch, %ld KiB peak RSS\n",
+            arena->allocations,
+            arena->blocks,
+            arena->peak,
+            usage.ru_maxrss);
+}
+
+/******************************************************************************
+ * @brief    Print the operation counters and stage latencies of every thread
+ *           to stderr, in the Prometheus text format
+ ******************************************************************************/
+void print_stats(void)
+{
+    calc_stats  stats;
+    calc_buffer text = { NULL, 0, 0 };
+
+    calc_stats_snapshot(&stats);
+    if (calc_stats_format(&text, &stats))
+    {
+        fwrite(text.data, 1, text.used, stderr);
+    }
+    else
+    {
+        handle_error("Error! Out of memory.\n");
+    }
+    calc_buffer_free(&text);
+}
+
+/******************************************************************************
+ * @brief    Thread that prints the statistics whenever SIGUSR1 arrives
+ ******************************************************************************/
+void * dump_stats(void * argument)
+{
+    sigset_t * signals = argument;
+    int        received;
+
+    for (;;)
+    {
+        if (0 == sigwait(signals, &received))
+        {
+            print_stats();
+        }
+    }
+    return NULL;
+}
+
+/******************************************************************************
+ * @brief    Have SIGUSR1 print the statistics from now on
+ * @note     Call before any other thread is started: SIGUSR1 is blocked so
+ *           that the threads started after inherit the mask, and only the
+ *           dumping thread ever takes it.
+ ******************************************************************************/
+void watch_stats(void)
+{
+    static sigset_t signals;
+    pthread_t       thread;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    if (0 == pthread_sigmask(SIG_BLOCK, &signals, NULL) &&
+        0 == pthread_create(&thread, NULL, dump_stats, &signals))
+    {
+        pthread_detach(thread);
+    }
+}
+
+/******************************************************************************
+ * @brief    Parse the count an option takes
+ * @param    text    Decimal digits only: no sign, space or base prefix
+ * @param    maximum Largest count accepted; a larger one is invalid rather
+ *                   than wrapped, as an operand would be
+ * @param    count   Set to the count
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int parse_count(const char * text, uint32_t maximum, uint32_t * count)
+{
+    uint32_t value = 0;
+
+    if ('\0' == *text)
+    {
+        return 0;
+    }
+    for (; '\0' != *text; text++)
+    {
+        if (*text < '0' || *text > '9')
+        {
+            return 0;
+        }
+
+        uint32_t digit = (uint32_t)(*text - '0');
+        if (digit > maximum || value > (maximum - digit) / 10)
+        {
+            return 0;
+        }
+        value = value * 10 + digit;
+    }
+    *count = value;
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Parse the name of an I/O backend
+ * @param    name    "uring" or "posix"
+ * @param    io      Set to the backend
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int parse_io(const char * name, calc_io * io)
+{
+    if (0 == strcmp(name, "uring"))
+    {
+        *io = CALC_IO_URING;
+        return 1;
+    }
+    if (0 == strcmp(name, "posix"))
+    {
+        *io = CALC_IO_POSIX;
+        return 1;
+    }
+    handle_error("Error! Invalid I/O backend.\n");
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Parse an operand width
+ * @param    name    "32", "64", "128" or "big"
+ * @param    width   Set to the width
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int parse_width(const char * name, calc_width * width)
+{
+    static const struct
+    {
+        const char * name;
+        calc_width   width;
+    } widths[] = {
+        { "32", CALC_WIDTH_32 },
+        { "64", CALC_WIDTH_64 },
+        { "128", CALC_WIDTH_128 },
+        { "big", CALC_WIDTH_BIG },
+    };
+
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++)
+    {
+        if (0 == strcmp(name, widths[i].name))
+        {
+            *width = widths[i].width;
+            return 1;
+        }
+    }
+    handle_error("Error! Invalid width.\n");
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Parse a division output mode
+ * @param    name    "double", "int", "exact", "shortest" or a number of
+ *                   decimals up to CALC_DIV_DIGITS_MAX
+ * @param    format  Set to the format
+ * @return   1 if valid, 0 otherwise
+ ******************************************************************************/
+int parse_division(const char * name, calc_div_format * format)
+{
+    static const struct
+    {
+        const char *  name;
+        calc_div_mode mode;
+    } modes[] = {
+        { "double", CALC_DIV_DOUBLE },
+        { "int", CALC_DIV_INTEGER },
+        { "exact", CALC_DIV_EXACT },
+        { "shortest", CALC_DIV_SHORTEST },
+    };
+    uint32_t digits;
+
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]); i++)
+    {
+        if (0 == strcmp(name, modes[i].name))
+        {
+            format->mode   = modes[i].mode;
+            format->digits = 0;
+            return 1;
+        }
+    }
+    if (parse_count(name, CALC_DIV_DIGITS_MAX, &digits))
+    {
+        format->mode   = CALC_DIV_FIXED;
+        format->digits = digits;
+        return 1;
+    }
+    handle_error("Error! Invalid division mode.\n");
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Run a single calculation at a given width
+ * @param    argc    Argument count, argv[1] being "--width"
+ * @param    argv    Arguments
+ * @return   EXIT_SUCCESS if the calculation succeeded, EXIT_FAILURE otherwise
+ ******************************************************************************/
+int run_wide(int argc, char * argv[])
+{
+    calc_width   width;
+    calc_uint128 operand1;
+    calc_uint128 operand2;
+    char         line[CALC_FORMAT_MAX];
+
+    if (6 != argc)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    if (!parse_width(argv[2], &width))
+    {
+        return EXIT_FAILURE;
+    }
+    if (CALC_WIDTH_BIG == width)
+    {
+        return run_big(argv + 3);
+    }
+    if (CALC_WIDTH_32 == width)
+    {
+        // Print 32-bit quotients through the double, as batch mode does
+        return run_calculation(argv + 3, classic_division);
+    }
+    if (!calc_parse_wide(argv[3], strlen(argv[3]), width, &operand1))
+    {
+        handle_error("Error! Invalid operand1.\n");
+        return EXIT_FAILURE;
+    }
+    if (!calc_parse_wide(argv[5], strlen(argv[5]), width, &operand2))
+    {
+        handle_error("Error! Invalid operand2.\n");
+        return EXIT_FAILURE;
+    }
+
+    calc_wide_result result = calc_execute_wide(
+        width, calc_parse_operator(argv[4]), operand1, operand2);
+    fwrite(line,
+           1,
+           calc_format_wide(line, &result),
+           (CALC_OK == result.status) ? stdout : stderr);
+    return (CALC_OK == result.status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/******************************************************************************
+ * @brief    Run a single calculation with arbitrary precision
+ * @param    argv    Operand, operator and operand
+ * @return   EXIT_SUCCESS if the calculation succeeded, EXIT_FAILURE otherwise
+ ******************************************************************************/
+int run_big(char * argv[])
+{
+    calc_big        operand1;
+    calc_big        operand2;
+    calc_big_result result;
+    calc_buffer     line   = { NULL, 0, 0 };
+    int             status = EXIT_FAILURE;
+
+    calc_big_init(&operand1);
+    calc_big_init(&operand2);
+    calc_big_init(&result.value);
+    if (!calc_big_parse(argv[0], strlen(argv[0]), &operand1))
+    {
+        handle_error("Error! Invalid operand1.\n");
+    }
+    else if (!calc_big_parse(argv[2], strlen(argv[2]), &operand2))
+    {
+        handle_error("Error! Invalid operand2.\n");
+    }
+    else
+    {
+        calc_big_execute(
+            calc_parse_operator(argv[1]), &operand1, &operand2, &result);
+        if (!calc_format_big(&line, &result))
+        {
+            handle_error("Error! Out of memory.\n");
+        }
+        else
+        {
+            status = (CALC_OK == result.status) ? EXIT_SUCCESS : EXIT_FAILURE;
+            fwrite(line.data,
+                   1,
+                   line.used,
+                   (EXIT_SUCCESS == status) ? stdout : stderr);
+        }
+    }
+    calc_buffer_free(&line);
+    calc_big_free(&operand1);
+    calc_big_free(&operand2);
+    calc_big_free(&result.value);
+    return status;
+}
+
+/******************************************************************************
+ * @brief    Run a single 32-bit calculation
+ * @param    argv    Operand, operator and operand
+ * @param    format  How a quotient is printed
+ * @return   EXIT_SUCCESS if the calculation succeeded, EXIT_FAILURE otherwise
+ ******************************************************************************/
+int run_calculation(char * argv[], calc_div_format format)
+{
+    uint32_t operand1;
+    uint32_t operand2;
+    char     line[CALC_FORMAT_MAX];
+
+    // Convert operand1
+    if (!calc_parse_operand(argv[0], &operand1))
+    {
+        handle_error("Error! Invalid operand1.\n");
+        return EXIT_FAILURE;
+    }
+
+    // Convert operand2
+    if (!calc_parse_operand(argv[2], &operand2))
+    {
+        handle_error("Error! Invalid operand2.\n");
+        return EXIT_FAILURE;
+    }
+
+    // A zero divisor is caught where the quotient or remainder is taken
+    calc_op op = calc_parse_operator(argv[1]);
+
+    // Division modes other than the double are formatted from the operands
+    if (CALC_OP_DIV == op && CALC_DIV_DOUBLE != format.mode)
+    {
+        int failed = (0 == operand2);
+        fwrite(line,
+               1,
+               calc_format_division(
+                   line, (int32_t)operand1, (int32_t)operand2, format),
+               failed ? stderr : stdout);
+        return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+
+    // Perform calculation
+    calc_result result = calc_execute(op, operand1, operand2);
+    print_result((CALC_OK == result.status) ? stdout : stderr, &result);
+    if (CALC_OK != result.status)
+    {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************
+ * @brief    Run a single calculation with a division output mode
+ * @param    argc    Argument count, argv[1] being "--div"
+ * @param    argv    Arguments
+ * @return   EXIT_SUCCESS if the calculation succeeded, EXIT_FAILURE otherwise
+ ******************************************************************************/
+int run_division(int argc, char * argv[])
+{
+    calc_div_format format;
+
+    if (6 != argc)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    if (!parse_division(argv[2], &format))
+    {
+        return EXIT_FAILURE;
+    }
+    return run_calculation(argv + 3, format);
+}
+
+/******************************************************************************
+ * @brief    Report why a batch run stopped, if it did not finish
+ * @param    status  Outcome of the run
+ * @return   1 if the run finished, 0 otherwise
+ ******************************************************************************/
+int report_batch_status(calc_batch_status status)
+{
+    switch (status)
+    {
+        case CALC_BATCH_OK:
+            return 1;
+        case CALC_BATCH_READ_ERROR:
+            handle_error("Error! Failed to read input.\n");
+            break;
+        case CALC_BATCH_WRITE_ERROR:
+            handle_error("Error! Failed to write output.\n");
+            break;
+        case CALC_BATCH_NO_MEMORY:
+            handle_error("Error! Out of memory.\n");
+            break;
+        case CALC_BATCH_BAD_FORMAT:
+            handle_error("Error! Invalid binary input.\n");
+            break;
+        case CALC_BATCH_NODE_ERROR:
+            handle_error("Error! No node answered every shard.\n");
+            break;
+    }
+    return 0;
+}
+
+/******************************************************************************
+ * @brief    Run batch mode
+ * @param    argc    Argument count, argv[1] being "--batch" or "--binary"
+ * @param    argv    Arguments
+ * @return   EXIT_SUCCESS if every line was evaluated, EXIT_FAILURE otherwise
+ ******************************************************************************/
+int run_batch(int argc, char * argv[])
+{
+    const char *      path     = NULL;
+    uint32_t          threads  = 1;
+    uint32_t          cache    = 0;
+    unsigned          numa     = 0;
+    calc_batch_counts counts   = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    int               binary   = (0 == strcmp(argv[1], "--binary"));
+    int               stats    = 0;
+    calc_io           io       = CALC_IO_URING;
+    calc_width        width    = CALC_WIDTH_32;
+    calc_div_format   division = classic_division;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (!binary && 0 == strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], THREADS_MAX, &threads) ||
+                0 == threads)
+            {
+                handle_error("Error! Invalid thread count.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!binary && 0 == strcmp(argv[i], "--numa"))
+        {
+            numa = calc_numa_nodes();
+        }
+        else if (!binary && 0 == strcmp(argv[i], "--cache") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], CACHE_MAX, &cache) || 0 == cache)
+            {
+                handle_error("Error! Invalid cache size.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!binary && 0 == strcmp(argv[i], "--io") && i + 1 < argc)
+        {
+            if (!parse_io(argv[++i], &io))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!binary && 0 == strcmp(argv[i], "--width") && i + 1 < argc)
+        {
+            if (!parse_width(argv[++i], &width))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (!binary && 0 == strcmp(argv[i], "--div") && i + 1 < argc)
+        {
+            if (!parse_division(argv[++i], &division))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--stats"))
+        {
+            stats = 1;
+        }
+        else if (NULL == path)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (CALC_WIDTH_32 != width && CALC_DIV_DOUBLE != division.mode)
+    {
+        handle_error("Error! --div needs 32-bit operands.\n");
+        return EXIT_FAILURE;
+    }
+
+    int input_fd = STDIN_FILENO;
+    if (NULL != path && 0 != strcmp(path, "-"))
+    {
+        input_fd = open(path, O_RDONLY);
+        if (input_fd < 0)
+        {
+            handle_error("Error! Unable to open batch file.\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    watch_stats();
+    calc_batch_status status =
+        binary ? calc_binary_run(input_fd, STDOUT_FILENO, &counts)
+               : calc_batch_run(input_fd,
+                                STDOUT_FILENO,
+                                threads,
+                                numa,
+                                cache,
+                                width,
+                                division,
+                                io,
+                                &counts);
+    if (STDIN_FILENO != input_fd)
+    {
+        close(input_fd);
+    }
+
+    if (0 != cache)
+    {
+        fprintf(stderr,
+                "Cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                " evictions\n",
+                counts.cache.hits,
+                counts.cache.misses,
+                counts.cache.evictions);
+    }
+    if (stats)
+    {
+        print_memory(&counts.arena);
+        print_stats();
+    }
+
+    if (!report_batch_status(status))
+    {
+        return EXIT_FAILURE;
+    }
+    return (0 == counts.failed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/******************************************************************************
+ * @brief    Reduce a stream or a binary column of operands
+ * @param    argc    Argument count, argv[1] being "--reduce"
+ * @param    argv    Arguments: the operator, then options and a file
+ * @return   EXIT_SUCCESS if every operand was reduced, EXIT_FAILURE
+ *           otherwise
+ ******************************************************************************/
+int run_reduce(int argc, char * argv[])
+{
+    const char *      path    = NULL;
+    uint32_t          threads = 1;
+    int               wide    = 0;
+    int               binary  = 0;
+    calc_batch_counts counts  = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    calc_reduction    result;
+    calc_batch_status status;
+
+    calc_reduce_op op = calc_parse_reduction((argc >= 3) ? argv[2] : NULL);
+    if (CALC_REDUCE_INVALID == op)
+    {
+        handle_error("Error! Invalid reduction.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 3; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], THREADS_MAX, &threads) ||
+                0 == threads)
+            {
+                handle_error("Error! Invalid thread count.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--wide"))
+        {
+            wide = 1;
+        }
+        else if (0 == strcmp(argv[i], "--binary"))
+        {
+            binary = 1;
+        }
+        else if (NULL == path)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    int input_fd = STDIN_FILENO;
+    if (NULL != path && 0 != strcmp(path, "-"))
+    {
+        input_fd = open(path, O_RDONLY);
+        if (input_fd < 0)
+        {
+            handle_error("Error! Unable to open batch file.\n");
+            return EXIT_FAILURE;
+        }
+    }
+    status = binary ? calc_binary_reduce(input_fd, op, threads, wide, &result)
+                    : calc_batch_reduce(
+                          input_fd, op, threads, wide, &result, &counts);
+    if (STDIN_FILENO != input_fd)
+    {
+        close(input_fd);
+    }
+
+    if (!report_batch_status(status))
+    {
+        return EXIT_FAILURE;
+    }
+    if (0 != counts.failed)
+    {
+        fprintf(stderr,
+                "Error! %zu of %zu lines are not operands.\n",
+                counts.failed,
+                counts.lines);
+        return EXIT_FAILURE;
+    }
+    if (CALC_OK != result.status)
+    {
+        fprintf(stderr, "%s\n", calc_status_message(result.status));
+        return EXIT_FAILURE;
+    }
+    printf("Result: %" PRId64 "\n", result.value);
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************
+ * @brief    Evaluate an infix expression
+ * @param    argc    Argument count, argv[1] being "--expr"
+ * @param    argv    Arguments: the expression, then name=value bindings
+ * @return   EXIT_SUCCESS if the expression was evaluated, EXIT_FAILURE
+ *           otherwise
+ ******************************************************************************/
+int run_expression(int argc, char * argv[])
+{
+    calc_expr * expr;
+    size_t      offset;
+    uint32_t    bindings[CALC_EXPR_VARIABLES_MAX];
+    int         bound[CALC_EXPR_VARIABLES_MAX] = { 0 };
+
+    if (argc < 3)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    calc_expr_status status = calc_expr_compile(argv[2], &expr, &offset);
+    if (CALC_EXPR_OK != status)
+    {
+        fprintf(stderr,
+                "%s (at offset %zu)\n",
+                calc_expr_status_message(status),
+                offset);
+        return EXIT_FAILURE;
+    }
+
+    int valid = 1;
+    for (int i = 3; valid && i < argc; i++)
+    {
+        const char * equals = strchr(argv[i], '=');
+        size_t       count  = calc_expr_variable_count(expr);
+        size_t       index  = count;
+
+        if (NULL != equals)
+        {
+            index = calc_expr_find_variable(
+                expr, argv[i], (size_t)(equals - argv[i]));
+        }
+        if (index == count)
+        {
+            handle_error("Error! Unknown variable.\n");
+            valid = 0;
+        }
+        else if (!calc_parse_operand(equals + 1, &bindings[index]))
+        {
+            handle_error("Error! Invalid variable value.\n");
+            valid = 0;
+        }
+        else
+        {
+            bound[index] = 1;
+        }
+    }
+    for (size_t i = 0; valid && i < calc_expr_variable_count(expr); i++)
+    {
+        if (!bound[i])
+        {
+            fprintf(stderr,
+                    "Error! Variable %s is not bound.\n",
+                    calc_expr_variable_name(expr, i));
+            valid = 0;
+        }
+    }
+
+    calc_result result = { CALC_OK, CALC_KIND_UINT, { 0 } };
+    if (valid)
+    {
+        result = calc_expr_eval(expr, bindings);
+        print_result((CALC_OK == result.status) ? stdout : stderr, &result);
+    }
+    calc_expr_free(expr);
+    return (valid && CALC_OK == result.status) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/******************************************************************************
+ * @brief    Signal handler: make the running server return
+ ******************************************************************************/
+void stop_server(int signal_number)
+{
+    (void)signal_number;
+    if (NULL != serving)
+    {
+        calc_server_stop(serving);
+    }
+}
+
+/******************************************************************************
+ * @brief    Run server mode
+ * @param    argc    Argument count, argv[1] being "--serve"
+ * @param    argv    Arguments
+ * @return   EXIT_SUCCESS once interrupted, EXIT_FAILURE on error
+ ******************************************************************************/
+int run_server(int argc, char * argv[])
+{
+    const char *      unix_path   = NULL;
+    const char *      tcp_address = NULL;
+    uint32_t          cache       = 0;
+    calc_server *     server;
+    calc_batch_counts counts      = { 0, 0, { 0, 0, 0 }, { 0, 0, 0 } };
+    int               stats       = 0;
+    calc_io           io          = CALC_IO_URING;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--unix") && i + 1 < argc)
+        {
+            unix_path = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--tcp") && i + 1 < argc)
+        {
+            tcp_address = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--cache") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], CACHE_MAX, &cache) || 0 == cache)
+            {
+                handle_error("Error! Invalid cache size.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--io") && i + 1 < argc)
+        {
+            if (!parse_io(argv[++i], &io))
+            {
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--stats"))
+        {
+            stats = 1;
+        }
+        else
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (NULL == unix_path && NULL == tcp_address)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    switch (calc_server_create(unix_path, tcp_address, cache, io, &server))
+    {
+        case CALC_SERVER_OK:
+            break;
+        case CALC_SERVER_ADDRESS_ERROR:
+            handle_error("Error! Unable to listen on the given address.\n");
+            return EXIT_FAILURE;
+        case CALC_SERVER_POLL_ERROR:
+            handle_error("Error! Unable to set up the event loop.\n");
+            return EXIT_FAILURE;
+        case CALC_SERVER_NO_MEMORY:
+            handle_error("Error! Out of memory.\n");
+            return EXIT_FAILURE;
+    }
+
+    watch_stats();
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = stop_server;
+    sigemptyset(&action.sa_mask);
+    serving = server;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    calc_server_status status = calc_server_run(server, &counts);
+    serving                   = NULL;
+    calc_server_destroy(server);
+
+    fprintf(stderr,
+            "Served %zu requests, %zu failed\n",
+            counts.lines,
+            counts.failed);
+    if (0 != cache)
+    {
+        fprintf(stderr,
+                "Cache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+                " evictions\n",
+                counts.cache.hits,
+                counts.cache.misses,
+                counts.cache.evictions);
+    }
+    if (stats)
+    {
+        print_memory(&counts.arena);
+        print_stats();
+    }
+    if (CALC_SERVER_OK != status)
+    {
+        handle_error("Error! The event loop failed.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/******************************************************************************
+ * @brief    Run coordinator mode
+ * @param    argc    Argument count, argv[1] being "--coordinate"
+ * @param    argv    Arguments
+ * @return   EXIT_SUCCESS if every line or row was evaluated, EXIT_FAILURE
+ *           otherwise
+ ******************************************************************************/
+int run_coordinator(int argc, char * argv[])
+{
+    const char *      path       = NULL;
+    const char *      nodes[NODES_MAX];
+    size_t            node_count = 0;
+    uint32_t          shard      = 0;
+    uint32_t          credits    = CREDITS_DEFAULT;
+    uint32_t          timeout    = TIMEOUT_DEFAULT;
+    int               binary     = 0;
+    calc_coord_counts counts;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (0 == strcmp(argv[i], "--node") && i + 1 < argc)
+        {
+            if (NODES_MAX == node_count)
+            {
+                handle_error("Error! Too many nodes.\n");
+                return EXIT_FAILURE;
+            }
+            nodes[node_count++] = argv[++i];
+        }
+        else if (0 == strcmp(argv[i], "--shard") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], SHARD_MAX, &shard) || 0 == shard)
+            {
+                handle_error("Error! Invalid shard size.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--credits") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], CREDITS_MAX, &credits) || 0 == credits)
+            {
+                handle_error("Error! Invalid credit count.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--timeout") && i + 1 < argc)
+        {
+            if (!parse_count(argv[++i], TIMEOUT_MAX, &timeout) || 0 == timeout)
+            {
+                handle_error("Error! Invalid timeout.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (0 == strcmp(argv[i], "--binary"))
+        {
+            binary = 1;
+        }
+        else if (NULL == path)
+        {
+            path = argv[i];
+        }
+        else
+        {
+            print_usage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (0 == node_count)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    if (0 == shard)
+    {
+        shard = binary ? SHARD_ROWS : SHARD_LINES;
+    }
+
+    int input_fd = STDIN_FILENO;
+    if (NULL != path && 0 != strcmp(path, "-"))
+    {
+        input_fd = open(path, O_RDONLY);
+        if (input_fd < 0)
+        {
+            handle_error("Error! Unable to open batch file.\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    memset(&counts, 0, sizeof(counts));
+    calc_batch_status status = calc_coord_run(input_fd,
+                                              STDOUT_FILENO,
+                                              binary,
+                                              nodes,
+                                              node_count,
+                                              shard,
+                                              credits,
+                                              timeout,
+                                              &counts);
+    if (STDIN_FILENO != input_fd)
+    {
+        close(input_fd);
+    }
+
+    if (0 != counts.nodes_lost)
+    {
+        fprintf(stderr,
+                "Lost %zu of %zu nodes, %zu shards sent again\n",
+                counts.nodes_lost,
+                node_count,
+                counts.redispatched);
+    }
+    if (!report_batch_status(status))
+    {
+        return EXIT_FAILURE;
+    }
+    return (0 == counts.failed) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/******************************************************************************
+ * @brief    Handle errors
+ * @param    message Error message
+ ******************************************************************************/
+void handle_error(const char * message)
+{
+    fprintf(stderr, "%s", message);
+}
+
+/******************************************************************************
+ * @brief    Main function
+ ******************************************************************************/
+int main(int argc, char * argv[])
+{
+    if (argc >= 2 &&
+        (0 == strcmp(argv[1], "--batch") || 0 == strcmp(argv[1], "--binary")))
+    {
+        return run_batch(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--reduce"))
+    {
+        return run_reduce(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--expr"))
+    {
+        return run_expression(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--serve"))
+    {
+        return run_server(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--coordinate"))
+    {
+        return run_coordinator(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--width"))
+    {
+        return run_wide(argc, argv);
+    }
+    if (argc >= 2 && 0 == strcmp(argv[1], "--div"))
+    {
+        return run_division(argc, argv);
+    }
+
+    if (argc != 4)
+    {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+    return run_calculation(argv + 1, classic_division);
+}
@@ -0,0 +1,106 @@
+/******************************************************************************
+ * @file    main_static.c
+ * @brief   One-shot calculator for scripts, built as calc-static
+ * @version 1.6
+ * @date    October 2026
+ *
+ * A script that runs "./simplecalc a op b" once per value spends most of
+ * each run loading shared objects and setting up libc, not calculating.
+ * This entry point answers only that form. It is linked statically, so no
+ * dynamic loader runs, and it uses neither stdio nor locales nor the heap:
+ * the operands go through the same parser as batch lines, and the one
+ * line of output (or of error, on stderr) goes out in a single write(2).
+ * Results and messages are those of simplecalc, and so is the usage, on
+ * stdout and in one write(2) too, but for listing only the form answered.
+ ******************************************************************************/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "calc.h"
+
+// simplecalc's usage, for "a op b" only
+static const char usage[] = "Usage: ./calc-static operand1 operator operand2\n"
+                            "Supported Operators:\n"
+                            " (+)  addition\n"
+                            " (-)  subtraction\n"
+                            " (*)  multiplication\n"
+                            " (/)  divide\n"
+                            " (%)  modulo\n"
+                            " (<<) left shift\n"
+                            " (>>) right shift\n"
+                            " (&)  bitwise AND\n"
+                            " (|)  bitwise OR\n"
+                            " (^)  bitwise XOR\n"
+                            " (<<<) rotate left\n"
+                            " (>>>) rotate right\n";
+
+// Function Prototypes
+int  write_line(int fd, const char * line, size_t length);
+void write_message(int fd, const char * message);
+
+/******************************************************************************
+ * @brief    Write a whole line in one system call, if the descriptor takes it
+ * @return   1 if the line was written, 0 otherwise
+ ******************************************************************************/
+int write_line(int fd, const char * line, size_t length)
+{
+    while (0 != length)
+    {
+        ssize_t count = write(fd, line, length);
+        if (count <= 0)
+        {
+            return 0;
+        }
+        line += count;
+        length -= (size_t)count;
+    }
+    return 1;
+}
+
+/******************************************************************************
+ * @brief    Write a message that ends in a newline
+ ******************************************************************************/
+void write_message(int fd, const char * message)
+{
+    (void)write_line(fd, message, strlen(message));
+}
+
+/******************************************************************************
+ * @brief    Main function
+ ******************************************************************************/
+int main(int argc, char * argv[])
+{
+    uint32_t operand1;
+    uint32_t operand2;
+    char     line[CALC_FORMAT_MAX];
+
+    if (4 != argc)
+    {
+        (void)write_line(STDOUT_FILENO, usage, sizeof(usage) - 1);
+        return EXIT_FAILURE;
+    }
+    if (!calc_parse_operand(argv[1], &operand1))
+    {
+        write_message(STDERR_FILENO, "Error! Invalid operand1.\n");
+        return EXIT_FAILURE;
+    }
+    if (!calc_parse_operand(argv[3], &operand2))
+    {
+        write_message(STDERR_FILENO, "Error! Invalid operand2.\n");
+        return EXIT_FAILURE;
+    }
+
+    calc_result result =
+        calc_execute(calc_parse_operator(argv[2]), operand1, operand2);
+    int ok = (CALC_OK == result.status);
+    if (!write_line(ok ? STDOUT_FILENO : STDERR_FILENO,
+                    line,
+                    calc_format_result(line, &result)))
+    {
+        return EXIT_FAILURE;
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}